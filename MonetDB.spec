@@ -582,6 +582,7 @@ embedded library (%{name}-embedded).
 %{_libdir}/monetdb5*/lib_capi.so
 %endif
 %{_libdir}/monetdb5*/lib_csv.so
+%{_libdir}/monetdb5*/lib_parquet.so
 %{_libdir}/monetdb5*/lib_generator.so
 %{_libdir}/monetdb5*/lib_monetdb_loader.so
 
@@ -834,6 +835,7 @@ package.  You probably don't need this, unless you are a developer.
 %{_bindir}/example2
 %{_bindir}/example_append
 %{_bindir}/example_append_raw
+%{_bindir}/example_arrow
 %{_bindir}/example_backup
 %{_bindir}/example_blob
 %{_bindir}/example_connections
@@ -1041,6 +1043,7 @@ rm "${RPM_BUILD_ROOT}"%{_bindir}/example1
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example2
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example_append
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example_append_raw
+rm "${RPM_BUILD_ROOT}"%{_bindir}/example_arrow
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example_backup
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example_blob
 rm "${RPM_BUILD_ROOT}"%{_bindir}/example_connections
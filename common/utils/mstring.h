@@ -245,6 +245,84 @@ checkUTF8(const char *v)
 	return true;
 }
 
+/* SWAR ("SIMD within a register") helpers to look at eight bytes at
+ * a time.  swar_eq returns a word in which the high bit of each byte
+ * is set if and only if the corresponding byte of w is equal to c (no
+ * false positives), and all other bits are zero. */
+#define SWAR_ONES	UINT64_C(0x0101010101010101)
+#define SWAR_HIGH	UINT64_C(0x8080808080808080)
+
+static inline uint64_t
+swar_load(const char *s)
+{
+	uint64_t w;
+	memcpy(&w, s, sizeof(w));
+	return w;
+}
+
+static inline uint64_t
+swar_eq(uint64_t w, char c)
+{
+	const uint64_t low7 = ~SWAR_HIGH;
+	uint64_t x = w ^ (SWAR_ONES * (unsigned char) c);
+	return ~(((x & low7) + low7) | x | low7);
+}
+
+/* Return the offset of the first (lowest addressed) byte of a word
+ * loaded with swar_load whose high bit is set in m; m must be a
+ * non-zero combination of swar_eq results. */
+static inline int
+swar_first(uint64_t m)
+{
+#ifdef __has_builtin
+#ifdef WORDS_BIGENDIAN
+#if __has_builtin(__builtin_clzll)
+	return __builtin_clzll(m) >> 3;
+#define SWAR_BUILTIN_USED
+#endif
+#else
+#if __has_builtin(__builtin_ctzll)
+	return __builtin_ctzll(m) >> 3;
+#define SWAR_BUILTIN_USED
+#endif
+#endif
+#endif
+#ifndef SWAR_BUILTIN_USED
+	int i = 0;
+#ifdef WORDS_BIGENDIAN
+	while ((m & (SWAR_HIGH << 56)) == 0) {
+		m <<= 8;
+		i++;
+	}
+#else
+	while ((m & 0x80) == 0) {
+		m >>= 8;
+		i++;
+	}
+#endif
+	return i;
+#endif
+#undef SWAR_BUILTIN_USED
+}
+
+/* Return a pointer to the first byte in [s, e) that is equal to c1, c2
+ * or c3, or e if there is no such byte.  Pass the same character
+ * multiple times if fewer are needed. */
+static inline const char *
+strfind3(const char *s, const char *e, char c1, char c2, char c3)
+{
+	while (e - s >= 8) {
+		uint64_t w = swar_load(s);
+		uint64_t m = swar_eq(w, c1) | swar_eq(w, c2) | swar_eq(w, c3);
+		if (m)
+			return s + swar_first(m);
+		s += 8;
+	}
+	while (s < e && *s != c1 && *s != c2 && *s != c3)
+		s++;
+	return s;
+}
+
 __attribute__((__format__(__printf__, 4, 0)))
 static inline int
 vreallocprintf(char **buf, size_t *pos, size_t *capacity, _In_z_ _Printf_format_string_ const char *fmt, va_list args)
@@ -0,0 +1,2 @@
+@echo off
+example_arrow.exe > nul
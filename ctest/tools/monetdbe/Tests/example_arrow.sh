@@ -0,0 +1,2 @@
+#!/bin/sh
+example_arrow > /dev/null
@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#include "monetdbe.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define error(msg) do{fprintf(stderr, "Failure: %s\n", msg); return -1;}while(0)
+
+/* print a utf8view value: 4 byte length, then either the string inlined
+ * (at most 12 bytes) or a 4 byte prefix, buffer index and offset */
+static void
+print_view(const struct ArrowArray *a, int64_t r)
+{
+	const uint8_t *valid = a->buffers[0];
+	const int32_t *view = (const int32_t *) a->buffers[1] + 4 * r;
+
+	if (valid && !(valid[r / 8] & (1 << (r % 8)))) {
+		printf("NULL");
+	} else if (view[0] <= 12) {
+		printf("%.*s", (int) view[0], (const char *) (view + 1));
+	} else {
+		const char *data = a->buffers[2 + view[2]];
+		printf("%.*s", (int) view[0], data + view[3]);
+	}
+}
+
+int
+main(void)
+{
+	char* err = NULL;
+	monetdbe_database mdbe = NULL;
+	monetdbe_result* result = NULL;
+	struct ArrowSchema schema;
+	struct ArrowArray array;
+
+	// second argument is a string for the db directory or NULL for in-memory mode
+	if (monetdbe_open(&mdbe, NULL, NULL))
+		error("Failed to open database");
+	if ((err = monetdbe_query(mdbe, "CREATE TABLE test (x integer, y string)", NULL, NULL)) != NULL)
+		error(err);
+	if ((err = monetdbe_query(mdbe, "INSERT INTO test VALUES (42, 'Hello'), (NULL, 'World'), (7, NULL), (8, 'a string that does not fit inline')", NULL, NULL)) != NULL)
+		error(err);
+	if ((err = monetdbe_query(mdbe, "SELECT x, y FROM test; ", &result, NULL)) != NULL)
+		error(err);
+	if ((err = monetdbe_result_fetch_arrow(result, &schema, &array)) != NULL)
+		error(err);
+	// the exported array holds its own references, the result may go first
+	if ((err = monetdbe_cleanup_result(mdbe, result)) != NULL)
+		error(err);
+
+	if (strcmp(schema.format, "+s") != 0 || schema.n_children != 2 || array.n_children != 2 || array.length != 4)
+		error("Unexpected struct array");
+	if (strcmp(schema.children[0]->format, "i") != 0 || strcmp(schema.children[0]->name, "x") != 0)
+		error("Unexpected schema for column x");
+	if (strcmp(schema.children[1]->format, "vu") != 0 || strcmp(schema.children[1]->name, "y") != 0)
+		error("Unexpected schema for column y");
+	if (array.children[0]->null_count != 1 || array.children[1]->null_count != 1)
+		error("Unexpected null count");
+
+	const struct ArrowArray *x = array.children[0];
+	const uint8_t *valid = x->buffers[0];
+	const int32_t *xdata = x->buffers[1];
+	for (int64_t r = 0; r < array.length; r++) {
+		if (valid && !(valid[r / 8] & (1 << (r % 8))))
+			printf("NULL");
+		else
+			printf("%" PRId32, xdata[r]);
+		printf(", ");
+		print_view(array.children[1], r);
+		printf("\n");
+	}
+	if (xdata[0] != 42)
+		error("Unexpected value");
+
+	array.release(&array);
+	schema.release(&schema);
+	if (array.release != NULL || schema.release != NULL)
+		error("Arrow structures were not released");
+
+	if (monetdbe_close(mdbe))
+		error("Failed to close database");
+	return 0;
+}
@@ -283,9 +283,11 @@ typedef struct {
 	bool remove;		/* remove storage file when freeing */
 	bool wasempty;		/* heap was empty when last saved/created */
 	bool hasfile;		/* .filename exists on disk */
+	bool spilled;		/* spilled partitions (see HEAPspill) */
 	storage_t storage;	/* storage mode (mmap/malloc). */
 	storage_t newstorage;	/* new desired storage mode at re-allocation. */
 	bat parentid;		/* cache id of VIEW parent bat */
+	struct Strdict *strdict; /* string heap is free of duplicates */
 } Heap;
 
 typedef struct Hash Hash;
@@ -336,6 +338,8 @@ gdk_export bool VALisnil(const ValRecord *v);
 typedef struct PROPrec PROPrec;
 
 #define ORDERIDXOFF		3
+#define ZONEMAPOFF		4
+#define ZONEMAP_BLOCK		1024
 
 /* assert that atom width is power of 2, i.e., width == 1<<shift */
 #define assert_shift_width(shift,width) assert(((shift) == 0 && (width) == 0) || ((unsigned)1<<(shift)) == (unsigned)(width))
@@ -418,6 +422,7 @@ typedef struct BAT {
 #endif
 	Heap *torderidx;	/* order oid index */
 	Strimps *tstrimps;	/* string imprint index  */
+	Heap *tzonemap;		/* per-block min/max index */
 	PROPrec *tprops;	/* list of dynamic properties stored in the bat descriptor */
 
 	MT_Lock theaplock;	/* lock protecting heap reference changes */
@@ -1387,6 +1392,8 @@ gdk_export BAT *STRMPfilter(BAT *b, BAT *s, const char *q, const bool keep_nils)
 gdk_export void STRMPdestroy(BAT *b);
 gdk_export bool BAThasstrimps(BAT *b);
 gdk_export gdk_return BATsetstrimps(BAT *b);
+gdk_export gdk_return STRMPcreatefrom(BAT *b, BAT *v);
+gdk_export bool STRMPshare(BAT *v, BAT *b);
 
 /* Rtree structure functions */
 #ifdef HAVE_RTREE
@@ -1564,6 +1571,7 @@ gdk_export gdk_return BATsemijoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl,
 	__attribute__((__warn_unused_result__));
 gdk_export BAT *BATintersect(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, bool max_one, BUN estimate);
 gdk_export BAT *BATdiff(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, bool not_in, BUN estimate);
+gdk_export BAT *BATbloomfilter(BAT *l, BAT *r, BAT *sl, BAT *sr);
 gdk_export gdk_return BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate)
 	__attribute__((__access__(write_only, 1)))
 	__attribute__((__access__(write_only, 2)))
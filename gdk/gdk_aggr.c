@@ -5229,3 +5229,164 @@ BATgroupcorrelation(BAT *b1, BAT *b2, BAT *g, BAT *e, BAT *s, int tp, bool skip_
 	ma_close(&ma_state);
 	return NULL;
 }
+
+/* Select the values in b (restricted to the candidate list s) that
+ * fulfill the condition "b op val" (see BATthetaselect) and calculate
+ * naggr aggregates over the corresponding values of the columns in
+ * cols.  The aggregates are given by name in aggr[] and can be
+ * "count" (the column is ignored), "sum", "min", or "max"; the result
+ * of each is stored in res[], whose vtype must have been set by the
+ * caller.  Nils are skipped, and the result of an aggregate over no
+ * values is nil (except for count).
+ *
+ * Instead of first materializing the complete selection and then the
+ * projections of the columns, the work is done in morsels of
+ * candidates that are small enough that the intermediates stay in the
+ * L2 cache: for each morsel we do the select, and then immediately the
+ * aggregates, using the partial selection as candidate list.  The
+ * partial results are collected and aggregated at the end.  Only fixed
+ * size types are supported. */
+gdk_return
+BATthetaselectaggr(BAT *b, BAT *s, const void *val, const char *op,
+		   int naggr, const char *const *aggr, BAT **cols,
+		   ValPtr res)
+{
+	struct canditer ci;
+	BAT **parts;
+	lng *counts;
+	size_t width;
+	BUN morsel, nmorsels = 0;
+	gdk_return rc = GDK_FAIL;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	assert(naggr > 0);
+	width = b->twidth + sizeof(oid);
+	for (int i = 0; i < naggr; i++) {
+		if (strcmp(aggr[i], "count") == 0) {
+			if (res[i].vtype != TYPE_lng) {
+				GDKerror("count result must be of type lng\n");
+				return GDK_FAIL;
+			}
+			continue;
+		}
+		if (strcmp(aggr[i], "sum") != 0 &&
+		    strcmp(aggr[i], "min") != 0 &&
+		    strcmp(aggr[i], "max") != 0) {
+			GDKerror("unknown aggregate %s\n", aggr[i]);
+			return GDK_FAIL;
+		}
+		if (ATOMvarsized(cols[i]->ttype) ||
+		    ATOMvarsized(res[i].vtype) ||
+		    BATcount(cols[i]) != BATcount(b) ||
+		    cols[i]->hseqbase != b->hseqbase) {
+			GDKerror("unsupported column for aggregate %s\n",
+				 aggr[i]);
+			return GDK_FAIL;
+		}
+		width += cols[i]->twidth;
+	}
+
+	canditer_init(&ci, b, s);
+	morsel = (BUN) (GDK_l2_cachesize / width);
+	if (morsel < 1024)
+		morsel = 1024;
+
+	parts = GDKzalloc(naggr * sizeof(BAT *));
+	counts = GDKzalloc(naggr * sizeof(lng));
+	if (parts == NULL || counts == NULL)
+		goto bailout;
+	for (int i = 0; i < naggr; i++) {
+		if (strcmp(aggr[i], "count") != 0 &&
+		    (parts[i] = COLnew(0, res[i].vtype,
+				       ci.ncand / morsel + 1,
+				       TRANSIENT)) == NULL)
+			goto bailout;
+	}
+
+	for (BUN lo = 0; lo < ci.ncand; lo += morsel) {
+		BAT *cm, *sel;
+
+		TIMEOUT_CHECK(qry_ctx, GOTO_LABEL_TIMEOUT_HANDLER(bailout, qry_ctx));
+		nmorsels++;
+		if ((cm = canditer_slice(&ci, lo, lo + morsel)) == NULL)
+			goto bailout;
+		sel = BATthetaselect(b, cm, val, op);
+		BBPunfix(cm->batCacheid);
+		if (sel == NULL)
+			goto bailout;
+		for (int i = 0; i < naggr; i++) {
+			ValRecord v = (ValRecord) {.vtype = res[i].vtype};
+			BAT *p;
+
+			switch (aggr[i][1]) {
+			case 'o':	/* count */
+				counts[i] += (lng) BATcount(sel);
+				continue;
+			case 'u':	/* sum */
+				if (BATsum(VALget(&v), v.vtype, cols[i], sel, true, true) != GDK_SUCCEED) {
+					BBPunfix(sel->batCacheid);
+					goto bailout;
+				}
+				break;
+			default:	/* min, max */
+				if ((p = BATproject(sel, cols[i])) == NULL) {
+					BBPunfix(sel->batCacheid);
+					goto bailout;
+				}
+				if ((aggr[i][1] == 'i' ?
+				     BATmin_skipnil(NULL, p, VALget(&v), true) :
+				     BATmax_skipnil(NULL, p, VALget(&v), true)) == NULL) {
+					BBPunfix(p->batCacheid);
+					BBPunfix(sel->batCacheid);
+					goto bailout;
+				}
+				BBPunfix(p->batCacheid);
+				break;
+			}
+			if (BUNappend(parts[i], VALget(&v), false) != GDK_SUCCEED) {
+				BBPunfix(sel->batCacheid);
+				goto bailout;
+			}
+		}
+		BBPunfix(sel->batCacheid);
+	}
+
+	for (int i = 0; i < naggr; i++) {
+		switch (aggr[i][1]) {
+		case 'o':
+			res[i].val.lval = counts[i];
+			break;
+		case 'u':
+			if (BATsum(VALget(&res[i]), res[i].vtype, parts[i], NULL, true, true) != GDK_SUCCEED)
+				goto bailout;
+			break;
+		case 'i':
+			if (BATmin_skipnil(NULL, parts[i], VALget(&res[i]), true) == NULL)
+				goto bailout;
+			break;
+		default:
+			if (BATmax_skipnil(NULL, parts[i], VALget(&res[i]), true) == NULL)
+				goto bailout;
+			break;
+		}
+	}
+	rc = GDK_SUCCEED;
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",s=" ALGOOPTBATFMT
+		  ",op=%s,naggr=%d,morsel=" BUNFMT ",nmorsels=" BUNFMT
+		  " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOOPTBATPAR(s), op, naggr,
+		  morsel, nmorsels, GDKusec() - t0);
+
+  bailout:
+	if (parts) {
+		for (int i = 0; i < naggr; i++)
+			BBPreclaim(parts[i]);
+		GDKfree(parts);
+	}
+	GDKfree(counts);
+	return rc;
+}
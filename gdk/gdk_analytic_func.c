@@ -17,6 +17,9 @@
 Heap *
 GDKinitialize_segment_tree(void)
 {
+	/* several segment trees may exist at the same time, so they
+	 * need different names in case they get memory mapped */
+	static ATOMIC_TYPE stid = ATOMIC_VAR_INIT(0);
 	Heap *h = GDKmalloc(sizeof(Heap));
 	if (h == NULL)
 		return NULL;
@@ -25,8 +28,8 @@ GDKinitialize_segment_tree(void)
 		.dirty = true,
 		.refs = ATOMIC_VAR_INIT(1),
 	};
-	snprintf(h->filename, sizeof(h->filename), "st%zu.tmp",
-		 (size_t) MT_getpid());
+	snprintf(h->filename, sizeof(h->filename), "st%zu_%zu.tmp",
+		 (size_t) MT_getpid(), (size_t) ATOMIC_INC(&stid));
 	if (h->farmid < 0 || HEAPalloc(h, 1024, 1) != GDK_SUCCEED) {
 		GDKfree(h);
 		return NULL;
@@ -66,6 +69,96 @@ GDKrebuild_segment_tree(oid ncount, oid data_size, Heap *st, void **segment_tree
 	return GDK_SUCCEED;
 }
 
+/* The window aggregates sum, min, max and count compute each
+ * partition independently of the others.  If there are enough rows
+ * and there is a partitioning, the rows are divided into ranges of
+ * whole partitions which are processed by separate threads, each with
+ * its own segment tree.  The function that computes a range reports
+ * errors through its return value since only the calling thread can
+ * use GDKerror. */
+#define ANALYTIC_MINROWS	((oid) 1 << 16)	/* min rows per thread */
+
+enum analytic_error {
+	ANALYTIC_OK,
+	ANALYTIC_FAIL,		/* allocation failed */
+	ANALYTIC_NOSUPPORT,	/* type combination not supported */
+	ANALYTIC_FSUM,		/* floating point sum failed */
+	ANALYTIC_OVERFLOW,	/* overflow in calculation */
+};
+
+struct analytic {
+	BAT *p, *r;
+	BATiter *bi;
+	const bit *np, *op;
+	const oid *start, *end;
+	int tpe, tp1, tp2, frame_type;
+	bool count_all;
+	/* compute rows [lo,hi) which consist of whole partitions */
+	enum analytic_error (*range)(const struct analytic *a, oid lo, oid hi, bool *has_nils);
+};
+
+struct analyticwork {
+	const struct analytic *a;
+	oid lo, hi;
+	bool has_nils;
+	enum analytic_error err;
+};
+
+static void
+analytic_work(void *arg)
+{
+	struct analyticwork *w = arg;
+
+	w->err = w->a->range(w->a, w->lo, w->hi, &w->has_nils);
+}
+
+/* compute the window aggregate for all cnt rows, using multiple
+ * threads if parallel is set and it is worth it */
+static enum analytic_error
+analytic_partitions(const struct analytic *a, oid cnt, bool parallel,
+		    bool *has_nils)
+{
+	struct analyticwork *work;
+	oid nthreads = (oid) GDKnr_threads;
+	int n = 0;
+	enum analytic_error err = ANALYTIC_OK;
+
+	*has_nils = false;
+	if (nthreads > cnt / ANALYTIC_MINROWS)
+		nthreads = cnt / ANALYTIC_MINROWS;
+	if (!parallel || a->np == NULL || nthreads <= 1 ||
+	    (work = GDKmalloc(nthreads * sizeof(*work))) == NULL)
+		return a->range(a, 0, cnt, has_nils);
+
+	/* split at the partition boundaries following the equally
+	 * spaced positions */
+	for (oid t = 1, lo = 0; t <= nthreads && lo < cnt; t++) {
+		oid hi = t == nthreads ? cnt : cnt / nthreads * t;
+		if (hi <= lo)
+			continue;
+		while (hi < cnt && !a->np[hi])
+			hi++;
+		work[n++] = (struct analyticwork) {
+			.a = a,
+			.lo = lo,
+			.hi = hi,
+		};
+		lo = hi;
+	}
+	GDKparallel(analytic_work, work, sizeof(*work), n, "windowXXXX");
+	for (int i = 0; i < n; i++) {
+		*has_nils |= work[i].has_nils;
+		if (err == ANALYTIC_OK && work[i].err != ANALYTIC_OK) {
+			err = work[i].err;
+			/* the error of another thread got lost */
+			if (err == ANALYTIC_FAIL && i > 0)
+				GDKerror("could not allocate segment tree\n");
+		}
+	}
+	GDKfree(work);
+	return err;
+}
+
 #define NTILE_CALC(TPE, NEXT_VALUE, LNG_HGE, UPCAST, VALIDATION)	\
 	do {								\
 		UPCAST j = 0, ncnt = (UPCAST) (i - k);			\
@@ -1168,7 +1261,7 @@ GDKanalyticallead(BAT *b, BAT *p, BUN lead, const void *restrict default_value,
 				if (op[j] || j == k) {			\
 					BUN x = l * width;		\
 					for (; ; l--) {			\
-						memcpy(rcast + x, curval, width); \
+						memcpy(rbase + x, curval, width); \
 						x -= width;		\
 						if (l == j)		\
 							break;		\
@@ -1348,6 +1441,55 @@ minmaxvarsized##IMP:							\
 	} while (0)
 
 #define ANALYTICAL_MIN_MAX(OP, MIN_MAX, GT_LT)				\
+static enum analytic_error						\
+analytical_##OP##_range(const struct analytic *a, oid lo, oid hi, bool *has_nilsp) \
+{									\
+	BAT *p = a->p, *r = a->r;					\
+	BATiter bi = *a->bi;						\
+	bool has_nils = false, last = false;				\
+	oid i = lo + 1, j = lo, k = lo, l = 0, cnt = hi,		\
+		*levels_offset = NULL, nlevels = 0;			\
+	const oid *restrict start = a->start, *restrict end = a->end;	\
+	const bit *np = a->np, *op = a->op;				\
+	int tpe = a->tpe;						\
+	const void *nil = ATOMnilptr(tpe);				\
+	int (*atomcmp)(const void *, const void *) = ATOMcompare(tpe);	\
+	bool (*atomeq)(const void *, const void *) = ATOMequal(tpe);	\
+	void *segment_tree = NULL;					\
+	gdk_return res = GDK_SUCCEED;					\
+	uint16_t width = r->twidth;					\
+	uint8_t *rbase = (uint8_t *) Tloc(r, 0);			\
+	uint8_t *restrict rcast = rbase + lo * width;			\
+	Heap *st = NULL;						\
+									\
+	switch (a->frame_type) {					\
+	case 3: /* unbounded until current row */			\
+		ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, UNBOUNDED_TILL_CURRENT_ROW); \
+		break;							\
+	case 4: /* current row until unbounded */			\
+		ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, CURRENT_ROW_TILL_UNBOUNDED); \
+		break;							\
+	case 5: /* all rows */						\
+		ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, ALL_ROWS);	\
+		break;							\
+	case 6: /* current row */					\
+		ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, CURRENT_ROW); \
+		break;							\
+	default:							\
+		if ((st = GDKinitialize_segment_tree()) == NULL) {	\
+			res = GDK_FAIL;					\
+			goto cleanup;					\
+		}							\
+		ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, OTHERS);	\
+		break;							\
+	}								\
+cleanup:								\
+	if (st)								\
+		HEAPdecref(st, true);					\
+	*has_nilsp = has_nils;						\
+	return res == GDK_SUCCEED ? ANALYTIC_OK : ANALYTIC_FAIL;	\
+}									\
+									\
 BAT *									\
 GDKanalytical##OP(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, int tpe, int frame_type) \
 {									\
@@ -1361,56 +1503,37 @@ GDKanalytical##OP(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, int tpe, int frame_typ
 	BATiter bi = bat_iterator(b);					\
 	BATiter si = bat_iterator(s);					\
 	BATiter ei = bat_iterator(e);					\
-	bool has_nils = false, last = false;				\
-	oid i = 1, j = 0, k = 0, l = 0, cnt = BATcount(b), *restrict start = si.base, *restrict end = ei.base, \
-		*levels_offset = NULL, nlevels = 0;			\
-	bit *np = pi.base, *op = oi.base;				\
-	const void *nil = ATOMnilptr(tpe);				\
-	int (*atomcmp)(const void *, const void *) = ATOMcompare(tpe);	\
-	bool (*atomeq)(const void *, const void *) = ATOMequal(tpe);	\
-	void *segment_tree = NULL;					\
-	gdk_return res = GDK_SUCCEED;					\
-	uint16_t width = r->twidth;					\
-	uint8_t *restrict rcast = (uint8_t *) Tloc(r, 0);		\
-	Heap *st = NULL;						\
+	bool has_nils = false;						\
+	oid cnt = BATcount(b);						\
+	struct analytic a = {						\
+		.p = p,							\
+		.r = r,							\
+		.bi = &bi,						\
+		.np = pi.base,						\
+		.op = oi.base,						\
+		.start = si.base,					\
+		.end = ei.base,						\
+		.tpe = tpe,						\
+		.frame_type = frame_type,				\
+		.range = analytical_##OP##_range,			\
+	};								\
+	enum analytic_error err = ANALYTIC_OK;				\
 									\
-	assert(np == NULL || cnt == 0 || np[0] == 0);			\
-	if (cnt > 0) {							\
-		switch (frame_type) {					\
-		case 3: /* unbounded until current row */		\
-			ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, UNBOUNDED_TILL_CURRENT_ROW); \
-			break;						\
-		case 4: /* current row until unbounded */		\
-			ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, CURRENT_ROW_TILL_UNBOUNDED); \
-			break;						\
-		case 5: /* all rows */					\
-			ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, ALL_ROWS); \
-			break;						\
-		case 6: /* current row */				\
-			ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, CURRENT_ROW); \
-			break;						\
-		default:						\
-			if ((st = GDKinitialize_segment_tree()) == NULL) { \
-				res = GDK_FAIL;				\
-				goto cleanup;				\
-			}						\
-			ANALYTICAL_MIN_MAX_BRANCHES(MIN_MAX, GT_LT, OTHERS); \
-			break;						\
-		}							\
+	assert(a.np == NULL || cnt == 0 || a.np[0] == 0);		\
+	/* var-sized results are appended to the heap one at a time */	\
+	if (cnt > 0)							\
+		err = analytic_partitions(&a, cnt, !ATOMvarsized(tpe), &has_nils); \
+	if (err == ANALYTIC_OK) {					\
+		BATsetcount(r, cnt);					\
+		r->tnonil = !has_nils;					\
+		r->tnil = has_nils;					\
 	}								\
-									\
-	BATsetcount(r, cnt);						\
-	r->tnonil = !has_nils;						\
-	r->tnil = has_nils;						\
-cleanup:								\
 	bat_iterator_end(&pi);						\
 	bat_iterator_end(&oi);						\
 	bat_iterator_end(&bi);						\
 	bat_iterator_end(&si);						\
 	bat_iterator_end(&ei);						\
-	if (st)								\
-		HEAPdecref(st, true);					\
-	if (res != GDK_SUCCEED) {					\
+	if (err != ANALYTIC_OK) {					\
 		BBPreclaim(r);						\
 		r = NULL;						\
 	} else {							\
@@ -1732,6 +1855,53 @@ countothers##IMP:							\
 		}							\
 	} while (0)
 
+static enum analytic_error
+analytical_count_range(const struct analytic *a, oid lo, oid hi, bool *has_nilsp)
+{
+	BAT *p = a->p;
+	oid i = lo + 1, j = lo, k = lo, l = 0, cnt = hi,
+		*levels_offset = NULL, nlevels = 0;
+	const oid *restrict start = a->start, *restrict end = a->end;
+	lng curval = 0, *rb = (lng *) Tloc(a->r, 0);
+	const bit *np = a->np, *op = a->op;
+	int tpe = a->tpe;
+	const void *restrict nil = ATOMnilptr(tpe);
+	bool (*atomeq) (const void *, const void *) = ATOMequal(tpe);
+	const void *restrict bheap = a->bi->base;
+	BATiter bi = *a->bi;
+	bool count_all = a->count_all, last = false;
+	void *segment_tree = NULL;
+	gdk_return res = GDK_SUCCEED;
+	Heap *st = NULL;
+
+	switch (a->frame_type) {
+	case 3: /* unbounded until current row */
+		ANALYTICAL_COUNT_BRANCHES(UNBOUNDED_TILL_CURRENT_ROW);
+		break;
+	case 4: /* current row until unbounded */
+		ANALYTICAL_COUNT_BRANCHES(CURRENT_ROW_TILL_UNBOUNDED);
+		break;
+	case 5: /* all rows */
+		ANALYTICAL_COUNT_BRANCHES(ALL_ROWS);
+		break;
+	case 6: /* current row */
+		ANALYTICAL_COUNT_BRANCHES(CURRENT_ROW);
+		break;
+	default:
+		if (!count_all && (st = GDKinitialize_segment_tree()) == NULL) {
+			res = GDK_FAIL;
+			goto cleanup;
+		}
+		ANALYTICAL_COUNT_BRANCHES(OTHERS);
+		break;
+	}
+cleanup:
+	if (st)
+		HEAPdecref(st, true);
+	*has_nilsp = false;
+	return res == GDK_SUCCEED ? ANALYTIC_OK : ANALYTIC_FAIL;
+}
+
 BAT *
 GDKanalyticalcount(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, bit ignore_nils, int tpe, int frame_type)
 {
@@ -1745,55 +1915,37 @@ GDKanalyticalcount(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, bit ignore_nils, int
 	BATiter bi = bat_iterator(b);
 	BATiter si = bat_iterator(s);
 	BATiter ei = bat_iterator(e);
-	oid i = 1, j = 0, k = 0, l = 0, cnt = BATcount(b), *restrict start = si.base, *restrict end = ei.base,
-		*levels_offset = NULL, nlevels = 0;
-	lng curval = 0, *rb = (lng *) Tloc(r, 0);
-	bit *np = pi.base, *op = oi.base;
-	const void *restrict nil = ATOMnilptr(tpe);
-	bool (*atomeq) (const void *, const void *) = ATOMequal(tpe);
-	const void *restrict bheap = bi.base;
-	bool count_all = !ignore_nils || bi.nonil, last = false;
-	void *segment_tree = NULL;
-	gdk_return res = GDK_SUCCEED;
-	Heap *st = NULL;
-
-	assert(np == NULL || cnt == 0 || np[0] == 0);
-	if (cnt > 0) {
-		switch (frame_type) {
-		case 3: /* unbounded until current row */
-			ANALYTICAL_COUNT_BRANCHES(UNBOUNDED_TILL_CURRENT_ROW);
-			break;
-		case 4: /* current row until unbounded */
-			ANALYTICAL_COUNT_BRANCHES(CURRENT_ROW_TILL_UNBOUNDED);
-			break;
-		case 5: /* all rows */
-			ANALYTICAL_COUNT_BRANCHES(ALL_ROWS);
-			break;
-		case 6: /* current row */
-			ANALYTICAL_COUNT_BRANCHES(CURRENT_ROW);
-			break;
-		default:
-			if (!count_all && (st = GDKinitialize_segment_tree()) == NULL) {
-				res = GDK_FAIL;
-				goto cleanup;
-			}
-			ANALYTICAL_COUNT_BRANCHES(OTHERS);
-			break;
-		}
+	oid cnt = BATcount(b);
+	bool has_nils;
+	struct analytic a = {
+		.p = p,
+		.r = r,
+		.bi = &bi,
+		.np = pi.base,
+		.op = oi.base,
+		.start = si.base,
+		.end = ei.base,
+		.tpe = tpe,
+		.frame_type = frame_type,
+		.count_all = !ignore_nils || bi.nonil,
+		.range = analytical_count_range,
+	};
+	enum analytic_error err = ANALYTIC_OK;
+
+	assert(a.np == NULL || cnt == 0 || a.np[0] == 0);
+	if (cnt > 0)
+		err = analytic_partitions(&a, cnt, true, &has_nils);
+	if (err == ANALYTIC_OK) {
+		BATsetcount(r, cnt);
+		r->tnonil = true;
+		r->tnil = false;
 	}
-
-	BATsetcount(r, cnt);
-	r->tnonil = true;
-	r->tnil = false;
-cleanup:
 	bat_iterator_end(&pi);
 	bat_iterator_end(&oi);
 	bat_iterator_end(&bi);
 	bat_iterator_end(&si);
 	bat_iterator_end(&ei);
-	if (st)
-		HEAPdecref(st, true);
-	if (res != GDK_SUCCEED) {
+	if (err != ANALYTIC_OK) {
 		BBPreclaim(r);
 		r = NULL;
 	} else {
@@ -2086,6 +2238,62 @@ sum##TPE1##TPE2##IMP:						\
 		}							\
 	} while (0)
 
+static enum analytic_error
+analytical_sum_range(const struct analytic *a, oid lo, oid hi, bool *has_nilsp)
+{
+	BAT *p = a->p, *r = a->r;
+	BATiter bi = *a->bi;
+	bool has_nils = false, last = false;
+	oid i = lo + 1, j = lo, k = lo, l = 0, cnt = hi,
+		*levels_offset = NULL, nlevels = 0;
+	const oid *restrict start = a->start, *restrict end = a->end;
+	const bit *np = a->np, *op = a->op;
+	int tp1 = a->tp1, tp2 = a->tp2;
+	void *segment_tree = NULL;
+	gdk_return res = GDK_SUCCEED;
+	enum analytic_error err = ANALYTIC_OK;
+	Heap *st = NULL;
+
+	switch (a->frame_type) {
+	case 3: /* unbounded until current row */
+		ANALYTICAL_SUM_BRANCHES(UNBOUNDED_TILL_CURRENT_ROW);
+		break;
+	case 4: /* current row until unbounded */
+		ANALYTICAL_SUM_BRANCHES(CURRENT_ROW_TILL_UNBOUNDED);
+		break;
+	case 5: /* all rows */
+		ANALYTICAL_SUM_BRANCHES(ALL_ROWS);
+		break;
+	case 6: /* current row */
+		ANALYTICAL_SUM_BRANCHES(CURRENT_ROW);
+		break;
+	default:
+		if ((st = GDKinitialize_segment_tree()) == NULL) {
+			res = GDK_FAIL;
+			goto cleanup;
+		}
+		ANALYTICAL_SUM_BRANCHES(OTHERS);
+		break;
+	}
+cleanup:
+	if (st)
+		HEAPdecref(st, true);
+	*has_nilsp = has_nils;
+	if (err == ANALYTIC_OK && res != GDK_SUCCEED)
+		err = ANALYTIC_FAIL;
+	return err;
+
+nosupport:
+	err = ANALYTIC_NOSUPPORT;
+	goto cleanup;
+bailout:
+	err = ANALYTIC_FSUM;
+	goto cleanup;
+calc_overflow:
+	err = ANALYTIC_OVERFLOW;
+	goto cleanup;
+}
+
 BAT *
 GDKanalyticalsum(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, int tp1, int tp2, int frame_type)
 {
@@ -2097,53 +2305,52 @@ GDKanalyticalsum(BAT *p, BAT *o, BAT *b, BAT *s, BAT *e, int tp1, int tp2, int f
 	BATiter bi = bat_iterator(b);
 	BATiter si = bat_iterator(s);
 	BATiter ei = bat_iterator(e);
-	bool has_nils = false, last = false;
-	oid i = 1, j = 0, k = 0, l = 0, cnt = BATcount(b), *restrict start = si.base, *restrict end = ei.base,
-		*levels_offset = NULL, nlevels = 0;
-	bit *np = pi.base, *op = oi.base;
-	void *segment_tree = NULL;
-	gdk_return res = GDK_SUCCEED;
-	Heap *st = NULL;
+	bool has_nils = false;
+	oid cnt = BATcount(b);
+	struct analytic a = {
+		.p = p,
+		.r = r,
+		.bi = &bi,
+		.np = pi.base,
+		.op = oi.base,
+		.start = si.base,
+		.end = ei.base,
+		.tp1 = tp1,
+		.tp2 = tp2,
+		.frame_type = frame_type,
+		.range = analytical_sum_range,
+	};
+	enum analytic_error err = ANALYTIC_OK;
 	lng t0 = 0;
 
 	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
-	assert(np == NULL || cnt == 0 || np[0] == 0);
-	if (cnt > 0) {
-		switch (frame_type) {
-		case 3: /* unbounded until current row */
-			ANALYTICAL_SUM_BRANCHES(UNBOUNDED_TILL_CURRENT_ROW);
-			break;
-		case 4: /* current row until unbounded */
-			ANALYTICAL_SUM_BRANCHES(CURRENT_ROW_TILL_UNBOUNDED);
-			break;
-		case 5: /* all rows */
-			ANALYTICAL_SUM_BRANCHES(ALL_ROWS);
-			break;
-		case 6: /* current row */
-			ANALYTICAL_SUM_BRANCHES(CURRENT_ROW);
-			break;
-		default:
-			if ((st = GDKinitialize_segment_tree()) == NULL) {
-				res = GDK_FAIL;
-				goto cleanup;
-			}
-			ANALYTICAL_SUM_BRANCHES(OTHERS);
-			break;
-		}
+	assert(a.np == NULL || cnt == 0 || a.np[0] == 0);
+	if (cnt > 0)
+		err = analytic_partitions(&a, cnt, true, &has_nils);
+	switch (err) {
+	case ANALYTIC_OK:
+		BATsetcount(r, cnt);
+		r->tnonil = !has_nils;
+		r->tnil = has_nils;
+		break;
+	case ANALYTIC_NOSUPPORT:
+		GDKerror("42000!type combination (sum(%s)->%s) not supported.\n", ATOMname(tp1), ATOMname(tp2));
+		break;
+	case ANALYTIC_FSUM:
+		GDKerror("42000!error while calculating floating-point sum\n");
+		break;
+	case ANALYTIC_OVERFLOW:
+		GDKerror("22003!overflow in calculation.\n");
+		break;
+	default:
+		break;
 	}
-
-	BATsetcount(r, cnt);
-	r->tnonil = !has_nils;
-	r->tnil = has_nils;
-cleanup:
 	bat_iterator_end(&pi);
 	bat_iterator_end(&oi);
 	bat_iterator_end(&bi);
 	bat_iterator_end(&si);
 	bat_iterator_end(&ei);
-	if (st)
-		HEAPdecref(st, true);
-	if (res != GDK_SUCCEED) {
+	if (err != ANALYTIC_OK) {
 		BBPreclaim(r);
 		r = NULL;
 	} else {
@@ -2158,19 +2365,6 @@ cleanup:
 			  GDKusec() - t0);
 	}
 	return r;
-
-nosupport:
-	GDKerror("42000!type combination (sum(%s)->%s) not supported.\n", ATOMname(tp1), ATOMname(tp2));
-	res = GDK_FAIL;
-	goto cleanup;
-bailout:
-	GDKerror("42000!error while calculating floating-point sum\n");
-	res = GDK_FAIL;
-	goto cleanup;
-calc_overflow:
-	GDKerror("22003!overflow in calculation.\n");
-	res = GDK_FAIL;
-	goto cleanup;
 }
 
 /* product on integers */
@@ -389,6 +389,18 @@ ATOMreplaceVAR(BAT *b, var_t *dst, const void *src)
 #define GDK_ELIMBASE(x)		(((x) >> GDK_ELIMPOWER) << GDK_ELIMPOWER)
 #define GDK_VAROFFSET		((var_t) GDK_STRHASHSIZE)
 
+/* A string heap that outgrows the fully duplicate eliminated area
+ * keeps an in-memory dictionary (Heap.strdict) of all its strings for
+ * as long as there are no more than GDK_STRDICTLIMIT of them, so that
+ * it stays free of duplicates.  In a heap for which GDK_STRUNIQUE
+ * holds, equal strings have equal offsets, so the offsets can be
+ * compared instead of the strings.  Since the dictionary can be
+ * dropped by the thread that adds strings to the heap, GDK_STRUNIQUE
+ * is only a hint for other threads: they must be prepared for
+ * strLocate to return (var_t) -1. */
+#define GDK_STRDICTLIMIT	(1<<16)
+#define GDK_STRUNIQUE(h)	(GDK_ELIMDOUBLES(h) || (h)->strdict != NULL)
+
 /*
  * @- String Comparison, NILs and UTF-8
  *
@@ -476,6 +476,7 @@ BATclear(BAT *b, bool force)
 	OIDXdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 	PROPdestroy(b);
 
 	bat tvp = 0;
@@ -566,6 +567,7 @@ BATfree(BAT *b)
 	HASHfree(b);
 	OIDXfree(b);
 	STRMPfree(b);
+	ZMfree(b);
 	RTREEfree(b);
 	MT_lock_set(&b->theaplock);
 	if (nunique != BUN_NONE) {
@@ -596,6 +598,7 @@ BATfree(BAT *b)
 		assert((ATOMIC_GET(&b->tvheap->refs) & HEAPREFS) == 1);
 		assert(b->tvheap->parentid == b->batCacheid);
 		HEAPfree(b->tvheap, false);
+		strDictDestroy(b->tvheap);
 	}
 	MT_lock_unset(&b->theaplock);
 }
@@ -605,6 +608,7 @@ void
 BATdestroy(BAT *b)
 {
 	if (b->tvheap) {
+		strDictDestroy(b->tvheap);
 		GDKfree(b->tvheap);
 	}
 	PROPdestroy_nolock(b);
@@ -831,6 +835,8 @@ COLcopy2(BAT *b, int tt, bool writable, bool mayshare, role_t role)
 				bn->tascii = bi.ascii;
 				if (ATOMstorage(b->ttype) == TYPE_str && bi.vhfree >= GDK_STRHASHSIZE)
 					memcpy(bn->tvheap->base, strhash, GDK_STRHASHSIZE);
+				if (bi.vh->strdict)
+					strDictBuild(bn->tvheap);
 			}
 		}
 		memcpy(bn->theap->base, bi.base, bi.hfree);
@@ -1433,6 +1439,7 @@ BUNdelete(BAT *b, oid o)
 	OIDXdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 	PROPdestroy(b);
 	return GDK_SUCCEED;
 }
@@ -1599,6 +1606,7 @@ BUNinplacemulti(BAT *b, const oid *positions, const void *values, BUN count, boo
 		OIDXdestroy(b);
 		STRMPdestroy(b);
 		RTREEdestroy(b);
+		ZMdestroy(b);
 
 		if (b->tvheap && b->ttype) {
 			var_t _d;
@@ -172,7 +172,7 @@ insert_string_bat(BAT *b, BATiter *ni, struct canditer *ci, bool force, bool may
 		    unshare_varsized_heap(b) != GDK_SUCCEED) {
 			return GDK_FAIL;
 		}
-		if (oldcnt == 0 || (!GDK_ELIMDOUBLES(b->tvheap) &&
+		if (oldcnt == 0 || (!GDK_STRUNIQUE(b->tvheap) &&
 				    !GDK_ELIMDOUBLES(ni->vh))) {
 			/* we'll consider copying the string heap completely
 			 *
@@ -219,6 +219,12 @@ insert_string_bat(BAT *b, BATiter *ni, struct canditer *ci, bool force, bool may
 				b->tvheap->free = toff + ni->vhfree;
 				b->tvheap->dirty = true;
 				b->tascii &= ni->ascii;
+				/* a copy of a heap without duplicates
+				 * is also without duplicates */
+				if (toff == 0 && GDK_STRUNIQUE(ni->vh))
+					strDictBuild(b->tvheap);
+				else
+					strDictDestroy(b->tvheap);
 				MT_lock_unset(&b->theaplock);
 			}
 		}
@@ -312,7 +318,7 @@ insert_string_bat(BAT *b, BATiter *ni, struct canditer *ci, bool force, bool may
 			}
 		}
 	} else if (b->tvheap->free < ni->vhfree / 2 ||
-		   GDK_ELIMDOUBLES(b->tvheap)) {
+		   GDK_STRUNIQUE(b->tvheap)) {
 		/* if b's string heap is much smaller than n's string
 		 * heap, don't bother checking whether n's string
 		 * values occur in b's string heap; also, if b is
@@ -1124,6 +1130,7 @@ BATdel(BAT *b, BAT *d)
 	PROPdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 	if (BATtdense(d)) {
 		oid o = d->tseqbase;
 		BUN c = BATcount(d);
@@ -1314,6 +1321,7 @@ BATappend_or_update(BAT *b, BAT *p, const oid *positions, BAT *n,
 	OIDXdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 	/* load hash so that we can maintain it */
 	(void) BATcheckhash(b);
 
@@ -2444,6 +2452,358 @@ do_sort(void *restrict h, void *restrict t, const void *restrict base,
 	return GDK_SUCCEED;
 }
 
+/* Parallel sort.  The values (and the order oids that go with them)
+ * are divided into as many consecutive chunks as there are threads,
+ * and each chunk is sorted by its own thread using do_sort, i.e. with
+ * radix sort for fixed-width keys and with quick or merge sort
+ * otherwise.  The sorted chunks are then merged.  To merge in
+ * parallel, the output is divided into partitions using splitter
+ * values taken from a sample of the sorted chunks: partition p gets,
+ * from each chunk, the values that are not smaller than splitter p-1
+ * and smaller than splitter p.  Equal values therefore always end up
+ * in the same partition, and since the merge prefers the lower chunk
+ * when values are equal, the merge is stable if the chunk sorts
+ * are. */
+#define PSORT_MINCHUNK	((size_t) 1 << 16) /* min values per chunk */
+#define PSORT_PARTS	4		   /* merge partitions per thread */
+
+struct psort {
+	char *h;		/* values, sorted result */
+	char *t;		/* oids (or NULL), sorted with the values */
+	char *th, *tt;		/* temporary copies of h and t */
+	const char *base;	/* var heap base (or NULL) */
+	int (*cmp)(const void *, const void *);
+	const void *nil;
+	size_t n;
+	int hs, ts, tpe;
+	int stype;		/* storage type of fixed-width values */
+	bool reverse, nilslast, stable;
+	int nchunks;
+	size_t nparts;
+	size_t *bounds;		/* per partition, per chunk start */
+	size_t *outpos;		/* per partition output start */
+	ATOMIC_TYPE nextpart;
+	ATOMIC_TYPE failed;
+};
+
+struct psortwork {
+	struct psort *ps;
+	int idx;
+};
+
+/* start of chunk i */
+#define PSORT_CHUNK(ps, i)	((ps)->n / (ps)->nchunks * (i))
+#define PSORT_CHUNKEND(ps, i)					\
+	((i) == (ps)->nchunks - 1 ? (ps)->n : PSORT_CHUNK(ps, (i) + 1))
+
+static inline const void *
+psort_val(const struct psort *ps, const char *h, size_t i)
+{
+	if (ps->base)
+		return ps->base + VarHeapVal(h, i, ps->hs);
+	return h + i * ps->hs;
+}
+
+/* compare two values in the order in which do_sort sorts them */
+#define PSORT_CMP(TYPE)							\
+	do {								\
+		TYPE a = *(const TYPE *) v1, b = *(const TYPE *) v2;	\
+		if (ps->reverse == ps->nilslast ||			\
+		    !(is_##TYPE##_nil(a) || is_##TYPE##_nil(b))) {	\
+			/* nil is the smallest value */			\
+			int c = (a > b) - (a < b);			\
+			return ps->reverse ? -c : c;			\
+		}							\
+	} while (0)
+/* for floating point, nil is NaN which doesn't compare */
+#define PSORT_CMP_FP(TYPE)						\
+	do {								\
+		TYPE a = *(const TYPE *) v1, b = *(const TYPE *) v2;	\
+		if (!is_##TYPE##_nil(a) && !is_##TYPE##_nil(b)) {	\
+			int c = (a > b) - (a < b);			\
+			return ps->reverse ? -c : c;			\
+		}							\
+	} while (0)
+
+static inline int
+psort_cmp(const struct psort *ps, const void *v1, const void *v2)
+{
+	/* shortcuts for the most common key types */
+	switch (ps->stype) {
+	case TYPE_int:
+		PSORT_CMP(int);
+		break;
+	case TYPE_lng:
+		PSORT_CMP(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		PSORT_CMP(hge);
+		break;
+#endif
+	case TYPE_flt:
+		PSORT_CMP_FP(flt);
+		break;
+	case TYPE_dbl:
+		PSORT_CMP_FP(dbl);
+		break;
+	default:
+		break;
+	}
+	if (ps->reverse != ps->nilslast) {
+		/* nils are not where the comparison function puts
+		 * them */
+		bool n1 = ps->cmp(v1, ps->nil) == 0;
+		bool n2 = ps->cmp(v2, ps->nil) == 0;
+		if (n1 || n2) {
+			if (n1 && n2)
+				return 0;
+			return (n1 ? 1 : -1) * (ps->nilslast ? 1 : -1);
+		}
+	}
+	int c = ps->cmp(v1, v2);
+	return ps->reverse ? -c : c;
+}
+
+/* phase 1: copy a chunk to the temporary space and sort it there */
+static void
+psort_chunk(void *arg)
+{
+	struct psortwork *w = arg;
+	struct psort *ps = w->ps;
+	size_t start = PSORT_CHUNK(ps, w->idx);
+	size_t end = PSORT_CHUNKEND(ps, w->idx);
+
+	memcpy(ps->th + start * ps->hs, ps->h + start * ps->hs,
+	       (end - start) * ps->hs);
+	if (ps->t)
+		memcpy(ps->tt + start * ps->ts, ps->t + start * ps->ts,
+		       (end - start) * ps->ts);
+	if (do_sort(ps->th + start * ps->hs,
+		    ps->t ? ps->tt + start * ps->ts : NULL,
+		    ps->base, end - start, ps->hs, ps->ts, ps->tpe,
+		    ps->reverse, ps->nilslast, ps->stable) != GDK_SUCCEED)
+		ATOMIC_SET(&ps->failed, 1);
+}
+
+/* first position in [lo,hi) of the temporary values whose value is not
+ * smaller than v */
+static size_t
+psort_lower(const struct psort *ps, size_t lo, size_t hi, const void *v)
+{
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (psort_cmp(ps, psort_val(ps, ps->th, mid), v) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* restore the heap property of the merge heap below position cur; chunk
+ * a comes before chunk b if its current value is smaller, or if the
+ * values are equal and a is the lower chunk */
+static inline void
+psort_siftdown(const struct psort *ps, int *heap, int nh, int cur,
+	       const size_t *pos)
+{
+#define PSORT_LESS(a, b)						\
+	((c = psort_cmp(ps, psort_val(ps, ps->th, pos[a]),		\
+			psort_val(ps, ps->th, pos[b]))) < 0 ||		\
+	 (c == 0 && (a) < (b)))
+	for (;;) {
+		int min = cur, chld, c;
+		if ((chld = 2 * cur + 1) < nh &&
+		    PSORT_LESS(heap[chld], heap[min]))
+			min = chld;
+		if ((chld = 2 * cur + 2) < nh &&
+		    PSORT_LESS(heap[chld], heap[min]))
+			min = chld;
+		if (min == cur)
+			break;
+		int tmp = heap[cur];
+		heap[cur] = heap[min];
+		heap[min] = tmp;
+		cur = min;
+	}
+#undef PSORT_LESS
+}
+
+/* phase 2: merge the chunks, one partition at a time, using a binary
+ * heap of the chunks that still have values in the partition */
+static void
+psort_merge(void *arg)
+{
+	struct psortwork *w = arg;
+	struct psort *ps = w->ps;
+	int k = ps->nchunks;
+	size_t part;
+	size_t *pos, *end;
+	int *heap;
+
+	pos = GDKmalloc(2 * k * sizeof(size_t));
+	heap = GDKmalloc(k * sizeof(int));
+	if (pos == NULL || heap == NULL) {
+		GDKfree(pos);
+		GDKfree(heap);
+		ATOMIC_SET(&ps->failed, 1);
+		return;
+	}
+	end = pos + k;
+
+	while ((part = (size_t) ATOMIC_ADD(&ps->nextpart, 1)) < ps->nparts) {
+		const size_t *lo = ps->bounds + part * k;
+		const size_t *hi = lo + k;
+		size_t o = ps->outpos[part];
+		int nh = 0;
+
+		if (ATOMIC_GET(&ps->failed))
+			break;
+		for (int i = 0; i < k; i++) {
+			pos[i] = lo[i];
+			end[i] = hi[i];
+			if (pos[i] < end[i])
+				heap[nh++] = i;
+		}
+		for (int i = nh / 2 - 1; i >= 0; i--)
+			psort_siftdown(ps, heap, nh, i, pos);
+		while (nh > 0) {
+			int i = heap[0];
+			memcpy(ps->h + o * ps->hs, ps->th + pos[i] * ps->hs,
+			       ps->hs);
+			if (ps->t)
+				memcpy(ps->t + o * ps->ts,
+				       ps->tt + pos[i] * ps->ts, ps->ts);
+			o++;
+			if (++pos[i] == end[i])
+				heap[0] = heap[--nh];
+			psort_siftdown(ps, heap, nh, 0, pos);
+		}
+		assert(o == (part == ps->nparts - 1 ? ps->n : ps->outpos[part + 1]));
+	}
+	GDKfree(pos);
+	GDKfree(heap);
+}
+
+/* Sort like do_sort, but if there is enough work, sort chunks in
+ * parallel and merge them in parallel.  *parallel is set if the
+ * parallel algorithm was used. */
+static gdk_return
+do_parallel_sort(void *restrict h, void *restrict t, const void *restrict base,
+		 size_t n, int hs, int ts, int tpe, bool reverse,
+		 bool nilslast, bool stable, bool *parallel)
+{
+	int nthreads = GDKnr_threads;
+
+	*parallel = false;
+	if (nthreads <= 1 ||
+	    n / nthreads < PSORT_MINCHUNK ||
+	    ATOMstorage(tpe) == TYPE_msk)
+		return do_sort(h, t, base, n, hs, ts, tpe, reverse, nilslast,
+			       stable);
+
+	struct psort ps = {
+		.h = h,
+		.t = t,
+		.base = base,
+		.cmp = ATOMcompare(tpe),
+		.nil = ATOMnilptr(tpe),
+		.n = n,
+		.hs = hs,
+		.ts = ts,
+		.tpe = tpe,
+		.stype = base ? TYPE_void : ATOMstorage(tpe),
+		.reverse = reverse,
+		.nilslast = nilslast,
+		.stable = stable,
+		.nchunks = nthreads,
+		.nparts = (size_t) nthreads * PSORT_PARTS,
+	};
+	struct psortwork *work;
+	char *smpl = NULL;
+	size_t nsmpl = (size_t) ps.nchunks * ps.nparts;
+	gdk_return rc = GDK_FAIL;
+
+	ATOMIC_INIT(&ps.nextpart, 0);
+	ATOMIC_INIT(&ps.failed, 0);
+	work = GDKmalloc(nthreads * sizeof(*work));
+	ps.th = GDKmalloc(n * hs);
+	ps.tt = t ? GDKmalloc(n * ts) : NULL;
+	ps.bounds = GDKmalloc((ps.nparts + 1) * ps.nchunks * sizeof(size_t));
+	ps.outpos = GDKmalloc(ps.nparts * sizeof(size_t));
+	smpl = GDKmalloc(nsmpl * hs);
+	if (work == NULL || ps.th == NULL || (t && ps.tt == NULL) ||
+	    ps.bounds == NULL || ps.outpos == NULL || smpl == NULL) {
+		/* not enough memory for the parallel version, sort
+		 * in place instead */
+		GDKclrerr();
+		rc = do_sort(h, t, base, n, hs, ts, tpe, reverse, nilslast,
+			     stable);
+		goto bailout;
+	}
+	*parallel = true;
+	MT_thread_setalgorithm("parallel sort");
+	for (int i = 0; i < nthreads; i++)
+		work[i] = (struct psortwork) {.ps = &ps, .idx = i,};
+
+	/* phase 1: sort the chunks */
+	GDKparallel(psort_chunk, work, sizeof(*work), nthreads,
+		    "psortXXXX");
+	if (ATOMIC_GET(&ps.failed))
+		goto bailout;
+
+	/* choose the splitters from an evenly spaced sample of each
+	 * sorted chunk */
+	for (int c = 0; c < ps.nchunks; c++) {
+		size_t start = PSORT_CHUNK(&ps, c);
+		size_t len = PSORT_CHUNKEND(&ps, c) - start;
+		for (size_t j = 0; j < ps.nparts; j++)
+			memcpy(smpl + (c * ps.nparts + j) * hs,
+			       ps.th + (start + j * len / ps.nparts) * hs, hs);
+	}
+	if (do_sort(smpl, NULL, base, nsmpl, hs, 0, tpe, reverse, nilslast,
+		    false) != GDK_SUCCEED)
+		goto bailout;
+	/* bounds[p * nchunks + c] is where partition p starts in
+	 * chunk c; partition nparts starts at the end of the chunks */
+	for (int c = 0; c < ps.nchunks; c++) {
+		size_t start = PSORT_CHUNK(&ps, c);
+		size_t end = PSORT_CHUNKEND(&ps, c);
+		ps.bounds[c] = start;
+		for (size_t p = 1; p < ps.nparts; p++) {
+			start = psort_lower(&ps, start, end,
+					    psort_val(&ps, smpl, p * ps.nchunks));
+			ps.bounds[p * ps.nchunks + c] = start;
+		}
+		ps.bounds[ps.nparts * ps.nchunks + c] = end;
+	}
+	size_t o = 0;
+	for (size_t p = 0; p < ps.nparts; p++) {
+		ps.outpos[p] = o;
+		for (int c = 0; c < ps.nchunks; c++)
+			o += ps.bounds[(p + 1) * ps.nchunks + c] - ps.bounds[p * ps.nchunks + c];
+	}
+	assert(o == n);
+
+	/* phase 2: merge the chunks back into h (and t) */
+	GDKparallel(psort_merge, work, sizeof(*work), nthreads,
+		    "psortXXXX");
+	if (ATOMIC_GET(&ps.failed))
+		goto bailout;
+	rc = GDK_SUCCEED;
+
+  bailout:
+	GDKfree(work);
+	GDKfree(ps.th);
+	GDKfree(ps.tt);
+	GDKfree(ps.bounds);
+	GDKfree(ps.outpos);
+	GDKfree(smpl);
+	return rc;
+}
+
+
 /* Sort the bat b according to both o and g.  The stable and reverse
  * parameters indicate whether the sort should be stable or descending
  * respectively.  The parameter b is required, o and g are optional
@@ -2488,7 +2848,7 @@ BATsort(BAT **sorted, BAT **order, BAT **groups,
 	oid *restrict grps, *restrict ords, prev;
 	BUN p, q, r;
 	lng t0 = GDKusec();
-	bool mkorderidx, orderidxlock = false;
+	bool mkorderidx, orderidxlock = false, parallel = false;
 	Heap *oidxh = NULL;
 
 	/* we haven't implemented NILs as largest value for stable
@@ -2876,11 +3236,13 @@ BATsort(BAT **sorted, BAT **order, BAT **groups,
 		if ((reverse != nilslast ||
 		     (reverse ? !bn->trevsorted : !bn->tsorted)) &&
 		    (BATmaterialize(bn, BUN_NONE) != GDK_SUCCEED ||
-		     do_sort(Tloc(bn, 0),
-			     ords,
-			     bn->tvheap ? bn->tvheap->base : NULL,
-			     BATcount(bn), bn->twidth, ords ? sizeof(oid) : 0,
-			     bn->ttype, reverse, nilslast, stable) != GDK_SUCCEED)) {
+		     do_parallel_sort(Tloc(bn, 0),
+				      ords,
+				      bn->tvheap ? bn->tvheap->base : NULL,
+				      BATcount(bn), bn->twidth,
+				      ords ? sizeof(oid) : 0, bn->ttype,
+				      reverse, nilslast, stable,
+				      &parallel) != GDK_SUCCEED)) {
 			if (m != NULL) {
 				HEAPfree(m, true);
 				GDKfree(m);
@@ -2945,7 +3307,8 @@ BATsort(BAT **sorted, BAT **order, BAT **groups,
 		  ALGOBATPAR(b), ALGOOPTBATPAR(o), ALGOOPTBATPAR(g),
 		  reverse, nilslast, stable, ALGOOPTBATPAR(bn),
 		  ALGOOPTBATPAR(gn), ALGOOPTBATPAR(on),
-		  g ? "grouped " : "", GDKusec() - t0);
+		  g ? "grouped " : parallel ? "parallel " : "",
+		  GDKusec() - t0);
 	if (pb && pb != b)
 		BBPunfix(pb->batCacheid);
 	return GDK_SUCCEED;
@@ -3234,6 +3597,7 @@ BATcount_no_nil(BAT *b, BAT *s)
 	bool (*atomeq)(const void *, const void *);
 	struct canditer ci;
 	oid hseq;
+	var_t off;
 
 	BATcheck(b, 0);
 
@@ -3308,8 +3672,8 @@ BATcount_no_nil(BAT *b, BAT *s)
 			cnt += !is_inet6_nil(((const inet6 *) p)[canditer_next(&ci) - hseq]);
 		break;
 	case TYPE_str:
-		if (GDK_ELIMDOUBLES(bi.vh)) {
-			var_t off = strLocate(bi.vh, str_nil);
+		if (GDK_STRUNIQUE(bi.vh) &&
+		    (off = strLocate(bi.vh, str_nil)) != (var_t) -1) {
 			if (off == (var_t) -2) {
 				cnt = ci.ncand;
 				break;
@@ -1211,6 +1211,7 @@ fixhashashbat(BAT *b)
 	PROPdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 
 	/* make backup of heaps */
 	const char *t;
@@ -1429,6 +1430,7 @@ jsonupgradebat(BAT *b, json_storage_conversion fixJSONStorage)
 	PROPdestroy(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 
 	/* backup the current heaps */
 	if (GDKmove(b->theap->farmid, srcdir, bnme, "tail",
@@ -4194,6 +4196,7 @@ BBPrecover(int farmid)
 			GDKunlink(farmid, dstpath, path, "thashb");
 			GDKunlink(farmid, dstpath, path, "torderidx");
 			GDKunlink(farmid, dstpath, path, "tstrimps");
+			GDKunlink(farmid, dstpath, path, "tzonemap");
 		}
 	}
 	closedir(dirp);
@@ -4430,6 +4433,11 @@ BBPdiskscan(const char *parent, size_t baseoff)
 				delete = b == NULL;
 				if (!delete)
 					b->tstrimps = (Strimps *)1;
+			} else if (strncmp(p + 1, "tzonemap", 8) == 0) {
+				BAT *b = getdesc(bid);
+				delete = b == NULL;
+				if (!delete)
+					b->tzonemap = (Heap *) 1;
 			} else if (strncmp(p + 1, "new", 3) != 0) {
 				ok = false;
 			}
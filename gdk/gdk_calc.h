@@ -148,6 +148,7 @@ gdk_export void *BATmax(BAT *b, void *aggr);
 gdk_export void *BATmin(BAT *b, void *aggr);
 gdk_export void *BATmax_skipnil(allocator *, BAT *b, void *aggr, bit skipnil);
 gdk_export void *BATmin_skipnil(allocator *, BAT *b, void *aggr, bit skipnil);
+gdk_export gdk_return BATthetaselectaggr(BAT *b, BAT *s, const void *val, const char *op, int naggr, const char *const *aggr, BAT **cols, ValPtr res);
 
 gdk_export dbl BATcalcstdev_population(dbl *avgp, BAT *b);
 gdk_export dbl BATcalcstdev_sample(dbl *avgp, BAT *b);
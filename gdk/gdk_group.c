@@ -41,7 +41,7 @@
  * is always created.  In other words, the groups argument may not be
  * NULL, but the extents and histo arguments may be NULL.
  *
- * There are six different implementations of the grouping code.
+ * There are seven different implementations of the grouping code.
  *
  * If it can be trivially determined that all groups are singletons,
  * we can produce the outputs trivially.
@@ -57,6 +57,10 @@
  * consecutive values in b and need to scan sections of g for equal
  * groups.
  *
+ * If we expect many groups and there is no hash table on b, we
+ * partition the values and group the partitions in parallel (see
+ * radixgroup).
+ *
  * If a hash table already exists on b, we can make use of it.
  *
  * Otherwise we build a partial hash table on the fly.
@@ -651,6 +655,604 @@ ctz(oid x)
 			      GOTO_LABEL_TIMEOUT_HANDLER(error, qry_ctx)); \
 	} while (0)
 
+/* Radix-partitioned parallel grouping.
+ *
+ * With many distinct values, the partial hash table built below is
+ * much larger than the cache, and building it is a long sequence of
+ * cache misses on a single thread.  Here we partition the values on
+ * the high bits of a hash so that the groups of each partition fit in
+ * the L2 cache, and group the partitions independently in a number of
+ * worker threads (also see radixjoin in gdk_join.c).  Since equal
+ * values end up in the same partition, no group spans partitions.
+ * The groups found in the partitions are then renumbered so that, as
+ * with the other implementations, group ids are dense and assigned in
+ * order of first occurrence, which also means that the extents are
+ * sorted.  The result can therefore be fed to the grouped aggregates
+ * in gdk_aggr.c as is.
+ *
+ * Each value (combined with its pre-existing group, if any) is
+ * reduced to a 64 bit key.  For int and lng based types without
+ * subgrouping (and int with a limited number of pre-existing groups)
+ * the key is the value itself, otherwise it is a hash and values with
+ * equal keys are compared for real.
+ *
+ * All passes over the data are either sequential or confined to a
+ * single partition.  Going from partition order back to the order of
+ * the candidates is done by remembering the partition of each
+ * candidate: since the partitions preserve the order of the
+ * candidates, walking the candidates and keeping a cursor per
+ * partition visits the partitioned data in candidate order.
+ *
+ * That also makes this the out-of-core grouping: when there is no
+ * memory for the hash table (see GDKspilling), the partitioned data is
+ * kept in files in TEMP_DATA, and only the hash tables of the
+ * partitions being grouped are in memory. */
+
+#define RGRP_MAXBITS	8
+#define RGRP_HASH(v)	((ulng) (v) * UINT64_C(0x9E3779B97F4A7C15))
+/* number of bytes per group in the hash table of a partition (key,
+ * first position, link, and bucket) */
+#define RGRP_GROUPSIZE	(2 * sizeof(ulng) + 2 * sizeof(BUN))
+/* flag in the temporary group id of the first value of a group */
+#define RGRP_FIRST	((oid) 1 << (8 * SIZEOF_OID - 1))
+
+struct radixgroup {
+	BATiter *bi;
+	int tpe;		/* TYPE_int, TYPE_lng, or other (use eq) */
+	bool (*eq)(const void *, const void *);
+	const oid *grps;	/* pre-existing grouping, or NULL */
+	bool exact;		/* equal keys means equal values */
+	bool counts;		/* count the group sizes */
+	BUN off;		/* position in b of first candidate */
+	oid seq;		/* oid of first candidate */
+	BUN ncand;
+	unsigned nbits;		/* number of partitioning bits */
+	BUN nparts;		/* 1 << nbits */
+	int nthreads;
+	bool spill;		/* partitioned data is in files */
+	Heap hrpart, hpkeys, hppos; /* the files if spilling */
+	uint8_t *rpart;		/* partition of each candidate */
+	ulng *pkeys;		/* keys, partitioned; later group ids */
+	BUN *ppos;		/* candidate index, partitioned (only if
+				 * !exact); later group sizes, then map
+				 * to final group id */
+	BUN *hist;		/* per thread & partition count/position */
+	BUN *nfirst;		/* per thread & partition new groups */
+	BUN *bounds;		/* start of each partition */
+	BUN *ngrpp;		/* number of groups in each partition */
+	oid *ngrps;		/* the output group ids */
+	oid *exts;		/* extents, or NULL */
+	lng *cnts;		/* histogram, or NULL */
+	ATOMIC_TYPE nextpart;	/* next partition to be processed */
+	ATOMIC_TYPE failed;	/* a worker failed (malloc or timeout) */
+};
+
+struct radixgroupwork {
+	struct radixgroup *rg;
+	int idx;		/* worker number */
+	BUN ngrp;		/* first group id of our range */
+	BUN maxgrppos;		/* position of our last new group */
+	bool sorted;		/* group ids in our range are sorted */
+};
+
+static inline ulng
+radixgroup_key(const struct radixgroup *rg, BUN r)
+{
+	BUN p = r + rg->off;
+	ulng k;
+
+	switch (rg->tpe) {
+	case TYPE_int:
+		k = (unsigned int) ((const int *) rg->bi->base)[p];
+		if (rg->grps)
+			k |= (ulng) rg->grps[r] << 32;
+		return k;
+	case TYPE_lng:
+		k = (ulng) ((const lng *) rg->bi->base)[p];
+		break;
+	default:
+		k = (ulng) ATOMhash(rg->bi->type, BUNtail(rg->bi, p));
+		break;
+	}
+	if (rg->grps)
+		k ^= RGRP_HASH(rg->grps[r] + 1);
+	return k;
+}
+
+static inline bool
+radixgroup_equal(const struct radixgroup *rg, BUN r1, BUN r2)
+{
+	if (rg->grps && rg->grps[r1] != rg->grps[r2])
+		return false;
+	switch (rg->tpe) {
+	case TYPE_int:
+		return ((const int *) rg->bi->base)[r1 + rg->off] ==
+			((const int *) rg->bi->base)[r2 + rg->off];
+	case TYPE_lng:
+		return ((const lng *) rg->bi->base)[r1 + rg->off] ==
+			((const lng *) rg->bi->base)[r2 + rg->off];
+	default:
+		return (*rg->eq)(BUNtail(rg->bi, r1 + rg->off),
+				 BUNtail(rg->bi, r2 + rg->off));
+	}
+}
+
+/* the range of candidates of worker idx */
+#define RGRP_RANGE(rg, idx, start, end)					\
+	do {								\
+		start = (rg)->ncand * (idx) / (rg)->nthreads;		\
+		end = (rg)->ncand * ((idx) + 1) / (rg)->nthreads;	\
+	} while (0)
+
+/* partitioning is done in two phases: first we count how many values
+ * go into each partition (per thread), then we scatter the keys (and
+ * candidate indexes) */
+static void
+radixgroup_count(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	size_t counter = 0;
+	BUN start, end;
+	BUN *restrict hist = rg->hist + (BUN) w->idx * rg->nparts;
+	uint8_t *restrict rpart = rg->rpart;
+	unsigned shift = 64 - rg->nbits;
+
+	RGRP_RANGE(rg, w->idx, start, end);
+	memset(hist, 0, rg->nparts * sizeof(BUN));
+	for (BUN r = start; r < end; r++) {
+		GDK_CHECK_TIMEOUT(qry_ctx, counter, goto bailout);
+		BUN p = rg->nbits == 0 ? 0 : (BUN) (RGRP_HASH(radixgroup_key(rg, r)) >> shift);
+		rpart[r] = (uint8_t) p;
+		hist[p]++;
+	}
+	return;
+  bailout:
+	ATOMIC_SET(&rg->failed, 1);
+}
+
+static void
+radixgroup_scatter(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	size_t counter = 0;
+	BUN start, end;
+	BUN *restrict hist = rg->hist + (BUN) w->idx * rg->nparts;
+	const uint8_t *restrict rpart = rg->rpart;
+	ulng *restrict pkeys = rg->pkeys;
+	BUN *restrict ppos = rg->ppos;
+
+	RGRP_RANGE(rg, w->idx, start, end);
+	for (BUN r = start; r < end; r++) {
+		GDK_CHECK_TIMEOUT(qry_ctx, counter, goto bailout);
+		BUN i = hist[rpart[r]]++;
+		pkeys[i] = radixgroup_key(rg, r);
+		if (!rg->exact)
+			ppos[i] = r;
+	}
+	return;
+  bailout:
+	ATOMIC_SET(&rg->failed, 1);
+}
+
+/* group the partitions until there are none left; the key of each
+ * value is replaced by a temporary group id, the index of its group
+ * in the partition plus the start of the partition, with the first
+ * value of each group flagged with RGRP_FIRST; the group sizes are
+ * stored in ppos at the same index, which is safe since that index is
+ * never larger than that of the value being processed; we also count
+ * the number of new groups per partition that each of the workers
+ * will encounter when walking its range of candidates */
+static void
+radixgroup_group(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	size_t counter = 0;
+	ulng *gkeys = NULL;
+	BUN *gpos = NULL, *link = NULL, *bckt = NULL;
+	BUN ngmax = 0, nbmax = 0;
+	BUN part;
+
+	while ((part = (BUN) ATOMIC_ADD(&rg->nextpart, 1)) < rg->nparts) {
+		if (ATOMIC_GET(&rg->failed))
+			break;
+		BUN lo = rg->bounds[part];
+		BUN n = rg->bounds[part + 1] - lo;
+		BUN ng = 0;
+		int t = 0;
+		/* the values of worker t are before rg->hist[t] */
+		BUN tend = rg->hist[part];
+		for (int i = 0; i < rg->nthreads; i++)
+			rg->nfirst[i * rg->nparts + part] = 0;
+		if (n == 0) {
+			rg->ngrpp[part] = 0;
+			continue;
+		}
+		if (n > ngmax) {
+			GDKfree(gkeys);
+			GDKfree(gpos);
+			GDKfree(link);
+			gkeys = GDKmalloc(n * sizeof(ulng));
+			gpos = rg->exact ? NULL : GDKmalloc(n * sizeof(BUN));
+			link = GDKmalloc(n * sizeof(BUN));
+			if (gkeys == NULL || (gpos == NULL && !rg->exact) ||
+			    link == NULL)
+				goto bailout;
+			ngmax = n;
+		}
+		/* the hash table starts small and is doubled whenever
+		 * there are more groups than buckets */
+		unsigned hbits = 8;
+		BUN nb = (BUN) 1 << hbits;
+		if (nb > nbmax) {
+			GDKfree(bckt);
+			if ((bckt = GDKmalloc(nb * sizeof(BUN))) == NULL)
+				goto bailout;
+			nbmax = nb;
+		}
+		for (BUN b = 0; b < nb; b++)
+			bckt[b] = BUN_NONE;
+		ulng *restrict pkeys = rg->pkeys + lo;
+		BUN *restrict ppos = rg->ppos + lo;
+		for (BUN i = 0; i < n; i++) {
+			GDK_CHECK_TIMEOUT(qry_ctx, counter, goto bailout);
+			ulng k = pkeys[i];
+			BUN h = (BUN) ((RGRP_HASH(k) << rg->nbits) >> (64 - hbits));
+			BUN g;
+			for (g = bckt[h]; g != BUN_NONE; g = link[g]) {
+				if (gkeys[g] == k &&
+				    (rg->exact || radixgroup_equal(rg, ppos[i], gpos[g])))
+					break;
+			}
+			if (g != BUN_NONE) {
+				pkeys[i] = lo + g;
+				if (rg->counts)
+					ppos[g]++;
+				continue;
+			}
+			g = ng++;
+			gkeys[g] = k;
+			if (!rg->exact)
+				gpos[g] = ppos[i];
+			link[g] = bckt[h];
+			bckt[h] = g;
+			pkeys[i] = (lo + g) | RGRP_FIRST;
+			if (rg->counts)
+				ppos[g] = 1;
+			while (lo + i >= tend)
+				tend = rg->hist[++t * rg->nparts + part];
+			rg->nfirst[t * rg->nparts + part]++;
+			if (ng > nb && hbits + rg->nbits < 64) {
+				/* rehash the groups */
+				hbits++;
+				nb <<= 1;
+				if (nb > nbmax) {
+					GDKfree(bckt);
+					if ((bckt = GDKmalloc(nb * sizeof(BUN))) == NULL)
+						goto bailout;
+					nbmax = nb;
+				}
+				for (BUN b = 0; b < nb; b++)
+					bckt[b] = BUN_NONE;
+				for (BUN j = 0; j < ng; j++) {
+					h = (BUN) ((RGRP_HASH(gkeys[j]) << rg->nbits) >> (64 - hbits));
+					link[j] = bckt[h];
+					bckt[h] = j;
+				}
+			}
+		}
+		rg->ngrpp[part] = ng;
+	}
+	GDKfree(gkeys);
+	GDKfree(gpos);
+	GDKfree(link);
+	GDKfree(bckt);
+	return;
+  bailout:
+	ATOMIC_SET(&rg->failed, 1);
+	GDKfree(gkeys);
+	GDKfree(gpos);
+	GDKfree(link);
+	GDKfree(bckt);
+}
+
+/* set the cursors of worker idx to the start of its values in each
+ * partition */
+static void
+radixgroup_cursors(const struct radixgroup *rg, int idx, BUN *cur)
+{
+	for (BUN p = 0; p < rg->nparts; p++)
+		cur[p] = idx == 0 ? rg->bounds[p] : rg->hist[(idx - 1) * rg->nparts + p];
+}
+
+/* give the new groups in the range of the worker their final id in
+ * order of first occurrence (w->ngrp is the first one), and fill in
+ * the extents and histogram; ppos becomes the map from temporary to
+ * final group id */
+static void
+radixgroup_number(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	BUN start, end;
+	BUN cur[1 << RGRP_MAXBITS];
+	const uint8_t *restrict rpart = rg->rpart;
+	const ulng *restrict pkeys = rg->pkeys;
+	BUN *restrict gmap = rg->ppos;
+	oid grp = w->ngrp;
+
+	RGRP_RANGE(rg, w->idx, start, end);
+	radixgroup_cursors(rg, w->idx, cur);
+	for (BUN r = start; r < end; r++) {
+		ulng k = pkeys[cur[rpart[r]]++];
+		if (k & RGRP_FIRST) {
+			BUN slot = (BUN) (k & ~RGRP_FIRST);
+			if (rg->cnts)
+				rg->cnts[grp] = (lng) gmap[slot];
+			gmap[slot] = grp;
+			if (rg->exts)
+				rg->exts[grp] = rg->seq + r;
+			grp++;
+			w->maxgrppos = r;
+		}
+	}
+}
+
+/* replace the temporary group ids by the final ones, one partition
+ * at a time so that the relevant part of the map is in the cache */
+static void
+radixgroup_map(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	const BUN *restrict gmap = rg->ppos;
+	BUN part;
+
+	while ((part = (BUN) ATOMIC_ADD(&rg->nextpart, 1)) < rg->nparts) {
+		ulng *restrict pkeys = rg->pkeys;
+		for (BUN i = rg->bounds[part], e = rg->bounds[part + 1]; i < e; i++)
+			pkeys[i] = gmap[pkeys[i] & ~RGRP_FIRST];
+	}
+}
+
+/* put the group ids in the order of the candidates */
+static void
+radixgroup_unscatter(void *arg)
+{
+	struct radixgroupwork *w = arg;
+	struct radixgroup *rg = w->rg;
+	BUN start, end;
+	BUN cur[1 << RGRP_MAXBITS];
+	const uint8_t *restrict rpart = rg->rpart;
+	const ulng *restrict pkeys = rg->pkeys;
+	oid *restrict ngrps = rg->ngrps;
+	bool sorted = true;
+
+	RGRP_RANGE(rg, w->idx, start, end);
+	radixgroup_cursors(rg, w->idx, cur);
+	for (BUN r = start; r < end; r++) {
+		ngrps[r] = (oid) pkeys[cur[rpart[r]]++];
+		if (r > start && ngrps[r] < ngrps[r - 1])
+			sorted = false;
+	}
+	w->sorted = sorted;
+}
+
+/* Decide whether to use radixgroup: the candidates must be dense.  If
+ * there is no memory for the hash table, the partitions are spilled to
+ * disk (see GDKspilling) and *spillp is set, whatever the size of the
+ * input, so also for the slices of a query split by mitosis and the
+ * grouping of their packed results.  Otherwise we must expect so many
+ * groups that the serial hash table doesn't fit in the last level
+ * cache, and there must be multiple threads.  On return, *nbitsp is the
+ * number of partitioning bits to use. */
+static bool
+radixgroup_wanted(BAT *b, BATiter *bi, struct canditer *ci,
+		  const oid *grps, oid maxgrp, unsigned *nbitsp, bool *spillp)
+{
+	if (ci->tpe != cand_dense ||
+	    bi->type == TYPE_msk ||
+	    (grps == NULL && BATcheckhash(b)) ||
+	    (ci->ncand * RGRP_GROUPSIZE <= GDK_llc_cachesize &&
+	     !GDKspilling(ci->ncand * RGRP_GROUPSIZE)))
+		return false;
+	BUN est = bi->unique_est != 0 ? (BUN) bi->unique_est : BATguess_uniques(b, ci);
+	if (grps && !is_oid_nil(maxgrp) && est <= maxgrp)
+		est = maxgrp + 1;
+	if (est > ci->ncand)
+		est = ci->ncand;
+	*spillp = GDKspilling(est * RGRP_GROUPSIZE);
+	if (!*spillp &&
+	    (est * RGRP_GROUPSIZE <= GDK_llc_cachesize ||
+	     GDKnr_threads <= 1))
+		return false;
+	/* choose the number of partitions such that the groups of a
+	 * partition fit in the L2 cache, but have enough partitions
+	 * to spread the work over the threads; the number of
+	 * partitions is limited since each is written and read as a
+	 * separate stream */
+	unsigned nbits = 0;
+	while (nbits < RGRP_MAXBITS &&
+	       ((est * RGRP_GROUPSIZE >> nbits) > GDK_l2_cachesize ||
+		((BUN) 1 << nbits) < (BUN) 4 * GDKnr_threads))
+		nbits++;
+	*nbitsp = nbits;
+	return true;
+}
+
+/* The actual grouping; gn has room for the group ids, en and hn (if
+ * not NULL) for *maxgrpsp groups and are extended if there are more.
+ * On success, *ngrpp is the number of groups. */
+static gdk_return
+radixgroup(BATiter *bi, struct canditer *ci, int t, const oid *grps,
+	   oid maxgrp, unsigned nbits, bool spill, BAT *gn, BAT *en, BAT *hn,
+	   BUN *maxgrpsp, oid *ngrpp, BUN *maxgrppos)
+{
+	struct radixgroup rg = {
+		.bi = bi,
+		.tpe = t == TYPE_int || t == TYPE_lng ? t : TYPE_void,
+		.eq = ATOMequal(bi->type),
+		.grps = grps,
+		.counts = hn != NULL,
+		.off = ci->seq - bi->b->hseqbase,
+		.seq = ci->seq,
+		.ncand = ci->ncand,
+		.nbits = nbits,
+		.nparts = (BUN) 1 << nbits,
+		.nthreads = GDKnr_threads > 1 ? GDKnr_threads : 1,
+		.spill = spill,
+		.ngrps = Tloc(gn, 0),
+	};
+	struct radixgroupwork *work = NULL;
+	gdk_return rc = GDK_FAIL;
+
+	assert(ci->tpe == cand_dense);
+	assert(nbits <= RGRP_MAXBITS);
+	MT_thread_setalgorithm(spill ? "radixgroup (spilled to disk)" : "radixgroup");
+	switch (rg.tpe) {
+	case TYPE_int:
+		rg.exact = grps == NULL ||
+			(!is_oid_nil(maxgrp) && maxgrp <= (oid) UINT32_MAX);
+		break;
+	case TYPE_lng:
+		rg.exact = grps == NULL;
+		break;
+	default:
+		rg.exact = false;
+		break;
+	}
+	ATOMIC_INIT(&rg.nextpart, 0);
+	ATOMIC_INIT(&rg.failed, 0);
+
+	work = GDKmalloc(rg.nthreads * sizeof(*work));
+	if (spill) {
+		if (HEAPspill(&rg.hrpart, rg.ncand, "radixgrp") == GDK_SUCCEED)
+			rg.rpart = (uint8_t *) rg.hrpart.base;
+		if (HEAPspill(&rg.hpkeys, rg.ncand * sizeof(ulng), "radixgrp") == GDK_SUCCEED)
+			rg.pkeys = (ulng *) rg.hpkeys.base;
+		if (HEAPspill(&rg.hppos, rg.ncand * sizeof(BUN), "radixgrp") == GDK_SUCCEED)
+			rg.ppos = (BUN *) rg.hppos.base;
+	} else {
+		rg.rpart = GDKmalloc(rg.ncand);
+		rg.pkeys = GDKmalloc(rg.ncand * sizeof(ulng));
+		rg.ppos = GDKmalloc(rg.ncand * sizeof(BUN));
+	}
+	rg.hist = GDKmalloc(rg.nthreads * rg.nparts * sizeof(BUN));
+	rg.nfirst = GDKmalloc(rg.nthreads * rg.nparts * sizeof(BUN));
+	rg.bounds = GDKmalloc((rg.nparts + 1) * sizeof(BUN));
+	rg.ngrpp = GDKmalloc(rg.nparts * sizeof(BUN));
+	if (work == NULL || rg.rpart == NULL || rg.pkeys == NULL ||
+	    rg.ppos == NULL || rg.hist == NULL || rg.nfirst == NULL ||
+	    rg.bounds == NULL || rg.ngrpp == NULL)
+		goto bailout;
+	for (int i = 0; i < rg.nthreads; i++)
+		work[i] = (struct radixgroupwork) {.rg = &rg, .idx = i,};
+
+	/* phase 1: histograms */
+	GDKparallel(radixgroup_count, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+	if (ATOMIC_GET(&rg.failed))
+		goto bailout;
+	/* turn the histograms into scatter positions and partition
+	 * boundaries; within a partition, the values stay in the
+	 * order of the candidates */
+	BUN pos = 0;
+	for (BUN p = 0; p < rg.nparts; p++) {
+		rg.bounds[p] = pos;
+		for (int i = 0; i < rg.nthreads; i++) {
+			BUN c = rg.hist[i * rg.nparts + p];
+			rg.hist[i * rg.nparts + p] = pos;
+			pos += c;
+		}
+	}
+	rg.bounds[rg.nparts] = pos;
+	assert(pos == rg.ncand);
+	/* phase 2: scatter; afterwards, hist contains the end of the
+	 * values of each worker in each partition */
+	GDKparallel(radixgroup_scatter, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+	if (ATOMIC_GET(&rg.failed))
+		goto bailout;
+	/* phase 3: group the partitions */
+	GDKparallel(radixgroup_group, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+	if (ATOMIC_GET(&rg.failed))
+		goto bailout;
+
+	BUN ngrp = 0;
+	for (int i = 0; i < rg.nthreads; i++) {
+		work[i].ngrp = ngrp;
+		for (BUN p = 0; p < rg.nparts; p++)
+			ngrp += rg.nfirst[i * rg.nparts + p];
+	}
+	if (ngrp > *maxgrpsp) {
+		if ((en && BATextend(en, ngrp) != GDK_SUCCEED) ||
+		    (hn && BATextend(hn, ngrp) != GDK_SUCCEED))
+			goto bailout;
+		*maxgrpsp = ngrp;
+	}
+	rg.exts = en ? Tloc(en, 0) : NULL;
+	rg.cnts = hn ? Tloc(hn, 0) : NULL;
+
+	/* phase 4: renumber the groups in order of first occurrence
+	 * and put the group ids in candidate order */
+	GDKparallel(radixgroup_number, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+	ATOMIC_SET(&rg.nextpart, 0);
+	GDKparallel(radixgroup_map, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+	GDKparallel(radixgroup_unscatter, work, sizeof(*work), rg.nthreads,
+		    "radixgrpXXXX");
+
+	gn->tsorted = true;
+	*maxgrppos = BUN_NONE;
+	for (int i = 0; i < rg.nthreads; i++) {
+		BUN start, end;
+		RGRP_RANGE(&rg, i, start, end);
+		if (start == end)
+			continue;
+		if (!work[i].sorted ||
+		    (start > 0 && rg.ngrps[start] < rg.ngrps[start - 1]))
+			gn->tsorted = false;
+		if ((i == rg.nthreads - 1 ? ngrp : work[i + 1].ngrp) > work[i].ngrp)
+			*maxgrppos = work[i].maxgrppos;
+	}
+	*ngrpp = (oid) ngrp;
+	rc = GDK_SUCCEED;
+
+  bailout:
+	if (rc != GDK_SUCCEED) {
+		QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+		if (TIMEOUT_TEST(qry_ctx))
+			TIMEOUT_ERROR(qry_ctx, __FILE__, __func__, __LINE__);
+		else if (ATOMIC_GET(&rg.failed))
+			GDKerror("radix grouping failed to allocate memory\n");
+	}
+	GDKfree(work);
+	if (spill) {
+		if (rg.rpart)
+			HEAPfree(&rg.hrpart, true);
+		if (rg.pkeys)
+			HEAPfree(&rg.hpkeys, true);
+		if (rg.ppos)
+			HEAPfree(&rg.hppos, true);
+	} else {
+		GDKfree(rg.rpart);
+		GDKfree(rg.pkeys);
+		GDKfree(rg.ppos);
+	}
+	GDKfree(rg.hist);
+	GDKfree(rg.nfirst);
+	GDKfree(rg.bounds);
+	GDKfree(rg.ngrpp);
+	return rc;
+}
+
 gdk_return
 BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 		  BAT *b, BAT *s, BAT *g, BAT *e, BAT *h, bool subsorted)
@@ -676,6 +1278,8 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 	lng t0 = 0;
 	const char *algomsg = "";
 	bool locked = false;
+	unsigned nbits;
+	bool spill = false;
 
 	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
 
@@ -901,7 +1505,7 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 	/* for strings we can use the offset instead of the actual
 	 * string values if we know that the strings in the string
 	 * heap are unique */
-	if (t == TYPE_str && GDK_ELIMDOUBLES(bi.vh)) {
+	if (t == TYPE_str && GDK_STRUNIQUE(bi.vh)) {
 		switch (bi.width) {
 		case 1:
 			t = TYPE_bte;
@@ -1040,6 +1644,12 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 			GRP_subscan_old_groups_any();
 			break;
 		}
+	} else if (radixgroup_wanted(b, &bi, &ci, grps, maxgrp, &nbits, &spill)) {
+		/* many groups: partition and group in parallel */
+		algomsg = spill ? "radix partitioned, spilled -- " : "radix partitioned -- ";
+		if (radixgroup(&bi, &ci, t, grps, maxgrp, nbits, spill, gn, en, hn,
+			       &maxgrps, &ngrp, &maxgrppos) != GDK_SUCCEED)
+			goto error;
 	} else if (g == NULL &&
 		   (BATcheckhash(b) ||
 		    ((!bi.transient ||
@@ -109,6 +109,7 @@ HEAPgrow(Heap **hp, size_t size, bool mayshare)
 		if (HEAPalloc(new, size, 1) == GDK_SUCCEED) {
 			new->free = old->free;
 			new->cleanhash = old->cleanhash;
+			new->strdict = strDictCopy(old);
 			if (old->free > 0 &&
 			    (new->storage == STORE_MEM || old->storage == STORE_MEM))
 				memcpy(new->base, old->base, old->free);
@@ -219,6 +220,58 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 	return GDK_SUCCEED;
 }
 
+/* Allocate the heap H of SIZE bytes for the partitions an operator
+ * spills to disk (see GDKspilling).  Unlike HEAPalloc, which only
+ * resorts to a memory mapped file when memory is short, the heap is
+ * always a file in the TEMP_DATA directory, so that the OS can write
+ * the partitions out and read them back sequentially.  The file is
+ * removed by HEAPfree(h, true). */
+static ATOMIC_TYPE nspill = ATOMIC_VAR_INIT(0);
+
+gdk_return
+HEAPspill(Heap *h, size_t size, const char *name)
+{
+	char nme[MAXPATH];
+
+	*h = (Heap) {
+		.farmid = 1,
+	};
+	snprintf(h->filename, sizeof(h->filename), "%s%c%s%zu_%zu",
+		 TEMPDIR_NAME, DIR_SEP, name, (size_t) MT_getpid(),
+		 (size_t) ATOMIC_INC(&nspill));
+	if (GDKinmemory(h->farmid))
+		return HEAPalloc(h, size, 1);
+
+	h->size = (MAX(size, 1) + GDK_mmap_pagesize - 1) & ~(GDK_mmap_pagesize - 1);
+	if (GDKvm_cursize() + h->size >= GDK_vm_maxsize &&
+	    !MT_thread_override_limits()) {
+		GDKerror("allocating too much memory (current: %zu, requested: %zu, limit: %zu)\n", GDKvm_cursize(), h->size, GDK_vm_maxsize);
+		return GDK_FAIL;
+	}
+	if (GDKfilepath(nme, sizeof(nme), h->farmid, BATDIR, h->filename, NULL) != GDK_SUCCEED)
+		return GDK_FAIL;
+	h->storage = h->newstorage = STORE_MMAP;
+	h->base = HEAPcreatefile(NOFARM, &h->size, nme);
+	if (h->base == NULL) {
+		(void) MT_remove(nme);
+		GDKerror("Insufficient space for spilling %zu bytes.", h->size);
+		return GDK_FAIL;
+	}
+	h->hasfile = true;
+	/* the file doesn't count against the memory limit of the query,
+	 * that is the point of spilling */
+	h->spilled = true;
+	TRC_DEBUG(HEAP, "%s %zu %p (spill)\n", h->filename, h->size, h->base);
+	return GDK_SUCCEED;
+}
+
+/* The number of heaps created by HEAPspill since the server started. */
+size_t
+GDKspill_count(void)
+{
+	return (size_t) ATOMIC_GET(&nspill);
+}
+
 /* Extend the allocated space of the heap H to be at least SIZE bytes.
  * If the heap grows beyond a threshold and a filename is known, the
  * heap is converted from allocated memory to a memory-mapped file.
@@ -242,7 +295,7 @@ HEAPextend(Heap *h, size_t size, bool mayshare)
 {
 	size_t osize = h->size;
 	size_t xsize;
-	QryCtx *qc = h->farmid == 1 ? MT_thread_get_qry_ctx() : NULL;
+	QryCtx *qc = h->farmid == 1 && !h->spilled ? MT_thread_get_qry_ctx() : NULL;
 
 	if (size <= h->size)
 		return GDK_SUCCEED;	/* nothing to do */
@@ -613,6 +666,8 @@ HEAPcopy(Heap *dst, Heap *src, size_t offset)
 		memcpy(dst->base, src->base + offset, src->free - offset);
 		dst->cleanhash = src->cleanhash;
 		dst->dirty = true;
+		if (offset == 0 && src->strdict)
+			strDictBuild(dst);
 		return GDK_SUCCEED;
 	}
 	return GDK_FAIL;
@@ -624,7 +679,7 @@ void
 HEAPfree(Heap *h, bool rmheap)
 {
 	if (h->base) {
-		if (h->farmid == 1 && (h->storage == STORE_MEM || h->storage == STORE_MMAP || h->storage == STORE_PRIV)) {
+		if (h->farmid == 1 && !h->spilled && (h->storage == STORE_MEM || h->storage == STORE_MMAP || h->storage == STORE_PRIV)) {
 			QryCtx *qc = MT_thread_get_qry_ctx();
 			if (qc)
 				ATOMIC_SUB(&qc->datasize, h->size);
@@ -692,6 +747,7 @@ HEAPdecref(Heap *h, bool remove)
 	switch (refs & HEAPREFS) {
 	case 0:
 		HEAPfree(h, (bool) (refs & HEAPREMOVE));
+		strDictDestroy(h);
 		GDKfree(h);
 		break;
 	case 1:
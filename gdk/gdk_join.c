@@ -2770,6 +2770,14 @@ mergejoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 		nr++;							\
 	} while (false)
 
+/* equality of two strings in the same string heap that is free of
+ * duplicates: equal strings are stored only once */
+static bool
+streq_unique(const void *v1, const void *v2)
+{
+	return v1 == v2;
+}
+
 #define EQ_int(a, b)	((a) == (b))
 #define EQ_lng(a, b)	((a) == (b))
 #ifdef HAVE_HGE
@@ -2917,6 +2925,7 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 	const void *nil = ATOMnilptr(l->ttype);
 	int (*cmp)(const void *, const void *) = ATOMcompare(l->ttype);
 	bool (*eq)(const void *, const void *) = ATOMequal(l->ttype);
+	bool (*veq)(const void *, const void *) = eq;
 	oid lval = oid_nil;	/* hold value if l is dense */
 	const char *v = (const char *) &lval;
 	bool lskipped = false;	/* whether we skipped values in l */
@@ -3112,6 +3121,13 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 	if (lci->tpe != cand_dense)
 		r1->tseqbase = oid_nil;
 
+	if (lvars && ATOMstorage(li.type) == TYPE_str &&
+	    li.vh == ri.vh && GDK_STRUNIQUE(li.vh)) {
+		/* both sides share a string heap without duplicates,
+		 * so we can compare the offsets instead of the
+		 * strings */
+		veq = streq_unique;
+	}
 
 	switch (t) {
 	case TYPE_int:
@@ -3146,7 +3162,7 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 				     rb != BUN_NONE;
 				     rb = HASHgetlink(hsh, rb)) {
 					ro = canditer_idx(rci, rb);
-					if (!(*eq)(v, BUNtail(&ri, ro - r->hseqbase)))
+					if (!(*veq)(v, BUNtail(&ri, ro - r->hseqbase)))
 						continue;
 					if (only_misses) {
 						nr++;
@@ -3176,7 +3192,7 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 				     rb != BUN_NONE;
 				     rb = HASHgetlink(hsh, rb)) {
 					if (rb >= rl && rb < rh &&
-					    (*eq)(v, BUNtail(&ri, rb)) &&
+					    (*veq)(v, BUNtail(&ri, rb)) &&
 					    canditer_contains(rci, ro = (oid) (rb - roff + rseq))) {
 						if (only_misses) {
 							nr++;
@@ -3192,7 +3208,7 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 				     rb != BUN_NONE;
 				     rb = HASHgetlink(hsh, rb)) {
 					if (rb >= rl && rb < rh &&
-					    (*eq)(v, BUNtail(&ri, rb))) {
+					    (*veq)(v, BUNtail(&ri, rb))) {
 						if (only_misses) {
 							nr++;
 							break;
@@ -3337,6 +3353,446 @@ hashjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r,
 	return GDK_FAIL;
 }
 
+/* Radix-partitioned parallel hash join.
+ *
+ * When the hash table on the inner side of a join does not fit in the
+ * last level cache, just about every probe results in a cache miss.
+ * Here we partition both inputs on the high bits of a hash of the
+ * values so that the inner side of each partition fits in the L2
+ * cache, and then join the pairs of partitions independently in a
+ * number of worker threads.  This is only used for inner joins on
+ * columns with a fixed-size int or lng based type, see joincost().
+ *
+ * The same partitioning gives us a grace hash join when there is no
+ * memory for the hash table (see GDKspilling): then the partitions and
+ * the results of the workers are spilled to files in TEMP_DATA, which
+ * are written and read sequentially, while only the hash tables of the
+ * partitions being joined are in memory. */
+
+#define RADIX_MAXBITS	14
+#define RADIX_HASH(v)	((uint64_t) (v) * UINT64_C(0x9E3779B97F4A7C15))
+/* the cost of partitioning and joining one value on one thread, and
+ * the cost of a probe in a hash table that is not in the cache, both
+ * relative to the cost of one hash probe (see joincost) */
+#define RADIX_COST	3.0
+#define RADIX_MISS_COST	4.0
+
+struct radixside {
+	const void *vals;	/* values (tail heap) */
+	oid hseq;		/* hseqbase of the BAT */
+	struct canditer *ci;	/* candidates (values to partition) */
+	void *pvals;		/* values, partitioned */
+	oid *poids;		/* oids, partitioned */
+	Heap hvals, hoids;	/* files of pvals and poids if spilling */
+	BUN *hist;		/* per thread & partition count/position */
+	BUN *bounds;		/* start of each partition */
+};
+
+struct radixjoin {
+	int tpe;		/* TYPE_int or TYPE_lng */
+	bool nil_matches;
+	unsigned nbits;		/* number of partitioning bits */
+	BUN nparts;		/* 1 << nbits */
+	int nthreads;
+	bool spill;		/* spill partitions and results to disk */
+	struct radixside side[2]; /* [0]: outer, [1]: inner */
+	ATOMIC_TYPE nextpart;	/* next partition to be joined */
+	ATOMIC_TYPE failed;	/* a worker failed (malloc or timeout) */
+};
+
+struct radixwork {
+	struct radixjoin *rj;
+	int idx;		/* worker number */
+	oid *r1, *r2;		/* result of this worker */
+	BUN nres, maxres;
+	Heap h1, h2;		/* files of r1 and r2 if spilling */
+};
+
+/* make room for more results of a worker */
+static bool
+radixwork_extend(struct radixwork *w)
+{
+	BUN sz = w->maxres == 0 ? INCRSIZE : w->maxres * 2;
+
+	if (w->rj->spill) {
+		if (w->maxres == 0 ?
+		    (HEAPspill(&w->h1, sz * sizeof(oid), "radixjoin") != GDK_SUCCEED ||
+		     HEAPspill(&w->h2, sz * sizeof(oid), "radixjoin") != GDK_SUCCEED) :
+		    (HEAPextend(&w->h1, sz * sizeof(oid), false) != GDK_SUCCEED ||
+		     HEAPextend(&w->h2, sz * sizeof(oid), false) != GDK_SUCCEED))
+			return false;
+		w->r1 = (oid *) w->h1.base;
+		w->r2 = (oid *) w->h2.base;
+	} else {
+		oid *r1 = GDKrealloc(w->r1, sz * sizeof(oid));
+		if (r1 == NULL)
+			return false;
+		w->r1 = r1;
+		oid *r2 = GDKrealloc(w->r2, sz * sizeof(oid));
+		if (r2 == NULL)
+			return false;
+		w->r2 = r2;
+	}
+	w->maxres = sz;
+	return true;
+}
+
+static void
+radixwork_free(struct radixwork *w)
+{
+	if (w->rj->spill) {
+		if (w->h1.base)
+			HEAPfree(&w->h1, true);
+		if (w->h2.base)
+			HEAPfree(&w->h2, true);
+	} else {
+		GDKfree(w->r1);
+		GDKfree(w->r2);
+	}
+}
+
+#define RADIX_PARTITION(TYPE, DOIT)					\
+	do {								\
+		const TYPE *restrict vals = sd->vals;			\
+		TYPE *restrict pvals = sd->pvals;			\
+		TYPE v;							\
+		(void) pvals;						\
+		for (BUN i = start; i < end; i++) {			\
+			GDK_CHECK_TIMEOUT(qry_ctx, counter, goto bailout); \
+			o = canditer_next(&ci);				\
+			v = vals[o - sd->hseq];				\
+			if (!rj->nil_matches && is_##TYPE##_nil(v))	\
+				continue;				\
+			p = rj->nbits == 0 ? 0 : (BUN) (RADIX_HASH(v) >> (64 - rj->nbits)); \
+			DOIT;						\
+		}							\
+	} while (0)
+
+/* partitioning is done in two phases: first we count how many values
+ * go into each partition (per thread), then we scatter the values */
+static void
+radixjoin_partition(void *arg, bool scatter)
+{
+	struct radixwork *w = arg;
+	struct radixjoin *rj = w->rj;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	size_t counter = 0;
+
+	for (int s = 0; s < 2; s++) {
+		struct radixside *sd = &rj->side[s];
+		struct canditer ci = *sd->ci;
+		BUN start = ci.ncand * w->idx / rj->nthreads;
+		BUN end = ci.ncand * (w->idx + 1) / rj->nthreads;
+		BUN *restrict hist = sd->hist + (BUN) w->idx * rj->nparts;
+		BUN p;
+		oid o;
+
+		canditer_setidx(&ci, start);
+		if (!scatter) {
+			memset(hist, 0, rj->nparts * sizeof(BUN));
+			if (rj->tpe == TYPE_int)
+				RADIX_PARTITION(int, hist[p]++);
+			else
+				RADIX_PARTITION(lng, hist[p]++);
+		} else {
+			if (rj->tpe == TYPE_int)
+				RADIX_PARTITION(int, (pvals[hist[p]] = v, sd->poids[hist[p]++] = o));
+			else
+				RADIX_PARTITION(lng, (pvals[hist[p]] = v, sd->poids[hist[p]++] = o));
+		}
+	}
+	return;
+  bailout:
+	ATOMIC_SET(&rj->failed, 1);
+}
+
+static void
+radixjoin_count(void *arg)
+{
+	radixjoin_partition(arg, false);
+}
+
+static void
+radixjoin_scatter(void *arg)
+{
+	radixjoin_partition(arg, true);
+}
+
+#define RADIX_JOINPART(TYPE)						\
+	do {								\
+		const TYPE *restrict ivals = (const TYPE *) rj->side[1].pvals + ilo; \
+		const TYPE *restrict ovals = (const TYPE *) rj->side[0].pvals; \
+		for (BUN i = 0; i < icnt; i++) {			\
+			BUN b = (BUN) ((RADIX_HASH(ivals[i]) << rj->nbits) >> (64 - hbits)); \
+			link[i] = bckt[b];				\
+			bckt[b] = i;					\
+		}							\
+		for (BUN j = olo; j < ohi; j++) {			\
+			GDK_CHECK_TIMEOUT(qry_ctx, counter, goto bailout); \
+			TYPE v = ovals[j];				\
+			BUN b = (BUN) ((RADIX_HASH(v) << rj->nbits) >> (64 - hbits)); \
+			for (BUN i = bckt[b]; i != BUN_NONE; i = link[i]) { \
+				if (ivals[i] != v)			\
+					continue;			\
+				if (w->nres == w->maxres &&		\
+				    !radixwork_extend(w))		\
+					goto bailout;			\
+				w->r1[w->nres] = rj->side[0].poids[j];	\
+				w->r2[w->nres] = ipoids[i];		\
+				w->nres++;				\
+			}						\
+		}							\
+	} while (0)
+
+/* join pairs of partitions until there are none left */
+static void
+radixjoin_join(void *arg)
+{
+	struct radixwork *w = arg;
+	struct radixjoin *rj = w->rj;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+	size_t counter = 0;
+	BUN *bckt = NULL, *link = NULL;
+	BUN nbckt = 0, nlink = 0;
+	BUN p;
+
+	while ((p = (BUN) ATOMIC_ADD(&rj->nextpart, 1)) < rj->nparts) {
+		if (ATOMIC_GET(&rj->failed))
+			break;
+		BUN ilo = rj->side[1].bounds[p];
+		BUN icnt = rj->side[1].bounds[p + 1] - ilo;
+		BUN olo = rj->side[0].bounds[p];
+		BUN ohi = rj->side[0].bounds[p + 1];
+		if (icnt == 0 || olo == ohi)
+			continue;
+		/* number of hash bits within the partition */
+		unsigned hbits = ilog2(icnt);
+		if (hbits + rj->nbits > 64)
+			hbits = 64 - rj->nbits;
+		BUN nb = (BUN) 1 << hbits;
+		if (nb > nbckt) {
+			GDKfree(bckt);
+			if ((bckt = GDKmalloc(nb * sizeof(BUN))) == NULL)
+				goto bailout;
+			nbckt = nb;
+		}
+		if (icnt > nlink) {
+			GDKfree(link);
+			if ((link = GDKmalloc(icnt * sizeof(BUN))) == NULL)
+				goto bailout;
+			nlink = icnt;
+		}
+		for (BUN i = 0; i < nb; i++)
+			bckt[i] = BUN_NONE;
+		const oid *restrict ipoids = rj->side[1].poids + ilo;
+		if (rj->tpe == TYPE_int)
+			RADIX_JOINPART(int);
+		else
+			RADIX_JOINPART(lng);
+	}
+	GDKfree(bckt);
+	GDKfree(link);
+	return;
+  bailout:
+	ATOMIC_SET(&rj->failed, 1);
+	GDKfree(bckt);
+	GDKfree(link);
+}
+
+/* The actual join.  If swapped is set, the inner (build) side is l,
+ * otherwise it is r.  The result is not sorted in any particular
+ * order. */
+static gdk_return
+radixjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r,
+	  struct canditer *restrict lci, struct canditer *restrict rci,
+	  bool nil_matches, lng t0, bool swapped, const char *reason)
+{
+	BATiter li = bat_iterator(l);
+	BATiter ri = bat_iterator(r);
+	struct radixjoin rj = {
+		.tpe = ATOMbasetype(l->ttype),
+		.nil_matches = nil_matches,
+		.nthreads = GDKnr_threads > 1 ? GDKnr_threads : 1,
+	};
+	struct radixwork *work = NULL;
+	BAT *r1 = NULL, *r2 = NULL;
+	BUN icnt = swapped ? lci->ncand : rci->ncand;
+	size_t width = li.width;
+	gdk_return rc = GDK_FAIL;
+
+	assert(rj.tpe == TYPE_int || rj.tpe == TYPE_lng);
+	assert(ATOMtype(l->ttype) == ATOMtype(r->ttype));
+	MT_thread_setalgorithm(swapped ? "radixjoin (swapped)" : "radixjoin");
+	rj.spill = GDKspilling(icnt * (width + 2 * sizeof(BUN)));
+	if (rj.spill)
+		MT_thread_setalgorithm("spilled to disk");
+
+	/* choose the number of partitions such that the inner side of
+	 * a partition (values, oids, and hash table) fits in the L2
+	 * cache */
+	size_t isize = icnt * (width + sizeof(oid) + 2 * sizeof(BUN));
+	while (rj.nbits < RADIX_MAXBITS &&
+	       (isize >> rj.nbits) > GDK_l2_cachesize)
+		rj.nbits++;
+	rj.nparts = (BUN) 1 << rj.nbits;
+	ATOMIC_INIT(&rj.nextpart, 0);
+	ATOMIC_INIT(&rj.failed, 0);
+
+	rj.side[0] = (struct radixside) {
+		.vals = swapped ? ri.base : li.base,
+		.hseq = swapped ? r->hseqbase : l->hseqbase,
+		.ci = swapped ? rci : lci,
+	};
+	rj.side[1] = (struct radixside) {
+		.vals = swapped ? li.base : ri.base,
+		.hseq = swapped ? l->hseqbase : r->hseqbase,
+		.ci = swapped ? lci : rci,
+	};
+	work = GDKmalloc(rj.nthreads * sizeof(*work));
+	if (work == NULL)
+		goto bailout;
+	for (int i = 0; i < rj.nthreads; i++)
+		work[i] = (struct radixwork) {.rj = &rj, .idx = i,};
+	for (int s = 0; s < 2; s++) {
+		struct radixside *sd = &rj.side[s];
+		if (rj.spill) {
+			if (HEAPspill(&sd->hvals, sd->ci->ncand * width, "radixjoin") != GDK_SUCCEED ||
+			    HEAPspill(&sd->hoids, sd->ci->ncand * sizeof(oid), "radixjoin") != GDK_SUCCEED)
+				goto bailout;
+			sd->pvals = sd->hvals.base;
+			sd->poids = (oid *) sd->hoids.base;
+		} else {
+			sd->pvals = GDKmalloc(sd->ci->ncand * width);
+			sd->poids = GDKmalloc(sd->ci->ncand * sizeof(oid));
+		}
+		sd->hist = GDKmalloc(rj.nthreads * rj.nparts * sizeof(BUN));
+		sd->bounds = GDKmalloc((rj.nparts + 1) * sizeof(BUN));
+		if (sd->pvals == NULL || sd->poids == NULL ||
+		    sd->hist == NULL || sd->bounds == NULL)
+			goto bailout;
+	}
+
+	/* phase 1: histograms */
+	GDKparallel(radixjoin_count, work, sizeof(*work), rj.nthreads,
+		    "radixjoinXXXX");
+	if (ATOMIC_GET(&rj.failed))
+		goto bailout;
+	/* turn the histograms into scatter positions and partition
+	 * boundaries */
+	for (int s = 0; s < 2; s++) {
+		struct radixside *sd = &rj.side[s];
+		BUN pos = 0;
+		for (BUN p = 0; p < rj.nparts; p++) {
+			sd->bounds[p] = pos;
+			for (int i = 0; i < rj.nthreads; i++) {
+				BUN c = sd->hist[i * rj.nparts + p];
+				sd->hist[i * rj.nparts + p] = pos;
+				pos += c;
+			}
+		}
+		sd->bounds[rj.nparts] = pos;
+	}
+	/* phase 2: scatter */
+	GDKparallel(radixjoin_scatter, work, sizeof(*work), rj.nthreads,
+		    "radixjoinXXXX");
+	if (ATOMIC_GET(&rj.failed))
+		goto bailout;
+	/* phase 3: join the partitions */
+	GDKparallel(radixjoin_join, work, sizeof(*work), rj.nthreads,
+		    "radixjoinXXXX");
+	if (ATOMIC_GET(&rj.failed))
+		goto bailout;
+
+	/* collect the results of the workers */
+	BUN nres = 0;
+	for (int i = 0; i < rj.nthreads; i++)
+		nres += work[i].nres;
+	r1 = COLnew(0, TYPE_oid, nres, TRANSIENT);
+	if (r1 == NULL)
+		goto bailout;
+	if (r2p) {
+		r2 = COLnew(0, TYPE_oid, nres, TRANSIENT);
+		if (r2 == NULL)
+			goto bailout;
+	}
+	oid *o1 = Tloc(r1, 0), *o2 = r2 ? Tloc(r2, 0) : NULL;
+	for (int i = 0; i < rj.nthreads; i++) {
+		if (work[i].nres == 0)
+			continue;
+		memcpy(o1, swapped ? work[i].r2 : work[i].r1,
+		       work[i].nres * sizeof(oid));
+		o1 += work[i].nres;
+		if (o2) {
+			memcpy(o2, swapped ? work[i].r1 : work[i].r2,
+			       work[i].nres * sizeof(oid));
+			o2 += work[i].nres;
+		}
+	}
+	BATsetcount(r1, nres);
+	r1->tnil = false;
+	r1->tnonil = true;
+	r1->tkey = ri.key || nres <= 1;
+	r1->tsorted = r1->trevsorted = nres <= 1;
+	r1->tseqbase = nres == 0 ? 0 : nres == 1 ? *(oid *) Tloc(r1, 0) : oid_nil;
+	if (r2) {
+		BATsetcount(r2, nres);
+		r2->tnil = false;
+		r2->tnonil = true;
+		r2->tkey = li.key || nres <= 1;
+		r2->tsorted = r2->trevsorted = nres <= 1;
+		r2->tseqbase = nres == 0 ? 0 : nres == 1 ? *(oid *) Tloc(r2, 0) : oid_nil;
+	}
+	*r1p = r1;
+	if (r2p)
+		*r2p = r2;
+	rc = GDK_SUCCEED;
+
+	TRC_DEBUG(ALGO, "l=" ALGOBATFMT "," "r=" ALGOBATFMT
+		  ",sl=" ALGOOPTBATFMT "," "sr=" ALGOOPTBATFMT ","
+		  "nil_matches=%s,nbits=%u,nthreads=%d;%s%s %s -> "
+		  ALGOBATFMT "," ALGOOPTBATFMT " (" LLFMT "usec)\n",
+		  ALGOBATPAR(l), ALGOBATPAR(r),
+		  ALGOOPTBATPAR(lci->s), ALGOOPTBATPAR(rci->s),
+		  nil_matches ? "true" : "false", rj.nbits, rj.nthreads,
+		  swapped ? " swapped" : "", rj.spill ? " spilled" : "",
+		  reason,
+		  ALGOBATPAR(r1), ALGOOPTBATPAR(r2),
+		  GDKusec() - t0);
+
+  bailout:
+	if (rc != GDK_SUCCEED) {
+		QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+		if (TIMEOUT_TEST(qry_ctx))
+			TIMEOUT_ERROR(qry_ctx, __FILE__, __func__, __LINE__);
+		else if (ATOMIC_GET(&rj.failed))
+			GDKerror("radix join failed to allocate memory\n");
+		BBPreclaim(r1);
+		BBPreclaim(r2);
+	}
+	bat_iterator_end(&li);
+	bat_iterator_end(&ri);
+	for (int s = 0; s < 2; s++) {
+		struct radixside *sd = &rj.side[s];
+		if (rj.spill) {
+			if (sd->hvals.base)
+				HEAPfree(&sd->hvals, true);
+			if (sd->hoids.base)
+				HEAPfree(&sd->hoids, true);
+		} else {
+			GDKfree(sd->pvals);
+			GDKfree(sd->poids);
+		}
+		GDKfree(sd->hist);
+		GDKfree(sd->bounds);
+	}
+	if (work) {
+		for (int i = 0; i < rj.nthreads; i++)
+			radixwork_free(&work[i]);
+		GDKfree(work);
+	}
+	return rc;
+}
+
 /* Count the number of unique values for the first half and the complete
  * set (the sample s of b) and return the two values in *cnt1 and
  * *cnt2. In case of error, both values are 0. */
@@ -3550,7 +4006,7 @@ guess_uniques(BAT *b, struct canditer *ci)
 	bool key = b->tkey;
 	double unique_est = b->tunique_est;
 	BUN batcount = BATcount(b);
-	if (b->ttype == TYPE_str && GDK_ELIMDOUBLES(b->tvheap)) {
+	if (b->ttype == TYPE_str && GDK_STRUNIQUE(b->tvheap)) {
 		cnt1 = countStrings(b->tvheap);
 		if (ci->s == NULL ||
 		    (ci->tpe == cand_dense && ci->ncand == batcount)) {
@@ -3640,11 +4096,12 @@ BATguess_uniques(BAT *b, struct canditer *ci)
 }
 
 /* estimate the cost of doing a hashjoin with a hash on r; return value
- * is the estimated cost, the last three arguments receive some extra
- * information */
+ * is the estimated cost, the last four arguments receive some extra
+ * information; if radix is not NULL, a radix-partitioned join (see
+ * radixjoin) is considered as well */
 double
 joincost(BAT *r, BUN lcount, struct canditer *rci,
-	 bool *hash, bool *phash, bool *cand)
+	 bool *hash, bool *phash, bool *cand, bool *radix)
 {
 	bool rhash;
 	bool prhash = false;
@@ -3743,6 +4200,44 @@ joincost(BAT *r, BUN lcount, struct canditer *rci,
 		}
 		*cand = rcand;
 	}
+	if (radix) {
+		*radix = false;
+		int t = ATOMbasetype(r->ttype);
+		size_t hsize = (size_t) rci->ncand * (r->twidth + 2 * sizeof(BUN));
+		if (!BATtdense(r) &&
+		    (t == TYPE_int || t == TYPE_lng)) {
+			/* besides the hash table, memory is needed for
+			 * the result, at least one row per outer row
+			 * for a join on a key; a grace hash join keeps
+			 * both out of memory while joining */
+			if (!rhash &&
+			    GDKspilling(hsize + (size_t) lcount * 2 * sizeof(oid))) {
+				/* there is no memory for the hash
+				 * table, so do a grace hash join:
+				 * partition both sides on disk and
+				 * join the partitions one by one */
+				*radix = true;
+				if (cand)
+					*cand = false;
+			} else if (hsize > GDK_llc_cachesize &&
+				   GDKnr_threads > 1) {
+				/* the hash table doesn't fit in the
+				 * cache, so just about every probe is
+				 * a cache miss; partitioning both
+				 * sides and joining the partitions in
+				 * parallel costs a few sequential
+				 * passes over the inputs */
+				double hcost = rcost + (RADIX_MISS_COST - 1) * lcount;
+				double xcost = RADIX_COST * (lcount + rci->ncand) / GDKnr_threads;
+				if (xcost < hcost) {
+					rcost = xcost;
+					*radix = true;
+					if (cand)
+						*cand = false;
+				}
+			}
+		}
+	}
 	*hash = rhash;
 	*phash = prhash;
 	return rcost;
@@ -4268,7 +4763,7 @@ leftjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r, BAT *sl, BAT *sr,
 			goto doreturn;
 		}
 	}
-	rcost = joincost(r, lci.ncand, &rci, &rhash, &prhash, &rcand);
+	rcost = joincost(r, lci.ncand, &rci, &rhash, &prhash, &rcand, NULL);
 	if (rcost < 0) {
 		rc = GDK_FAIL;
 		goto doreturn;
@@ -4281,7 +4776,7 @@ leftjoin(BAT **r1p, BAT **r2p, BAT **r3p, BAT *l, BAT *r, BAT *sl, BAT *sr,
 		bool lhash, plhash, lcand, rkey = r->tkey;
 		double lcost;
 
-		lcost = joincost(l, rci.ncand, &lci, &lhash, &plhash, &lcand);
+		lcost = joincost(l, rci.ncand, &lci, &lhash, &plhash, &lcand, NULL);
 		if (lcost < 0) {
 			rc = GDK_FAIL;
 			goto doreturn;
@@ -4471,6 +4966,170 @@ BATdiff(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, bool not_in,
 	return NULL;
 }
 
+/* Bloom filter semijoin reduction.  The filter has BLOOM_BITS bits
+ * per value of r and two probes per value; together with the range
+ * of the values of r it is used to drop the rows of l that cannot
+ * have a match before they are joined (and projected). */
+#define BLOOM_BITS	8	/* bits per value of r */
+#define BLOOM_RATIO	4	/* l must be this much larger than r */
+#define BLOOM_HASH1(v)	((ulng) (v) * UINT64_C(0x9E3779B97F4A7C15))
+#define BLOOM_HASH2(v)	((ulng) (v) * UINT64_C(0xC2B2AE3D27D4EB4F))
+#define BLOOM_SET(h)	(bloom[(h) >> (64 - logm) >> 6] |= (ulng) 1 << (((h) >> (64 - logm)) & 63))
+#define BLOOM_TEST(h)	(bloom[(h) >> (64 - logm) >> 6] & ((ulng) 1 << (((h) >> (64 - logm)) & 63)))
+
+#define BLOOMFILTER(TYPE)						\
+	do {								\
+		const TYPE *restrict rvals = ri.base;			\
+		const TYPE *restrict lvals = li.base;			\
+		TYPE mn = 0, mx = 0;					\
+		bool empty = true;					\
+		TIMEOUT_LOOP(rci.ncand, qry_ctx) {			\
+			TYPE v = rvals[canditer_next(&rci) - r->hseqbase]; \
+			if (is_##TYPE##_nil(v))				\
+				continue;				\
+			if (empty) {					\
+				mn = mx = v;				\
+				empty = false;				\
+			} else if (v < mn) {				\
+				mn = v;					\
+			} else if (v > mx) {				\
+				mx = v;					\
+			}						\
+			BLOOM_SET(BLOOM_HASH1(v));			\
+			BLOOM_SET(BLOOM_HASH2(v));			\
+		}							\
+		TIMEOUT_CHECK(qry_ctx,					\
+			      GOTO_LABEL_TIMEOUT_HANDLER(bailout, qry_ctx)); \
+		if (empty)						\
+			break;						\
+		TIMEOUT_LOOP(lci.ncand, qry_ctx) {			\
+			oid o = canditer_next(&lci);			\
+			TYPE v = lvals[o - l->hseqbase];		\
+			/* nil is smaller than any value, so fails mn <= v */ \
+			if (v >= mn && v <= mx &&			\
+			    BLOOM_TEST(BLOOM_HASH1(v)) &&		\
+			    BLOOM_TEST(BLOOM_HASH2(v)))			\
+				dst[cnt++] = o;				\
+		}							\
+		TIMEOUT_CHECK(qry_ctx,					\
+			      GOTO_LABEL_TIMEOUT_HANDLER(bailout, qry_ctx)); \
+	} while (0)
+
+/* Return a candidate list with the rows of l (restricted to sl) whose
+ * value may occur in r (restricted to sr).  This is the cheap, inexact
+ * version of BATintersect: the values of r are summarized by their
+ * range and a Bloom filter, which is small enough to stay in the cache
+ * when r is much smaller than l, and the rows of l that fail either
+ * are dropped.  The result may still contain rows without a match, so
+ * it is only useful as a filter before the actual join.  Nils never
+ * match.  When the filter is not expected to pay off (r is not much
+ * smaller than l, or the type is not integer based), the candidates of
+ * l are returned unfiltered. */
+BAT *
+BATbloomfilter(BAT *l, BAT *r, BAT *sl, BAT *sr)
+{
+	struct canditer lci, rci;
+	BAT *bn;
+	BATiter li, ri;
+	ulng *bloom = NULL;
+	unsigned logm;
+	BUN cnt = 0;
+	oid *dst;
+	lng t0 = GDK_TRACER_TEST(M_DEBUG, ALGO) ? GDKusec() : 0;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+
+	BATcheck(l, NULL);
+	BATcheck(r, NULL);
+	canditer_init(&lci, l, sl);
+	canditer_init(&rci, r, sr);
+
+	switch (ATOMbasetype(l->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+		if (ATOMtype(l->ttype) == ATOMtype(r->ttype) &&
+		    lci.ncand > 0 &&
+		    lci.ncand >= (BUN) BLOOM_RATIO * rci.ncand)
+			break;
+		/* fall through */
+	default:
+		/* not worth it */
+		bn = canditer_slice(&lci, 0, lci.ncand);
+		TRC_DEBUG(ALGO, "l=" ALGOBATFMT ",r=" ALGOBATFMT
+			  ",sl=" ALGOOPTBATFMT ",sr=" ALGOOPTBATFMT
+			  " -> " ALGOOPTBATFMT " (unfiltered)\n",
+			  ALGOBATPAR(l), ALGOBATPAR(r),
+			  ALGOOPTBATPAR(sl), ALGOOPTBATPAR(sr),
+			  ALGOOPTBATPAR(bn));
+		return bn;
+	}
+
+	/* size of the filter in bits: a power of two of at least
+	 * BLOOM_BITS bits per value, and at least a word */
+	for (logm = 6; ((BUN) 1 << logm) < (BUN) BLOOM_BITS * rci.ncand; logm++)
+		;
+	bloom = GDKzalloc(((size_t) 1 << logm) / 8);
+	bn = COLnew(0, TYPE_oid, lci.ncand, TRANSIENT);
+	if (bloom == NULL || bn == NULL) {
+		GDKfree(bloom);
+		BBPreclaim(bn);
+		return NULL;
+	}
+	dst = Tloc(bn, 0);
+	li = bat_iterator(l);
+	ri = bat_iterator(r);
+	switch (ATOMbasetype(l->ttype)) {
+	case TYPE_bte:
+		BLOOMFILTER(bte);
+		break;
+	case TYPE_sht:
+		BLOOMFILTER(sht);
+		break;
+	case TYPE_int:
+		BLOOMFILTER(int);
+		break;
+	case TYPE_lng:
+		BLOOMFILTER(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		BLOOMFILTER(hge);
+		break;
+#endif
+	default:
+		MT_UNREACHABLE();
+	}
+	bat_iterator_end(&li);
+	bat_iterator_end(&ri);
+	GDKfree(bloom);
+
+	BATsetcount(bn, cnt);
+	bn->tsorted = true;
+	bn->trevsorted = cnt <= 1;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	bn = virtualize(bn);
+	TRC_DEBUG(ALGO, "l=" ALGOBATFMT ",r=" ALGOBATFMT
+		  ",sl=" ALGOOPTBATFMT ",sr=" ALGOOPTBATFMT
+		  ",bits=%u -> " ALGOOPTBATFMT " (" LLFMT "usec)\n",
+		  ALGOBATPAR(l), ALGOBATPAR(r),
+		  ALGOOPTBATPAR(sl), ALGOOPTBATPAR(sr),
+		  logm, ALGOOPTBATPAR(bn), GDKusec() - t0);
+	return bn;
+
+  bailout:
+	bat_iterator_end(&li);
+	bat_iterator_end(&ri);
+	GDKfree(bloom);
+	BBPreclaim(bn);
+	return NULL;
+}
+
 gdk_return
 BATthetajoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int op, bool nil_matches, BUN estimate)
 {
@@ -4519,6 +5178,7 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches
 	struct canditer lci, rci;
 	bool lhash = false, rhash = false, lcand = false;
 	bool plhash = false, prhash = false, rcand = false;
+	bool lradix = false, rradix = false;
 	bool swap;
 	bat parent;
 	double rcost = 0;
@@ -4640,8 +5300,8 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches
 		goto doreturn;
 	}
 
-	lcost = joincost(l, rci.ncand, &lci, &lhash, &plhash, &lcand);
-	rcost = joincost(r, lci.ncand, &rci, &rhash, &prhash, &rcand);
+	lcost = joincost(l, rci.ncand, &lci, &lhash, &plhash, &lcand, &lradix);
+	rcost = joincost(r, lci.ncand, &rci, &rhash, &prhash, &rcand, &rradix);
 	if (lcost < 0 || rcost < 0) {
 		rc = GDK_FAIL;
 		goto doreturn;
@@ -4669,6 +5329,12 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches
 			       estimate, t0, true, __func__);
 		if (rc == GDK_SUCCEED && r2p == NULL)
 			BBPunfix(r2->batCacheid);
+	} else if (swap ? lradix : rradix) {
+		/* the hash table would not fit in the cache: use a
+		 * radix-partitioned join with the inner side the
+		 * one that would have been hashed */
+		rc = radixjoin(r1p, r2p, l, r, &lci, &rci, nil_matches,
+			       t0, swap, __func__);
 	} else if (swap) {
 		rc = hashjoin(r2p ? r2p : &r2, r1p, NULL, r, l, &rci, &lci,
 			      nil_matches, false, false, false, false, false, false,
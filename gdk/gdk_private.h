@@ -22,6 +22,7 @@ enum heaptype {
 	hashheap,
 	orderidxheap,
 	strimpheap,
+	zonemapheap,
 	dataheap
 };
 
@@ -147,6 +148,10 @@ gdk_return GDKmove(int farmid, const char *dir1, const char *nme1, const char *e
 	__attribute__((__visibility__("hidden")));
 void *GDKmremap(const char *path, int mode, void *old_address, size_t old_size, size_t *new_size)
 	__attribute__((__visibility__("hidden")));
+void GDKparallel(void (*func)(void *), void *args, size_t argsize, int nargs, const char *name)
+	__attribute__((__visibility__("hidden")));
+bool GDKspilling(size_t size)
+	__attribute__((__visibility__("hidden")));
 gdk_return GDKremovedir(int farmid, const char *nme)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -203,6 +208,9 @@ void HEAPfree(Heap *h, bool remove)
 	__attribute__((__visibility__("hidden")));
 gdk_return HEAPgrow(Heap **old, size_t size, bool mayshare)
 	__attribute__((__visibility__("hidden")));
+gdk_return HEAPspill(Heap *h, size_t size, const char *name)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
 gdk_return HEAPload(Heap *h, const char *nme, const char *ext, bool trunc)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -211,7 +219,7 @@ void HEAP_recover(Heap *, const var_t *, BUN)
 gdk_return HEAPsave(Heap *h, const char *nme, const char *ext, bool dosync, BUN free, MT_Lock *lock)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
-double joincost(BAT *r, BUN lcount, struct canditer *rci, bool *hash, bool *phash, bool *cand)
+double joincost(BAT *r, BUN lcount, struct canditer *rci, bool *hash, bool *phash, bool *cand, bool *radix)
 	__attribute__((__visibility__("hidden")));
 void STRMPincref(Strimps *strimps)
 	__attribute__((__visibility__("hidden")));
@@ -219,6 +227,8 @@ void STRMPdecref(Strimps *strimps, bool remove)
 	__attribute__((__visibility__("hidden")));
 void STRMPfree(BAT *b)
 	__attribute__((__visibility__("hidden")));
+void STRMPsave(BAT *b)
+	__attribute__((__visibility__("hidden")));
 void MT_init_posix(void)
 	__attribute__((__visibility__("hidden")));
 void *MT_mmap(const char *path, int mode, size_t len)
@@ -241,6 +251,12 @@ void settailname(Heap *restrict tail, const char *restrict physnme, int tt, int
 	__attribute__((__visibility__("hidden")));
 void strCleanHash(Heap *hp, bool rebuild)
 	__attribute__((__visibility__("hidden")));
+void strDictBuild(Heap *h)
+	__attribute__((__visibility__("hidden")));
+void strDictDestroy(Heap *h)
+	__attribute__((__visibility__("hidden")));
+struct Strdict *strDictCopy(Heap *h)
+	__attribute__((__visibility__("hidden")));
 gdk_return strHeap(Heap *d, size_t cap)
 	__attribute__((__visibility__("hidden")));
 var_t strLocate(Heap *h, const char *v)
@@ -260,6 +276,16 @@ gdk_return unshare_varsized_heap(BAT *b)
 	__attribute__((__visibility__("hidden")));
 BAT *virtualize(BAT *bn)
 	__attribute__((__visibility__("hidden")));
+void ZMdestroy(BAT *b)
+	__attribute__((__visibility__("hidden")));
+void ZMfree(BAT *b)
+	__attribute__((__visibility__("hidden")));
+Heap *ZMget(BAT *b, BUN *ncovp)
+	__attribute__((__visibility__("hidden")));
+bool ZMnextrun(const Heap *hp, BUN ncov, BUN off, const void *tl, const void *th, BUN *pos, BUN end, BUN *lo, BUN *hi)
+	__attribute__((__visibility__("hidden")));
+void ZMsave(BAT *b, bool dosync)
+	__attribute__((__visibility__("hidden")));
 
 /* calculate the integer 2 logarithm (i.e. position of highest set
  * bit) of the argument (with a slight twist: 0 gives 0, 1 gives 1,
@@ -338,7 +364,7 @@ ilog2(BUN x)
 	ATOMname(b->ttype),						\
 	b->ttype==TYPE_str?b->twidth==1?"1":b->twidth==2?"2":b->twidth==4?"4":"8":"", \
 	!b->batTransient ? "P" : b->theap && b->theap->parentid != b->batCacheid ? "V" : b->tvheap && b->tvheap->parentid != b->batCacheid ? "v" : "T", \
-	BATtdense(b) ? "D" : b->ttype == TYPE_void && b->tvheap ? "X" : ATOMstorage(b->ttype) == TYPE_str && b->tvheap && GDK_ELIMDOUBLES(b->tvheap) ? "E" : "", \
+	BATtdense(b) ? "D" : b->ttype == TYPE_void && b->tvheap ? "X" : ATOMstorage(b->ttype) == TYPE_str && b->tvheap && GDK_STRUNIQUE(b->tvheap) ? "E" : "", \
 	b->tsorted ? "S" : b->tnosorted ? "!s" : "",			\
 	b->trevsorted ? "R" : b->tnorevsorted ? "!r" : "",		\
 	b->tkey ? "K" : b->tnokey[1] ? "!k" : "",			\
@@ -359,7 +385,7 @@ ilog2(BUN x)
 	b ? b->ttype==TYPE_str?b->twidth==1?"1":b->twidth==2?"2":b->twidth==4?"4":"8":"" : "", \
 	b ? "]" : "",							\
 	b ? !b->batTransient ? "P" : b->theap && b->theap->parentid != b->batCacheid ? "V" : b->tvheap && b->tvheap->parentid != b->batCacheid ? "v" : "T" : "", \
-	b ? BATtdense(b) ? "D" : b->ttype == TYPE_void && b->tvheap ? "X" : ATOMstorage(b->ttype) == TYPE_str && b->tvheap && GDK_ELIMDOUBLES(b->tvheap) ? "E" : "" : "", \
+	b ? BATtdense(b) ? "D" : b->ttype == TYPE_void && b->tvheap ? "X" : ATOMstorage(b->ttype) == TYPE_str && b->tvheap && GDK_STRUNIQUE(b->tvheap) ? "E" : "" : "", \
 	b ? b->tsorted ? "S" : b->tnosorted ? "!s" : "" : "",		\
 	b ? b->trevsorted ? "R" : b->tnorevsorted ? "!r" : "" : "",	\
 	b ? b->tkey ? "K" : b->tnokey[1] ? "!k" : "" : "",		\
@@ -415,6 +441,8 @@ extern batlock_t GDKbatLock[BBP_BATMASK + 1] __attribute__((__visibility__("hidd
 extern size_t GDK_mmap_minsize_persistent __attribute__((__visibility__("hidden"))); /* size after which we use memory mapped files for persistent heaps */
 extern size_t GDK_mmap_minsize_transient __attribute__((__visibility__("hidden"))); /* size after which we use memory mapped files for transient heaps */
 extern size_t GDK_mmap_pagesize __attribute__((__visibility__("hidden"))); /* mmap granularity */
+extern size_t GDK_l2_cachesize __attribute__((__visibility__("hidden"))); /* size of (per core) L2 cache */
+extern size_t GDK_llc_cachesize __attribute__((__visibility__("hidden"))); /* size of last level cache */
 
 #define BATcheck(tst, err)				\
 	do {						\
@@ -245,6 +245,70 @@ hashselect(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 		TIMEOUT_CHECK(qry_ctx, GOTO_LABEL_TIMEOUT_HANDLER(bailout, qry_ctx)); \
 	} while (false)
 
+/* core scan select loop for dense candidates: the values are tested
+ * in groups of 32 whose results are collected in a bit mask, a loop
+ * that compilers can vectorize, after which the oids of the matching
+ * values are extracted from the mask */
+#define densescanloop(NAME,TEST)					\
+	do {								\
+		BUN ncand = ci->ncand;					\
+		const oid seq = ci->seq;				\
+		const BUN off = seq - hseq;				\
+		*algo = "select: " #NAME " " #TEST " (blockwise)";	\
+		TIMEOUT_LOOP_IDX(p, ncand / 32, qry_ctx) {		\
+			uint32_t m = 0;					\
+			for (int j = 0; j < 32; j++) {			\
+				v = src[off + p * 32 + j];		\
+				m |= (uint32_t) (TEST) << j;		\
+			}						\
+			if (m != 0) {					\
+				if (cnt + 32 > BATcapacity(bn) &&	\
+				    BATcapacity(bn) < maximum) {	\
+					BUN g = (BUN) ((dbl) cnt / (dbl) ((p + 1) * 32) \
+						       * (dbl) (ncand - p * 32) * 1.1 + 1024); \
+					BATsetcount(bn, cnt);		\
+					if (BATextend(bn, MIN(BATcapacity(bn) + MAX(g, 32), maximum)) != GDK_SUCCEED) \
+						goto bailout;		\
+					dst = (oid *) Tloc(bn, 0);	\
+				}					\
+				do {					\
+					o = seq + p * 32 + candmask_lobit(m); \
+					dst[cnt++] = o;			\
+					m &= m - 1;			\
+				} while (m != 0);			\
+			}						\
+		}							\
+		TIMEOUT_CHECK(qry_ctx, GOTO_LABEL_TIMEOUT_HANDLER(bailout, qry_ctx)); \
+		for (p = ncand & ~(BUN) 31; p < ncand; p++) {		\
+			v = src[off + p];				\
+			if (TEST) {					\
+				o = seq + p;				\
+				dst = buninsfix(bn, dst, cnt, o, 32, maximum); \
+				if (dst == NULL) {			\
+					goto bailout;			\
+				}					\
+				cnt++;					\
+			}						\
+		}							\
+		ci->next = ncand;					\
+	} while (false)
+#define SCANLOOP(NAME,TEST)		scanloop(NAME, canditer_next, TEST)
+#define SCANLOOP_dense(NAME,TEST)	densescanloop(NAME, TEST)
+
+/* On x86-64 the dense scans are compiled for several instruction set
+ * extensions, the best of which is chosen at run time by the dynamic
+ * loader.  Elsewhere (e.g. aarch64 with NEON) the baseline
+ * instruction set already suffices to vectorize the loop above. */
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__has_attribute)
+#if __has_attribute(__target_clones__)
+#define SCANATTR_dense	__attribute__((__target_clones__("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef SCANATTR_dense
+#define SCANATTR_dense
+#endif
+#define SCANATTR
+
 /* argument list for type-specific core scan select function call */
 #define scanargs							\
 	bi, ci, bn, tl, th, li, hi, equi, anti, nil_matches, lval, hval, \
@@ -296,7 +360,7 @@ hashselect(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 
 /* definition of type-specific core scan select function */
 #define scanfunc(NAME, TYPE, ISDENSE)					\
-static BUN								\
+static SCANATTR##ISDENSE BUN						\
 NAME##_##TYPE(BATiter *bi, struct canditer *restrict ci, BAT *bn,	\
 	      const TYPE *tl, const TYPE *th, bool li, bool hi,		\
 	      bool equi, bool anti, bool nil_matches, bool lval,	\
@@ -419,23 +483,23 @@ NAME##_##TYPE(BATiter *bi, struct canditer *restrict ci, BAT *bn,	\
 	assert(hval);							\
 	if (equi) {							\
 		if (lnil)						\
-			scanloop(NAME, canditer_next##ISDENSE, is_##TYPE##_nil(v)); \
+			SCANLOOP##ISDENSE(NAME, is_##TYPE##_nil(v)); \
 		else							\
-			scanloop(NAME, canditer_next##ISDENSE, v == vl); \
+			SCANLOOP##ISDENSE(NAME, v == vl); \
 	} else if (anti) {						\
 		if (bi->nonil) {					\
-			scanloop(NAME, canditer_next##ISDENSE, (v <= vl || v >= vh)); \
+			SCANLOOP##ISDENSE(NAME, (v <= vl || v >= vh)); \
 		} else if (nil_matches) {				\
-			scanloop(NAME, canditer_next##ISDENSE, is_##TYPE##_nil(v) || v <= vl || v >= vh); \
+			SCANLOOP##ISDENSE(NAME, is_##TYPE##_nil(v) || v <= vl || v >= vh); \
 		} else {						\
-			scanloop(NAME, canditer_next##ISDENSE, !is_##TYPE##_nil(v) && (v <= vl || v >= vh)); \
+			SCANLOOP##ISDENSE(NAME, !is_##TYPE##_nil(v) && (v <= vl || v >= vh)); \
 		}							\
 	} else if (bi->nonil && vl == minval) {				\
-		scanloop(NAME, canditer_next##ISDENSE, v <= vh);			\
+		SCANLOOP##ISDENSE(NAME, v <= vh);			\
 	} else if (vh == maxval) {					\
-		scanloop(NAME, canditer_next##ISDENSE, v >= vl);			\
+		SCANLOOP##ISDENSE(NAME, v >= vl);			\
 	} else {							\
-		scanloop(NAME, canditer_next##ISDENSE, v >= vl && v <= vh);	\
+		SCANLOOP##ISDENSE(NAME, v >= vl && v <= vh);	\
 	}								\
 	return cnt;							\
   bailout:								\
@@ -615,7 +679,7 @@ fullscan_str(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 	oid o;
 	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
 
-	if (anti && tl == th && !bi->nonil && GDK_ELIMDOUBLES(bi->vh) &&
+	if (anti && tl == th && !bi->nonil && GDK_STRUNIQUE(bi->vh) &&
 	    strcmp(tl, str_nil) != 0 &&
 	    strLocate(bi->vh, str_nil) == (var_t) -2) {
 		/* anti-equi select for non-nil value, and there are no
@@ -625,7 +689,7 @@ fullscan_str(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 	}
 	if (!((equi ||
 	       (anti && tl == th && (bi->nonil || strcmp(tl, str_nil) == 0))) &&
-	      GDK_ELIMDOUBLES(bi->vh)))
+	      GDK_STRUNIQUE(bi->vh)))
 		return fullscan_any(bi, ci, bn, tl, th, li, hi, equi, anti,
 				    nil_matches, lval, hval, lnil, cnt, hseq,
 				    dst, maximum, algo);
@@ -648,9 +712,10 @@ fullscan_str(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 		return 0;
 	}
 	if (pos == (var_t) -1) {
-		*algo = NULL;
-		BBPreclaim(bn);
-		return BUN_NONE;
+		/* the heap lost its dictionary in the mean time */
+		return fullscan_any(bi, ci, bn, tl, th, li, hi, equi, anti,
+				    nil_matches, lval, hval, lnil, cnt, hseq,
+				    dst, maximum, algo);
 	}
 	*algo = anti ? "select: fullscan anti-equi strelim" : "select: fullscan equi strelim";
 	assert(pos >= GDK_VAROFFSET);
@@ -975,17 +1040,67 @@ realign_tags(void)
 }
 #endif
 
+/* call type-specific core scan select function */
+static BUN
+scandispatch(BATiter *bi, struct canditer *restrict ci, BAT *bn,
+	     const void *tl, const void *th,
+	     bool li, bool hi, bool equi, bool anti, bool nil_matches,
+	     bool lval, bool hval, bool lnil, BUN cnt, oid *restrict dst,
+	     BUN maximum, const char **algo)
+{
+	switch (ATOMbasetype(bi->type)) {
+	case TYPE_bte:
+		if (ci->tpe == cand_dense)
+			return densescan_bte(scanargs);
+		return fullscan_bte(scanargs);
+	case TYPE_sht:
+		if (ci->tpe == cand_dense)
+			return densescan_sht(scanargs);
+		return fullscan_sht(scanargs);
+	case TYPE_int:
+		if (ci->tpe == cand_dense)
+			return densescan_int(scanargs);
+		return fullscan_int(scanargs);
+	case TYPE_flt:
+		if (ci->tpe == cand_dense)
+			return densescan_flt(scanargs);
+		return fullscan_flt(scanargs);
+	case TYPE_dbl:
+		if (ci->tpe == cand_dense)
+			return densescan_dbl(scanargs);
+		return fullscan_dbl(scanargs);
+	case TYPE_lng:
+		if (ci->tpe == cand_dense)
+			return densescan_lng(scanargs);
+		return fullscan_lng(scanargs);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		if (ci->tpe == cand_dense)
+			return densescan_hge(scanargs);
+		return fullscan_hge(scanargs);
+#endif
+	case TYPE_str:
+		return fullscan_str(scanargs);
+	default:
+		return fullscan_any(scanargs);
+	}
+}
+
+/* If zmh is not NULL, it is a zone map on the values of bi (or on its
+ * parent, in which case bi starts at position zmoff of the parent)
+ * covering zmcov blocks, and only those runs of (dense) candidates are
+ * scanned whose blocks may contain values in the range. */
 static BAT *
 scanselect(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 	   const void *tl, const void *th,
 	   bool li, bool hi, bool equi, bool anti, bool nil_matches,
 	   bool lval, bool hval, bool lnil,
-	   BUN maximum, const char **algo)
+	   BUN maximum, const Heap *zmh, BUN zmcov, BUN zmoff,
+	   const char **algo)
 {
 #ifndef NDEBUG
 	int (*cmp)(const void *, const void *);
 #endif
-	int t;
 	BUN cnt = 0;
 	oid *restrict dst;
 
@@ -997,6 +1112,7 @@ scanselect(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 	assert(!equi || (li && hi && !anti));
 	assert(!anti || lval || hval);
 	assert(bi->type != TYPE_void || equi || bi->nonil);
+	assert(zmh == NULL || (ci->tpe == cand_dense && !anti && !(equi && lnil)));
 
 #ifndef NDEBUG
 	cmp = ATOMcompare(bi->type);
@@ -1006,63 +1122,34 @@ scanselect(BATiter *bi, struct canditer *restrict ci, BAT *bn,
 
 	dst = (oid *) Tloc(bn, 0);
 
-	t = ATOMbasetype(bi->type);
-
-	/* call type-specific core scan select function */
-	switch (t) {
-	case TYPE_bte:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_bte(scanargs);
-		else
-			cnt = fullscan_bte(scanargs);
-		break;
-	case TYPE_sht:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_sht(scanargs);
-		else
-			cnt = fullscan_sht(scanargs);
-		break;
-	case TYPE_int:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_int(scanargs);
-		else
-			cnt = fullscan_int(scanargs);
-		break;
-	case TYPE_flt:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_flt(scanargs);
-		else
-			cnt = fullscan_flt(scanargs);
-		break;
-	case TYPE_dbl:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_dbl(scanargs);
-		else
-			cnt = fullscan_dbl(scanargs);
-		break;
-	case TYPE_lng:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_lng(scanargs);
-		else
-			cnt = fullscan_lng(scanargs);
-		break;
-#ifdef HAVE_HGE
-	case TYPE_hge:
-		if (ci->tpe == cand_dense)
-			cnt = densescan_hge(scanargs);
-		else
-			cnt = fullscan_hge(scanargs);
-		break;
-#endif
-	case TYPE_str:
-		cnt = fullscan_str(scanargs);
-		break;
-	default:
-		cnt = fullscan_any(scanargs);
-		break;
-	}
-	if (cnt == BUN_NONE) {
-		return NULL;
+	if (zmh) {
+		struct canditer zci = *ci;
+		const oid hseq = bi->b->hseqbase;
+		BUN pos = ci->seq - hseq, end = pos + ci->ncand, zlo, zhi;
+		BUN nscan = 0;
+
+		while (ZMnextrun(zmh, zmcov, zmoff, lval ? tl : NULL, hval ? th : NULL,
+				 &pos, end, &zlo, &zhi)) {
+			zci.seq = hseq + zlo;
+			zci.ncand = zhi - zlo;
+			zci.next = 0;
+			nscan += zci.ncand;
+			cnt = scandispatch(bi, &zci, bn, tl, th, li, hi, equi,
+					   anti, nil_matches, lval, hval, lnil,
+					   cnt, dst, maximum, algo);
+			if (cnt == BUN_NONE)
+				return NULL;
+			dst = (oid *) Tloc(bn, 0);
+		}
+		*algo = nscan == ci->ncand ? "select: zonemap, no blocks skipped" : "select: zonemap";
+		TRC_DEBUG(ALGO, "zonemap scanned " BUNFMT " of " BUNFMT
+			  " candidates\n", nscan, ci->ncand);
+	} else {
+		cnt = scandispatch(bi, ci, bn, tl, th, li, hi, equi, anti,
+				   nil_matches, lval, hval, lnil, cnt, dst,
+				   maximum, algo);
+		if (cnt == BUN_NONE)
+			return NULL;
 	}
 	assert(bn->batCapacity >= cnt);
 
@@ -1659,7 +1746,7 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 	 * large; check for existence of hash last since that may
 	 * involve I/O */
 	if ((equi || antiequi) && !bi.sorted && !bi.revsorted) {
-		double cost = joincost(b, 1, &ci, &havehash, &phash, NULL);
+		double cost = joincost(b, 1, &ci, &havehash, &phash, NULL, NULL);
 		if (cost > 0 && cost < ci.ncand) {
 			wanthash = true;
 			if (havehash) {
@@ -2062,10 +2149,24 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 			}
 		}
 	} else {
+		Heap *zmh = NULL;
+		BUN zmoff = 0, zmcov = 0;
+
 		assert(!havehash);
+		/* if b or its parent has a zone map, we can skip blocks
+		 * that can't contain any qualifying values */
+		if (!anti && !(equi && lnil) && ci.tpe == cand_dense) {
+			if (pb == NULL)
+				zmh = ZMget(b, &zmcov);
+			else if (ATOMbasetype(pbi.type) == ATOMbasetype(bi.type) &&
+				 (zmh = ZMget(pb, &zmcov)) != NULL)
+				zmoff = bi.baseoff - pbi.baseoff;
+		}
 		bn = scanselect(&bi, &ci, bn, tl, th, li, hi, equi, anti,
 				nil_matches, lval, hval, lnil, maximum,
-				&algo);
+				zmh, zmcov, zmoff, &algo);
+		if (zmh)
+			HEAPdecref(zmh, false);
 	}
 	bat_iterator_end(&bi);
 	bat_iterator_end(&pbi);
@@ -767,6 +767,8 @@ BATsave_iter(BAT *b, BATiter *bi, BUN size)
 		MT_lock_unset(&b->theaplock);
 		if (locked &&  b->thash && b->thash != (Hash *) 1)
 			BAThashsave(b, dosync);
+		ZMsave(b, dosync);
+		STRMPsave(b);
 	}
 	if (locked)
 		MT_rwlock_rdunlock(&b->thashlock);
@@ -835,6 +837,7 @@ BATload_intern(bat bid, bool lock)
 		}
 		if (ATOMstorage(b->ttype) == TYPE_str) {
 			strCleanHash(b->tvheap, false);	/* ensure consistency */
+			strDictBuild(b->tvheap);
 		} else {
 			HEAP_recover(b->tvheap, (const var_t *) Tloc(b, 0),
 				     BATcount(b));
@@ -872,6 +875,7 @@ BATdelete(BAT *b)
 	PROPdestroy_nolock(b);
 	STRMPdestroy(b);
 	RTREEdestroy(b);
+	ZMdestroy(b);
 	if (b->theap) {
 		HEAPfree(b->theap, true);
 	}
@@ -669,7 +669,6 @@ BATstrimpsync(BAT *b)
 				  BATgetId(b), GDKusec() - t0, failed);
 		}
 	}
-	BBPunfix(b->batCacheid);
 }
 
 /* Perform some checks to see if it makes sense to persist the strimp
@@ -682,7 +681,6 @@ persistStrimp(BAT *b)
 	   && b->batInserted == b->batCount
 	   && !b->theap->dirty
 	   && !GDKinmemory(b->theap->farmid)) {
-		BBPfix(b->batCacheid);
 		char name[MT_NAME_LEN];
 		snprintf(name, sizeof(name), "strimpsync%d", b->batCacheid);
 		BATstrimpsync(b);
@@ -693,11 +691,14 @@ persistStrimp(BAT *b)
 
 /* This function calls all the necessary routines to create the strimp
  * header, allocates enough space for the heap and encodes the header.
+ * The header is built from the strings of v, which is b itself, or
+ * a string BAT with the values of b if b stores them in some other
+ * form (see STRMPcreatefrom).
  * It returns NULL if anything fails.
  *
  */
 static Strimps *
-STRMPcreateStrimpHeap(BAT *b, BAT *s)
+STRMPcreateStrimpHeap(BAT *b, BAT *v, BAT *s)
 {
 	uint8_t *h1, *h2;
 	Strimps *r = NULL;
@@ -715,7 +716,7 @@ STRMPcreateStrimpHeap(BAT *b, BAT *s)
 	}
 
 	if ((r = b->tstrimps) == NULL &&
-		STRMPbuildHeader(b, s, hpairs)) { /* Find the header pairs, put
+		STRMPbuildHeader(v, s, hpairs)) { /* Find the header pairs, put
 						 the result in hpairs */
 		/* The 64th bit in the bit string is used to indicate if
 		   the string is NULL. So the corresponding pair does
@@ -841,13 +842,15 @@ BATsetstrimps(BAT *b)
 /* This macro takes a bat and checks if the strimp construction has been
  * completed. It is completed when it is an actual pointer and the
  * number of bitstrings computed is the same as the number of elements
- * in the BAT.
+ * in the BAT.  A strimp that b uses on behalf of another BAT (see
+ * STRMPshare) is always complete.
  */
 #define STRIMP_COMPLETE(b)						\
 	((b)->tstrimps != NULL &&					\
 	 (b)->tstrimps != (Strimps *)1 &&				\
 	 (b)->tstrimps != (Strimps *)2 &&				\
-	 (((b)->tstrimps->strimps.free - ((char *)(b)->tstrimps->bitstrings_base - (b)->tstrimps->strimps.base)) == (b)->batCount*sizeof(uint64_t)))
+	 ((b)->tstrimps->strimps.parentid != (b)->batCacheid ||		\
+	  ((b)->tstrimps->strimps.free - ((char *)(b)->tstrimps->bitstrings_base - (b)->tstrimps->strimps.base)) == (b)->batCount*sizeof(uint64_t)))
 
 
 /* Strimp creation.
@@ -926,7 +929,7 @@ STRMPcreate(BAT *b, BAT *s)
 
 			assert(pb->tstrimps == NULL);
 
-			if ((r = STRMPcreateStrimpHeap(pb, s)) == NULL) {
+			if ((r = STRMPcreateStrimpHeap(pb, pb, s)) == NULL) {
 				/* Strimp creation failed, but it still
 				 * exists in the SQL layer. Set the
 				 * pointer to 2 so that construction
@@ -990,6 +993,106 @@ STRMPcreate(BAT *b, BAT *s)
 	return GDK_SUCCEED;
 }
 
+/* Strimps for BATs that hold strings in some other form, e.g. the
+ * FSST compressed columns of the SQL layer.
+ *
+ * The strimp of such a BAT b is requested with BATsetstrimps as usual.
+ * It is created by STRMPcreatefrom from a string BAT v with all the
+ * decoded values of b, and the decoded values of (a slice of) b can use
+ * it after STRMPshare.  Since the caller has to decode all of b to
+ * create the strimp, it is created at once and not per slice, and if
+ * that fails the request is dropped instead of retried.
+ */
+gdk_return
+STRMPcreatefrom(BAT *b, BAT *v)
+{
+	lng t0 = 0;
+	Strimps *r;
+	uint64_t *dh;
+
+	TRC_DEBUG_IF(ACCELERATOR) t0 = GDKusec();
+	if (ATOMstorage(v->ttype) != TYPE_str) {
+		GDKerror("Cannot create strimps index for non string bats\n");
+		return GDK_FAIL;
+	}
+	if (v->hseqbase != b->hseqbase || BATcount(v) != BATcount(b)) {
+		GDKerror("Values do not match the rows of the bat\n");
+		return GDK_FAIL;
+	}
+
+	MT_lock_set(&b->batIdxLock);
+	if (b->tstrimps == NULL || BATcheckstrimps(b)) {
+		/* not requested, or already there (possibly read from
+		 * disk) */
+		MT_lock_unset(&b->batIdxLock);
+		return GDK_SUCCEED;
+	}
+	b->tstrimps = NULL;
+	if ((r = STRMPcreateStrimpHeap(b, v, NULL)) == NULL) {
+		MT_lock_unset(&b->batIdxLock);
+		return GDK_FAIL;
+	}
+	MT_thread_setalgorithm("create strimp index");
+	BATiter vi = bat_iterator(v);
+	dh = (uint64_t *) r->bitstrings_base + b->hseqbase;
+	for (BUN i = 0; i < vi.count; i++) {
+		const char *cs = BUNtvar(&vi, i);
+		if (!strNil(cs))
+			*dh++ = STRMPmakebitstring(cs, r);
+		else
+			*dh++ = (uint64_t)0x1 << (STRIMP_HEADER_SIZE - 1); /* Encode NULL strings in the most significant bit */
+	}
+	bat_iterator_end(&vi);
+	r->strimps.free += b->batCount * sizeof(uint64_t);
+	b->tstrimps = r;
+	persistStrimp(b);
+	MT_lock_unset(&b->batIdxLock);
+
+	TRC_DEBUG(ACCELERATOR, "strimp creation took " LLFMT " usec\n", GDKusec()-t0);
+	return GDK_SUCCEED;
+}
+
+/* Let the string BAT v, which holds the decoded values of the rows of
+ * b starting at v->hseqbase, use the strimp of b.  Returns false if b
+ * has no complete strimp (yet). */
+bool
+STRMPshare(BAT *v, BAT *b)
+{
+	bool ret;
+
+	if (v->hseqbase < b->hseqbase ||
+	    v->hseqbase + BATcount(v) > b->hseqbase + BATcount(b))
+		return false;
+	MT_lock_set(&b->batIdxLock);
+	if ((ret = BATcheckstrimps(b) && STRIMP_COMPLETE(b))) {
+		STRMPincref(b->tstrimps);
+		MT_lock_set(&v->batIdxLock);
+		assert(v->tstrimps == NULL);
+		v->tstrimps = b->tstrimps;
+		MT_lock_unset(&v->batIdxLock);
+	}
+	MT_lock_unset(&b->batIdxLock);
+	return ret;
+}
+
+/* Write the strimp of b if that did not happen when it was created,
+ * because b itself was not saved yet; called when b is saved (see
+ * BATsave_iter). */
+void
+STRMPsave(BAT *b)
+{
+	Strimps *r;
+
+	if (GDKinmemory(b->theap->farmid))
+		return;
+	MT_lock_set(&b->batIdxLock);
+	if ((r = b->tstrimps) != NULL && r != (Strimps *)1 && r != (Strimps *)2 &&
+	    r->strimps.parentid == b->batCacheid &&
+	    (((uint64_t *) r->strimps.base)[0] & ((uint64_t) 1 << 32)) == 0 &&
+	    STRIMP_COMPLETE(b))
+		BATstrimpsync(b);
+	MT_lock_unset(&b->batIdxLock);
+}
 
 void
 STRMPdecref(Strimps *strimps, bool remove)
@@ -39,6 +39,19 @@
  * string heap, and allocating space for collision lists in the first
  * 64KiB of the string heap.  After the first 64KiB no extra space is
  * allocated for lists, so hash collisions cannot be resolved.
+ *
+ * When a fully duplicate eliminated string heap grows beyond 64KiB, an
+ * in-memory dictionary of all its strings is created (Heap.strdict)
+ * which is used instead of the hash table to keep the heap free of
+ * duplicates.  The dictionary is dropped for good once the heap
+ * contains more than GDK_STRDICTLIMIT strings.  Only the thread that
+ * is allowed to add strings to the heap changes the dictionary, and it
+ * does so while holding strdictlock.  That thread may look at the
+ * dictionary without the lock, all other threads may only use it
+ * through strLocate (which takes the lock) or check whether it exists
+ * (see GDK_STRUNIQUE).  The latter is merely a hint: the dictionary
+ * can be dropped at any time, but a heap never again becomes free of
+ * duplicates once it has lost its dictionary.
  */
 
 /* some of these macros are duplicates from gdk_atoms.c */
@@ -169,11 +182,164 @@ countStrings(const Heap *h)
 	return n;
 }
 
+static MT_Lock strdictlock = MT_LOCK_INITIALIZER(strdictlock);
+
+struct Strdict {
+	size_t mask;		/* number of slots minus one */
+	size_t count;		/* number of strings in the dictionary */
+	var_t offsets[];	/* string offsets, 0 for an empty slot */
+};
+
+static struct Strdict *
+strDictNew(size_t nslots)
+{
+	struct Strdict *d;
+
+	assert((nslots & (nslots - 1)) == 0);
+	d = GDKzalloc(offsetof(struct Strdict, offsets) + nslots * sizeof(var_t));
+	if (d == NULL) {
+		GDKclrerr();
+		return NULL;
+	}
+	d->mask = nslots - 1;
+	return d;
+}
+
+void
+strDictDestroy(Heap *h)
+{
+	struct Strdict *d;
+
+	MT_lock_set(&strdictlock);
+	d = h->strdict;
+	h->strdict = NULL;
+	MT_lock_unset(&strdictlock);
+	GDKfree(d);
+}
+
+/* return the offset of string v with hash value hsh in the dictionary
+ * of heap h, or 0 if it isn't there */
+static var_t
+strDictLocate(const Heap *h, const char *v, BUN hsh)
+{
+	const struct Strdict *d = h->strdict;
+
+	for (size_t i = hsh & d->mask; d->offsets[i] != 0; i = (i + 1) & d->mask) {
+		if (strcmp(v, h->base + d->offsets[i]) == 0)
+			return d->offsets[i];
+	}
+	return 0;
+}
+
+/* add the (new) string at offset pos with hash value hsh to the
+ * dictionary of heap h; if the dictionary would become too large or
+ * cannot be grown, it is dropped */
+static void
+strDictInsert(Heap *h, var_t pos, BUN hsh)
+{
+	struct Strdict *d = h->strdict, *o = NULL;
+	size_t i;
+
+	if (d->count >= GDK_STRDICTLIMIT) {
+		strDictDestroy(h);
+		return;
+	}
+	if (2 * (d->count + 1) > d->mask + 1) {
+		/* keep the table at most half full */
+		struct Strdict *n = strDictNew(2 * (d->mask + 1));
+		if (n == NULL) {
+			strDictDestroy(h);
+			return;
+		}
+		for (size_t j = 0; j <= d->mask; j++) {
+			if (d->offsets[j] == 0)
+				continue;
+			for (i = strHash(h->base + d->offsets[j]) & n->mask;
+			     n->offsets[i] != 0;
+			     i = (i + 1) & n->mask)
+				;
+			n->offsets[i] = d->offsets[j];
+		}
+		n->count = d->count;
+		o = d;
+		d = n;
+	}
+	MT_lock_set(&strdictlock);
+	for (i = hsh & d->mask; d->offsets[i] != 0; i = (i + 1) & d->mask)
+		;
+	d->offsets[i] = pos;
+	d->count++;
+	h->strdict = d;
+	MT_lock_unset(&strdictlock);
+	GDKfree(o);
+}
+
+/* (re)build the dictionary of string heap h: this only results in a
+ * dictionary if the heap is larger than the fully duplicate eliminated
+ * area, and all (not too many) strings in the heap are distinct */
+void
+strDictBuild(Heap *h)
+{
+	size_t pos = GDK_STRHASHSIZE;
+	size_t pad;
+	const char *s;
+	BUN hsh;
+
+	struct Strdict *d;
+
+	strDictDestroy(h);
+	if (GDK_ELIMDOUBLES(h) || (d = strDictNew(1 << 13)) == NULL)
+		return;
+	MT_lock_set(&strdictlock);
+	h->strdict = d;
+	MT_lock_unset(&strdictlock);
+	while (pos < h->free) {
+		pad = GDK_VARALIGN - (pos & (GDK_VARALIGN - 1));
+		if (pos + pad < GDK_ELIMLIMIT) {
+			if (pad < sizeof(stridx_t))
+				pad += GDK_VARALIGN;
+		} else if (pos >= GDK_ELIMLIMIT)
+			pad = 0;
+		pos += pad;
+		s = h->base + pos;
+		hsh = strHash(s);
+		if (strDictLocate(h, s, hsh) != 0) {
+			/* duplicate */
+			strDictDestroy(h);
+			return;
+		}
+		strDictInsert(h, (var_t) pos, hsh);
+		if (h->strdict == NULL)
+			return;
+		pos += strlen(s) + 1;
+	}
+}
+
+/* return a copy of the dictionary of heap h, or NULL if it has none
+ * (or we ran out of memory) */
+struct Strdict *
+strDictCopy(Heap *h)
+{
+	struct Strdict *n = NULL;
+
+	MT_lock_set(&strdictlock);
+	const struct Strdict *d = h->strdict;
+	if (d) {
+		size_t size = offsetof(struct Strdict, offsets) + (d->mask + 1) * sizeof(var_t);
+		if ((n = GDKmalloc(size)) == NULL)
+			GDKclrerr();
+		else
+			memcpy(n, d, size);
+	}
+	MT_lock_unset(&strdictlock);
+	return n;
+}
 
 /*
  * The strPut routine. The routine strLocate can be used to identify
  * the location of a string in the heap if it exists. Otherwise it
- * returns (var_t) -2 (-1 is reserved for error).
+ * returns (var_t) -2.  If the heap is not (or no longer) free of
+ * duplicates, strLocate cannot tell and returns (var_t) -1.
  */
 var_t
 strLocate(Heap *h, const char *v)
@@ -181,17 +347,29 @@ strLocate(Heap *h, const char *v)
 	stridx_t *ref, *next;
 
 	/* search hash-table, if double-elimination is still in place */
-	BUN off;
+	BUN off, hsh;
 	if (h->free == 0) {
 		/* empty, so there are no strings */
 		return (var_t) -2;
 	}
 
-	off = strHash(v);
-	off &= GDK_STRHASHMASK;
+	hsh = strHash(v);
+	off = hsh & GDK_STRHASHMASK;
 
-	/* should only use strLocate iff fully double eliminated */
-	assert(GDK_ELIMBASE(h->free) == 0);
+	if (GDK_ELIMBASE(h->free) != 0) {
+		/* the collision lists don't cover the whole heap, so
+		 * only the dictionary can tell */
+		var_t pos = (var_t) -1;
+
+		MT_lock_set(&strdictlock);
+		if (h->strdict) {
+			pos = strDictLocate(h, v, hsh);
+			if (pos == 0)
+				pos = (var_t) -2;
+		}
+		MT_lock_unset(&strdictlock);
+		return pos;
+	}
 
 	/* search the linked list */
 	for (ref = ((stridx_t *) h->base) + off; *ref; ref = next) {
@@ -210,7 +388,8 @@ strPut(BAT *b, var_t *dst, const void *V)
 	size_t pad;
 	size_t pos, len = strlen(v) + 1;
 	stridx_t *bucket;
-	BUN off;
+	BUN off, hsh;
+	bool elim;
 
 	if (h->free == 0) {
 		if (h->size < GDK_STRHASHTABLE * sizeof(stridx_t) + BATTINY * GDK_VARALIGN) {
@@ -230,11 +409,16 @@ strPut(BAT *b, var_t *dst, const void *V)
 		b->tascii = true;
 	}
 
-	off = strHash(v);
-	off &= GDK_STRHASHMASK;
+	hsh = strHash(v);
+	off = hsh & GDK_STRHASHMASK;
 	bucket = ((stridx_t *) h->base) + off;
 
-	if (*bucket) {
+	if (h->strdict) {
+		/* large string heap that is still free of duplicates:
+		 * search the dictionary */
+		if ((pos = strDictLocate(h, v, hsh)) != 0)
+			return *dst = (var_t) pos;
+	} else if (*bucket) {
 		assert(*bucket < h->free);
 		/* the hash list is not empty */
 		if (*bucket < GDK_ELIMLIMIT) {
@@ -317,6 +501,7 @@ strPut(BAT *b, var_t *dst, const void *V)
 	}
 
 	/* insert string */
+	elim = GDK_ELIMDOUBLES(h);
 	pos = h->free + pad;
 	*dst = (var_t) pos;
 	if (pad > 0)
@@ -334,6 +519,13 @@ strPut(BAT *b, var_t *dst, const void *V)
 	*bucket = (stridx_t) pos;	/* set bucket to the new string */
 	h->dirty = true;
 
+	if (h->strdict)
+		strDictInsert(h, (var_t) pos, hsh);
+	else if (elim && !GDK_ELIMDOUBLES(h))
+		/* the heap just outgrew the fully duplicate
+		 * eliminated area, continue with a dictionary */
+		strDictBuild(h);
+
 	if (b->tascii && !strNil(v)) {
 		for (const uint8_t *p = (const uint8_t *) v; *p; p++) {
 			if (*p >= 128) {
@@ -213,6 +213,7 @@ struct mtthread {
 	bool detached:1, waiting:1;
 	unsigned int refs:20;
 	bool limit_override;	/* not in bit field because of data races */
+	bool spill;		/* operators should spill to disk */
 	char threadname[MT_NAME_LEN];
 	QryCtx *qry_ctx;
 #ifdef HAVE_PTHREAD_H
@@ -768,6 +769,27 @@ MT_thread_override_limits(void)
 	return self && self->limit_override;
 }
 
+void
+MT_thread_setspill(bool spill)
+{
+	if (!thread_initialized)
+		return;
+	struct mtthread *self = thread_self();
+
+	if (self)
+		self->spill = spill;
+}
+
+bool
+MT_thread_getspill(void)
+{
+	if (!thread_initialized)
+		return false;
+	struct mtthread *self = thread_self();
+
+	return self && self->spill;
+}
+
 static struct thread_init_cb {
 	struct thread_init_cb *next;
 	void (*init)(void *);
@@ -774,6 +774,8 @@ gdk_export void MT_thread_setsemawait(MT_Sema *sema);
 gdk_export void MT_thread_setworking(const char *work);
 gdk_export void MT_thread_setalgorithm(const char *algo);
 gdk_export const char *MT_thread_getalgorithm(void);
+gdk_export void MT_thread_setspill(bool spill);
+gdk_export bool MT_thread_getspill(void);
 #ifdef LOCK_OWNER
 #define hide_exp(a,b) a ## b	/* hide export from exports test */
 hide_exp(gdk_ex,port) void MT_thread_add_mylock(MT_Lock *lock);
@@ -107,7 +107,7 @@ BATunique(BAT *b, BAT *s)
 	if (ATOMbasetype(bi.type) == TYPE_bte ||
 	    (bi.width == 1 &&
 	     ATOMstorage(bi.type) == TYPE_str &&
-	     GDK_ELIMDOUBLES(bi.vh))) {
+	     GDK_STRUNIQUE(bi.vh))) {
 		uint8_t val;
 
 		algomsg = "unique: byte-sized atoms";
@@ -133,7 +133,7 @@ BATunique(BAT *b, BAT *s)
 	} else if (ATOMbasetype(bi.type) == TYPE_sht ||
 		   (bi.width == 2 &&
 		    ATOMstorage(bi.type) == TYPE_str &&
-		    GDK_ELIMDOUBLES(bi.vh))) {
+		    GDK_STRUNIQUE(bi.vh))) {
 		uint16_t val;
 
 		algomsg = "unique: short-sized atoms";
@@ -445,6 +445,10 @@ size_t GDK_mmap_minsize_transient = MMAP_MINSIZE_TRANSIENT;
 size_t GDK_mmap_pagesize = MMAP_PAGESIZE; /* mmap granularity */
 size_t GDK_mem_maxsize = GDK_VM_MAXSIZE;
 size_t GDK_vm_maxsize = GDK_VM_MAXSIZE;
+/* cache sizes, used to size partitions of cache-conscious algorithms;
+ * the defaults are used if we can't find out the real values */
+size_t GDK_l2_cachesize = (size_t) 256 << 10;
+size_t GDK_llc_cachesize = (size_t) 8 << 20;
 
 #define SEG_SIZE(x)	(((x) + _MT_pagesize - 1) & ~(_MT_pagesize - 1))
 
@@ -805,6 +809,107 @@ MT_init(void)
 		GDK_vm_maxsize = l.rlim_cur;
 	}
 #endif
+
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL2_CACHE_SIZE)
+	{
+		long sz;
+		if ((sz = sysconf(_SC_LEVEL2_CACHE_SIZE)) > 0)
+			GDK_l2_cachesize = (size_t) sz;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+		if ((sz = sysconf(_SC_LEVEL3_CACHE_SIZE)) > 0)
+			GDK_llc_cachesize = (size_t) sz;
+		else
+#endif
+		if (GDK_l2_cachesize > GDK_llc_cachesize)
+			GDK_llc_cachesize = GDK_l2_cachesize;
+	}
+#endif
+}
+
+/*
+ * @+ Parallel execution
+ * Some of the GDK operators can split their work into independent
+ * pieces that are executed by a number of threads.  GDKparallel
+ * starts the threads, one for each element of the args array (the
+ * calling thread takes care of the first element), and waits for all
+ * of them to finish.  The query context of the caller is passed on so
+ * that the workers can check for timeouts.  If a thread cannot be
+ * started, its work is done by the calling thread.  The worker
+ * function cannot report errors through GDKerror, so the args
+ * structure should contain a field for that.
+ */
+struct parallel_start {
+	void (*func)(void *);
+	void *arg;
+	QryCtx *qry_ctx;
+	MT_Id tid;
+};
+
+static void
+GDKparallel_start(void *arg)
+{
+	struct parallel_start *ps = arg;
+
+	MT_thread_set_qry_ctx(ps->qry_ctx);
+	(*ps->func)(ps->arg);
+	MT_thread_set_qry_ctx(NULL);
+}
+
+void
+GDKparallel(void (*func)(void *), void *args, size_t argsize, int nargs,
+	    const char *name)
+{
+	struct parallel_start *ps;
+	QryCtx *qry_ctx = MT_thread_get_qry_ctx();
+
+	if (nargs <= 1 || (ps = GDKmalloc(nargs * sizeof(*ps))) == NULL) {
+		for (int i = 0; i < nargs; i++)
+			(*func)((char *) args + i * argsize);
+		return;
+	}
+	for (int i = 1; i < nargs; i++) {
+		ps[i] = (struct parallel_start) {
+			.func = func,
+			.arg = (char *) args + i * argsize,
+			.qry_ctx = qry_ctx,
+		};
+		if (MT_create_thread(&ps[i].tid, GDKparallel_start, &ps[i],
+				     MT_THR_JOINABLE, name) < 0) {
+			/* do the work ourselves */
+			ps[i].tid = 0;
+		}
+	}
+	(*func)(args);
+	for (int i = 1; i < nargs; i++) {
+		if (ps[i].tid == 0)
+			(*func)(ps[i].arg);
+		else
+			MT_join_thread(ps[i].tid);
+	}
+	GDKfree(ps);
+}
+
+/* Whether an operator that needs size bytes of working memory (a hash
+ * table) had better partition its input and spill the partitions to
+ * disk (see radixjoin and radixgroup).  This is the case when the MAL
+ * admission control let the instruction run although its memory claim
+ * could not be met (see MALadmission_claim), or when the memory is
+ * simply not there.  This is independent of the cache size: the last
+ * level cache can be larger than the memory limit of a query, and the
+ * slices of a query split by mitosis each need little, but together
+ * too much. */
+bool
+GDKspilling(size_t size)
+{
+	if (size == 0 || GDKinmemory(1))
+		return false;
+	if (MT_thread_getspill())
+		return true;
+	if (GDKmem_cursize() + size > GDK_mem_maxsize)
+		return true;
+	QryCtx *qc = MT_thread_get_qry_ctx();
+	return qc != NULL && qc->maxmem > 0 &&
+		ATOMIC_GET(&qc->datasize) + size > qc->maxmem;
 }
 
 /*
@@ -84,6 +84,7 @@ gdk_export gdk_return GDKmunmap(void *addr, int mode, size_t len);
 
 gdk_export size_t GDKmem_cursize(void);	/* RAM/swapmem that MonetDB has claimed from OS */
 gdk_export size_t GDKvm_cursize(void);	/* current MonetDB VM address space usage */
+gdk_export size_t GDKspill_count(void);	/* heaps spilled to disk by operators short of memory */
 
 gdk_export void GDKfree(void *blk);
 gdk_export void *GDKmalloc(size_t size)
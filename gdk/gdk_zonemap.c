@@ -0,0 +1,441 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * Zone maps
+ *
+ * A zone map records the minimum and maximum (non-nil) value for each
+ * block of ZONEMAP_BLOCK consecutive values of a persistent numeric
+ * column.  A range select can skip all blocks whose min..max range
+ * does not overlap the range searched for.  This pays off for columns
+ * where the values are correlated with the insertion order, such as
+ * timestamps in append-only event tables, where a selection on a time
+ * range only needs to look at a few blocks.
+ *
+ * The zone map only covers whole blocks of values that have been
+ * committed to disk (i.e. below batInserted).  Those values cannot
+ * change without the zone map being destroyed, so appending to the
+ * column leaves the zone map valid: it simply covers a prefix of the
+ * column and the zone map is extended with new blocks when it is used
+ * again.  The new blocks are appended in place if the heap has room,
+ * and the zone map is written to disk when the column is saved.  Any
+ * other modification destroys it.
+ *
+ * The heap consists of a header of ZONEMAPOFF oids (version, number of
+ * values covered, block size, storage type) followed by a (min, max)
+ * pair per block.  For a block consisting of only nils, both are nil.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define ZONEMAP_VERSION		((oid) 1)
+/* don't bother creating a zone map for fewer than this many blocks */
+#define ZONEMAP_MINBLOCKS	16
+
+/* types for which we maintain zone maps */
+static bool
+ZMtype(int tpe)
+{
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Persist the zone map of b if it changed since it was last saved;
+ * called when b itself is saved (see BATsave_iter), so that the zone
+ * map is written by the normal BAT sync and checkpoint. */
+void
+ZMsave(BAT *b, bool dosync)
+{
+	Heap *hp;
+	int fd;
+	lng t0  = GDKusec();
+	const char *failed = " failed";
+
+	if (GDKinmemory(b->theap->farmid))
+		return;
+	MT_lock_set(&b->batIdxLock);
+	if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1 && hp->dirty) {
+		if (HEAPsave(hp, hp->filename, NULL, dosync, hp->free, NULL) == GDK_SUCCEED) {
+			hp->hasfile = true;
+			if (hp->storage == STORE_MEM) {
+				if ((fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) >= 0) {
+					((oid *) hp->base)[0] |= (oid) 1 << 24;
+					if (write(fd, hp->base, SIZEOF_OID) >= 0) {
+						failed = ""; /* not failed */
+						if (dosync && !(ATOMIC_GET(&GDKdebug) & NOSYNCMASK)) {
+#if defined(NATIVE_WIN32)
+							_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+							fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+							fsync(fd);
+#endif
+						}
+					} else {
+						hp->dirty = true;
+						perror("write zonemap");
+					}
+					close(fd);
+				}
+			} else {
+				((oid *) hp->base)[0] |= (oid) 1 << 24;
+				if (dosync && !(ATOMIC_GET(&GDKdebug) & NOSYNCMASK) &&
+				    MT_msync(hp->base, SIZEOF_OID) < 0) {
+					hp->dirty = true;
+					failed = " sync failed";
+					((oid *) hp->base)[0] &= ~((oid) 1 << 24);
+				} else {
+					failed = ""; /* not failed */
+				}
+			}
+			TRC_DEBUG(ACCELERATOR, "ZMsave(%s): zonemap persisted"
+				  " (" LLFMT " usec)%s\n",
+				  BATgetId(b), GDKusec() - t0, failed);
+		}
+		GDKclrerr();
+	}
+	MT_lock_unset(&b->batIdxLock);
+}
+
+/* load a persisted zone map if there is one; called with batIdxLock
+ * held */
+static void
+ZMload(BAT *b)
+{
+	Heap *hp;
+	const char *nme = BBP_physical(b->batCacheid);
+	int fd;
+
+	assert(b->tzonemap == (Heap *) 1);
+	assert(!GDKinmemory(b->theap->farmid));
+	b->tzonemap = NULL;
+	if ((hp = GDKzalloc(sizeof(*hp))) != NULL &&
+	    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap)) >= 0) {
+		strtconcat(hp->filename, sizeof(hp->filename),
+			   nme, ".tzonemap", NULL);
+		hp->storage = hp->newstorage = STORE_INVALID;
+
+		/* check whether a persisted zone map can be found */
+		if ((fd = GDKfdlocate(hp->farmid, nme, "rb+", "tzonemap")) >= 0) {
+			struct stat st;
+			oid hdata[ZONEMAPOFF];
+
+			if (read(fd, hdata, sizeof(hdata)) == sizeof(hdata) &&
+			    hdata[0] == (((oid) 1 << 24) | ZONEMAP_VERSION) &&
+			    hdata[1] <= (oid) b->batInserted &&
+			    hdata[1] % ZONEMAP_BLOCK == 0 &&
+			    hdata[2] == ZONEMAP_BLOCK &&
+			    hdata[3] == (oid) ATOMbasetype(b->ttype) &&
+			    fstat(fd, &st) == 0 &&
+			    st.st_size >= (off_t) (hp->size = hp->free = ZONEMAPOFF * SIZEOF_OID + hdata[1] / ZONEMAP_BLOCK * 2 * b->twidth) &&
+			    HEAPload(hp, nme, "tzonemap", false) == GDK_SUCCEED) {
+				close(fd);
+				ATOMIC_INIT(&hp->refs, 1);
+				hp->hasfile = true;
+				b->tzonemap = hp;
+				TRC_DEBUG(ACCELERATOR, "ZMload(" ALGOBATFMT "): reusing persisted zonemap\n", ALGOBATPAR(b));
+				return;
+			}
+			close(fd);
+			/* unlink unusable file */
+			GDKunlink(hp->farmid, BATDIR, nme, "tzonemap");
+		}
+	}
+	GDKfree(hp);
+	GDKclrerr();	/* we're not currently interested in errors */
+}
+
+#define ZM_BUILD(TYPE)							\
+	do {								\
+		const TYPE *restrict src = (const TYPE *) bi.base;	\
+		TYPE *restrict zm = (TYPE *) ((oid *) hp->base + ZONEMAPOFF); \
+		for (BUN blk = from; blk < nblk; blk++) {		\
+			TYPE mn = TYPE##_nil, mx = TYPE##_nil;		\
+			BUN i = blk * ZONEMAP_BLOCK;			\
+			BUN e = i + ZONEMAP_BLOCK;			\
+			for (; i < e; i++) {				\
+				if (!is_##TYPE##_nil(src[i])) {		\
+					mn = mx = src[i];		\
+					break;				\
+				}					\
+			}						\
+			for (; i < e; i++) {				\
+				if (!is_##TYPE##_nil(src[i])) {		\
+					if (src[i] < mn)		\
+						mn = src[i];		\
+					else if (src[i] > mx)		\
+						mx = src[i];		\
+				}					\
+			}						\
+			zm[2 * blk] = mn;				\
+			zm[2 * blk + 1] = mx;				\
+		}							\
+	} while (0)
+
+/* Return the zone map of b with an extra reference, creating it or
+ * extending it over newly committed blocks first if b qualifies, and
+ * set *ncovp to the number of blocks it covers.  Return NULL if there
+ * is no zone map (this is not an error). */
+Heap *
+ZMget(BAT *b, BUN *ncovp)
+{
+	Heap *hp, *ohp;
+	BUN nblk, from = 0;
+	lng t0 = GDKusec();
+
+	if (!ZMtype(b->ttype) ||
+	    b->batRole != PERSISTENT ||
+	    GDKinmemory(b->theap->farmid) ||
+	    VIEWtparent(b) != 0)
+		return NULL;
+
+	MT_lock_set(&b->batIdxLock);
+	if (b->tzonemap == (Heap *) 1)
+		ZMload(b);
+	MT_lock_set(&b->theaplock);
+	nblk = b->batInserted / ZONEMAP_BLOCK;
+	BUN cap = BATcapacity(b) / ZONEMAP_BLOCK;
+	MT_lock_unset(&b->theaplock);
+	ohp = b->tzonemap;
+	if (ohp != NULL)
+		from = (BUN) ((const oid *) ohp->base)[1] / ZONEMAP_BLOCK;
+	else if (nblk < ZONEMAP_MINBLOCKS) {
+		MT_lock_unset(&b->batIdxLock);
+		return NULL;
+	}
+	if (from >= nblk) {
+		/* nothing new to cover */
+		if (ohp) {
+			HEAPincref(ohp);
+			*ncovp = from;
+		}
+		MT_lock_unset(&b->batIdxLock);
+		return ohp;
+	}
+
+	size_t size = ZONEMAPOFF * SIZEOF_OID + nblk * 2 * b->twidth;
+	if (ohp && ohp->size >= size) {
+		/* there is room for the new blocks: append them in
+		 * place; the blocks others are using don't change,
+		 * and they don't look beyond the blocks covered when
+		 * they got the zone map */
+		hp = ohp;
+	} else {
+		/* create a new heap with room for the blocks of the
+		 * capacity of b, so that appends usually fit */
+		if (cap < nblk)
+			cap = nblk;
+		if ((hp = GDKmalloc(sizeof(Heap))) == NULL) {
+			MT_lock_unset(&b->batIdxLock);
+			GDKclrerr();
+			return NULL;
+		}
+		*hp = (Heap) {
+			.farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap),
+			.parentid = b->batCacheid,
+			.refs = ATOMIC_VAR_INIT(1),
+		};
+		strtconcat(hp->filename, sizeof(hp->filename),
+			   BBP_physical(b->batCacheid), ".tzonemap", NULL);
+		if (hp->farmid < 0 ||
+		    HEAPalloc(hp, ZONEMAPOFF * SIZEOF_OID + cap * 2 * b->twidth, 1) != GDK_SUCCEED) {
+			GDKfree(hp);
+			MT_lock_unset(&b->batIdxLock);
+			GDKclrerr();
+			return NULL;
+		}
+		if (ohp)
+			memcpy(hp->base, ohp->base, ohp->free);
+		((oid *) hp->base)[2] = (oid) ZONEMAP_BLOCK;
+		((oid *) hp->base)[3] = (oid) ATOMbasetype(b->ttype);
+	}
+
+	BATiter bi = bat_iterator(b);
+	assert(bi.count >= nblk * ZONEMAP_BLOCK);
+	switch (ATOMbasetype(bi.type)) {
+	case TYPE_bte:
+		ZM_BUILD(bte);
+		break;
+	case TYPE_sht:
+		ZM_BUILD(sht);
+		break;
+	case TYPE_int:
+		ZM_BUILD(int);
+		break;
+	case TYPE_lng:
+		ZM_BUILD(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ZM_BUILD(hge);
+		break;
+#endif
+	case TYPE_flt:
+		ZM_BUILD(flt);
+		break;
+	case TYPE_dbl:
+		ZM_BUILD(dbl);
+		break;
+	default:
+		MT_UNREACHABLE();
+	}
+	bat_iterator_end(&bi);
+
+	/* the zone map is persisted again when b is saved (see
+	 * ZMsave), until then the file on disk, if any, is not
+	 * valid */
+	((oid *) hp->base)[0] = ZONEMAP_VERSION;
+	((oid *) hp->base)[1] = (oid) (nblk * ZONEMAP_BLOCK);
+	hp->free = size;
+	hp->dirty = true;
+	if (hp != ohp) {
+		b->tzonemap = hp;
+		if (ohp) {
+			hp->hasfile = ohp->hasfile;
+			HEAPdecref(ohp, false);
+		}
+	}
+	HEAPincref(hp);
+	*ncovp = nblk;
+	MT_lock_unset(&b->batIdxLock);
+	TRC_DEBUG(ACCELERATOR, "ZMget(" ALGOBATFMT "): %s zonemap with "
+		  BUNFMT " blocks (" LLFMT " usec)\n", ALGOBATPAR(b),
+		  from == 0 ? "created" : hp == ohp ? "extended in place" : "extended",
+		  nblk, GDKusec() - t0);
+	return hp;
+}
+
+#define ZM_SKIP(TYPE)							\
+	do {								\
+		const TYPE *zm = (const TYPE *) ((const oid *) hp->base + ZONEMAPOFF); \
+		return is_##TYPE##_nil(zm[2 * blk]) ||			\
+			(tl && zm[2 * blk + 1] < *(const TYPE *) tl) ||	\
+			(th && zm[2 * blk] > *(const TYPE *) th);	\
+	} while (0)
+
+/* Return true if the block can't contain any non-nil value in the
+ * (closed) range tl..th, where either bound may be NULL for an
+ * unbounded range. */
+static bool
+ZMskip(const Heap *hp, BUN blk, const void *tl, const void *th)
+{
+	switch ((int) ((const oid *) hp->base)[3]) {
+	case TYPE_bte:
+		ZM_SKIP(bte);
+	case TYPE_sht:
+		ZM_SKIP(sht);
+	case TYPE_int:
+		ZM_SKIP(int);
+	case TYPE_lng:
+		ZM_SKIP(lng);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ZM_SKIP(hge);
+#endif
+	case TYPE_flt:
+		ZM_SKIP(flt);
+	case TYPE_dbl:
+		ZM_SKIP(dbl);
+	default:
+		MT_UNREACHABLE();
+	}
+}
+
+/* Find the next run of positions at or after *pos and before end
+ * that may contain values in the range tl..th according to the first
+ * ncov blocks of the zone map hp.  Positions are relative to the start
+ * of the zone map minus off.  Positions not covered by the zone map are
+ * always part of a run.  Returns false if there are no more runs, else sets *lo and
+ * *hi to the run and advances *pos past it. */
+bool
+ZMnextrun(const Heap *hp, BUN ncov, BUN off, const void *tl, const void *th,
+	  BUN *pos, BUN end, BUN *lo, BUN *hi)
+{
+	BUN p = *pos, blk;
+
+	/* skip blocks that cannot match */
+	while (p < end &&
+	       (blk = (p + off) / ZONEMAP_BLOCK) < ncov &&
+	       ZMskip(hp, blk, tl, th))
+		p = (blk + 1) * ZONEMAP_BLOCK - off;
+	if (p >= end) {
+		*pos = end;
+		return false;
+	}
+	*lo = p;
+	/* extend the run over blocks that may match */
+	while (p < end &&
+	       ((blk = (p + off) / ZONEMAP_BLOCK) >= ncov ||
+		!ZMskip(hp, blk, tl, th))) {
+		if (blk >= ncov)
+			p = end;
+		else
+			p = (blk + 1) * ZONEMAP_BLOCK - off;
+	}
+	if (p > end)
+		p = end;
+	*hi = *pos = p;
+	return true;
+}
+
+void
+ZMfree(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&b->batIdxLock);
+		if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1) {
+			if (GDKinmemory(b->theap->farmid) || !hp->hasfile) {
+				b->tzonemap = NULL;
+				HEAPdecref(hp, true);
+			} else {
+				b->tzonemap = (Heap *) 1;
+				HEAPdecref(hp, false);
+			}
+		}
+		MT_lock_unset(&b->batIdxLock);
+	}
+}
+
+void
+ZMdestroy(BAT *b)
+{
+	if (b && b->tzonemap) {
+		Heap *hp;
+
+		MT_lock_set(&b->batIdxLock);
+		hp = b->tzonemap;
+		b->tzonemap = NULL;
+		MT_lock_unset(&b->batIdxLock);
+		if (hp == (Heap *) 1) {
+			GDKunlink(BBPselectfarm(b->batRole, b->ttype, zonemapheap),
+				  BATDIR,
+				  BBP_physical(b->batCacheid),
+				  "tzonemap");
+		} else if (hp != NULL) {
+			HEAPdecref(hp, true);
+		}
+	}
+}
@@ -256,6 +256,10 @@ MCinitClientRecord(Client c, oid user, bstream *fin, stream *fout)
 	ATOMIC_SET(&c->qryctx.datasize, 0);
 	c->qryctx.maxmem = 0;
 	c->maxmem = 0;
+	c->qrystk = NULL;
+	c->qrybudget = 0;
+	c->qryticket = 0;
+	c->qryqueued = 0;
 
 	c->prompt = PROMPT1;
 	c->promptlength = strlen(c->prompt);
@@ -361,6 +365,9 @@ MCcloseClient(Client c)
 	c->memorylimit = 0;
 	c->querytimeout = 0;
 	c->qryctx.endtime = 0;
+	c->qrystk = NULL;
+	c->qrybudget = 0;
+	c->qryticket = 0;
 	c->sessiontimeout = 0;
 	c->logical_sessiontimeout = 0;
 	c->idletimeout = 0;
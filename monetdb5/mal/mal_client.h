@@ -81,6 +81,10 @@ typedef struct CLIENT {
 	lng idletimeout;			/* idle in active transaction timeout */
 	lng querytimeout;			/* timeout per query in usec, 0 = no limit */
 	QryCtx qryctx;				/* per query limitations */
+	MalStkPtr qrystk;			/* query holding or waiting for a memory budget */
+	lng qrybudget;				/* memory budget of that query */
+	ulng qryticket;				/* place in line while waiting, 0 when admitted */
+	time_t qryqueued;			/* when the query asked for its budget */
 
 	time_t login;				/* Time when this session started */
 	lng session;				/* usec since start of server */
@@ -52,15 +52,38 @@ typedef struct FLOWEVENT {
 	lng argclaim;				/* memory foot print of arguments */
 	lng maxclaim;				/* memory foot print of largest argument, could be used to indicate result size */
 	struct FLOWEVENT *next;		/* linked list for queues */
+	struct FLOWEVENT *prev;		/* backward link for deques */
 } *FlowEvent, FlowEventRec;
 
 typedef struct queue {
-	int exitcount;				/* how many threads should exit */
+	ATOMIC_TYPE exitcount;		/* how many threads should exit */
 	FlowEvent first, last;		/* first and last element of the queue */
 	MT_Lock l;					/* it's a shared resource, ie we need locks */
 	MT_Sema s;					/* threads wait on empty queues */
 } Queue;
 
+/*
+ * Each worker has its own double ended queue of instructions that are
+ * ready for execution.  When a worker has finished an instruction, it
+ * pushes the instructions that thereby became eligible onto the back
+ * of its own deque, and it takes its next instruction from the back as
+ * well, so that it continues with data that is likely still in its
+ * cache.  An idle worker steals from the front of the deque of another
+ * worker.  The shared todo queue is only used for the initial
+ * instructions of a dataflow block and for instructions that had to
+ * be postponed for lack of memory.  The semaphore of the todo queue
+ * counts the instructions in all queues, so that a worker that passes
+ * it is guaranteed that there is an instruction for it somewhere.
+ * The deques are kept in a fixed array so that they can be searched
+ * without holding the dataflowLock; a deque outlives its worker, any
+ * instructions left behind can still be stolen.
+ */
+typedef struct deque {
+	FlowEvent first, last;		/* steal from first, own end is last */
+	MT_Lock l;
+	bool inuse;					/* owned by a worker */
+} Deque;
+
 /*
  * The dataflow dependency is administered in a graph list structure.
  * For each instruction we keep the list of instructions that
@@ -85,6 +108,7 @@ struct worker {
 	enum { WAITING, RUNNING, FREE, EXITED, FINISHING } flag;
 	ATOMIC_PTR_TYPE cntxt;		/* client we do work for (NULL -> any) */
 	MT_Sema s;
+	Deque *dq;					/* our own deque */
 	struct worker *next;
 };
 /* heads of three mutually exclusive linked lists, all using the .next
@@ -97,6 +121,12 @@ static int free_max = 0;		/* max number of spare free threads */
 
 static Queue *todo = 0;			/* pending instructions */
 
+static Deque deques[THREADS];	/* per worker deques */
+static ATOMIC_TYPE ndeques = ATOMIC_VAR_INIT(0); /* deques initialized */
+static ATOMIC_TYPE nready = ATOMIC_VAR_INIT(0); /* queued instructions */
+static ATOMIC_TYPE nsteals = ATOMIC_VAR_INIT(0); /* stolen instructions */
+static ATOMIC_TYPE nwaits = ATOMIC_VAR_INIT(0); /* waits for work */
+
 static ATOMIC_TYPE exiting = ATOMIC_VAR_INIT(0);
 static MT_Lock dataflowLock = MT_LOCK_INITIALIZER(dataflowLock);
 
@@ -158,6 +188,8 @@ q_enqueue(Queue *q, FlowEvent d)
 	}
 	d->next = NULL;
 	MT_lock_unset(&q->l);
+	if (q == todo)
+		ATOMIC_INC(&nready);
 	MT_sema_up(&q->s);
 }
 
@@ -183,23 +215,17 @@ q_requeue(Queue *q, FlowEvent d)
 		q->first = d;
 	}
 	MT_lock_unset(&q->l);
+	ATOMIC_INC(&nready);
 	MT_sema_up(&q->s);
 }
 
+/* take the first event from the queue, if cntxt != NULL, the first
+ * event with matching cntxt value; the caller must have passed the
+ * queue's semaphore */
 static FlowEvent
-q_dequeue(Queue *q, Client cntxt)
+q_take(Queue *q, Client cntxt)
 {
-	assert(q);
-	MT_sema_down(&q->s);
-	if (ATOMIC_GET(&exiting))
-		return NULL;
 	MT_lock_set(&q->l);
-	if (cntxt == NULL && q->exitcount > 0) {
-		q->exitcount--;
-		MT_lock_unset(&q->l);
-		return NULL;
-	}
-
 	FlowEvent *dp = &q->first;
 	FlowEvent pd = NULL;
 	/* if cntxt == NULL, return the first event, if cntxt != NULL, find
@@ -222,6 +248,193 @@ q_dequeue(Queue *q, Client cntxt)
 	return d;
 }
 
+static FlowEvent
+q_dequeue(Queue *q, Client cntxt)
+{
+	assert(q);
+	MT_sema_down(&q->s);
+	if (ATOMIC_GET(&exiting))
+		return NULL;
+	if (cntxt == NULL) {
+		ATOMIC_BASE_TYPE n = ATOMIC_GET(&q->exitcount);
+		while (n > 0) {
+			if (ATOMIC_CAS(&q->exitcount, &n, n - 1))
+				return NULL;
+		}
+	}
+	return q_take(q, cntxt);
+}
+
+/* push an event that has become eligible onto the back of our own
+ * deque */
+static void
+dq_push(Deque *dq, FlowEvent d)
+{
+	MT_lock_set(&dq->l);
+	d->next = NULL;
+	d->prev = dq->last;
+	if (dq->last)
+		dq->last->next = d;
+	else
+		dq->first = d;
+	dq->last = d;
+	MT_lock_unset(&dq->l);
+	ATOMIC_INC(&nready);
+	MT_sema_up(&todo->s);
+}
+
+/* take an event from the deque, searching from the back (own deque) or
+ * from the front (stealing); if cntxt != NULL only events for that
+ * client qualify */
+static FlowEvent
+dq_take(Deque *dq, Client cntxt, bool steal)
+{
+	FlowEvent d;
+
+	if ((steal ? dq->first : dq->last) == NULL)
+		return NULL;		/* quick check without lock */
+	MT_lock_set(&dq->l);
+	if (steal) {
+		for (d = dq->first; d && cntxt && d->flow->cntxt != cntxt; d = d->next)
+			;
+	} else {
+		for (d = dq->last; d && cntxt && d->flow->cntxt != cntxt; d = d->prev)
+			;
+	}
+	if (d) {
+		if (d->prev)
+			d->prev->next = d->next;
+		else
+			dq->first = d->next;
+		if (d->next)
+			d->next->prev = d->prev;
+		else
+			dq->last = d->prev;
+		d->next = d->prev = NULL;
+	}
+	MT_lock_unset(&dq->l);
+	return d;
+}
+
+/* Find work for worker t.  Returns NULL if the worker should exit, or
+ * if it is a worker for a specific client and there is no work for
+ * that client.  The order in which we look is: our own deque, the
+ * shared queue, the deques of the other workers. */
+static FlowEvent
+DFLOWgetwork(struct worker *t, Client cntxt)
+{
+	FlowEvent fe;
+
+	if (ATOMIC_GET(&nready) == 0)
+		ATOMIC_INC(&nwaits);	/* we're probably going to wait */
+	/* idle workers block here until an event is pushed onto one of
+	 * the queues */
+	MT_sema_down(&todo->s);
+	/* we passed the semaphore, so there is an event in one of the
+	 * queues for us (or we're asked to exit), but another worker may
+	 * have taken the one that was pushed onto a deque we had already
+	 * looked at, in which case the event it was entitled to is still
+	 * there: keep our claim and look again */
+	for (;;) {
+		if (ATOMIC_GET(&exiting))
+			return NULL;
+		if (cntxt == NULL) {
+			ATOMIC_BASE_TYPE n = ATOMIC_GET(&todo->exitcount);
+			while (n > 0) {
+				if (ATOMIC_CAS(&todo->exitcount, &n, n - 1))
+					return NULL;
+			}
+		}
+		if ((fe = dq_take(t->dq, cntxt, false)) == NULL &&
+			(fe = q_take(todo, cntxt)) == NULL) {
+			int n = (int) ATOMIC_GET(&ndeques);
+			int me = (int) (t->dq - deques);
+			for (int i = 1; i < n; i++) {
+				if ((fe = dq_take(&deques[(me + i) % n], cntxt, true)) != NULL) {
+					ATOMIC_INC(&nsteals);
+					break;
+				}
+			}
+		}
+		if (fe) {
+			ATOMIC_DEC(&nready);
+			return fe;
+		}
+		/* a specific worker only looks for work of its client and
+		 * gives the semaphore back itself */
+		if (cntxt)
+			return NULL;
+	}
+}
+
+/* claim a deque for a new worker; called with dataflowLock held */
+static Deque *
+dq_claim(void)
+{
+	int n = (int) ATOMIC_GET(&ndeques);
+	for (int i = 0; i < n; i++) {
+		if (!deques[i].inuse) {
+			deques[i].inuse = true;
+			return &deques[i];
+		}
+	}
+	if (n == THREADS)
+		return NULL;
+	deques[n] = (Deque) {.inuse = true,};
+	MT_lock_init(&deques[n].l, "DFLOWdeque");
+	ATOMIC_INC(&ndeques);
+	return &deques[n];
+}
+
+void
+DFLOWstatistics(lng *steals, lng *waits)
+{
+	*steals = (lng) ATOMIC_GET(&nsteals);
+	*waits = (lng) ATOMIC_GET(&nwaits);
+}
+
+/* An instruction has finished (or was skipped): decrease the blocked
+ * counter of the instructions that depend on it.  The ones for which
+ * the counter drops to zero are pushed onto our own deque, except that
+ * if hotpotato is set, the one with the largest memory claim is
+ * returned instead, so that we can continue with it right away using
+ * the result just produced. */
+static FlowEvent
+DFLOWwakeup(Deque *dq, FlowEvent fe, bool hotpotato)
+{
+	DataFlow flow = fe->flow;
+	FlowEvent nxt = NULL;
+	int last, i;
+
+	MT_lock_set(&flow->flowlock);
+	for (last = fe->pc - flow->start;
+		 last >= 0 && (i = flow->nodes[last]) > 0;
+		 last = flow->edges[last]) {
+		FlowEvent f = flow->status + i;
+		if (f->state != DFLOWpending)
+			continue;
+		f->argclaim += fe->hotclaim;
+		if (--f->blocks > 0)
+			continue;
+		f->state = DFLOWrunning;
+		if (hotpotato && (nxt == NULL || f->argclaim > nxt->argclaim)) {
+			/* find the one with the largest footprint */
+			FlowEvent tmp = nxt;
+			nxt = f;
+			f = tmp;
+		}
+		if (f)
+			dq_push(dq, f);
+	}
+	if (nxt) {
+		nxt->hotclaim = fe->hotclaim;
+		if (nxt->maxclaim < fe->maxclaim)
+			nxt->maxclaim = fe->maxclaim;
+	}
+	MT_lock_unset(&flow->flowlock);
+	return nxt;
+}
+
 /*
  * We simply move an instruction into the front of the queue.
  * Beware, we assume that variables are assigned a value once, otherwise
@@ -277,7 +490,7 @@ DFLOWworker(void *T)
 			if (fnxt == 0) {
 				MT_thread_setworking("waiting for work");
 				cntxt = ATOMIC_PTR_GET(&t->cntxt);
-				fe = q_dequeue(todo, cntxt);
+				fe = DFLOWgetwork(t, cntxt);
 				if (fe == NULL) {
 					if (cntxt) {
 						/* we're not done yet with work for the current
@@ -308,6 +521,7 @@ DFLOWworker(void *T)
 
 			/* whenever we have a (concurrent) error, skip it */
 			if (ATOMIC_PTR_GET(&flow->error)) {
+				(void) DFLOWwakeup(t->dq, fe, false);
 				q_enqueue(flow->done, fe);
 				continue;
 			}
@@ -351,6 +565,7 @@ DFLOWworker(void *T)
 				/* only collect one error (from one thread, needed for stable testing) */
 				(void) ATOMIC_PTR_CAS(&flow->error, &null, error);
 				/* after an error we skip the rest of the block */
+				(void) DFLOWwakeup(t->dq, fe, false);
 				q_enqueue(flow->done, fe);
 				continue;
 			}
@@ -375,39 +590,11 @@ DFLOWworker(void *T)
 					fe->maxclaim = footprint;
 			}
 
-/* Try to get rid of the hot potato or locate an alternative to proceed.
- */
-#define HOTPOTATO
-#ifdef HOTPOTATO
-			/* HOT potato choice */
-			int last = 0, nxt = -1;
-			lng nxtclaim = -1;
-
-			MT_lock_set(&flow->flowlock);
-			for (last = fe->pc - flow->start;
-				 last >= 0 && (i = flow->nodes[last]) > 0;
-				 last = flow->edges[last]) {
-				if (flow->status[i].state == DFLOWpending
-					&& flow->status[i].blocks == 1) {
-					/* find the one with the largest footprint */
-					if (nxt == -1 || flow->status[i].argclaim > nxtclaim) {
-						nxt = i;
-						nxtclaim = flow->status[i].argclaim;
-					}
-				}
-			}
-			/* hot potato can not be removed, use alternative to proceed */
-			if (nxt >= 0) {
-				flow->status[nxt].state = DFLOWrunning;
-				flow->status[nxt].blocks = 0;
-				flow->status[nxt].hotclaim = fe->hotclaim;
-				flow->status[nxt].argclaim += fe->hotclaim;
-				if (flow->status[nxt].maxclaim < fe->maxclaim)
-					flow->status[nxt].maxclaim = fe->maxclaim;
-				fnxt = flow->status + nxt;
-			}
-			MT_lock_unset(&flow->flowlock);
-#endif
+			/* make the instructions that were waiting for this one
+			 * eligible, and continue with the one that uses the
+			 * largest part of the result just produced (the "hot
+			 * potato") */
+			fnxt = DFLOWwakeup(t->dq, fe, true);
 
 			q_enqueue(flow->done, fe);
 		}
@@ -487,11 +674,17 @@ DFLOWinitialize(void)
 		*t = (struct worker) {
 			.flag = RUNNING,
 			.cntxt = ATOMIC_PTR_VAR_INIT(NULL),
+			.dq = dq_claim(),
 		};
+		if (t->dq == NULL) {
+			GDKfree(t);
+			continue;
+		}
 		MT_sema_init(&t->s, 0, "DFLOWsema"); /* placeholder name */
 		if (MT_create_thread(&t->id, DFLOWworker, t,
 							 MT_THR_JOINABLE, "DFLOWworkerXXXX") < 0) {
 			MT_sema_destroy(&t->s);
+			t->dq->inuse = false;
 			GDKfree(t);
 		} else {
 			t->next = workers;
@@ -644,7 +837,6 @@ DFLOWinitBlk(DataFlow flow, MalBlkPtr mb, int size)
 static str
 DFLOWscheduler(DataFlow flow, struct worker *w)
 {
-	int last;
 	int i;
 	int j;
 	InstrPtr p;
@@ -690,28 +882,9 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 			throw(MAL, "dataflow",
 				  "DFLOWscheduler(): q_dequeue(flow->done) returned NULL");
 		}
-
-		/*
-		 * When an instruction is finished we have to reduce the blocked
-		 * counter for all dependent instructions.  for those where it
-		 * drops to zero we can scheduler it we do it here instead of the scheduler
-		 */
-
-		MT_lock_set(&flow->flowlock);
+		/* the workers have already made the instructions that
+		 * depended on this one eligible */
 		tasks++;
-		for (last = f->pc - flow->start;
-			 last >= 0 && (i = flow->nodes[last]) > 0; last = flow->edges[last])
-			if (flow->status[i].state == DFLOWpending) {
-				flow->status[i].argclaim += f->hotclaim;
-				if (flow->status[i].blocks == 1) {
-					flow->status[i].blocks--;
-					flow->status[i].state = DFLOWrunning;
-					q_enqueue(todo, flow->status + i);
-				} else {
-					flow->status[i].blocks--;
-				}
-			}
-		MT_lock_unset(&flow->flowlock);
 	}
 	/* release the worker from its specific task (turn it into a
 	 * generic worker) */
@@ -734,8 +907,9 @@ finish_worker(struct worker *t)
 	MT_lock_unset(&dataflowLock);
 	MT_join_thread(t->id);
 	MT_sema_destroy(&t->s);
-	GDKfree(t);
 	MT_lock_set(&dataflowLock);
+	t->dq->inuse = false;
+	GDKfree(t);
 }
 
 /* We create a pool of GDKnr_threads-1 generic workers, that is,
@@ -808,11 +982,15 @@ runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc,
 			*t = (struct worker) {
 				.flag = WAITING,
 				.cntxt = ATOMIC_PTR_VAR_INIT(cntxt),
+				.dq = dq_claim(),
 			};
 			MT_sema_init(&t->s, 0, "DFLOWsema"); /* placeholder name */
-			if (MT_create_thread(&t->id, DFLOWworker, t,
+			if (t->dq == NULL ||
+				MT_create_thread(&t->id, DFLOWworker, t,
 								 MT_THR_JOINABLE, "DFLOWworkerXXXX") < 0) {
 				MT_sema_destroy(&t->s);
+				if (t->dq)
+					t->dq->inuse = false;
 				GDKfree(t);
 				t = NULL;
 			} else {
@@ -873,9 +1051,7 @@ runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc,
 	MT_lock_destroy(&flow->flowlock);
 
 	/* we created one worker, now tell one worker to exit again */
-	MT_lock_set(&todo->l);
-	todo->exitcount++;
-	MT_lock_unset(&todo->l);
+	ATOMIC_INC(&todo->exitcount);
 	MT_sema_up(&todo->s);
 
 	return msg;
@@ -941,5 +1117,11 @@ mal_dataflow_reset(void)
 		GDKfree(todo);
 	}
 	todo = 0;					/* pending instructions */
+	for (int i = 0, n = (int) ATOMIC_GET(&ndeques); i < n; i++) {
+		MT_lock_destroy(&deques[i].l);
+		deques[i] = (Deque) {0};
+	}
+	ATOMIC_SET(&ndeques, 0);
+	ATOMIC_SET(&nready, 0);
 	ATOMIC_SET(&exiting, 0);
 }
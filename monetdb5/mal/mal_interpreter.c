@@ -550,6 +550,12 @@ runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			throw(MAL, "mal.interpreter",
 				  SQLSTATE(HYT00) RUNTIME_SESSION_TIMEOUT);
 		}
+		/* wait for the memory budget of the query */
+		if ((ret = MALadmission_query(cntxt, mb, stk)) != MAL_SUCCEED) {
+			runtimeProfileFinish(cntxt, mb, stk);
+			ma_close(&ta_state);
+			return ret;
+		}
 	}
 	stkpc = startpc;
 	exceptionVar = -1;
@@ -1259,8 +1265,10 @@ runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			ret = createException(MAL, nme, "Exception not caught");
 		}
 	}
-	if (startedProfileQueue)
+	if (startedProfileQueue) {
+		MALadmission_query_release(cntxt, stk);
 		runtimeProfileFinish(cntxt, mb, stk);
+	}
 	ma_close(&ta_state);
 	return ret;
 }
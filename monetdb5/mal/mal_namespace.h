@@ -48,6 +48,7 @@
 	FUNC(bind_dbat); \
 	FUNC(bind_idxbat); \
 	FUNC(block); \
+	FUNC(bloomfilter); \
 	FUNC(bstream); \
 	FUNC(calc); \
 	FUNC(capi); \
@@ -101,6 +102,7 @@
 	FUNC(drop_view); \
 	FUNC(emptybind); \
 	FUNC(emptybindidx); \
+	FUNC(encode); \
 	FUNC(endsWith); \
 	FUNC(eval); \
 	FUNC(exec); \
@@ -112,6 +114,7 @@
 	FUNC(firstn); \
 	FUNC(first_value); \
 	FUNC(for); \
+	FUNC(fsst); \
 	FUNC(generator); \
 	FUNC(get); \
 	FUNC(getVariable); \
@@ -257,6 +260,7 @@
 	FUNC(take); \
 	FUNC(thetajoin); \
 	FUNC(thetaselect); \
+	FUNC(thetaselectaggr); \
 	FUNC(tid); \
 	FUNC(total); \
 	FUNC(transaction); \
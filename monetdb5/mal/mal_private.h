@@ -45,6 +45,9 @@ MALfcn findFunctionImplementation(const char *cname)
 char *MSP_locate_script(allocator *ma, const char *mod_name)
 	__attribute__((__visibility__("hidden")));
 
+void DFLOWstatistics(lng *steals, lng *waits)
+	__attribute__((__visibility__("hidden")));
+
 /* Reset primitives */
 void AUTHreset(void)
 	__attribute__((__visibility__("hidden")));
@@ -28,6 +28,7 @@
 #include "mal_utils.h"
 #include "mal_resource.h"
 #include "mal_internal.h"
+#include "mal_private.h"
 
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
@@ -180,6 +181,15 @@ prepareMalEvent(allocator *ma, Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 		goto cleanup_and_exit;
 	if (algo && !logadd(&logbuf, ",\"algorithm\":\"%s\"", algo))
 		goto cleanup_and_exit;
+	/* the scheduler statistics are reported once per query, in the
+	 * event of the outermost function which comes last */
+	if (mb && getPC(mb, pci) == 0 && (stk == NULL || stk->up == NULL)) {
+		lng steals, waits;
+		DFLOWstatistics(&steals, &waits);
+		if (!logadd(&logbuf, ",\"dflow_steals\":" LLFMT ",\"dflow_waits\":" LLFMT,
+					steals, waits))
+			goto cleanup_and_exit;
+	}
 	if (!logadd(&logbuf, "}\n"))	// end marker
 		goto cleanup_and_exit;
 	return logbuf.logbuffer;
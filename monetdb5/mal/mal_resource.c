@@ -16,18 +16,27 @@
 #include "mal_private.h"
 #include "mal_internal.h"
 #include "mal_instruction.h"
+#include "mal_runtime.h"
 
 /* Memory based admission does not seem to have a major impact so far. */
 static lng memorypool = 0;		/* memory claimed by concurrent threads */
 
 static MT_Lock admissionLock = MT_LOCK_INITIALIZER(admissionLock);
 
+/* Memory budgets of queries, protected by mal_delayLock */
+static lng querypool = 0;		/* budget reserved by running queries */
+static ulng queryticket = 0;	/* last ticket handed out to a waiting query */
+
 void
 mal_resource_reset(void)
 {
 	MT_lock_set(&admissionLock);
 	memorypool = (lng) MEMORY_THRESHOLD;
 	MT_lock_unset(&admissionLock);
+	MT_lock_set(&mal_delayLock);
+	querypool = 0;
+	queryticket = 0;
+	MT_lock_unset(&mal_delayLock);
 }
 
 /*
@@ -138,17 +147,25 @@ MALadmission_claim(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 
 	/* the argument claim is based on the input for an instruction */
 	if (memorypool > argclaim || ATOMIC_GET(&cntxt->workers) == 0) {
+		/* the claim can't be met, but the instruction is let
+		 * through since there is no other worker: ask the
+		 * operators to spill their partitions to disk (see
+		 * GDKspilling) */
+		bool spill = memorypool <= argclaim;
 		/* If we are low on memory resources, limit the user if he exceeds his memory budget
 		 * but make sure there is at least one worker thread active */
 		if (cntxt->memorylimit) {
 			if (argclaim + stk->memory >
-				(lng) cntxt->memorylimit * LL_CONSTANT(1048576)
-				&& ATOMIC_GET(&cntxt->workers) > 0) {
-				MT_lock_unset(&admissionLock);
-				return false;
+				(lng) cntxt->memorylimit * LL_CONSTANT(1048576)) {
+				if (ATOMIC_GET(&cntxt->workers) > 0) {
+					MT_lock_unset(&admissionLock);
+					return false;
+				}
+				spill = true;
 			}
 			stk->memory += argclaim;
 		}
+		MT_thread_setspill(spill);
 		memorypool -= argclaim;
 		stk->memory += argclaim;
 		MT_lock_set(&mal_delayLock);
@@ -170,6 +187,7 @@ MALadmission_release(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 	(void) cntxt;
 	(void) mb;
 	(void) pci;
+	MT_thread_setspill(false);
 	if (argclaim == 0)
 		return;
 
@@ -185,3 +203,137 @@ MALadmission_release(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 	MT_lock_unset(&admissionLock);
 	return;
 }
+
+/*
+ * Next to the claims of the individual instructions, a query can have
+ * a memory budget: the smaller of the max_memory of its user and the
+ * memory limit of its session (see sys.setmemorylimit).  The budgets
+ * of the running queries together should stay below the global budget,
+ * which is set with the query_memory_budget option (in MB) and which
+ * defaults to the MEMORY_THRESHOLD.  A new query whose budget does not
+ * fit in what is left waits in line until enough running queries
+ * finish.  The queries are admitted in the order in which they started
+ * waiting, and a query is always admitted when no other budget is
+ * reserved, so a budget larger than the global one only means the
+ * query runs alone.  Queries without a budget are not held up.
+ */
+static lng
+getQueryBudget(void)
+{
+	int budget = GDKgetenv_int("query_memory_budget", 0);
+
+	return budget > 0 ? (lng) budget << 20 : (lng) MEMORY_THRESHOLD;
+}
+
+/* show the query in the query queue as waiting or running */
+static void
+setQueryStatus(MalStkPtr stk, const char *from, const char *to)
+{
+	for (size_t i = 0; i < qsize; i++) {
+		if (QRYqueue[i].stk == stk) {
+			if (QRYqueue[i].status && strcmp(QRYqueue[i].status, from) == 0)
+				QRYqueue[i].status = (str) to;
+			break;
+		}
+	}
+}
+
+/* whether the query of cntxt is next in line and its budget fits */
+static bool
+admitQuery(Client cntxt, lng budget, lng limit)
+{
+	if (querypool > 0 && querypool + budget > limit)
+		return false;
+	for (int i = 0; i < MAL_MAXCLIENTS; i++) {
+		if (mal_clients[i].qryticket != 0 &&
+			mal_clients[i].qryticket < cntxt->qryticket)
+			return false;
+	}
+	return true;
+}
+
+str
+MALadmission_query(Client cntxt, MalBlkPtr mb, MalStkPtr stk)
+{
+	lng budget = (lng) cntxt->qryctx.maxmem, limit;
+	str msg = MAL_SUCCEED;
+
+	/* only top level queries, and only once if they are nested */
+	if (stk->up || budget == 0 || cntxt->qrystk != NULL)
+		return MAL_SUCCEED;
+	limit = getQueryBudget();
+	if (budget > limit)
+		budget = limit;
+
+	MT_lock_set(&mal_delayLock);
+	cntxt->qrystk = stk;
+	cntxt->qrybudget = budget;
+	cntxt->qryqueued = time(0);
+	cntxt->qryticket = ++queryticket;
+	while (!admitQuery(cntxt, budget, limit)) {
+		setQueryStatus(stk, "running", "waiting");
+		MT_lock_unset(&mal_delayLock);
+		MT_sleep_ms(DELAYUNIT * 5);
+		if (stk->status == 'q') {
+			msg = createException(MAL, "mal.interpreter",
+								  "Query with tag " OIDFMT
+								  " received stop signal", mb->tag);
+		} else if (cntxt->mode == FINISHCLIENT) {
+			msg = createException(MAL, "mal.interpreter",
+								  "prematurely stopped client");
+		} else if (cntxt->fdin && TIMEOUT_TEST(&cntxt->qryctx)) {
+			switch (cntxt->qryctx.endtime) {
+			case QRY_TIMEOUT:
+				msg = createException(MAL, "mal.interpreter", SQLSTATE(HYT00) RUNTIME_QRY_TIMEOUT);
+				break;
+			case QRY_INTERRUPT:
+				msg = createException(MAL, "mal.interpreter", SQLSTATE(HYT00) RUNTIME_QRY_INTERRUPT);
+				break;
+			default:
+				msg = createException(MAL, "mal.interpreter", SQLSTATE(HYT00) "Client disconnected");
+				MT_lock_set(&mal_contextLock);
+				cntxt->mode = FINISHCLIENT;
+				MT_lock_unset(&mal_contextLock);
+				break;
+			}
+		}
+		MT_lock_set(&mal_delayLock);
+		if (msg) {
+			cntxt->qrystk = NULL;
+			cntxt->qrybudget = 0;
+			cntxt->qryticket = 0;
+			MT_lock_unset(&mal_delayLock);
+			return msg;
+		}
+	}
+	setQueryStatus(stk, "waiting", "running");
+	cntxt->qryticket = 0;
+	querypool += budget;
+	MT_lock_unset(&mal_delayLock);
+	return MAL_SUCCEED;
+}
+
+void
+MALadmission_query_release(Client cntxt, MalStkPtr stk)
+{
+	MT_lock_set(&mal_delayLock);
+	if (cntxt->qrystk == stk) {
+		querypool -= cntxt->qrybudget;
+		if (querypool < 0)
+			querypool = 0;
+		cntxt->qrystk = NULL;
+		cntxt->qrybudget = 0;
+	}
+	MT_lock_unset(&mal_delayLock);
+}
+
+/* The memory budget of all queries together and the part of it
+ * reserved by running queries */
+void
+MALadmission_query_budget(lng *limit, lng *reserved)
+{
+	*limit = getQueryBudget();
+	MT_lock_set(&mal_delayLock);
+	*reserved = querypool;
+	MT_lock_unset(&mal_delayLock);
+}
@@ -28,6 +28,9 @@ extern bool MALadmission_claim(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 							   InstrPtr pci, lng argclaim);
 extern void MALadmission_release(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 								 InstrPtr pci, lng argclaim);
+extern str MALadmission_query(Client cntxt, MalBlkPtr mb, MalStkPtr stk);
+extern void MALadmission_query_release(Client cntxt, MalStkPtr stk);
+extern void MALadmission_query_budget(lng *limit, lng *reserved);
 
 #define FAIRNESS_THRESHOLD (MAX_DELAYS * DELAYUNIT)
 
@@ -217,7 +217,7 @@ runtimeProfileInit(Client cntxt, MalBlkPtr mb, MalStkPtr stk)
 		}
 	}
 	for (i = 0; i < qsize; i++) {
-		paused += QRYqueue[i].status && (QRYqueue[i].status[0] == 'p' || QRYqueue[i].status[0] == 'r');	/* running, prepared or paused */
+		paused += QRYqueue[i].status && (QRYqueue[i].status[0] == 'p' || QRYqueue[i].status[0] == 'r' || QRYqueue[i].status[0] == 'w');	/* running, prepared, paused or waiting */
 	}
 	if (qsize - paused < (size_t) MAL_MAXCLIENTS) {
 		qsize += MAL_MAXCLIENTS;
@@ -241,7 +241,8 @@ runtimeProfileInit(Client cntxt, MalBlkPtr mb, MalStkPtr stk)
 			qlast = 0;
 		if (QRYqueue[j].stk == NULL ||
 			QRYqueue[j].status == NULL ||
-			(QRYqueue[j].status[0] != 'r' && QRYqueue[j].status[0] != 'p')) {
+			(QRYqueue[j].status[0] != 'r' && QRYqueue[j].status[0] != 'p' &&
+			 QRYqueue[j].status[0] != 'w')) {
 			QRYqueue[j].mb = mb;
 			QRYqueue[j].tag = stk->tag = mb->tag;
 			QRYqueue[j].stk = stk;	// for status pause 'p'/running '0'/ quitting 'q'
@@ -372,6 +372,80 @@ ALGthetaselect2(Client ctx, bat *result, const bat *bid, const bat *sid, const v
 	return MAL_SUCCEED;
 }
 
+/* (r1,...,rn) := algebra.thetaselectaggr(b, s, val, op, aggr1, col1, ..., aggrn, coln)
+ * Calculate the aggregates over the columns restricted to the values
+ * selected by algebra.thetaselect(b, s, val, op), without
+ * materializing the selection and the projections. */
+static str
+ALGthetaselectaggr(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int naggr = pci->retc;
+	bat bid = *getArgReference_bat(stk, pci, naggr);
+	bat sid = *getArgReference_bat(stk, pci, naggr + 1);
+	const void *val = VALptr(&stk->stk[getArg(pci, naggr + 2)]);
+	const char *op = *getArgReference_str(stk, pci, naggr + 3);
+	BAT *b, *s = NULL;
+	BAT **cols;
+	const char **aggr;
+	ValPtr res;
+	str msg = MAL_SUCCEED;
+	gdk_return rc;
+
+	(void) cntxt;
+	if (pci->argc != naggr + 4 + 2 * naggr)
+		throw(MAL, "algebra.thetaselectaggr", ILLEGAL_ARGUMENT);
+	if ((b = BATdescriptor(bid)) == NULL)
+		throw(MAL, "algebra.thetaselectaggr",
+			  SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (!is_bat_nil(sid) && (s = BATdescriptor(sid)) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, "algebra.thetaselectaggr",
+			  SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	cols = GDKzalloc(naggr * sizeof(BAT *));
+	aggr = GDKmalloc(naggr * sizeof(const char *));
+	res = GDKmalloc(naggr * sizeof(ValRecord));
+	if (cols == NULL || aggr == NULL || res == NULL) {
+		msg = createException(MAL, "algebra.thetaselectaggr",
+							  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (int i = 0; i < naggr; i++) {
+		if (getArgType(mb, pci, naggr + 4 + 2 * i) != TYPE_str ||
+			!isaBatType(getArgType(mb, pci, naggr + 5 + 2 * i))) {
+			msg = createException(MAL, "algebra.thetaselectaggr",
+								  ILLEGAL_ARGUMENT);
+			goto bailout;
+		}
+		aggr[i] = *getArgReference_str(stk, pci, naggr + 4 + 2 * i);
+		if ((cols[i] = BATdescriptor(*getArgReference_bat(stk, pci, naggr + 5 + 2 * i))) == NULL) {
+			msg = createException(MAL, "algebra.thetaselectaggr",
+								  SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+			goto bailout;
+		}
+		res[i] = (ValRecord) {.vtype = getArgType(mb, pci, i)};
+	}
+	rc = BATthetaselectaggr(b, s, val, op, naggr, aggr, cols, res);
+	if (rc != GDK_SUCCEED) {
+		msg = createException(MAL, "algebra.thetaselectaggr", GDK_EXCEPTION);
+		goto bailout;
+	}
+	for (int i = 0; i < naggr; i++)
+		VALset(&stk->stk[getArg(pci, i)], res[i].vtype, VALget(&res[i]));
+
+  bailout:
+	if (cols) {
+		for (int i = 0; i < naggr; i++)
+			BBPreclaim(cols[i]);
+		GDKfree(cols);
+	}
+	GDKfree(aggr);
+	GDKfree(res);
+	BBPunfix(b->batCacheid);
+	BBPreclaim(s);
+	return msg;
+}
+
 static str
 ALGmarkselect(Client ctx, bat *r1, bat *r2, const bat *gid, const bat *mid, const bat *pid, const bit *Any)
 {
@@ -949,6 +1023,38 @@ ALGintersect(Client ctx, bat *r1, const bat *lid, const bat *rid, const bat *sli
 				   "algebra.intersect");
 }
 
+static str
+ALGbloomfilter(Client ctx, bat *r1, const bat *lid, const bat *rid,
+			   const bat *slid, const bat *srid)
+{
+	(void) ctx;
+	BAT *l, *r, *sl = NULL, *sr = NULL, *bn;
+
+	if ((l = BATdescriptor(*lid)) == NULL)
+		throw(MAL, "algebra.bloomfilter", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if ((r = BATdescriptor(*rid)) == NULL) {
+		BBPunfix(l->batCacheid);
+		throw(MAL, "algebra.bloomfilter", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if ((slid && !is_bat_nil(*slid) && (sl = BATdescriptor(*slid)) == NULL) ||
+		(srid && !is_bat_nil(*srid) && (sr = BATdescriptor(*srid)) == NULL)) {
+		BBPunfix(l->batCacheid);
+		BBPunfix(r->batCacheid);
+		BBPreclaim(sl);
+		throw(MAL, "algebra.bloomfilter", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	bn = BATbloomfilter(l, r, sl, sr);
+	BBPunfix(l->batCacheid);
+	BBPunfix(r->batCacheid);
+	BBPreclaim(sl);
+	BBPreclaim(sr);
+	if (bn == NULL)
+		throw(MAL, "algebra.bloomfilter", GDK_EXCEPTION);
+	*r1 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
 /* algebra.firstn(b:bat[:any],
  *                s:bat[:oid],
  *                g:bat[:oid],
@@ -1938,6 +2044,7 @@ static mel_func algebra_init_funcs[] = {
  command("algebra", "select", ALGselect1nil, false, "With unknown set, each nil != nil", args(1,8, batarg("",oid),batargany("b",1),argany("low",1),argany("high",1),arg("li",bit),arg("hi",bit),arg("anti",bit),arg("unknown",bit))),
  command("algebra", "select", ALGselect2nil, false, "With unknown set, each nil != nil", args(1,9, batarg("",oid),batargany("b",1),batarg("s",oid),argany("low",1),argany("high",1),arg("li",bit),arg("hi",bit),arg("anti",bit),arg("unknown",bit))),
  command("algebra", "thetaselect", ALGthetaselect2, false, "Select all head values of the first input BAT for which the tail value\nobeys the relation value OP VAL and for which the head value occurs in\nthe tail of the second input BAT.\nInput is a dense-headed BAT, output is a dense-headed BAT with in\nthe tail the head value of the input BAT for which the\nrelationship holds.  The output BAT is sorted on the tail value.", args(1,5, batarg("",oid),batargany("b",1),batarg("s",oid),argany("val",1),arg("op",str))),
+ pattern("algebra", "thetaselectaggr", ALGthetaselectaggr, false, "Calculate the aggregates (count, sum, min, or max) over the columns\nrestricted to the values selected by thetaselect(b, s, val, op),\nworking through the candidates in cache-sized morsels.", args(1,7, varargany("",0),batargany("b",1),batarg("s",oid),argany("val",1),arg("op",str),varargany("aggrcol",0))),
  command("algebra", "markselect", ALGmarkselect, false, "Group on group-ids, return aggregated anyequal or allnotequal", args(2,6, batarg("",oid), batarg("", bit), batarg("gid",oid), batarg("m", bit), batarg("p", bit), arg("any", bit))),
  command("algebra", "outerselect", ALGouterselect, false, "Per input lid return at least one row, if none of the predicates (p) hold, return a nil, else 'all' true cases.", args(2,6, batarg("",oid), batarg("", bit), batarg("lid", oid), batarg("rid", bit), batarg("predicate", bit), arg("any", bit))),
  command("algebra", "selectNotNil", ALGselectNotNil, false, "Select all not-nil values", args(1,2, batargany("",1),batargany("b",1))),
@@ -1973,6 +2080,7 @@ static mel_func algebra_init_funcs[] = {
  command("algebra", "rangejoin", ALGrangejoin1, false, "Range join: values in l and r1/r2 match if r1 <[=] l <[=] r2; only produce left output", args(1,11,batarg("",oid),batargany("l",1),batargany("r1",1),batargany("r2",1),batarg("sl",oid),batarg("sr",oid),arg("li",bit),arg("hi",bit),arg("anti",bit),arg("symmetric",bit),arg("estimate",lng))),
  command("algebra", "difference", ALGdifference, false, "Difference of l and r with candidate lists", args(1,8, batarg("",oid),batargany("l",1),batargany("r",1),batarg("sl",oid),batarg("sr",oid),arg("nil_matches",bit),arg("nil_clears",bit),arg("estimate",lng))),
  command("algebra", "intersect", ALGintersect, false, "Intersection of l and r with candidate lists (i.e. half of semi-join)", args(1,8, batarg("",oid),batargany("l",1),batargany("r",1),batarg("sl",oid),batarg("sr",oid),arg("nil_matches",bit),arg("max_one",bit),arg("estimate",lng))),
+ command("algebra", "bloomfilter", ALGbloomfilter, false, "Candidates of l whose value may occur in r, pre-filtered with a Bloom filter and the min/max range of r", args(1,5, batarg("",oid),batargany("l",1),batargany("r",1),batarg("sl",oid),batarg("sr",oid))),
  pattern("algebra", "firstn", ALGfirstn, false, "Calculate first N values of B with candidate list S", args(1,8, batarg("",oid),batargany("b",0),batarg("s",oid),batarg("g",oid),arg("n",lng),arg("asc",bit),arg("nilslast",bit),arg("distinct",bit))),
  pattern("algebra", "firstn", ALGfirstn, false, "Calculate first N values of B with candidate list S", args(2,9, batarg("",oid),batarg("",oid),batargany("b",0),batarg("s",oid),batarg("g",oid),arg("n",lng),arg("asc",bit),arg("nilslast",bit),arg("distinct",bit))),
  pattern("algebra", "firstn", ALGfirstn, false, "Calculate first N values of B with candidate list S", args(1,10, batarg("",oid),batargany("b",0),batarg("s",oid),batarg("g",oid),arg("n",lng),arg("o",lng),arg("return_skipped",bit),arg("asc",bit),arg("nilslast",bit),arg("distinct",bit))),
@@ -1456,7 +1456,7 @@ PCRElikeselect(Client ctx, bat *ret, const bat *bid, const bat *sid, const char
 			}
 
 			else
-				rev = BATnegcands(0, b->batCount, bn);
+				rev = BATnegcands(b->hseqbase, b->batCount, bn);
 			/* BAT *rev = BATnegcands(0, b->batCount, bn); */
 			BBPunfix(bn->batCacheid);
 			bn = rev;
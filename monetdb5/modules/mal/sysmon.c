@@ -17,6 +17,7 @@
 #include "gdk_time.h"
 #include "mal_exception.h"
 #include "mal_internal.h"
+#include "mal_resource.h"
 
 /* (c) M.L. Kersten
  * The queries currently in execution are returned to the front-end for managing expensive ones.
@@ -508,6 +509,147 @@ SYSMONstop(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 																tag);
 }
 
+static str
+SYSMONmemory_claims(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void) mb;
+
+	/* Temporary hack not allowing MAL clients (mclient -lmal)
+	   to use this function */
+	if (cntxt->sqlcontext == NULL)
+		throw(MAL, "SYSMONmemory_claims",
+			  SQLSTATE(42000) "Calling from a mclient -lmal.");
+
+	bat *s = getArgReference_bat(stk, pci, 0),
+			*u = getArgReference_bat(stk, pci, 1),
+			*t = getArgReference_bat(stk, pci, 2),
+			*ss = getArgReference_bat(stk, pci, 3),
+			*qd = getArgReference_bat(stk, pci, 4),
+			*b = getArgReference_bat(stk, pci, 5),
+			*c = getArgReference_bat(stk, pci, 6),
+			*a = getArgReference_bat(stk, pci, 7);
+
+	BUN sz = (BUN) MAL_MAXCLIENTS;
+	BAT *sessionid = COLnew(0, TYPE_int, sz, TRANSIENT),
+			*user = COLnew(0, TYPE_str, sz, TRANSIENT),
+			*tag = COLnew(0, TYPE_lng, sz, TRANSIENT),
+			*status = COLnew(0, TYPE_str, sz, TRANSIENT),
+			*queued = COLnew(0, TYPE_timestamp, sz, TRANSIENT),
+			*budget = COLnew(0, TYPE_int, sz, TRANSIENT),
+			*claimed = COLnew(0, TYPE_int, sz, TRANSIENT),
+			*allocated = COLnew(0, TYPE_int, sz, TRANSIENT);
+	str msg = MAL_SUCCEED;
+	bool admin = cntxt->user == MAL_ADMIN;
+
+	if (sessionid == NULL || user == NULL || tag == NULL ||
+		status == NULL || queued == NULL || budget == NULL ||
+		claimed == NULL || allocated == NULL) {
+		BBPreclaim(sessionid);
+		BBPreclaim(user);
+		BBPreclaim(tag);
+		BBPreclaim(status);
+		BBPreclaim(queued);
+		BBPreclaim(budget);
+		BBPreclaim(claimed);
+		BBPreclaim(allocated);
+		throw(MAL, "SYSMONmemory_claims", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	MT_lock_set(&mal_delayLock);
+	for (int i = 0; i < MAL_MAXCLIENTS; i++) {
+		Client cl = &mal_clients[i];
+		MalStkPtr qs = cl->qrystk;
+
+		/* the administrator sees all queries, others their own */
+		if (qs == NULL || cl->username == NULL ||
+			(!admin && (cntxt->username == NULL ||
+						strcmp(cl->username, cntxt->username) != 0)))
+			continue;
+		lng qtag = (lng) qs->tag;
+		int mb_budget = (int) (cl->qrybudget >> 20);
+		int mb_claimed = (int) (qs->memory >> 20);
+		int mb_allocated = (int) (ATOMIC_GET(&cl->qryctx.datasize) >> 20);
+		timestamp tsn = timestamp_fromtime(cl->qryqueued);
+		if (is_timestamp_nil(tsn)) {
+			msg = createException(MAL, "SYSMONmemory_claims",
+								  SQLSTATE(22003) "Cannot convert time.");
+			goto bailout;
+		}
+		if (BUNappend(sessionid, &cl->idx, false) != GDK_SUCCEED ||
+			BUNappend(user, cl->username, false) != GDK_SUCCEED ||
+			BUNappend(tag, &qtag, false) != GDK_SUCCEED ||
+			BUNappend(status, cl->qryticket ? "waiting" : "running", false) != GDK_SUCCEED ||
+			BUNappend(queued, &tsn, false) != GDK_SUCCEED ||
+			BUNappend(budget, &mb_budget, false) != GDK_SUCCEED ||
+			BUNappend(claimed, &mb_claimed, false) != GDK_SUCCEED ||
+			BUNappend(allocated, &mb_allocated, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	MT_lock_unset(&mal_delayLock);
+	*s = sessionid->batCacheid;
+	BBPkeepref(sessionid);
+	*u = user->batCacheid;
+	BBPkeepref(user);
+	*t = tag->batCacheid;
+	BBPkeepref(tag);
+	*ss = status->batCacheid;
+	BBPkeepref(status);
+	*qd = queued->batCacheid;
+	BBPkeepref(queued);
+	*b = budget->batCacheid;
+	BBPkeepref(budget);
+	*c = claimed->batCacheid;
+	BBPkeepref(claimed);
+	*a = allocated->batCacheid;
+	BBPkeepref(allocated);
+	return MAL_SUCCEED;
+
+  bailout:
+	MT_lock_unset(&mal_delayLock);
+	BBPunfix(sessionid->batCacheid);
+	BBPunfix(user->batCacheid);
+	BBPunfix(tag->batCacheid);
+	BBPunfix(status->batCacheid);
+	BBPunfix(queued->batCacheid);
+	BBPunfix(budget->batCacheid);
+	BBPunfix(claimed->batCacheid);
+	BBPunfix(allocated->batCacheid);
+	return msg ? msg : createException(MAL, "SYSMONmemory_claims",
+									   SQLSTATE(HY013) MAL_MALLOC_FAIL);
+}
+
+static str
+SYSMONmemory_budget(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void) cntxt;
+	(void) mb;
+	bat *b = getArgReference_bat(stk, pci, 0),
+			*r = getArgReference_bat(stk, pci, 1),
+			*s = getArgReference_bat(stk, pci, 2);
+	BAT *budget, *reserved, *spills;
+	lng limit, inuse, nspill = (lng) GDKspill_count();
+
+	MALadmission_query_budget(&limit, &inuse);
+	limit >>= 20;
+	inuse >>= 20;
+	budget = BATconstant(0, TYPE_lng, &limit, 1, TRANSIENT);
+	reserved = BATconstant(0, TYPE_lng, &inuse, 1, TRANSIENT);
+	spills = BATconstant(0, TYPE_lng, &nspill, 1, TRANSIENT);
+	if (budget == NULL || reserved == NULL || spills == NULL) {
+		BBPreclaim(budget);
+		BBPreclaim(reserved);
+		BBPreclaim(spills);
+		throw(MAL, "SYSMONmemory_budget", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	*b = budget->batCacheid;
+	BBPkeepref(budget);
+	*r = reserved->batCacheid;
+	BBPkeepref(reserved);
+	*s = spills->batCacheid;
+	BBPkeepref(spills);
+	return MAL_SUCCEED;
+}
+
 #include "mel.h"
 static mel_func sysmon_init_funcs[] = {
 	pattern("sysmon", "pause", SYSMONpause, true, "Suspend query execution with OID id", args(0, 1, arg("id", lng))),
@@ -518,6 +660,8 @@ static mel_func sysmon_init_funcs[] = {
 	pattern("sysmon", "stop", SYSMONstop, true, "Sysadmin call, stop query execution with OID id belonging to user", args(0, 2, arg("id", lng), arg("user", str))),
 	pattern("sysmon", "queue", SYSMONqueue, false, "A queue of queries that are currently being executed or recently finished", args(9, 9, batarg("tag", lng), batarg("sessionid", int), batarg("user", str), batarg("started", timestamp), batarg("status", str), batarg("query", str), batarg("finished", timestamp), batarg("workers", int), batarg("memory", int))),
 	pattern("sysmon", "queue", SYSMONqueue, false, "Sysadmin call, to see either the global queue or user queue of queries that are currently being executed or recently finished", args(9, 10, batarg("tag", lng), batarg("sessionid", int), batarg("user", str), batarg("started", timestamp), batarg("status", str), batarg("query", str), batarg("finished", timestamp), batarg("workers", int), batarg("memory", int), arg("user", str))),
+	pattern("sysmon", "memory_claims", SYSMONmemory_claims, false, "The memory budgets (in MB) of the queries that are running or waiting for their budget", args(8, 8, batarg("sessionid", int), batarg("user", str), batarg("tag", lng), batarg("status", str), batarg("queued", timestamp), batarg("budget", int), batarg("claimed", int), batarg("allocated", int))),
+	pattern("sysmon", "memory_budget", SYSMONmemory_budget, false, "The memory budget (in MB) for all queries together, the part of it reserved by running queries and the number of partitions spilled to disk", args(3, 3, batarg("budget", lng), batarg("reserved", lng), batarg("spills", lng))),
 	pattern("sysmon", "user_statistics", SYSMONstatistics, false, "", args(7, 7, batarg("user", str), batarg("querycount", lng), batarg("totalticks", lng), batarg("started", timestamp), batarg("finished", timestamp), batarg("maxticks", lng), batarg("maxquery", str))),
 	{ .imp=NULL }
 };
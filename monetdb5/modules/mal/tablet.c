@@ -47,6 +47,10 @@
 
 #define MAXWORKERS	64
 #define MAXBUFFERS 2
+/* slack at the end of the input buffers for tablet_find */
+#define SWARPAD 8
+/* minimum number of bytes per row splitter */
+#define MINSPLITSIZE	(64 * 1024)
 /* We restrict the row length to be 32MB for the time being */
 #define MAXROWSIZE(X) (X > 32*1024*1024 ? X : 32*1024*1024)
 
@@ -182,13 +186,39 @@ TABLETcollect(BAT **bats, Tablet *as)
 	return MAL_SUCCEED;
 }
 
+/* Return a pointer to the first byte in the NUL-terminated string s
+ * that is equal to c1 or c2, or to the terminating NUL byte.  We look
+ * at eight bytes at a time, so the string must be followed by at least
+ * SWARPAD bytes of accessible memory; the input buffers are allocated
+ * with that much slack. */
+static inline char *
+tablet_find(char *s, char c1, char c2)
+{
+	for (;;) {
+		uint64_t w = swar_load(s);
+		uint64_t mask = swar_eq(w, 0) | swar_eq(w, c1) | swar_eq(w, c2);
+		if (mask)
+			return s + swar_first(mask);
+		s += 8;
+	}
+}
+
 // the starting quote character has already been skipped
 
 static char *
 tablet_skip_string(char *s, char quote, bool escape)
 {
 	size_t i = 0, j = 0;
-	while (s[i]) {
+	for (;;) {
+		/* jump to the next quote or backslash, moving the bytes
+		 * in between into place if we removed anything already */
+		size_t n = (size_t) (tablet_find(s + i, quote, escape ? '\\' : quote) - (s + i));
+		if (j < i)
+			memmove(s + j, s + i, n);
+		i += n;
+		j += n;
+		if (s[i] == 0)
+			break;
 		if (escape && s[i] == '\\' && s[i + 1] != '\0')
 			s[j++] = s[i++];
 		else if (s[i] == quote) {
@@ -532,6 +562,10 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s, bstream *in)
  * Also the buffer size of the block stream might be a little small for
  * this task (1MB). It has been increased to 8MB, which indeed improved.
  *
+ * When reading from a file, the file reader in turn uses a number of
+ * splitter threads to find the record boundaries in its buffer, so
+ * that breaking up the file into rows is not limited to one core.
+ *
  * The work divider allocates subtasks to threads based on the
  * observed time spending so far.
  */
@@ -580,8 +614,33 @@ typedef struct {
 	bte *rowerror;
 	int errorcnt;
 	bool aborted;
+
+	int nsplit;					/* number of row splitters to use */
+	struct SPLITtask *split;	/* row splitters (producer only) */
 } READERtask;
 
+/* A row splitter scans a chunk of the producer's buffer for record
+ * separators.  Chunks start just after a record separator character,
+ * but that may have been inside a quoted field, so the splitter
+ * records the separators both for the case that the chunk starts
+ * outside and inside a quoted field.  Since every unescaped quote
+ * character toggles the state, the producer can figure out afterwards
+ * which case applies from the quote parity of the preceding chunks. */
+typedef struct SPLITtask {
+	READERtask *task;
+	MT_Id tid;
+	MT_Sema sema;				/* splitter waits for work, NULL chunk implies exit */
+	MT_Sema reply;				/* let producer continue */
+	char *s, *e;				/* the chunk */
+	uint32_t *ends[2];			/* separator offsets when starting outside/inside quotes */
+	uint32_t *lines[2];			/* newlines up to and including the separator */
+	uint32_t nends[2];
+	size_t maxends;				/* allocated size of ends and lines */
+	uint32_t nlines;			/* number of newlines in the chunk */
+	bool parity;				/* odd number of quotes in the chunk */
+	bool bad;					/* chunk needs sequential processing */
+} SPLITtask;
+
 /* returns TRUE if there is/might be more */
 static bool
 tablet_read_more(READERtask *task)
@@ -980,6 +1039,7 @@ SQLload_parse_row(READERtask *task, int idx)
 	BUN i;
 	char errmsg[BUFSIZ];
 	char ch = *task->csep;
+	char esc = task->escape ? '\\' : ch;
 	char *row = task->rows[task->cur][idx];
 	lng startlineno = task->startlineno[task->cur][idx];
 	Tablet *as = task->as;
@@ -1013,7 +1073,7 @@ SQLload_parse_row(READERtask *task, int idx)
 			}
 
 			/* eat away the column separator */
-			for (; *row; row++)
+			for (; *(row = tablet_find(row, ch, esc)); row++)
 				if (*row == '\\' && task->escape) {
 					if (row[1])
 						row++;
@@ -1054,7 +1114,7 @@ SQLload_parse_row(READERtask *task, int idx)
 			task->fields[i][idx] = row;
 
 			/* eat away the column separator */
-			for (; *row; row++)
+			for (; *(row = tablet_find(row, ch, esc)); row++)
 				if (*row == '\\' && task->escape) {
 					if (row[1])
 						row++;
@@ -1254,6 +1314,237 @@ mkdfa(allocator *ma, const unsigned char *sep, size_t seplen)
 #endif
 #endif
 
+/* Remember a record separator found at offset off in the chunk. */
+static bool
+SQLsplit_add(SPLITtask *t, int par, uint32_t off, uint32_t nlines)
+{
+	if (t->nends[par] == t->maxends) {
+		size_t maxends = t->maxends == 0 ? 4096 : 2 * t->maxends;
+		uint32_t *ends, *lines;
+
+		if (maxends > (size_t) t->task->limit)
+			maxends = (size_t) t->task->limit;
+		if (maxends == t->maxends) {
+			/* the producer can't use more rows than this anyway */
+			return true;
+		}
+		for (int j = 0; j < 2; j++) {
+			ends = GDKrealloc(t->ends[j], maxends * sizeof(uint32_t));
+			if (ends == NULL)
+				return false;
+			t->ends[j] = ends;
+			lines = GDKrealloc(t->lines[j], maxends * sizeof(uint32_t));
+			if (lines == NULL)
+				return false;
+			t->lines[j] = lines;
+		}
+		t->maxends = maxends;
+	}
+	t->ends[par][t->nends[par]] = off;
+	t->lines[par][t->nends[par]++] = nlines;
+	return true;
+}
+
+/* Find the record separators in a chunk of the input buffer.  This
+ * follows the same rules as the loop in SQLproducer, except that we
+ * don't know whether the chunk starts inside a quoted field, so we
+ * keep track of the quote parity instead of the quote state.  Since
+ * the chunk starts just after a (single byte, ASCII) record separator,
+ * we do know that we're not in the middle of a UTF-8 sequence or an
+ * escape sequence. */
+static void
+SQLsplit_chunk(SPLITtask *t)
+{
+	READERtask *task = t->task;
+	const char rsep = task->rsep[0];
+	const char quote = task->quote;
+	const bool escape = task->escape;
+	int nutf = 0;
+	int m = 0;
+	bool bs = false;
+	int par = 0;
+	uint32_t nlines = 0;
+
+	t->nends[0] = t->nends[1] = 0;
+	t->bad = false;
+	for (const char *e = t->s; e < t->e; e++) {
+		if (nutf == 0 && !bs) {
+			/* jump to the next interesting byte */
+			while (t->e - e >= 8) {
+				uint64_t w = swar_load(e);
+				uint64_t mask = (w & SWAR_HIGH) | swar_eq(w, 0) |
+					swar_eq(w, '\n') | swar_eq(w, rsep) |
+					swar_eq(w, quote) | swar_eq(w, '\\');
+				if (mask) {
+					e += swar_first(mask);
+					break;
+				}
+				e += 8;
+			}
+			if (e == t->e)
+				break;
+		}
+		if (nutf > 0) {
+			if (unlikely((*e & 0xC0) != 0x80))
+				goto bad;
+			if (unlikely(m != 0 && (*e & m) == 0))
+				goto bad;
+			m = 0;
+			nutf--;
+		} else if ((*e & 0x80) != 0) {
+			if ((*e & 0xE0) == 0xC0) {
+				nutf = 1;
+				if (unlikely((e[0] & 0x1E) == 0))
+					goto bad;
+			} else if ((*e & 0xF0) == 0xE0) {
+				nutf = 2;
+				if ((e[0] & 0x0F) == 0)
+					m = 0x20;
+			} else if (likely((*e & 0xF8) == 0xF0)) {
+				nutf = 3;
+				if ((e[0] & 0x07) == 0)
+					m = 0x30;
+			} else {
+				goto bad;
+			}
+		} else if (*e == '\n') {
+			nlines++;
+		} else if (unlikely(*e == 0)) {
+			goto bad;
+		}
+		if (bs) {
+			bs = false;
+		} else if (escape && *e == '\\') {
+			bs = true;
+		} else if (quote && *e == quote) {
+			par ^= 1;
+		} else if (*e == rsep) {
+			/* a separator if we started outside a quoted field
+			 * and have seen an even number of quotes, or if we
+			 * started inside and have seen an odd number */
+			if (!SQLsplit_add(t, par, (uint32_t) (e - t->s), nlines))
+				goto bad;
+		}
+	}
+	t->nlines = nlines;
+	t->parity = par != 0;
+	return;
+
+  bad:
+	t->bad = true;
+}
+
+static void
+SQLsplitter(void *arg)
+{
+	SPLITtask *t = (SPLITtask *) arg;
+
+	MT_thread_set_qry_ctx(&t->task->cntxt->qryctx);
+	for (;;) {
+		MT_sema_down(&t->sema);
+		if (t->s == NULL)
+			break;
+		SQLsplit_chunk(t);
+		MT_sema_up(&t->reply);
+	}
+	MT_thread_set_qry_ctx(NULL);
+}
+
+/* Start the row splitters.  The first one is run by the producer
+ * itself, so it doesn't get its own thread. */
+static void
+SQLsplit_start(READERtask *task)
+{
+	char name[MT_NAME_LEN];
+	int k;
+
+	if (task->nsplit <= 1)
+		return;
+	task->split = GDKzalloc(task->nsplit * sizeof(SPLITtask));
+	if (task->split == NULL) {
+		GDKclrerr();
+		return;
+	}
+	task->split[0].task = task;
+	for (k = 1; k < task->nsplit; k++) {
+		SPLITtask *t = &task->split[k];
+
+		t->task = task;
+		snprintf(name, sizeof(name), "split%d.sema", k);
+		MT_sema_init(&t->sema, 0, name);
+		snprintf(name, sizeof(name), "split%d.repl", k);
+		MT_sema_init(&t->reply, 0, name);
+		snprintf(name, sizeof(name), "splt%d", k);
+		if (MT_create_thread(&t->tid, SQLsplitter, t, MT_THR_JOINABLE, name) < 0) {
+			MT_sema_destroy(&t->sema);
+			MT_sema_destroy(&t->reply);
+			break;
+		}
+	}
+	task->nsplit = k;
+	if (k == 1) {
+		GDKfree(task->split);
+		task->split = NULL;
+	}
+}
+
+static void
+SQLsplit_stop(READERtask *task)
+{
+	if (task->split == NULL)
+		return;
+	for (int k = 0; k < task->nsplit; k++) {
+		SPLITtask *t = &task->split[k];
+
+		if (k > 0) {
+			t->s = NULL;
+			MT_sema_up(&t->sema);
+			MT_join_thread(t->tid);
+			MT_sema_destroy(&t->sema);
+			MT_sema_destroy(&t->reply);
+		}
+		for (int j = 0; j < 2; j++) {
+			GDKfree(t->ends[j]);
+			GDKfree(t->lines[j]);
+		}
+	}
+	GDKfree(task->split);
+	task->split = NULL;
+}
+
+/* Divide the buffer [s, end) into chunks that start just after a
+ * record separator and find the separators in all chunks in
+ * parallel.  Returns false if any of the chunks needs to be handled
+ * by the sequential code. */
+static bool
+SQLsplit_buffer(READERtask *task, char *s, char *end)
+{
+	const char rsep = task->rsep[0];
+	size_t len = (size_t) (end - s);
+	int n = task->nsplit, k;
+	bool ok = true;
+
+	task->split[0].s = s;
+	for (k = 1; k < n; k++) {
+		char *p = s + len / n * k;
+		if (p < task->split[k - 1].s)
+			p = task->split[k - 1].s;
+		p = memchr(p, rsep, (size_t) (end - p));
+		p = p ? p + 1 : end;
+		task->split[k - 1].e = p;
+		task->split[k].s = p;
+	}
+	task->split[n - 1].e = end;
+	for (k = 1; k < n; k++)
+		MT_sema_up(&task->split[k].sema);
+	SQLsplit_chunk(&task->split[0]);
+	for (k = 1; k < n; k++) {
+		MT_sema_down(&task->split[k].reply);
+		ok &= !task->split[k].bad;
+	}
+	return ok && !task->split[0].bad;
+}
+
 static void
 SQLproducer(void *p)
 {
@@ -1299,6 +1590,11 @@ SQLproducer(void *p)
 		consoleinput = true;
 		goto parseSTDIN;
 	}
+	/* we can only find record boundaries in parallel if the record
+	 * separator is a single byte that is not otherwise special */
+	if (rseplen == 1 && (rsep[0] & 0x80) == 0 && rsep[0] != '\\' &&
+		rsep[0] != quote)
+		SQLsplit_start(task);
 	for (;;) {
 		startlineno = lineno;
 		ateof[cur] = !tablet_read_more(task);
@@ -1364,6 +1660,49 @@ SQLproducer(void *p)
 			ateof[cur] = true;
 			goto reportlackofinput;
 		}
+		if (task->split && task->skip == 0 &&
+			end - s >= task->nsplit * MINSPLITSIZE &&
+			SQLsplit_buffer(task, s, end)) {
+			/* The splitters found the separators in each chunk for
+			 * both possible quote states at the start of the chunk.
+			 * The first chunk starts outside a quoted field, after
+			 * that the quote parity tells us which list to use. */
+			int state = 0;
+			lng linebase = lineno;
+			char *start = s;
+
+			for (int k = 0; k < task->nsplit; k++) {
+				const SPLITtask *t = &task->split[k];
+				const uint32_t *ends = t->ends[state];
+				const uint32_t *lines = t->lines[state];
+
+				for (uint32_t j = 0; j < t->nends[state]; j++) {
+					if (task->top[cur] == task->limit ||
+						cnt >= task->maxrow)
+						break;
+					rowno++;
+					task->startlineno[cur][task->top[cur]] = startlineno;
+					task->rows[cur][task->top[cur]++] = start;
+					cnt++;
+					t->s[ends[j]] = 0;
+					start = t->s + ends[j] + 1;
+					startlineno = lineno = linebase + lines[j];
+				}
+				if (task->top[cur] == task->limit || cnt >= task->maxrow)
+					break;
+				linebase += t->nlines;
+				state ^= t->parity;
+			}
+			if (task->top[cur] == task->limit || cnt >= task->maxrow) {
+				e = start;
+			} else {
+				e = end;
+				partial = end - start;
+				lineno = linebase;
+			}
+			task->b->pos += (size_t) (start - base);
+			base = s = start;
+		} else
 		for (e = s; *e && e < end && cnt < task->maxrow;) {
 			/* tokenize the record completely
 			 *
@@ -1380,6 +1719,25 @@ SQLproducer(void *p)
 			char q = 0;
 			size_t i = 0;
 			while (*e) {
+				if (nutf == 0 && !bs && i == 0) {
+					/* jump to the next byte that can change the
+					 * state (if we're in the middle of matching the
+					 * record separator, we need to look at every
+					 * byte) */
+					while (end - e >= 8) {
+						uint64_t w = swar_load(e);
+						uint64_t mask = (w & SWAR_HIGH) | swar_eq(w, 0) |
+							swar_eq(w, '\n') | swar_eq(w, rsep[0]) |
+							swar_eq(w, quote) | swar_eq(w, '\\');
+						if (mask) {
+							e += swar_first(mask);
+							break;
+						}
+						e += 8;
+					}
+					if (*e == 0)
+						break;
+				}
 				if (task->skip > 0) {
 					/* no interpretation of data we're skipping, just
 					 * look for newline */
@@ -1477,9 +1835,7 @@ SQLproducer(void *p)
 			/* then wait until it is done */
 			MT_sema_down(&task->producer);
 			if (cnt == task->maxrow) {
-				MT_thread_set_qry_ctx(NULL);
-				ma_close(&ta_state);
-				return;
+				goto do_return;
 			}
 		} else {
 			assert(!blocked[cur]);
@@ -1490,9 +1846,7 @@ SQLproducer(void *p)
 				MT_sema_down(&task->producer);
 				blocked[(cur + 1) % MAXBUFFERS] = false;
 				if (task->state == ENDOFCOPY) {
-					MT_thread_set_qry_ctx(NULL);
-					ma_close(&ta_state);
-					return;
+					goto do_return;
 				}
 			}
 			/* other buffer is done, proceed with current buffer */
@@ -1513,9 +1867,7 @@ SQLproducer(void *p)
 			if (cnt == task->maxrow) {
 				MT_sema_down(&task->producer);
 /*				TRC_DEBUG(MAL_SERVER, "Producer delivered all\n");*/
-				MT_thread_set_qry_ctx(NULL);
-				ma_close(&ta_state);
-				return;
+				goto do_return;
 			}
 		}
 /*		TRC_DEBUG(MAL_SERVER, "Continue producer buffer: %d\n", cur);*/
@@ -1523,15 +1875,11 @@ SQLproducer(void *p)
 		/* we ran out of input? */
 		if (task->ateof && !more) {
 /*			TRC_DEBUG(MAL_SERVER, "Producer encountered eof\n");*/
-			MT_thread_set_qry_ctx(NULL);
-			ma_close(&ta_state);
-			return;
+			goto do_return;
 		}
 		/* consumers ask us to stop? */
 		if (task->state == ENDOFCOPY) {
-			MT_thread_set_qry_ctx(NULL);
-			ma_close(&ta_state);
-			return;
+			goto do_return;
 		}
 		bufcnt[cur] = cnt;
 		/* move the non-parsed correct row data to the head of the next buffer */
@@ -1545,6 +1893,8 @@ SQLproducer(void *p)
 					 "incomplete record at end of file", s);
 		task->b->pos += partial;
 	}
+  do_return:
+	SQLsplit_stop(task);
 	MT_thread_set_qry_ctx(NULL);
 	ma_close(&ta_state);
 
@@ -1637,7 +1987,7 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out,
 	}
 	task.cur = 0;
 	for (i = 0; i < MAXBUFFERS; i++) {
-		task.base[i] = ma_alloc(ta, MAXROWSIZE(2 * b->size) + 2);
+		task.base[i] = ma_alloc(ta, MAXROWSIZE(2 * b->size) + 2 + SWARPAD);
 		task.rowlimit[i] = MAXROWSIZE(2 * b->size);
 		if (task.base[i] == NULL) {
 			tablet_error(&task, lng_nil, lng_nil, int_nil,
@@ -1660,6 +2010,8 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out,
 	task.seplen = strlen(csep);
 	task.rsep = rsep;
 	task.rseplen = strlen(rsep);
+	/* the file reader may use as many threads as the workers */
+	task.nsplit = threads;
 
 	MT_sema_init(&task.producer, 0, "task.producer");
 	MT_sema_init(&task.consumer, 0, "task.consumer");
@@ -45,7 +45,8 @@ OPTcandidatesImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 			else if (getFunctionId(p) == likeselectRef)
 				setVarCList(mb, getArg(p, 0));
 			else if (getFunctionId(p) == intersectRef
-					 || getFunctionId(p) == differenceRef)
+					 || getFunctionId(p) == differenceRef
+					 || getFunctionId(p) == bloomfilterRef)
 				setVarCList(mb, getArg(p, 0));
 			else if (getFunctionId(p) == uniqueRef)
 				setVarCList(mb, getArg(p, 0));
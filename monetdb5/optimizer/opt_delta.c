@@ -0,0 +1,268 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#include "monetdb_config.h"
+#include "opt_delta.h"
+
+/* The residuals of a delta compressed column are only meaningful at
+ * their position, therefore projections are delayed (the candidates are
+ * kept next to the compressed column) until the values are needed or an
+ * operator on the compressed values is found.  This optimizer runs after
+ * mergetable, such that the operators work on the partitions. */
+
+typedef struct delta_var {
+	int o;						/* compressed column */
+	int base;
+	int step;
+	int cand;					/* delayed projection, 0 if none */
+} delta_var;
+
+static int
+delta_sum_type(int tpe)
+{
+	if (tpe == TYPE_int)
+		return TYPE_lng;
+#ifdef HAVE_HGE
+	if (tpe == TYPE_lng)
+		return TYPE_hge;
+#else
+	if (tpe == TYPE_lng)
+		return TYPE_lng;
+#endif
+	return TYPE_any;
+}
+
+static InstrPtr
+delta_materialize(MalBlkPtr mb, delta_var *d, int tpe)
+{
+	InstrPtr r;
+
+	if (d->cand) {
+		r = newInstructionArgs(mb, deltaRef, projectionRef, 5);
+		if (r == NULL)
+			return NULL;
+		getArg(r, 0) = newTmpVariable(mb, tpe);
+		r = pushArgument(mb, r, d->cand);
+	} else {
+		r = newInstructionArgs(mb, deltaRef, decompressRef, 4);
+		if (r == NULL)
+			return NULL;
+		getArg(r, 0) = newTmpVariable(mb, tpe);
+	}
+	r = pushArgument(mb, r, d->o);
+	r = pushArgument(mb, r, d->base);
+	r = pushArgument(mb, r, d->step);
+	pushInstruction(mb, r);
+	return r;
+}
+
+str
+OPTdeltaImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, k, limit, slimit;
+	InstrPtr p = 0, *old = NULL;
+	int actions = 0;
+	delta_var *vars = NULL;
+	str msg = MAL_SUCCEED;
+	allocator *ta = MT_thread_getallocator();
+
+	(void) stk;
+
+	if (mb->inlineProp)
+		goto wrapup1;
+
+	limit = mb->stop;
+
+	for (i = 0; i < limit; i++) {
+		p = mb->stmt[i];
+		if (p && p->retc == 1 && getModuleId(p) == deltaRef
+			&& getFunctionId(p) == decompressRef) {
+			break;
+		}
+	}
+	if (i == limit)
+		goto wrapup1;			/* nothing to do */
+
+	allocator_state ta_state = ma_open(ta);
+	vars = ma_zalloc(ta, 2 * mb->vtop * sizeof(delta_var));
+	if (vars == NULL)
+		goto wrapup;
+
+	slimit = mb->ssize;
+	old = mb->stmt;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		ma_close(&ta_state);
+		throw(MAL, "optimizer.delta", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		if (p == 0)
+			continue;			//left behind by others?
+		if (p->retc == 1 && p->argc == 4 && getModuleId(p) == deltaRef
+			&& getFunctionId(p) == decompressRef) {
+			k = getArg(p, 0);
+			vars[k].o = getArg(p, 1);
+			vars[k].base = getArg(p, 2);
+			vars[k].step = getArg(p, 3);
+			vars[k].cand = 0;
+			freeInstruction(mb, p);
+			continue;
+		}
+		int done = 0;
+		for (j = p->retc; j < p->argc; j++) {
+			k = getArg(p, j);
+			if (!vars[k].o)
+				continue;
+			delta_var *d = &vars[k];
+			int tpe = getVarType(mb, d->base);
+
+			if (getModuleId(p) == algebraRef && getFunctionId(p) == projectionRef
+				&& p->retc == 1 && p->argc == 3 && j == 2) {
+				/* projection(cand, col) with col = delta.decompress(o, base, step)
+				 * is delayed, the candidates of a delayed projection are
+				 * combined first */
+				int l = getArg(p, 0), cand = getArg(p, 1);
+				if (d->cand) {
+					InstrPtr r = newInstructionArgs(mb, algebraRef, projectionRef, 3);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.delta",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, 0) = newTmpVariable(mb, newBatType(TYPE_oid));
+					r = pushArgument(mb, r, cand);
+					r = pushArgument(mb, r, d->cand);
+					pushInstruction(mb, r);
+					cand = getArg(r, 0);
+				}
+				vars[l] = *d;
+				vars[l].cand = cand;
+				freeInstruction(mb, p);
+				done = 1;
+				break;
+			} else if (p->argc == 2 && p->retc == 1
+					   && p->barrier == ASSIGNsymbol) {
+				/* a = b */
+				vars[getArg(p, 0)] = *d;
+				freeInstruction(mb, p);
+				done = 1;
+				break;
+			} else if (!d->cand
+					   && ((getModuleId(p) == algebraRef
+							&& getFunctionId(p) == subsliceRef)
+						   || (getModuleId(p) == batRef
+							   && getFunctionId(p) == mirrorRef)
+						   || (getModuleId(p) == batcalcRef
+							   && getFunctionId(p) == identityRef))) {
+				/* these only depend on the positions of col */
+				InstrPtr r = copyInstruction(mb, p);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.delta",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, j) = d->o;
+				pushInstruction(mb, r);
+				freeInstruction(mb, p);
+				done = 1;
+				break;
+			} else if (!d->cand && getModuleId(p) == algebraRef && j == 1
+					   && ((getFunctionId(p) == thetaselectRef && p->argc == 5
+							&& getArgType(mb, p, 3) == tpe)
+						   || (getFunctionId(p) == selectRef && p->argc == 9
+							   && getArgType(mb, p, 3) == tpe
+							   && getArgType(mb, p, 4) == tpe))) {
+				/* pos = thetaselect(col, cand, v, op) |
+				 * pos = select(col, cand, l, h, li, hi, anti, unknown)
+				 * on the residuals, ie
+				 * pos = delta.thetaselect(o, cand, base, step, v, op) */
+				InstrPtr r = newInstructionArgs(mb, deltaRef, getFunctionId(p), p->argc + 2);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.delta",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = getArg(p, 0);
+				r = pushArgument(mb, r, d->o);
+				r = pushArgument(mb, r, getArg(p, 2));
+				r = pushArgument(mb, r, d->base);
+				r = pushArgument(mb, r, d->step);
+				for (int a = 3; a < p->argc; a++)
+					r = pushArgument(mb, r, getArg(p, a));
+				pushInstruction(mb, r);
+				freeInstruction(mb, p);
+				done = 1;
+				break;
+			} else if (getModuleId(p) == aggrRef && p->retc == 1 && p->argc == 2
+					   && ((getFunctionId(p) == sumRef
+							&& getArgType(mb, p, 0) == delta_sum_type(tpe))
+						   || ((getFunctionId(p) == minRef
+								|| getFunctionId(p) == maxRef)
+							   && getArgType(mb, p, 0) == tpe))) {
+				/* s = aggr.sum(col) with col = projection(cand, delta.decompress(o, base, step))
+				 * s = delta.sum(cand, o, base, step) */
+				InstrPtr r = newInstructionArgs(mb, deltaRef, getFunctionId(p), 5);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.delta",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = getArg(p, 0);
+				if (d->cand)
+					r = pushArgument(mb, r, d->cand);
+				else
+					r = pushNilBat(mb, r);
+				r = pushArgument(mb, r, d->o);
+				r = pushArgument(mb, r, d->base);
+				r = pushArgument(mb, r, d->step);
+				pushInstruction(mb, r);
+				freeInstruction(mb, p);
+				done = 1;
+				break;
+			} else {
+				/* need to decompress */
+				InstrPtr r = delta_materialize(mb, d, getArgType(mb, p, j));
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.delta",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(p, j) = getArg(r, 0);
+				actions++;
+			}
+		}
+		if (msg)
+			break;
+		if (done)
+			actions++;
+		else
+			pushInstruction(mb, p);
+	}
+
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(mb, old[i]);
+	/* Defense line against incorrect plans */
+	if (msg == MAL_SUCCEED && actions > 0) {
+		msg = chkTypes(ctx->usermodule, mb, FALSE);
+		if (!msg)
+			msg = chkFlow(mb);
+		if (!msg)
+			msg = chkDeclarations(mb);
+	}
+	/* keep all actions taken as a post block comment */
+  wrapup:
+	ma_close(&ta_state);
+  wrapup1:
+	/* keep actions taken as a fake argument */
+	(void) pushInt(mb, pci, actions);
+
+	return msg;
+}
@@ -241,7 +241,9 @@ OPTemptybindImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk,
 				emptyresult(0);
 			}
 		}
-		if (getModuleId(p) == forRef && getFunctionId(p) == decompressRef) {
+		if ((getModuleId(p) == forRef || getModuleId(p) == fsstRef
+			 || getModuleId(p) == deltaRef)
+			&& getFunctionId(p) == decompressRef) {
 			if (empty[getArg(p, 1)]) {
 				actions++;
 				emptyresult(0);
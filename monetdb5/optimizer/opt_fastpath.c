@@ -19,6 +19,8 @@
 #include "opt_dataflow.h"
 #include "opt_deadcode.h"
 #include "opt_dict.h"
+#include "opt_fsst.h"
+#include "opt_delta.h"
 #include "opt_for.h"
 #include "opt_emptybind.h"
 #include "opt_evaluate.h"
@@ -30,6 +32,7 @@
 #include "opt_postfix.h"
 #include "opt_mergetable.h"
 #include "opt_mitosis.h"
+#include "opt_morsel.h"
 #include "opt_multiplex.h"
 #include "opt_profiler.h"
 #include "opt_pushselect.h"
@@ -79,6 +82,8 @@ OPTminimalpipeImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	optcall(OPTdeadcodeImplementation);
 	optcall(OPTforImplementation);
 	optcall(OPTdictImplementation);
+	optcall(OPTfsstImplementation);
+	optcall(OPTdeltaImplementation);
 	if (multiplex)
 		optcall(OPTmultiplexImplementation);
 	if (generator)
@@ -134,16 +139,19 @@ OPTdefaultpipeImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	optcall(OPTaliasesImplementation);
 	optcall(OPTforImplementation);
 	optcall(OPTdictImplementation);
+	optcall(OPTfsstImplementation);
 	if (!no_mitosis) {
 		optcall(OPTmitosisImplementation);
 		optcall(OPTmergetableImplementation); /* depends on mitosis */
 	}
+	optcall(OPTdeltaImplementation);	/* works on the partitions */
 	optcall(OPTaliasesImplementation);
 	optcall(OPTconstantsImplementation);
 	if (!recursive)
 		optcall(OPTcommonTermsImplementation);
 	optcall(OPTprojectionpathImplementation);
 	optcall(OPTdeadcodeImplementation);
+	optcall(OPTmorselImplementation);
 	if (!no_mitosis) {
 		optcall(OPTmatpackImplementation); /* depends on mergetable */
 		optcall(OPTreorderImplementation); /* depends on mitosis */
@@ -0,0 +1,283 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#include "monetdb_config.h"
+#include "opt_fsst.h"
+
+static bool
+isNilBat(MalBlkPtr mb, int var)
+{
+	return isVarConstant(mb, var) && getVarConstant(mb, var).bat
+		&& is_bat_nil(getVarConstant(mb, var).val.bval);
+}
+
+static bool
+isEqualityOp(MalBlkPtr mb, int var)
+{
+	if (!isVarConstant(mb, var) || getVarType(mb, var) != TYPE_str)
+		return false;
+	const char *op = getVarConstant(mb, var).val.sval;
+	return strcmp(op, "==") == 0 || strcmp(op, "=") == 0 || strcmp(op, "!=") == 0;
+}
+
+str
+OPTfsstImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, k, limit, slimit;
+	InstrPtr p = 0, *old = NULL;
+	int actions = 0;
+	int *varisfsst = NULL, *varfsstvalue = NULL;
+	str msg = MAL_SUCCEED;
+	allocator *ta = MT_thread_getallocator();
+
+	(void) stk;
+
+	if (mb->inlineProp)
+		goto wrapup1;
+
+	limit = mb->stop;
+
+	for (i = 0; i < limit; i++) {
+		p = mb->stmt[i];
+		if (p && p->retc == 1 && getModuleId(p) == fsstRef
+			&& getFunctionId(p) == decompressRef) {
+			break;
+		}
+	}
+	if (i == limit)
+		goto wrapup1;			/* nothing to do */
+
+	allocator_state ta_state = ma_open(ta);
+	varisfsst = ma_zalloc(ta, 2 * mb->vtop * sizeof(int));
+	varfsstvalue = ma_zalloc(ta, 2 * mb->vtop * sizeof(int));
+	if (varisfsst == NULL || varfsstvalue == NULL)
+		goto wrapup;
+
+	slimit = mb->ssize;
+	old = mb->stmt;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		ma_close(&ta_state);
+		throw(MAL, "optimizer.fsst", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	// Consolidate the actual need for variables
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		if (p == 0)
+			continue;			//left behind by others?
+		if (p->retc == 1 && getModuleId(p) == fsstRef
+			&& getFunctionId(p) == decompressRef) {
+			// remember we have encountered a fsst decompress function
+			k = getArg(p, 0);
+			varisfsst[k] = getArg(p, 1);
+			varfsstvalue[k] = getArg(p, 2);
+			freeInstruction(mb, p);
+			continue;
+		}
+		int done = 0;
+		for (j = p->retc; j < p->argc; j++) {
+			k = getArg(p, j);
+			if (varisfsst[k]) {	// maybe we could delay this usage
+				if (getModuleId(p) == algebraRef
+					&& getFunctionId(p) == projectionRef) {
+					/* projection(cand, col) with col = fsst.decompress(o,u)
+					 * v1 = projection(cand, o)
+					 * fsst.decompress(v1, u) */
+					InstrPtr r = copyInstruction(mb, p);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					int tpe = getVarType(mb, varisfsst[k]);
+					int l = getArg(r, 0);
+					getArg(r, 0) = newTmpVariable(mb, tpe);
+					getArg(r, j) = varisfsst[k];
+					varisfsst[l] = getArg(r, 0);
+					varfsstvalue[l] = varfsstvalue[k];
+					pushInstruction(mb, r);
+					freeInstruction(mb, p);
+					done = 1;
+					break;
+				} else if (p->argc == 2 && p->retc == 1
+						   && p->barrier == ASSIGNsymbol) {
+					/* a = b */
+					int l = getArg(p, 0);
+					varisfsst[l] = varisfsst[k];
+					varfsstvalue[l] = varfsstvalue[k];
+					freeInstruction(mb, p);
+					done = 1;
+					break;
+				} else if ((getModuleId(p) == algebraRef
+							&& getFunctionId(p) == subsliceRef)
+						   || (getModuleId(p) == batRef
+							   && getFunctionId(p) == mirrorRef)
+						   || (getModuleId(p) == batcalcRef
+							   && getFunctionId(p) == identityRef)
+						   || (getModuleId(p) == aggrRef
+							   && getFunctionId(p) == countRef)
+						   || (getModuleId(p) == groupRef
+							   && (getFunctionId(p) == subgroupRef
+								   || getFunctionId(p) == subgroupdoneRef
+								   || getFunctionId(p) == groupRef
+								   || getFunctionId(p) == groupdoneRef))) {
+					/* pos = subslice(col, l, h), id = mirror/identity(col),
+					 * cnt = count(col), group.group[done](col) |
+					 * group.subgroup[done](col, grp) with
+					 * col = fsst.decompress(o,u)
+					 * the same on o, as equal strings have equal encodings */
+					InstrPtr r = copyInstruction(mb, p);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, j) = varisfsst[k];
+					pushInstruction(mb, r);
+					freeInstruction(mb, p);
+					done = 1;
+					break;
+				} else if (getModuleId(p) == algebraRef
+						   && getFunctionId(p) == thetaselectRef
+						   && p->argc == 5 && j == 1
+						   && getArgType(mb, p, 3) == TYPE_str
+						   && isEqualityOp(mb, getArg(p, 4))) {
+					/* pos = thetaselect(col, cand, v, ==) with col = fsst.decompress(o,u)
+					 * e = fsst.encode(u, v)
+					 * pos = thetaselect(o, cand, e, ==) */
+					InstrPtr q = newInstructionArgs(mb, fsstRef, encodeRef, 3);
+					if (q == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(q, 0) = newTmpVariable(mb, TYPE_blob);
+					q = pushArgument(mb, q, varfsstvalue[k]);
+					q = pushArgument(mb, q, getArg(p, 3));
+					pushInstruction(mb, q);
+
+					InstrPtr r = copyInstruction(mb, p);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, j) = varisfsst[k];
+					getArg(r, 3) = getArg(q, 0);
+					pushInstruction(mb, r);
+					freeInstruction(mb, p);
+					done = 1;
+					break;
+				} else if (getModuleId(p) == algebraRef
+						   && getFunctionId(p) == likeselectRef
+						   && p->argc == 7 && j == 1
+						   && !isNilBat(mb, getArg(p, 2))) {
+					/* pos = likeselect(col, cand, ...) with col = fsst.decompress(o,u)
+					 * v1 = projection(cand, o)
+					 * v2 = fsst.decompress(v1, u)
+					 * v3 = likeselect(v2, nil, ...)
+					 * pos = projection(v3, cand)
+					 * only the candidates are decompressed */
+					int cand = getArg(p, 2);
+					InstrPtr q = newInstructionArgs(mb, algebraRef, projectionRef, 3);
+					if (q == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(q, 0) = newTmpVariable(mb, getVarType(mb, varisfsst[k]));
+					q = pushArgument(mb, q, cand);
+					q = pushArgument(mb, q, varisfsst[k]);
+					pushInstruction(mb, q);
+
+					InstrPtr r = newInstructionArgs(mb, fsstRef, decompressRef, 3);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, 0) = newTmpVariable(mb, getArgType(mb, p, j));
+					r = pushArgument(mb, r, getArg(q, 0));
+					r = pushArgument(mb, r, varfsstvalue[k]);
+					pushInstruction(mb, r);
+
+					InstrPtr s = copyInstruction(mb, p);
+					if (s == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(s, 0) = newTmpVariable(mb, getArgType(mb, p, 0));
+					getArg(s, j) = getArg(r, 0);
+					s->argc = 2;
+					s = pushNilBat(mb, s);
+					for (int a = 3; a < p->argc; a++)
+						s = pushArgument(mb, s, getArg(p, a));
+					pushInstruction(mb, s);
+
+					InstrPtr t = newInstructionArgs(mb, algebraRef, projectionRef, 3);
+					if (t == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(t, 0) = getArg(p, 0);
+					t = pushArgument(mb, t, getArg(s, 0));
+					t = pushArgument(mb, t, cand);
+					pushInstruction(mb, t);
+					freeInstruction(mb, p);
+					done = 1;
+					break;
+				} else {
+					/* need to decompress */
+					int tpe = getArgType(mb, p, j);
+					InstrPtr r = newInstructionArgs(mb, fsstRef, decompressRef, 3);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.fsst",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, 0) = newTmpVariable(mb, tpe);
+					r = pushArgument(mb, r, varisfsst[k]);
+					r = pushArgument(mb, r, varfsstvalue[k]);
+					pushInstruction(mb, r);
+
+					getArg(p, j) = getArg(r, 0);
+					actions++;
+				}
+			}
+		}
+		if (msg)
+			break;
+		if (done)
+			actions++;
+		else
+			pushInstruction(mb, p);
+	}
+
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(mb, old[i]);
+	/* Defense line against incorrect plans */
+	if (msg == MAL_SUCCEED && actions > 0) {
+		msg = chkTypes(ctx->usermodule, mb, FALSE);
+		if (!msg)
+			msg = chkFlow(mb);
+		if (!msg)
+			msg = chkDeclarations(mb);
+	}
+	/* keep all actions taken as a post block comment */
+  wrapup:
+	ma_close(&ta_state);
+  wrapup1:
+	/* keep actions taken as a fake argument */
+	(void) pushInt(mb, pci, actions);
+
+	return msg;
+}
@@ -2681,7 +2681,8 @@ OPTmergetableImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk,
 		if (match > 0
 			&&
 			((getModuleId(p) == algebraRef && getFunctionId(p) == projectionRef)
-			 || ((getModuleId(p) == dictRef || getModuleId(p) == forRef)
+			 || ((getModuleId(p) == dictRef || getModuleId(p) == forRef
+				  || getModuleId(p) == fsstRef || getModuleId(p) == deltaRef)
 				 && getFunctionId(p) == decompressRef))
 			&& (m = is_a_mat(getArg(p, 1), &ml)) >= 0) {
 			n = is_a_mat(getArg(p, 2), &ml);
@@ -2696,7 +2697,8 @@ OPTmergetableImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk,
 		/* Handle setops */
 		if (match > 0 && getModuleId(p) == algebraRef
 			&& (getFunctionId(p) == differenceRef
-				|| getFunctionId(p) == intersectRef)
+				|| getFunctionId(p) == intersectRef
+				|| getFunctionId(p) == bloomfilterRef)
 			&& (m = is_a_mat(getArg(p, 1), &ml)) >= 0) {
 			n = is_a_mat(getArg(p, 2), &ml);
 			o = is_a_mat(getArg(p, 3), &ml);
@@ -0,0 +1,277 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/* The morsel optimizer looks for selections whose only purpose is to
+ * feed simple aggregates, i.e. the pattern
+ *
+ *	C := algebra.thetaselect(b, s, val, op);
+ *	Y1 := algebra.projection(C, Z1);
+ *	A1 := aggr.sum(Y1);
+ *	...
+ *	N := aggr.count(C);
+ *
+ * where C and the projections are not used anywhere else.  Such a
+ * chain materializes the complete candidate list and all projected
+ * columns, only to reduce them to a single value.  The chain is
+ * replaced by
+ *
+ *	(A1, ..., N) := algebra.thetaselectaggr(b, s, val, op, "sum", Z1, ..., "count", b);
+ *
+ * which works through the candidates in cache-sized morsels, so that
+ * the intermediates never leave the cache.  After mitosis this is done
+ * for each partition separately, i.e. on each worker.
+ */
+#include "monetdb_config.h"
+#include "opt_morsel.h"
+
+typedef struct {
+	const char *aggr;			/* "count", "sum", "min", "max" */
+	int res;					/* result variable */
+	int col;					/* column to aggregate */
+} morselaggr;
+
+/* Return the name of the aggregate if q is a simple aggregate on a
+ * single (bat) argument that we can handle, else NULL. */
+static const char *
+simpleAggr(MalBlkPtr mb, InstrPtr q)
+{
+	if (getModuleId(q) != aggrRef || q->retc != 1 || q->argc != 2 ||
+		!isaBatType(getArgType(mb, q, 1)) ||
+		ATOMvarsized(getBatType(getArgType(mb, q, 1))) ||
+		ATOMvarsized(getArgType(mb, q, 0)))
+		return NULL;
+	if (getFunctionId(q) == countRef)
+		return "count";
+	if (getFunctionId(q) == sumRef)
+		return "sum";
+	if (getFunctionId(q) == minRef)
+		return "min";
+	if (getFunctionId(q) == maxRef)
+		return "max";
+	return NULL;
+}
+
+str
+OPTmorselImplementation(Client ctx, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, limit, slimit, actions = 0;
+	InstrPtr p, q, *old = NULL, *fused = NULL;
+	int *uses = NULL, *firstuse = NULL, *defpc = NULL, *rmpcs = NULL;
+	int *fusedpc = NULL;
+	bool *removed = NULL;
+	morselaggr *aggrs = NULL;
+	str msg = MAL_SUCCEED;
+	allocator *ta = MT_thread_getallocator();
+
+	(void) stk;
+
+	if (mb->inlineProp)
+		goto wrapup1;
+
+	limit = mb->stop;
+	for (i = 0; i < limit; i++) {
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) == algebraRef && getFunctionId(p) == thetaselectRef)
+			break;
+	}
+	if (i == limit)
+		goto wrapup1;			/* nothing to do */
+
+	allocator_state ta_state = ma_open(ta);
+	uses = ma_zalloc(ta, mb->vtop * sizeof(int));
+	firstuse = ma_zalloc(ta, mb->vtop * sizeof(int));
+	defpc = ma_zalloc(ta, mb->vtop * sizeof(int));
+	removed = ma_zalloc(ta, limit * sizeof(bool));
+	fused = ma_zalloc(ta, limit * sizeof(InstrPtr));
+	fusedpc = ma_alloc(ta, limit * sizeof(int));
+	aggrs = ma_alloc(ta, limit * sizeof(morselaggr));
+	rmpcs = ma_alloc(ta, limit * sizeof(int));
+	if (uses == NULL || firstuse == NULL || defpc == NULL ||
+		removed == NULL || fused == NULL || fusedpc == NULL ||
+		aggrs == NULL || rmpcs == NULL) {
+		msg = createException(MAL, "optimizer.morsel",
+							  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	for (i = 0; i < limit; i++) {
+		p = getInstrPtr(mb, i);
+		for (j = 0; j < p->retc; j++)
+			defpc[getArg(p, j)] = i;
+		for (j = p->retc; j < p->argc; j++) {
+			int v = getArg(p, j);
+			if (uses[v]++ == 0)
+				firstuse[v] = i;
+		}
+	}
+
+	for (i = 0; i < limit; i++) {
+		int cand, naggr = 0, nrm = 0, pos, nuses = 0, nproj = 0;
+		bool ok = true;
+
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) != algebraRef ||
+			getFunctionId(p) != thetaselectRef || p->retc != 1 ||
+			p->argc != 5 || removed[i])
+			continue;
+		cand = getArg(p, 0);
+		if (uses[cand] == 0)
+			continue;
+		rmpcs[nrm++] = i;
+		/* find all uses of the selection, they should all be
+		 * (indirect) simple aggregates */
+		for (j = i + 1; j < limit && nuses < uses[cand]; j++) {
+			const char *aggr;
+			int k;
+
+			if (removed[j])
+				continue;		/* part of an earlier chain */
+			q = getInstrPtr(mb, j);
+			if (q->barrier) {
+				ok = false;
+				break;
+			}
+			for (k = q->retc; k < q->argc; k++)
+				if (getArg(q, k) == cand)
+					break;
+			if (k == q->argc)
+				continue;
+			nuses++;
+			if ((aggr = simpleAggr(mb, q)) != NULL && strcmp(aggr, "count") == 0) {
+				/* N := aggr.count(C) */
+				aggrs[naggr++] = (morselaggr) {
+					.aggr = aggr,
+					.res = getArg(q, 0),
+					.col = getArg(p, 1),
+				};
+				rmpcs[nrm++] = j;
+				continue;
+			}
+			if (getModuleId(q) != algebraRef ||
+				getFunctionId(q) != projectionRef || q->retc != 1 ||
+				q->argc != 3 || getArg(q, 1) != cand ||
+				getArg(q, 2) == cand ||
+				uses[getArg(q, 0)] != 1) {
+				ok = false;
+				break;
+			}
+			/* Y := algebra.projection(C, Z); A := aggr.xxx(Y) */
+			int y = getArg(q, 0), l;
+			InstrPtr r = NULL;
+			for (l = j + 1; l < limit; l++) {
+				r = getInstrPtr(mb, l);
+				if (r->barrier) {
+					l = limit;
+					break;
+				}
+				if (r->argc == 2 && r->retc == 1 && getArg(r, 1) == y)
+					break;
+			}
+			if (l == limit || (aggr = simpleAggr(mb, r)) == NULL) {
+				ok = false;
+				break;
+			}
+			aggrs[naggr++] = (morselaggr) {
+				.aggr = aggr,
+				.res = getArg(r, 0),
+				.col = getArg(q, 2),
+			};
+			rmpcs[nrm++] = j;
+			rmpcs[nrm++] = l;
+			if (strcmp(aggr, "count") != 0)
+				nproj++;
+		}
+		if (!ok || nuses != uses[cand] || nproj == 0)
+			continue;
+		/* the results are produced as soon as all columns are
+		 * available, so they can't be used before that */
+		pos = i;
+		for (j = 0; j < naggr; j++)
+			if (defpc[aggrs[j].col] > pos)
+				pos = defpc[aggrs[j].col];
+		for (j = 0; j < naggr; j++) {
+			if (uses[aggrs[j].res] > 0 && firstuse[aggrs[j].res] <= pos) {
+				ok = false;
+				break;
+			}
+		}
+		if (!ok)
+			continue;
+
+		q = newInstructionArgs(mb, algebraRef, thetaselectaggrRef,
+							   3 * naggr + 4);
+		if (q == NULL) {
+			msg = createException(MAL, "optimizer.morsel",
+								  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			goto bailout;
+		}
+		getArg(q, 0) = aggrs[0].res;
+		for (j = 1; j < naggr; j++)
+			q = pushReturn(mb, q, aggrs[j].res);
+		for (j = 1; j < 5; j++)
+			q = pushArgument(mb, q, getArg(p, j));
+		for (j = 0; j < naggr; j++) {
+			q = pushStr(mb, q, aggrs[j].aggr);
+			q = pushArgument(mb, q, aggrs[j].col);
+		}
+		if (mb->errors) {
+			freeInstruction(mb, q);
+			msg = mb->errors;
+			mb->errors = NULL;
+			goto bailout;
+		}
+		/* remove the selection, the projections and the aggregates */
+		for (j = 0; j < nrm; j++)
+			removed[rmpcs[j]] = true;
+		fused[actions] = q;
+		fusedpc[actions] = pos;
+		actions++;
+	}
+
+	if (actions == 0)
+		goto wrapup;
+
+	slimit = mb->ssize;
+	old = mb->stmt;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		msg = createException(MAL, "optimizer.morsel",
+							  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (i = 0; i < limit; i++) {
+		if (removed[i])
+			freeInstruction(mb, old[i]);
+		else
+			pushInstruction(mb, old[i]);
+		for (j = 0; j < actions; j++)
+			if (fusedpc[j] == i)
+				pushInstruction(mb, fused[j]);
+	}
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(mb, old[i]);
+
+	/* Defense line against incorrect plans */
+	msg = chkTypes(ctx->usermodule, mb, FALSE);
+	if (!msg)
+		msg = chkFlow(mb);
+	if (!msg)
+		msg = chkDeclarations(mb);
+	goto wrapup;
+
+  bailout:
+	for (i = 0; i < actions; i++)
+		freeInstruction(mb, fused[i]);
+  wrapup:
+	ma_close(&ta_state);
+  wrapup1:
+	/* keep actions taken as a fake argument */
+	(void) pushInt(mb, pci, actions);
+	return msg;
+}
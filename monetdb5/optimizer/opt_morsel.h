@@ -0,0 +1,20 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _OPT_MORSEL_
+#define _OPT_MORSEL_
+#include "opt_support.h"
+#include "mal_builder.h"
+#include "mal_exception.h"
+
+extern str OPTmorselImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
+								   InstrPtr p);
+
+#endif
@@ -40,8 +40,11 @@
 #include "opt_postfix.h"
 #include "opt_for.h"
 #include "opt_dict.h"
+#include "opt_fsst.h"
+#include "opt_delta.h"
 #include "opt_mergetable.h"
 #include "opt_mitosis.h"
+#include "opt_morsel.h"
 #include "opt_multiplex.h"
 #include "opt_profiler.h"
 #include "opt_pushselect.h"
@@ -78,12 +81,15 @@ static const struct {
 	{"emptybind", &OPTemptybindImplementation},
 	{"evaluate", &OPTevaluateImplementation},
 	{"for", &OPTforImplementation},
+	{"fsst", &OPTfsstImplementation},
+	{"delta", &OPTdeltaImplementation},
 	{"garbageCollector", &OPTgarbageCollectorImplementation},
 	{"generator", &OPTgeneratorImplementation},
 	{"inline", &OPTinlineImplementation},
 	{"matpack", &OPTmatpackImplementation},
 	{"mergetable", &OPTmergetableImplementation},
 	{"mitosis", &OPTmitosisImplementation},
+	{"morsel", &OPTmorselImplementation},
 	{"multiplex", &OPTmultiplexImplementation},
 	{"postfix", &OPTpostfixImplementation},
 	{"profiler", &OPTprofilerImplementation},
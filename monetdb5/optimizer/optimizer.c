@@ -70,6 +70,8 @@ static mel_func optimizer_init_funcs[] = {
 	optwrapper_pattern("inline", "Expand inline functions"),
 	optwrapper_pattern("projectionpath", "Join path constructor"),
 	optwrapper_pattern("mergetable", "Resolve the multi-table definitions"),
+	optwrapper_pattern("morsel",
+					   "Fuse selections feeding simple aggregates into cache-sized morsels"),
 	optwrapper_pattern("mitosis",
 					   "Modify the plan to exploit parallel processing on multiple cores"),
 	optwrapper_pattern("multiplex", "Compiler for multiplexed instructions"),
@@ -84,6 +86,8 @@ static mel_func optimizer_init_funcs[] = {
 	optwrapper_pattern("strimps", "Use strimps index if appropriate"),
 	optwrapper_pattern("for", "Push for decompress down"),
 	optwrapper_pattern("dict", "Push dict decompress down"),
+	optwrapper_pattern("fsst", "Push fsst decompress down"),
+	optwrapper_pattern("delta", "Push delta decompress down"),
 	{.imp = NULL}
 };
 
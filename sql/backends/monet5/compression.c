@@ -0,0 +1,507 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/* The compression advisor estimates for every column of the persistent
+ * user tables the size after 'dict' and 'for' compression, using the
+ * column statistics (number of unique values, min and max), and advises
+ * the smallest when it at least halves the size of the column, ie the
+ * bytes a scan has to read.
+ *
+ * The decisions are kept in memory and are shown by the
+ * sys.compression_advice view.  sys.compression_advisor(true) compresses
+ * all advised columns at once, sys.auto_compression(interval) registers a
+ * background callback which, when the server is idle, compresses the
+ * advised columns of the tables which had no commits since the previous
+ * pass (ie the cold columns), each in its own transaction. */
+
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+#include "gdk_time.h"
+
+#include "compression.h"
+#include "dict.h"
+#include "for.h"
+
+#define ADVISOR_MIN_ROWS	4096	/* smaller columns are not worth it */
+#define ADVISOR_IDLE_TIME	10		/* in seconds without active transactions */
+
+typedef enum advice {
+	ADVICE_NONE,
+	ADVICE_DICT,
+	ADVICE_FOR
+} advice;
+
+static const char *advice_names[] = { "none", "dict", "for" };
+
+typedef struct decision {
+	sqlid tid;
+	sqlid cid;
+	lng rows;
+	lng uniques;
+	lng size;
+	lng compressed_size;
+	advice advice;
+	bool applied;
+	int stable;					/* passes without changes of the column */
+	ulng changed;				/* commit time of the last change of the table */
+	int pass;
+	timestamp advised;
+	char reason[128];
+} decision;
+
+static MT_Lock advisor_lock = MT_LOCK_INITIALIZER(advisor_lock);
+static decision *decisions = NULL;
+static int nr_decisions = 0, sz_decisions = 0, nr_passes = 0;
+
+/* call with the advisor_lock set */
+static decision *
+find_decision(sqlid cid, bool create)
+{
+	for (int i = 0; i < nr_decisions; i++)
+		if (decisions[i].cid == cid)
+			return decisions + i;
+	if (!create)
+		return NULL;
+	if (nr_decisions == sz_decisions) {
+		int sz = sz_decisions ? sz_decisions * 2 : 256;
+		decision *nd = GDKrealloc(decisions, sz * sizeof(decision));
+		if (!nd)
+			return NULL;
+		decisions = nd;
+		sz_decisions = sz;
+	}
+	decisions[nr_decisions] = (decision) { .cid = cid, .stable = -1, };
+	return decisions + nr_decisions++;
+}
+
+static void
+advise_column(sql_trans *tr, sql_column *c, decision *d)
+{
+	sqlstore *store = tr->store;
+	BAT *b;
+	lng size, best;
+	advice adv = ADVICE_NONE;
+
+	if (c->storage_type) {
+		/* keep the decision which compressed it */
+		if (!d->applied) {
+			d->advice = ADVICE_NONE;
+			d->advised = timestamp_current();
+			d->compressed_size = d->size;
+			snprintf(d->reason, sizeof(d->reason), "already compressed");
+		}
+		return;
+	}
+	d->advice = ADVICE_NONE;
+	d->applied = false;
+	d->advised = timestamp_current();
+	if (!(b = store->storage_api.bind_col(tr, c, RDONLY))) {
+		snprintf(d->reason, sizeof(d->reason), "cannot access column");
+		return;
+	}
+
+	BATiter bi = bat_iterator(b);
+	lng rows = (lng) bi.count;
+	/* a column is cold when its table had no commits since the previous
+	 * pass, updates and deletes included (0 when we cannot tell) */
+	ulng changed = store->storage_api.commit_ts_tab(tr, c->t);
+	d->stable = changed && d->changed == changed ? d->stable + 1 : 0;
+	d->changed = changed;
+	d->rows = rows;
+	size = best = rows * bi.width + (bi.vh ? (lng) bi.vh->free : 0);
+	d->size = d->compressed_size = size;
+	if (rows < ADVISOR_MIN_ROWS) {
+		bat_iterator_end(&bi);
+		bat_destroy(b);
+		d->uniques = 0;
+		snprintf(d->reason, sizeof(d->reason), "too few rows");
+		return;
+	}
+
+	bool nonil = false, unique = false;
+	double unique_est = 0.0;
+	ValRecord min, max;
+	int ok = sql_trans_col_stats(tr, c, &nonil, &unique, &unique_est, &min, &max);
+	lng uniques = unique ? rows : (lng) unique_est;
+	if (uniques == 0)
+		uniques = (lng) BATguess_uniques(b, NULL);
+	d->uniques = uniques;
+
+	/* dict: offsets into the unique values, kept next to the original heap */
+	if (uniques < 65536) {
+		lng dsize = rows * (uniques < 256 ? 1 : 2) + uniques * bi.width + (bi.vh ? (lng) bi.vh->free : 0);
+		if (dsize < best) {
+			best = dsize;
+			adv = ADVICE_DICT;
+		}
+	}
+	/* for: offsets from the minimum, only not null bigint columns */
+	if (bi.type == TYPE_lng && !c->null) {
+		lng mn = lng_nil, mx = lng_nil;
+		if ((ok & 3) == 3) {
+			mn = min.val.lval;
+			mx = max.val.lval;
+		} else {
+			ptr pmn = BATmin(b, NULL), pmx = BATmax(b, NULL);
+			if (pmn && pmx) {
+				mn = *(lng *) pmn;
+				mx = *(lng *) pmx;
+			}
+			GDKfree(pmn);
+			GDKfree(pmx);
+		}
+		if (!is_lng_nil(mn) && !is_lng_nil(mx) && (mx < 0 || mn >= 0 || mx <= GDK_lng_max + mn) &&
+			mx - mn <= GDK_sht_max) {
+			lng fsize = rows * ((mx - mn) < GDK_bte_max / 2 ? 1 : 2);
+			if (fsize < best) {
+				best = fsize;
+				adv = ADVICE_FOR;
+			}
+		}
+	}
+	if (ok & 1)
+		VALclear(&min);
+	if (ok & 2)
+		VALclear(&max);
+	bat_iterator_end(&bi);
+	bat_destroy(b);
+
+	d->compressed_size = best;
+	if (adv == ADVICE_NONE) {
+		snprintf(d->reason, sizeof(d->reason), "no smaller encoding");
+	} else if (best * 2 > size) {
+		snprintf(d->reason, sizeof(d->reason), "%s saves only %d%%", advice_names[adv], (int) (100 - best * 100 / size));
+	} else {
+		d->advice = adv;
+		snprintf(d->reason, sizeof(d->reason), "%s saves %d%%", advice_names[adv], (int) (100 - best * 100 / size));
+	}
+}
+
+/* collects the decisions for all columns of the persistent user tables,
+ * returns the columns to compress (only the cold ones if requested) */
+static str
+advisor_analyze(sql_trans *tr, bool cold, sqlid **cols, int *ncols)
+{
+	struct os_iter si;
+	int pass, n = 0, sz = 0;
+	sqlid *res = NULL;
+
+	MT_lock_set(&advisor_lock);
+	pass = ++nr_passes;
+	MT_lock_unset(&advisor_lock);
+
+	os_iterator(&si, tr->cat->schemas, tr, NULL);
+	for (sql_base *b = oi_next(&si); b; b = oi_next(&si)) {
+		sql_schema *s = (sql_schema *) b;
+		struct os_iter oi;
+
+		if (b->name[0] == '%' || !s->tables)
+			continue;
+		os_iterator(&oi, s->tables, tr, NULL);
+		for (sql_base *bt = oi_next(&oi); bt; bt = oi_next(&oi)) {
+			sql_table *t = (sql_table *) bt;
+
+			if (!isTable(t) || isTempTable(t) || t->system)
+				continue;
+			for (node *ncol = ol_first_node(t->columns); ncol; ncol = ncol->next) {
+				sql_column *c = ncol->data;
+				decision d;
+
+				MT_lock_set(&advisor_lock);
+				decision *p = find_decision(c->base.id, true);
+				if (p)
+					d = *p;
+				MT_lock_unset(&advisor_lock);
+				if (!p) {
+					GDKfree(res);
+					throw(SQL, "sql.compression_advisor", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				}
+				d.tid = t->base.id;
+				d.pass = pass;
+				advise_column(tr, c, &d);
+				MT_lock_set(&advisor_lock);
+				if ((p = find_decision(c->base.id, true)) != NULL)
+					*p = d;
+				MT_lock_unset(&advisor_lock);
+
+				if (d.advice != ADVICE_NONE && !d.applied && (!cold || d.stable > 0)) {
+					if (n == sz) {
+						sz = sz ? sz * 2 : 64;
+						sqlid *nres = GDKrealloc(res, sz * sizeof(sqlid) * 2);
+						if (!nres) {
+							GDKfree(res);
+							throw(SQL, "sql.compression_advisor", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						}
+						res = nres;
+					}
+					res[2 * n] = t->base.id;
+					res[2 * n + 1] = c->base.id;
+					n++;
+				}
+			}
+		}
+	}
+
+	/* forget the dropped columns */
+	MT_lock_set(&advisor_lock);
+	for (int i = 0; i < nr_decisions; ) {
+		if (decisions[i].pass != pass)
+			decisions[i] = decisions[--nr_decisions];
+		else
+			i++;
+	}
+	MT_lock_unset(&advisor_lock);
+	*cols = res;
+	*ncols = n;
+	return MAL_SUCCEED;
+}
+
+static str
+advisor_apply(sql_trans *tr, sqlid tid, sqlid cid)
+{
+	sql_table *t = sql_trans_find_table(tr, tid);
+	sql_column *c = NULL;
+	advice adv = ADVICE_NONE;
+	str msg = MAL_SUCCEED;
+
+	if (t) {
+		for (node *n = ol_first_node(t->columns); n && !c; n = n->next) {
+			sql_column *nc = n->data;
+			if (nc->base.id == cid)
+				c = nc;
+		}
+	}
+	MT_lock_set(&advisor_lock);
+	decision *d = find_decision(cid, false);
+	if (d)
+		adv = d->advice;
+	MT_lock_unset(&advisor_lock);
+	if (!c || c->storage_type || adv == ADVICE_NONE)
+		return MAL_SUCCEED;
+
+	if (adv == ADVICE_DICT)
+		msg = DICTcompress_column(tr, c, false);
+	else
+		msg = FORcompress_column(tr, c);
+
+	MT_lock_set(&advisor_lock);
+	if ((d = find_decision(cid, false)) != NULL) {
+		if (msg) {
+			const char *m = strchr(msg, '!');
+			snprintf(d->reason, sizeof(d->reason), "%s", m ? m + 1 : msg);
+		} else {
+			d->applied = true;
+			d->advised = timestamp_current();
+		}
+	}
+	MT_lock_unset(&advisor_lock);
+	return msg;
+}
+
+str
+COMPRESSIONadvisor(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	bit apply = *getArgReference_bit(stk, pci, 1);
+	mvc *m = NULL;
+	str msg;
+	sqlid *cols = NULL;
+	int ncols = 0;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if ((msg = advisor_analyze(m->session->tr, false, &cols, &ncols)) != NULL)
+		return msg;
+	if (apply == TRUE) {
+		for (int i = 0; i < ncols && !msg; i++)
+			msg = advisor_apply(m->session->tr, cols[2 * i], cols[2 * i + 1]);
+	}
+	GDKfree(cols);
+	return msg;
+}
+
+static gdk_return
+compression_callback(int argc, void *argv[])
+{
+	sqlstore *store = (sqlstore *) argv[0];
+	allocator *sa = MT_thread_getallocator();
+	allocator_state sa_state;
+	sql_session *session = NULL;
+	sqlid *cols = NULL;
+	int ncols = 0;
+	str msg;
+
+	(void) argc;
+	/* only when idle */
+	if (ATOMIC_GET(&store->nr_active) > 0 ||
+		(lng) ATOMIC_GET(&store->lastactive) + ADVISOR_IDLE_TIME * LL_CONSTANT(1000000) > GDKusec())
+		return GDK_SUCCEED;
+
+	sa_state = ma_open(sa);
+	if ((session = sql_session_create(store, sa, 0)) == NULL) {
+		TRC_ERROR(SQL_EXECUTION, "[compression_callback] -- Failed to create session!");
+		ma_close(&sa_state);
+		return GDK_FAIL;
+	}
+	if (sql_trans_begin(session) < 0) {
+		TRC_ERROR(SQL_EXECUTION, "[compression_callback] -- Failed to begin transaction!");
+		sql_session_destroy(session);
+		ma_close(&sa_state);
+		return GDK_FAIL;
+	}
+	msg = advisor_analyze(session->tr, true, &cols, &ncols);
+	(void) sql_trans_end(session, SQL_OK);
+	if (msg)
+		TRC_ERROR(SQL_EXECUTION, "[compression_callback] -- %s", msg);
+
+	/* every column in its own transaction, stop as soon as other work comes in */
+	for (int i = 0; i < ncols && !msg; i++) {
+		if (ATOMIC_GET(&store->nr_active) > 0 || GDKexiting())
+			break;
+		if (sql_trans_begin(session) < 0)
+			break;
+		if ((msg = advisor_apply(session->tr, cols[2 * i], cols[2 * i + 1])) != MAL_SUCCEED) {
+			(void) sql_trans_end(session, SQL_ERR);
+			msg = MAL_SUCCEED;
+		} else if (sql_trans_end(session, SQL_OK) != SQL_OK) {
+			MT_lock_set(&advisor_lock);
+			decision *d = find_decision(cols[2 * i + 1], false);
+			if (d) {
+				d->applied = false;
+				snprintf(d->reason, sizeof(d->reason), "transaction conflict");
+			}
+			MT_lock_unset(&advisor_lock);
+		}
+	}
+	GDKfree(cols);
+	sql_session_destroy(session);
+	ma_close(&sa_state);
+	return GDK_SUCCEED;
+}
+
+str
+COMPRESSIONauto(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int interval = *getArgReference_int(stk, pci, 1); // in sec
+	mvc *m = NULL;
+	str msg;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (is_int_nil(interval) || interval <= 0)
+		throw(SQL, "sql.auto_compression", SQLSTATE(42000) "The interval must be a positive number of seconds");
+
+	void *argv[1] = {m->store};
+	if (gdk_add_callback("compression_advisor", compression_callback, 1, argv, interval) != GDK_SUCCEED)
+		throw(SQL, "sql.auto_compression", "adding compression advisor callback failed!");
+	return MAL_SUCCEED;
+}
+
+str
+COMPRESSIONstop_auto(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	mvc *m = NULL;
+	str msg;
+
+	(void) stk;
+	(void) pci;
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (gdk_remove_callback("compression_advisor", NULL) != GDK_SUCCEED)
+		throw(SQL, "sql.stop_auto_compression", "removing compression advisor callback failed!");
+	return MAL_SUCCEED;
+}
+
+str
+COMPRESSIONadvice(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *col, *rows, *uniques, *size, *csize, *adv, *applied, *reason, *advised;
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	MT_lock_set(&advisor_lock);
+	col = COLnew(0, TYPE_int, nr_decisions, TRANSIENT);
+	rows = COLnew(0, TYPE_lng, nr_decisions, TRANSIENT);
+	uniques = COLnew(0, TYPE_lng, nr_decisions, TRANSIENT);
+	size = COLnew(0, TYPE_lng, nr_decisions, TRANSIENT);
+	csize = COLnew(0, TYPE_lng, nr_decisions, TRANSIENT);
+	adv = COLnew(0, TYPE_str, nr_decisions, TRANSIENT);
+	applied = COLnew(0, TYPE_bit, nr_decisions, TRANSIENT);
+	reason = COLnew(0, TYPE_str, nr_decisions, TRANSIENT);
+	advised = COLnew(0, TYPE_timestamp, nr_decisions, TRANSIENT);
+	if (col == NULL || rows == NULL || uniques == NULL || size == NULL || csize == NULL ||
+		adv == NULL || applied == NULL || reason == NULL || advised == NULL) {
+		msg = createException(SQL, "sql.compression_advice", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (int i = 0; i < nr_decisions; i++) {
+		decision *d = decisions + i;
+		bit a = d->applied;
+
+		if (BUNappend(col, &d->cid, false) != GDK_SUCCEED ||
+			BUNappend(rows, &d->rows, false) != GDK_SUCCEED ||
+			BUNappend(uniques, &d->uniques, false) != GDK_SUCCEED ||
+			BUNappend(size, &d->size, false) != GDK_SUCCEED ||
+			BUNappend(csize, &d->compressed_size, false) != GDK_SUCCEED ||
+			BUNappend(adv, advice_names[d->advice], false) != GDK_SUCCEED ||
+			BUNappend(applied, &a, false) != GDK_SUCCEED ||
+			BUNappend(reason, d->reason, false) != GDK_SUCCEED ||
+			BUNappend(advised, &d->advised, false) != GDK_SUCCEED) {
+			msg = createException(SQL, "sql.compression_advice", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	MT_lock_unset(&advisor_lock);
+
+	*getArgReference_bat(stk, pci, 0) = col->batCacheid;
+	BBPkeepref(col);
+	*getArgReference_bat(stk, pci, 1) = rows->batCacheid;
+	BBPkeepref(rows);
+	*getArgReference_bat(stk, pci, 2) = uniques->batCacheid;
+	BBPkeepref(uniques);
+	*getArgReference_bat(stk, pci, 3) = size->batCacheid;
+	BBPkeepref(size);
+	*getArgReference_bat(stk, pci, 4) = csize->batCacheid;
+	BBPkeepref(csize);
+	*getArgReference_bat(stk, pci, 5) = adv->batCacheid;
+	BBPkeepref(adv);
+	*getArgReference_bat(stk, pci, 6) = applied->batCacheid;
+	BBPkeepref(applied);
+	*getArgReference_bat(stk, pci, 7) = reason->batCacheid;
+	BBPkeepref(reason);
+	*getArgReference_bat(stk, pci, 8) = advised->batCacheid;
+	BBPkeepref(advised);
+	return MAL_SUCCEED;
+
+  bailout:
+	MT_lock_unset(&advisor_lock);
+	BBPreclaim(col);
+	BBPreclaim(rows);
+	BBPreclaim(uniques);
+	BBPreclaim(size);
+	BBPreclaim(csize);
+	BBPreclaim(adv);
+	BBPreclaim(applied);
+	BBPreclaim(reason);
+	BBPreclaim(advised);
+	return msg;
+}
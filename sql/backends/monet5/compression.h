@@ -0,0 +1,21 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _COMPRESSION_H
+#define _COMPRESSION_H
+
+#include "sql.h"
+
+extern str COMPRESSIONadvisor(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str COMPRESSIONauto(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str COMPRESSIONstop_auto(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str COMPRESSIONadvice(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+#endif /* _COMPRESSION_H */
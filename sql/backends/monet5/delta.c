@@ -0,0 +1,1029 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * Delta compression of integer columns.
+ *
+ * Sequential keys, timestamps and other slowly changing integer columns
+ * are stored as the residual against a linear model of the row position,
+ * ie the value at position p is base + step * p + r.  The residuals are
+ * small and stored in a bte, sht or (for lng columns) int column.  A
+ * chain of differences between neighbouring rows would compress a bit
+ * better, but the storage needs a value per row that can be decoded on
+ * its own: appends may fill holes of deleted rows and the parallel
+ * plans work on slices of the column.
+ *
+ * All arithmetic is done modulo the width of the column type, so any
+ * model can be decoded exactly.  The model (base and step) is kept in
+ * the storage type of the column, "DELTA-<base>-<step>".
+ *
+ * Dates and timestamps are bit fields of the year, month, day (and time
+ * of day), which jump at the end of every month (and day).  Their model
+ * is of the number of days, or microseconds, since the epoch instead,
+ * the residuals are encoded from and decoded to that linear scale.
+ *
+ * Selections and the sum, min and max aggregates are evaluated on the
+ * residuals.  For dense candidates the model gives bounds for a block of
+ * rows, such that blocks are accepted or skipped as a whole.
+ */
+
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+
+#include "delta.h"
+
+#define DELTA_BLOCK 1024		/* positions per block */
+
+#define DELTA_VAL(TPE, UTPE, base, step, p, r)							\
+	((TPE) ((UTPE) (base) + (UTPE) (step) * (UTPE) (p) + (UTPE) (r)))
+
+/* call MACRO for the value type TT (int or lng storage) and residual type RT */
+#define DELTA_DISPATCH(TT, RT, MACRO)									\
+	do {																\
+		if (ATOMstorage(TT) == TYPE_int) {								\
+			if ((RT) == TYPE_bte)										\
+				MACRO(int, unsigned int, bte, GDK_bte_max);				\
+			else														\
+				MACRO(int, unsigned int, sht, GDK_sht_max);				\
+		} else {														\
+			if ((RT) == TYPE_bte)										\
+				MACRO(lng, ulng, bte, GDK_bte_max);						\
+			else if ((RT) == TYPE_sht)									\
+				MACRO(lng, ulng, sht, GDK_sht_max);						\
+			else														\
+				MACRO(lng, ulng, int, GDK_int_max);						\
+		}																\
+	} while (0)
+
+/* the number of days or microseconds since the epoch of a date or
+ * timestamp, other values are linear already */
+static inline lng
+delta_linear(int tt, lng v)
+{
+	if (tt == TYPE_date)
+		return date_diff((date) v, timestamp_date(unixepoch));
+	if (tt == TYPE_timestamp)
+		return timestamp_diff((timestamp) v, unixepoch);
+	return v;
+}
+
+/* the date of a number of days since the epoch, the inverse of
+ * date_countdays (H. Hinnant's civil_from_days), without the loop over the
+ * months of date_add_day */
+static inline date
+delta_date(lng days)
+{
+	lng z = days + 719468;		/* days since 0000-03-01 */
+	lng era = (z >= 0 ? z : z - 146096) / 146097;
+	lng doe = z - era * 146097;
+	lng yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	lng doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	lng mp = (5 * doy + 2) / 153;
+	int m = (int) (mp < 10 ? mp + 3 : mp - 9);
+
+	return date_create((int) (yoe + era * 400 + (m <= 2)), m, (int) (doy - (153 * mp + 2) / 5 + 1));
+}
+
+static inline lng
+delta_unlinear(int tt, lng v)
+{
+	if (tt == TYPE_date)
+		return delta_date(v);
+	if (tt == TYPE_timestamp) {
+		lng days = v >= 0 ? v / DAY_USEC : -((DAY_USEC - 1 - v) / DAY_USEC);
+		return timestamp_create(delta_date(days), v - days * DAY_USEC);
+	}
+	return v;
+}
+
+static inline bool
+delta_is_linear(int tt)
+{
+	return tt != TYPE_date && tt != TYPE_timestamp;
+}
+
+/* convert the n values v decoded from the linear scale of tt back */
+static void
+delta_unlinear_values(void *v, BUN n, int tt)
+{
+	if (delta_is_linear(tt))
+		return;
+	if (ATOMstorage(tt) == TYPE_int) {
+		int *iv = v;
+		for (BUN i = 0; i < n; i++)
+			if (!is_int_nil(iv[i]))
+				iv[i] = (int) delta_unlinear(tt, iv[i]);
+	} else {
+		lng *lv = v;
+		for (BUN i = 0; i < n; i++)
+			if (!is_lng_nil(lv[i]))
+				lv[i] = delta_unlinear(tt, lv[i]);
+	}
+}
+
+static sql_column *
+get_newcolumn(sql_trans *tr, sql_column *c)
+{
+	sql_table *t = find_sql_table_id(tr, c->t->s, c->t->base.id);
+	if (t)
+		return find_sql_column(t, c->base.name);
+	return NULL;
+}
+
+/* The bounds of the values on the positions first up to last, given
+ * residuals within [-rmax, rmax].  Only when these bounds are within the
+ * domain [tmin, tmax] the (modular) values equal the model, therefore
+ * false is returned otherwise. */
+static inline bool
+delta_bounds(lng base, lng step, oid first, oid last, lng rmax, lng tmin, lng tmax, lng *mn, lng *mx)
+{
+#ifdef HAVE_HGE
+	hge f = (hge) base + (hge) step * (hge) first;
+	hge l = (hge) base + (hge) step * (hge) last;
+	hge lo = (step >= 0 ? f : l) - rmax;
+	hge hi = (step >= 0 ? l : f) + rmax;
+
+	if (lo < tmin || hi > tmax)
+		return false;
+	*mn = (lng) lo;
+	*mx = (lng) hi;
+	return true;
+#else
+	(void) base;
+	(void) step;
+	(void) first;
+	(void) last;
+	(void) rmax;
+	(void) tmin;
+	(void) tmax;
+	(void) mn;
+	(void) mx;
+	return false;
+#endif
+}
+
+#define ENCODE(TPE, UTPE, RTPE, RMAX)									\
+	do {																\
+		const TPE *restrict iv = src;									\
+		RTPE *restrict ov = dst;										\
+		for (BUN i = 0; i < cnt; i++) {									\
+			oid p = pos ? pos[i] : pos0 + i;							\
+			if (is_##TPE##_nil(iv[i]))									\
+				return false;											\
+			TPE v = lin ? iv[i] : (TPE) delta_linear(tt, iv[i]);		\
+			TPE r = (TPE) ((UTPE) v - (UTPE) base - (UTPE) step * (UTPE) p); \
+			if (r < -RMAX || r > RMAX)									\
+				return false;											\
+			ov[i] = (RTPE) r;											\
+		}																\
+	} while (0)
+
+/* encode cnt values on the positions pos (or pos0 and onwards), returns
+ * false if a value is nil or doesn't fit the residual type */
+static bool
+delta_encode(void *dst, const void *src, BUN cnt, const oid *pos, oid pos0, lng base, lng step, int tt, int rt)
+{
+	bool lin = delta_is_linear(tt);
+
+	DELTA_DISPATCH(tt, rt, ENCODE);
+	return true;
+}
+
+#define MODEL(TPE, UTPE)												\
+static void																\
+delta_model_##TPE(const TPE *v, BUN n, oid hseq, TPE step, TPE *base, ulng *span) \
+{																		\
+	TPE b = (TPE) ((UTPE) v[0] - (UTPE) step * (UTPE) hseq);			\
+	TPE rmin = 0, rmax = 0;												\
+	for (BUN i = 0; i < n; i++) {										\
+		TPE r = (TPE) ((UTPE) v[i] - (UTPE) b - (UTPE) step * (UTPE) (hseq + i)); \
+		if (r < rmin)													\
+			rmin = r;													\
+		if (r > rmax)													\
+			rmax = r;													\
+	}																	\
+	*span = (ulng) ((UTPE) rmax - (UTPE) rmin);							\
+	/* center the residuals around 0 */								\
+	*base = (TPE) ((UTPE) b + (UTPE) rmin + (UTPE) (*span / 2));		\
+}
+MODEL(int, unsigned int)
+MODEL(lng, ulng)
+
+#define FIT(TPE, UTPE)													\
+	do {																\
+		const TPE *v = Tloc(b, 0);										\
+		TPE b0, b1;														\
+		ulng s0, s1;													\
+		for (BUN i = 0; i < n; i++)										\
+			if (is_##TPE##_nil(v[i])) {									\
+				bat_destroy(l);											\
+				throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: for 'delta' compression column's cannot have NULL's"); \
+			}															\
+		/* the slope between the first and last value, or a constant */ \
+		dbl d = n > 1 ? round(((dbl) v[n - 1] - (dbl) v[0]) / (dbl) (n - 1)) : 0; \
+		TPE slope = d > (dbl) GDK_##TPE##_min && d < (dbl) GDK_##TPE##_max ? (TPE) d : 0; \
+		delta_model_##TPE(v, n, b->hseqbase, slope, &b1, &s1);			\
+		delta_model_##TPE(v, n, b->hseqbase, 0, &b0, &s0);				\
+		if (s0 <= s1) {													\
+			*base = b0;													\
+			*step = 0;													\
+			span = s0;													\
+		} else {														\
+			*base = b1;													\
+			*step = slope;												\
+			span = s1;													\
+		}																\
+	} while (0)
+
+static str
+DELTAcompress_(BAT **r, lng *base, lng *step, BAT *b, role_t role)
+{
+	int tt = ATOMstorage(b->ttype), rt;
+	BUN n = BATcount(b);
+	ulng span = 0;
+	BAT *l = NULL;
+
+	if (n == 0)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: cannot compress an empty column");
+	if (!delta_is_linear(b->ttype)) {
+		/* fit and encode the days or microseconds since the epoch */
+		if (!(l = COLnew(b->hseqbase, tt, n, TRANSIENT)))
+			throw(SQL, "delta.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		if (tt == TYPE_int) {
+			const int *iv = Tloc(b, 0);
+			int *ov = Tloc(l, 0);
+			for (BUN i = 0; i < n; i++)
+				ov[i] = (int) delta_linear(b->ttype, iv[i]);
+		} else {
+			const lng *iv = Tloc(b, 0);
+			lng *ov = Tloc(l, 0);
+			for (BUN i = 0; i < n; i++)
+				ov[i] = delta_linear(b->ttype, iv[i]);
+		}
+		BATsetcount(l, n);
+		b = l;
+	}
+	if (tt == TYPE_int)
+		FIT(int, unsigned int);
+	else
+		FIT(lng, ulng);
+
+	if (span <= 2 * GDK_bte_max)
+		rt = TYPE_bte;
+	else if (span <= 2 * GDK_sht_max)
+		rt = TYPE_sht;
+	else if (tt == TYPE_lng && span <= 2 * (ulng) GDK_int_max)
+		rt = TYPE_int;
+	else {
+		bat_destroy(l);
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: too large value spread for 'delta' compression");
+	}
+
+	BAT *o = COLnew(b->hseqbase, rt, n, role);
+	if (!o) {
+		bat_destroy(l);
+		throw(SQL, "delta.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	if (!delta_encode(Tloc(o, 0), Tloc(b, 0), n, NULL, b->hseqbase, *base, *step, tt, rt)) {
+		bat_destroy(l);
+		bat_destroy(o);
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: cannot encode the column");
+	}
+	bat_destroy(l);
+	BATsetcount(o, n);
+	BATnegateprops(o);
+	o->tnonil = true;
+	o->tnil = false;
+	*r = o;
+	return MAL_SUCCEED;
+}
+
+str
+DELTAcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)mb;
+	str msg = MAL_SUCCEED;
+	const char *sname = *getArgReference_str(stk, pci, 1);
+	const char *tname = *getArgReference_str(stk, pci, 2);
+	const char *cname = *getArgReference_str(stk, pci, 3);
+	backend *be = NULL;
+	sql_trans *tr = NULL;
+
+	if (!sname || !tname || !cname)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: invalid column name");
+	if (strNil(sname))
+		throw(SQL, "delta.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tname))
+		throw(SQL, "delta.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (strNil(cname))
+		throw(SQL, "delta.compress", SQLSTATE(42000) "Column name cannot be NULL");
+	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
+		return msg;
+	tr = be->mvc->session->tr;
+
+	sql_schema *s = find_sql_schema(tr, sname);
+	if (!s)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
+	sql_table *t = find_sql_table(tr, s, tname);
+	if (!t)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
+	if (!isTable(t))
+		throw(SQL, "delta.compress", SQLSTATE(42000) "%s '%s' is not persistent",
+			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "delta.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "delta.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+	sql_column *c = find_sql_column(t, cname);
+	if (!c)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
+	int tt = c->type.type->localtype;
+	if (ATOMstorage(tt) != TYPE_int && ATOMstorage(tt) != TYPE_lng)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "delta compress: for 'delta' compression the column must be an int or bigint (based) column");
+	if (c->storage_type)
+		throw(SQL, "delta.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
+
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o = NULL;
+	if( b == NULL)
+		throw(SQL,"delta.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+
+	lng base = 0, step = 0;
+	msg = DELTAcompress_(&o, &base, &step, b, PERSISTENT);
+	bat_destroy(b);
+	if (msg != MAL_SUCCEED)
+		return msg;
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "DELTA-" LLFMT "-" LLFMT, base, step);
+	switch (sql_trans_alter_storage(tr, c, buf)) {
+		case -1:
+			msg = createException(SQL, "delta.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			break;
+		case -2:
+		case -3:
+			msg = createException(SQL, "delta.compress", SQLSTATE(42000) "transaction conflict detected");
+			break;
+		default:
+			break;
+	}
+	if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+		msg = createException(SQL, "delta.compress", SQLSTATE(HY013) "alter_storage failed");
+	if (msg == MAL_SUCCEED) {
+		switch (store->storage_api.col_compress(tr, c, ST_DELTA, o, NULL)) {
+			case -1:
+				msg = createException(SQL, "delta.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "delta.compress", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+	}
+	bat_destroy(o);
+	return msg;
+}
+
+#define DECOMPRESS(TPE, UTPE, RTPE, RMAX)								\
+	do {																\
+		const RTPE *restrict iv = Tloc(o, 0);							\
+		TPE *restrict ov = Tloc(b, 0);									\
+		for (BUN i = 0; i < cnt; i++)									\
+			ov[i] = DELTA_VAL(TPE, UTPE, base, step, hseq + i, iv[i]);	\
+	} while (0)
+
+BAT *
+DELTAdecompress_(BAT *o, lng base, lng step, int tt, role_t role)
+{
+	BUN cnt = BATcount(o);
+	oid hseq = o->hseqbase;
+	BAT *b = COLnew(hseq, tt, cnt, role);
+
+	if (!b)
+		return NULL;
+	DELTA_DISPATCH(tt, o->ttype, DECOMPRESS);
+	delta_unlinear_values(Tloc(b, 0), cnt, tt);
+	BATsetcount(b, cnt);
+	BATnegateprops(b);
+	return b;
+}
+
+/* returns a new bat with residuals, or NULL in *noffsets if the values
+ * don't fit the model, ie the column needs to be decompressed */
+int
+DELTAprepare4append(BAT **noffsets, BAT *vals, BUN offset, BAT *offsets, lng base, lng step, int rt)
+{
+	BUN cnt = BATcount(vals);
+	const oid *pos = NULL;
+	oid pos0 = offset;
+
+	*noffsets = NULL;
+	if (ATOMstorage(vals->ttype) != TYPE_int && ATOMstorage(vals->ttype) != TYPE_lng)
+		return 0;
+	if (offsets) {
+		if (offsets->ttype == TYPE_void)
+			pos0 = offsets->tseqbase;
+		else
+			pos = Tloc(offsets, 0);
+	}
+	BAT *n = COLnew(0, rt, cnt, TRANSIENT);
+	if (!n)
+		return -1;
+	if (!delta_encode(Tloc(n, 0), Tloc(vals, 0), cnt, pos, pos0, base, step, vals->ttype, rt)) {
+		bat_destroy(n);
+		return 0;
+	}
+	BATsetcount(n, cnt);
+	BATnegateprops(n);
+	*noffsets = n;
+	return 0;
+}
+
+int
+DELTAprepare4append_vals(void **noffsets, void *vals, BUN cnt, BUN offset, BAT *offsets, lng base, lng step, int vtype, int rt)
+{
+	*noffsets = NULL;
+	void *n = GDKmalloc(cnt * ATOMsize(rt));
+	if (!n)
+		return -1;
+	if (!delta_encode(n, vals, cnt, offsets ? Tloc(offsets, 0) : NULL, offset, base, step, vtype, rt)) {
+		GDKfree(n);
+		return 0;
+	}
+	*noffsets = n;
+	return 0;
+}
+
+/* the model is passed as the base value (of the column type) and the step */
+static lng
+delta_base(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, int arg)
+{
+	if (ATOMstorage(getArgType(mb, pci, arg)) == TYPE_int)
+		return *(int *) getArgReference(stk, pci, arg);
+	return *(lng *) getArgReference(stk, pci, arg);
+}
+
+static bool
+delta_valid(MalBlkPtr mb, InstrPtr pci, int arg, BAT *o)
+{
+	int tt = ATOMstorage(getArgType(mb, pci, arg));
+
+	return (tt == TYPE_int && (o->ttype == TYPE_bte || o->ttype == TYPE_sht)) ||
+		(tt == TYPE_lng && (o->ttype == TYPE_bte || o->ttype == TYPE_sht || o->ttype == TYPE_int));
+}
+
+str
+DELTAdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	bat O = *getArgReference_bat(stk, pci, 1);
+	lng base = delta_base(mb, stk, pci, 2);
+	lng step = *getArgReference_lng(stk, pci, 3);
+
+	BAT *o = BATdescriptor(O);
+	if (!o)
+		throw(SQL, "delta.decompress", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (!delta_valid(mb, pci, 2, o)) {
+		bat_destroy(o);
+		throw(SQL, "delta.decompress", SQLSTATE(3F000) "delta decompress: invalid type");
+	}
+	BAT *b = DELTAdecompress_(o, base, step, getArgType(mb, pci, 2), TRANSIENT);
+	bat_destroy(o);
+	if (!b)
+		throw(SQL, "delta.decompress", GDK_EXCEPTION);
+	*r = b->batCacheid;
+	BBPkeepref(b);
+	return MAL_SUCCEED;
+}
+
+/* The positions to handle are given by a candidate list c, by any oid
+ * bat (with possibly nils and duplicates) or all of o if c is NULL. */
+typedef struct delta_positions {
+	struct canditer ci;
+	const oid *cv;
+	BUN cnt;
+	bool cands;
+	bool dense;
+} delta_positions;
+
+static void
+delta_positions_init(delta_positions *dp, BAT *o, BAT *c)
+{
+	dp->cv = NULL;
+	dp->dense = false;
+	if (c == NULL || c->ttype == TYPE_msk || complex_cand(c) ||
+		(c->ttype == TYPE_void && !is_oid_nil(c->tseqbase)) ||
+		(c->tsorted && c->tkey && c->tnonil)) {
+		canditer_init(&dp->ci, c ? NULL : o, c);
+		dp->cands = true;
+		dp->cnt = dp->ci.ncand;
+		dp->dense = dp->ci.tpe == cand_dense;
+	} else {
+		/* a void bat with a nil seqbase has only nils */
+		if (c->ttype != TYPE_void)
+			dp->cv = Tloc(c, 0);
+		dp->cands = false;
+		dp->cnt = BATcount(c);
+	}
+}
+
+static inline oid
+delta_position(delta_positions *dp, BUN i)
+{
+	if (dp->cands)
+		return canditer_next(&dp->ci);
+	return dp->cv ? dp->cv[i] : oid_nil;
+}
+
+#define PROJECT(TPE, UTPE, RTPE, RMAX)									\
+	do {																\
+		const RTPE *restrict iv = Tloc(o, 0);							\
+		TPE *restrict ov = Tloc(bn, 0);									\
+		for (BUN i = 0; i < dp.cnt; i++) {								\
+			oid p = delta_position(&dp, i);								\
+			if (is_oid_nil(p)) {										\
+				ov[i] = TPE##_nil;										\
+				nils = true;											\
+			} else if (p < hseq || p - hseq >= ocnt) {					\
+				goto bailout;											\
+			} else {													\
+				ov[i] = DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq]); \
+			}															\
+		}																\
+	} while (0)
+
+str
+DELTAprojection(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	bat C = *getArgReference_bat(stk, pci, 1);
+	bat O = *getArgReference_bat(stk, pci, 2);
+	int tt = getArgType(mb, pci, 3);
+	lng base = delta_base(mb, stk, pci, 3);
+	lng step = *getArgReference_lng(stk, pci, 4);
+
+	BAT *c = BATdescriptor(C);
+	BAT *o = BATdescriptor(O);
+	if (!c || !o) {
+		bat_destroy(c);
+		bat_destroy(o);
+		throw(SQL, "delta.projection", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if (!delta_valid(mb, pci, 3, o)) {
+		bat_destroy(c);
+		bat_destroy(o);
+		throw(SQL, "delta.projection", SQLSTATE(3F000) "delta projection: invalid type");
+	}
+
+	delta_positions dp;
+	oid hseq = o->hseqbase;
+	BUN ocnt = BATcount(o);
+	bool nils = false;
+	delta_positions_init(&dp, o, c);
+	BAT *bn = COLnew(c->hseqbase, tt, dp.cnt, TRANSIENT);
+	if (!bn) {
+		bat_destroy(c);
+		bat_destroy(o);
+		throw(SQL, "delta.projection", GDK_EXCEPTION);
+	}
+	DELTA_DISPATCH(tt, o->ttype, PROJECT);
+	delta_unlinear_values(Tloc(bn, 0), dp.cnt, tt);
+	bat_destroy(c);
+	bat_destroy(o);
+	BATsetcount(bn, dp.cnt);
+	BATnegateprops(bn);
+	bn->tnil = nils;
+	bn->tnonil = !nils;
+	*r = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+
+  bailout:
+	bat_destroy(c);
+	bat_destroy(o);
+	bat_destroy(bn);
+	throw(SQL, "delta.projection", SQLSTATE(42000) "delta projection: position out of range");
+}
+
+#define SELECT(TPE, UTPE, RTPE, RMAX)									\
+	do {																\
+		const RTPE *restrict iv = Tloc(o, 0);							\
+		TPE l = (TPE) lo, h = (TPE) hi;									\
+		if (ci.tpe == cand_dense) {										\
+			for (oid p = ci.seq, e = ci.seq + ci.ncand; p < e; ) {		\
+				oid be = MIN(e, p + DELTA_BLOCK);						\
+				lng mn, mx;												\
+				if (delta_bounds(base, step, p, be - 1, RMAX, GDK_##TPE##_min, GDK_##TPE##_max, &mn, &mx)) { \
+					bool all = mn >= lo && mx <= hi;					\
+					if (all || mx < lo || mn > hi) {					\
+						/* the whole block qualifies or not */			\
+						if (all != anti)								\
+							for (; p < be; p++)							\
+								rp[cnt++] = p;							\
+						p = be;											\
+						continue;										\
+					}													\
+				}														\
+				for (; p < be; p++) {									\
+					TPE v = DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq]); \
+					if ((v >= l && v <= h) != anti)						\
+						rp[cnt++] = p;									\
+				}														\
+			}															\
+		} else {														\
+			for (BUN i = 0; i < ci.ncand; i++) {						\
+				oid p = canditer_next(&ci);								\
+				TPE v = DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq]); \
+				if ((v >= l && v <= h) != anti)							\
+					rp[cnt++] = p;										\
+			}															\
+		}																\
+	} while (0)
+
+/* select the positions with a value within [lo, hi] (or outside when
+ * anti), the column doesn't contain nils */
+static BAT *
+delta_select(BAT *o, BAT *s, lng base, lng step, int tt, lng lo, lng hi, bool anti)
+{
+	struct canditer ci;
+	canditer_init(&ci, o, s);
+	bool isint = ATOMstorage(tt) == TYPE_int;
+	lng rmax = o->ttype == TYPE_bte ? GDK_bte_max : o->ttype == TYPE_sht ? GDK_sht_max : GDK_int_max;
+	lng mn, mx;
+
+	if (lo > hi && !anti)
+		return BATdense(0, 0, 0);
+	/* on sorted data most partitions qualify or not as a whole */
+	if (ci.ncand > 0 && delta_bounds(base, step, canditer_idx(&ci, 0), canditer_last(&ci), rmax,
+									 isint ? GDK_int_min : GDK_lng_min,
+									 isint ? GDK_int_max : GDK_lng_max, &mn, &mx)) {
+		bool all = mn >= lo && mx <= hi;
+		if (all || mx < lo || mn > hi)
+			return all != anti ? canditer_slice(&ci, 0, ci.ncand) : BATdense(0, 0, 0);
+	}
+
+	BAT *bn = COLnew(0, TYPE_oid, ci.ncand, TRANSIENT);
+	if (!bn)
+		return NULL;
+	oid *restrict rp = Tloc(bn, 0);
+	oid hseq = o->hseqbase;
+	BUN cnt = 0;
+
+	DELTA_DISPATCH(tt, o->ttype, SELECT);
+	BATsetcount(bn, cnt);
+	bn->tsorted = true;
+	bn->trevsorted = cnt <= 1;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	if (cnt > 1 && rp[cnt - 1] - rp[0] == cnt - 1) {
+		/* a dense result is cheaper to use as candidates */
+		oid first = rp[0];
+		bat_destroy(bn);
+		return BATdense(0, first, cnt);
+	}
+	bn->tseqbase = cnt == 0 ? 0 : cnt == 1 ? rp[0] : oid_nil;
+	return bn;
+}
+
+static str
+delta_select_args(BAT **o, BAT **s, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, const char *fname)
+{
+	bat O = *getArgReference_bat(stk, pci, 1);
+	bat S = *getArgReference_bat(stk, pci, 2);
+
+	*s = NULL;
+	if (!(*o = BATdescriptor(O)) || (!is_bat_nil(S) && !(*s = BATdescriptor(S)))) {
+		bat_destroy(*o);
+		throw(SQL, fname, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if (!delta_valid(mb, pci, 3, *o)) {
+		bat_destroy(*o);
+		bat_destroy(*s);
+		throw(SQL, fname, SQLSTATE(3F000) "delta select: invalid type");
+	}
+	return MAL_SUCCEED;
+}
+
+str
+DELTAthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	int tt = getArgType(mb, pci, 3);
+	lng base = delta_base(mb, stk, pci, 3);
+	lng step = *getArgReference_lng(stk, pci, 4);
+	lng val = delta_base(mb, stk, pci, 5);
+	const char *op = *getArgReference_str(stk, pci, 6);
+	bool isint = ATOMstorage(tt) == TYPE_int;
+	lng tmin = isint ? GDK_int_min : GDK_lng_min;
+	lng tmax = isint ? GDK_int_max : GDK_lng_max;
+	lng lo, hi;
+	bool anti = false;
+	BAT *o, *s, *bn;
+	str msg;
+
+	if ((msg = delta_select_args(&o, &s, mb, stk, pci, "delta.thetaselect")) != MAL_SUCCEED)
+		return msg;
+	val = delta_linear(tt, val);	/* the model is of the linear scale, nil stays nil */
+	if ((isint && is_int_nil((int) val)) || (!isint && is_lng_nil(val))) {
+		/* nothing equals or compares to nil */
+		lo = 1;
+		hi = 0;
+	} else if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0) {
+		lo = hi = val;
+	} else if (strcmp(op, "!=") == 0 || strcmp(op, "<>") == 0) {
+		lo = hi = val;
+		anti = true;
+	} else if (strcmp(op, "<") == 0) {
+		lo = tmin;
+		hi = val - 1;
+	} else if (strcmp(op, "<=") == 0) {
+		lo = tmin;
+		hi = val;
+	} else if (strcmp(op, ">") == 0) {
+		lo = val == tmax ? 1 : val + 1;
+		hi = val == tmax ? 0 : tmax;
+	} else if (strcmp(op, ">=") == 0) {
+		lo = val;
+		hi = tmax;
+	} else {
+		bat_destroy(o);
+		bat_destroy(s);
+		throw(SQL, "delta.thetaselect", SQLSTATE(42000) "delta thetaselect: unknown operator '%s'", op);
+	}
+	bn = delta_select(o, s, base, step, tt, lo, hi, anti);
+	bat_destroy(o);
+	bat_destroy(s);
+	if (!bn)
+		throw(SQL, "delta.thetaselect", GDK_EXCEPTION);
+	*r = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+DELTAselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	int tt = getArgType(mb, pci, 3);
+	lng base = delta_base(mb, stk, pci, 3);
+	lng step = *getArgReference_lng(stk, pci, 4);
+	lng l = delta_base(mb, stk, pci, 5);
+	lng h = delta_base(mb, stk, pci, 6);
+	bit li = *getArgReference_bit(stk, pci, 7);
+	bit hi = *getArgReference_bit(stk, pci, 8);
+	bit anti = *getArgReference_bit(stk, pci, 9);
+	bit unknown = *getArgReference_bit(stk, pci, 10);
+	bool isint = ATOMstorage(tt) == TYPE_int;
+	lng tmin = isint ? GDK_int_min : GDK_lng_min;
+	lng tmax = isint ? GDK_int_max : GDK_lng_max;
+	BAT *o, *s, *bn;
+	str msg;
+
+	if ((msg = delta_select_args(&o, &s, mb, stk, pci, "delta.select")) != MAL_SUCCEED)
+		return msg;
+	/* the model is of the linear scale, nil stays nil */
+	l = delta_linear(tt, l);
+	h = delta_linear(tt, h);
+	/* nil is below the domain of both int and lng */
+	if (l >= tmin && h >= tmin && !(l == tmax && !li) && !(h == tmin && !hi) &&
+		(li ? l : l + 1) <= (hi ? h : h - 1)) {
+		/* a closed range, the common case */
+		bn = delta_select(o, s, base, step, tt, li ? l : l + 1, hi ? h : h - 1, anti);
+	} else {
+		/* open ended ranges and nil semantics are left to the
+		 * generic implementation */
+		BAT *b = DELTAdecompress_(o, base, step, tt, TRANSIENT);
+		bn = NULL;
+		if (b) {
+			bn = BATselect(b, s, getArgReference(stk, pci, 5), getArgReference(stk, pci, 6), li, hi, anti, unknown);
+			bat_destroy(b);
+		}
+	}
+	bat_destroy(o);
+	bat_destroy(s);
+	if (!bn)
+		throw(SQL, "delta.select", GDK_EXCEPTION);
+	*r = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+#define MINMAX(TPE, UTPE, RTPE, RMAX)									\
+	do {																\
+		const RTPE *restrict iv = Tloc(o, 0);							\
+		TPE best = TPE##_nil;											\
+		if (dp.dense) {													\
+			oid seq = dp.ci.seq;										\
+			BUN nblk = (dp.cnt + DELTA_BLOCK - 1) / DELTA_BLOCK;		\
+			/* visit the most promising blocks first and skip the		\
+			 * blocks that cannot improve the result */					\
+			bool rev = (step >= 0) == domax;							\
+			for (BUN k = 0; k < nblk; k++) {							\
+				oid p = seq + (rev ? nblk - 1 - k : k) * DELTA_BLOCK;	\
+				oid be = MIN(seq + dp.cnt, p + DELTA_BLOCK);			\
+				lng mn, mx;												\
+				if (!is_##TPE##_nil(best) &&							\
+					delta_bounds(base, step, p, be - 1, RMAX, GDK_##TPE##_min, GDK_##TPE##_max, &mn, &mx) && \
+					(domax ? mx <= best : mn >= best))					\
+					continue;											\
+				for (; p < be; p++) {									\
+					TPE v = DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq]); \
+					if (is_##TPE##_nil(best) || (domax ? v > best : v < best)) \
+						best = v;										\
+				}														\
+			}															\
+		} else {														\
+			for (BUN i = 0; i < dp.cnt; i++) {							\
+				oid p = delta_position(&dp, i);							\
+				if (is_oid_nil(p))										\
+					continue;											\
+				if (p < hseq || p - hseq >= ocnt)						\
+					goto bailout;										\
+				TPE v = DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq]); \
+				if (is_##TPE##_nil(best) || (domax ? v > best : v < best)) \
+					best = v;											\
+			}															\
+		}																\
+		*(TPE *) res = best;											\
+	} while (0)
+
+static str
+delta_aggr_args(BAT **c, BAT **o, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, const char *fname)
+{
+	bat C = *getArgReference_bat(stk, pci, 1);
+	bat O = *getArgReference_bat(stk, pci, 2);
+
+	*c = NULL;
+	if (!(*o = BATdescriptor(O)) || (!is_bat_nil(C) && !(*c = BATdescriptor(C)))) {
+		bat_destroy(*o);
+		throw(SQL, fname, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if (!delta_valid(mb, pci, 3, *o)) {
+		bat_destroy(*o);
+		bat_destroy(*c);
+		throw(SQL, fname, SQLSTATE(3F000) "delta aggregate: invalid type");
+	}
+	return MAL_SUCCEED;
+}
+
+static str
+delta_minmax(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, bool domax, const char *fname)
+{
+	ptr res = getArgReference(stk, pci, 0);
+	int tt = getArgType(mb, pci, 3);
+	lng base = delta_base(mb, stk, pci, 3);
+	lng step = *getArgReference_lng(stk, pci, 4);
+	BAT *c, *o;
+	str msg;
+
+	if ((msg = delta_aggr_args(&c, &o, mb, stk, pci, fname)) != MAL_SUCCEED)
+		return msg;
+
+	delta_positions dp;
+	oid hseq = o->hseqbase;
+	BUN ocnt = BATcount(o);
+	delta_positions_init(&dp, o, c);
+	if (dp.dense && dp.cnt > 0 && (dp.ci.seq < hseq || dp.ci.seq + dp.cnt > hseq + ocnt))
+		goto bailout;
+	DELTA_DISPATCH(tt, o->ttype, MINMAX);
+	delta_unlinear_values(res, 1, tt);
+	bat_destroy(c);
+	bat_destroy(o);
+	return MAL_SUCCEED;
+
+  bailout:
+	bat_destroy(c);
+	bat_destroy(o);
+	throw(SQL, fname, SQLSTATE(42000) "delta aggregate: position out of range");
+}
+
+str
+DELTAmin(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return delta_minmax(mb, stk, pci, false, "delta.min");
+}
+
+str
+DELTAmax(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return delta_minmax(mb, stk, pci, true, "delta.max");
+}
+
+#ifdef HAVE_HGE
+typedef hge delta_sum;
+#define SUM_ADD(v)		sum += (v)
+#else
+typedef lng delta_sum;
+
+#define SUM_ADD(v)												\
+	do {														\
+		lng _v = (v);											\
+		if ((_v > 0 && sum > GDK_lng_max - _v) ||				\
+			(_v < 0 && sum < GDK_lng_min - _v))					\
+			goto overflow;										\
+		sum += _v;												\
+	} while (0)
+#endif
+
+#define SUM(TPE, UTPE, RTPE, RMAX)										\
+	do {																\
+		const RTPE *restrict iv = Tloc(o, 0);							\
+		if (dp.dense) {													\
+			for (oid p = dp.ci.seq, e = dp.ci.seq + dp.cnt; p < e; ) {	\
+				oid be = MIN(e, p + DELTA_BLOCK);						\
+				lng mn, mx;												\
+				if (delta_bounds(base, step, p, be - 1, RMAX, GDK_##TPE##_min, GDK_##TPE##_max, &mn, &mx)) { \
+					/* no wrap around, sum the model and the residuals */ \
+					lng rs = 0;											\
+					for (oid q = p; q < be; q++)						\
+						rs += iv[q - hseq];								\
+					lng n = (lng) (be - p);								\
+					SUM_ADD((delta_sum) n * base + (delta_sum) step * ((delta_sum) (p + be - 1) * n / 2) + rs); \
+					p = be;												\
+					continue;											\
+				}														\
+				for (; p < be; p++)										\
+					SUM_ADD(DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq])); \
+			}															\
+			found = dp.cnt > 0;											\
+		} else {														\
+			for (BUN i = 0; i < dp.cnt; i++) {							\
+				oid p = delta_position(&dp, i);							\
+				if (is_oid_nil(p))										\
+					continue;											\
+				if (p < hseq || p - hseq >= ocnt)						\
+					goto bailout;										\
+				SUM_ADD(DELTA_VAL(TPE, UTPE, base, step, p, iv[p - hseq])); \
+				found = true;											\
+			}															\
+		}																\
+	} while (0)
+
+str
+DELTAsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	int rt = getArgType(mb, pci, 0);
+	int tt = getArgType(mb, pci, 3);
+	lng base = delta_base(mb, stk, pci, 3);
+	lng step = *getArgReference_lng(stk, pci, 4);
+	bool found = false;
+	BAT *c, *o;
+	str msg;
+	delta_sum sum = 0;
+
+	if ((msg = delta_aggr_args(&c, &o, mb, stk, pci, "delta.sum")) != MAL_SUCCEED)
+		return msg;
+
+	delta_positions dp;
+	oid hseq = o->hseqbase;
+	BUN ocnt = BATcount(o);
+	delta_positions_init(&dp, o, c);
+	if (dp.dense && dp.cnt > 0 && (dp.ci.seq < hseq || dp.ci.seq + dp.cnt > hseq + ocnt))
+		goto bailout;
+	DELTA_DISPATCH(tt, o->ttype, SUM);
+	bat_destroy(c);
+	bat_destroy(o);
+
+#ifdef HAVE_HGE
+	if (rt == TYPE_hge) {
+		*getArgReference_hge(stk, pci, 0) = found ? sum : hge_nil;
+		return MAL_SUCCEED;
+	}
+	if (sum > GDK_lng_max || sum < GDK_lng_min)
+		throw(SQL, "delta.sum", SQLSTATE(22003) "overflow in sum aggregate");
+#endif
+	assert(rt == TYPE_lng);
+	(void) rt;
+	*getArgReference_lng(stk, pci, 0) = found ? (lng) sum : lng_nil;
+	return MAL_SUCCEED;
+
+#ifndef HAVE_HGE
+  overflow:
+	bat_destroy(c);
+	bat_destroy(o);
+	throw(SQL, "delta.sum", SQLSTATE(22003) "overflow in sum aggregate");
+#endif
+  bailout:
+	bat_destroy(c);
+	bat_destroy(o);
+	throw(SQL, "delta.sum", SQLSTATE(42000) "delta aggregate: position out of range");
+}
@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _DELTA_H
+#define _DELTA_H
+
+#include "sql.h"
+
+extern str DELTAcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAprojection(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAmin(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAmax(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DELTAsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+#endif /* _DELTA_H */
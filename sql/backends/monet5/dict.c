@@ -250,6 +250,50 @@ DICTcompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
+str
+DICTcompress_column(sql_trans *tr, sql_column *c, bool ordered)
+{
+	str msg = MAL_SUCCEED;
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o, *u;
+	if( b == NULL)
+		throw(SQL,"dict.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+
+	msg = DICTcompress_intern(&o, &u, b, ordered, true, true);
+	bat_destroy(b);
+	if (msg == MAL_SUCCEED) {
+		switch (sql_trans_alter_storage(tr, c, "DICT")) {
+			case -1:
+				msg = createException(SQL, "dict.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "dict.compress", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+		if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+			msg = createException(SQL, "dict.compress", SQLSTATE(HY013) "alter_storage failed");
+		if (msg == MAL_SUCCEED) {
+			switch (store->storage_api.col_compress(tr, c, ST_DICT, o, u)) {
+				case -1:
+					msg = createException(SQL, "dict.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				case -2:
+				case -3:
+					msg = createException(SQL, "dict.compress", SQLSTATE(42000) "transaction conflict detected");
+					break;
+				default:
+					break;
+			}
+		}
+		bat_destroy(u);
+		bat_destroy(o);
+	}
+	return msg;
+}
+
 str
 DICTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -294,44 +338,7 @@ DICTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	if (c->storage_type)
 		throw(SQL, "dict.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
 
-	sqlstore *store = tr->store;
-	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o, *u;
-	if( b == NULL)
-		throw(SQL,"dict.compress", SQLSTATE(HY005) "Cannot access column descriptor");
-
-	msg = DICTcompress_intern(&o, &u, b, ordered, true, true);
-	bat_destroy(b);
-	if (msg == MAL_SUCCEED) {
-		switch (sql_trans_alter_storage(tr, c, "DICT")) {
-			case -1:
-				msg = createException(SQL, "dict.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-				break;
-			case -2:
-			case -3:
-				msg = createException(SQL, "dict.compress", SQLSTATE(42000) "transaction conflict detected");
-				break;
-			default:
-				break;
-		}
-		if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
-			msg = createException(SQL, "dict.compress", SQLSTATE(HY013) "alter_storage failed");
-		if (msg == MAL_SUCCEED) {
-			switch (store->storage_api.col_compress(tr, c, ST_DICT, o, u)) {
-				case -1:
-					msg = createException(SQL, "dict.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-					break;
-				case -2:
-				case -3:
-					msg = createException(SQL, "dict.compress", SQLSTATE(42000) "transaction conflict detected");
-					break;
-				default:
-					break;
-			}
-		}
-		bat_destroy(u);
-		bat_destroy(o);
-	}
-	return msg;
+	return DICTcompress_column(tr, c, ordered);
 }
 
 #define decompress_loop(TPE) \
@@ -196,6 +196,53 @@ FORcompress_intern(allocator *ma, char **comp_min_val, BAT **r, BAT *b)
 	return NULL;
 }
 
+str
+FORcompress_column(sql_trans *tr, sql_column *c)
+{
+	str msg = MAL_SUCCEED;
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o = NULL;
+	if( b == NULL)
+		throw(SQL,"for.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state = ma_open(ta);
+	char *comp_min_val = NULL;
+	msg = FORcompress_intern(ta, &comp_min_val, &o, b);
+	bat_destroy(b);
+	if (msg == MAL_SUCCEED) {
+		switch (sql_trans_alter_storage(tr, c, comp_min_val)) {
+			case -1:
+				msg = createException(SQL, "for.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "for.compress", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+		if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+			msg = createException(SQL, "for.compress", SQLSTATE(HY013) "alter_storage failed");
+		if (msg == MAL_SUCCEED) {
+			switch (store->storage_api.col_compress(tr, c, ST_FOR, o, NULL)) {
+				case -1:
+					msg = createException(SQL, "for.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				case -2:
+				case -3:
+					msg = createException(SQL, "for.compress", SQLSTATE(42000) "transaction conflict detected");
+					break;
+				default:
+					break;
+			}
+		}
+		bat_destroy(o);
+	}
+	ma_close(&ta_state);
+	return msg;
+}
+
 str
 FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -241,47 +288,7 @@ FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	if (c->storage_type)
 		throw(SQL, "for.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
 
-	sqlstore *store = tr->store;
-	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o = NULL;
-	if( b == NULL)
-		throw(SQL,"for.compress", SQLSTATE(HY005) "Cannot access column descriptor");
-
-	allocator *ta = MT_thread_getallocator();
-	allocator_state ta_state = ma_open(ta);
-	char *comp_min_val = NULL;
-	msg = FORcompress_intern(ta, &comp_min_val, &o, b);
-	bat_destroy(b);
-	if (msg == MAL_SUCCEED) {
-		switch (sql_trans_alter_storage(tr, c, comp_min_val)) {
-			case -1:
-				msg = createException(SQL, "for.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-				break;
-			case -2:
-			case -3:
-				msg = createException(SQL, "for.compress", SQLSTATE(42000) "transaction conflict detected");
-				break;
-			default:
-				break;
-		}
-		if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
-			msg = createException(SQL, "for.compress", SQLSTATE(HY013) "alter_storage failed");
-		if (msg == MAL_SUCCEED) {
-			switch (store->storage_api.col_compress(tr, c, ST_FOR, o, NULL)) {
-				case -1:
-					msg = createException(SQL, "for.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-					break;
-				case -2:
-				case -3:
-					msg = createException(SQL, "for.compress", SQLSTATE(42000) "transaction conflict detected");
-					break;
-				default:
-					break;
-			}
-		}
-		bat_destroy(o);
-	}
-	ma_close(&ta_state);
-	return msg;
+	return FORcompress_column(tr, c);
 }
 
 int
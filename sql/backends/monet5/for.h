@@ -14,6 +14,7 @@
 #include "sql.h"
 
 //extern BAT *FORdecompress_(BAT *o, lng minval, int type, role_t role);
+extern str FORcompress_column(sql_trans *tr, sql_column *c);
 extern str FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str FORdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 
@@ -0,0 +1,666 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * FSST (fast static symbol table) compression of string columns.
+ *
+ * A table of at most 255 symbols of 1 up to 8 bytes is trained on a
+ * sample of the column.  A string is encoded as a sequence of one byte
+ * codes, each standing for a symbol, or the escape code followed by a
+ * literal byte that is not covered by the table.  Short, repetitive
+ * strings (urls, user agents, identifiers) typically shrink by a factor
+ * 2 to 3 and decoding is a simple table lookup and copy per code.
+ *
+ * The encoding of a string only depends on the symbol table, so equal
+ * strings have equal encodings.  This allows equality selections to be
+ * evaluated on the compressed values, after encoding the constant.
+ *
+ * The compressed column is a blob bat, the serialized symbol table is
+ * stored as a single row blob bat next to it (like the values of a dict
+ * compressed column).  The symbol table is never retrained, values
+ * appended later are encoded with the existing table.
+ *
+ * A strimps index of the column stays with the compressed bat, but it
+ * is built over the decoded strings: the first time (a slice of) the
+ * column is decompressed, all of it is decoded once to create the
+ * strimp, after which the decompressed slices share it, so that LIKE
+ * selections on them can use it.
+ */
+
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+
+#include "fsst.h"
+
+#define FSST_ESCAPE 255
+#define FSST_MAXSYMBOLS 255
+#define FSST_MAXLEN 8
+#define FSST_CODES 512			/* symbols, followed by the 256 literal bytes */
+#define FSST_SAMPLEROWS 4096
+#define FSST_SAMPLESIZE (1<<18)	/* bytes of strings to train on */
+#define FSST_GENERATIONS 5
+
+typedef struct fsst_table {
+	int nsymbols;
+	uint8_t len[FSST_MAXSYMBOLS];
+	uint8_t sym[FSST_MAXSYMBOLS][FSST_MAXLEN];
+	/* encoder index, per first byte the codes on decreasing length */
+	uint16_t first[257];
+	uint8_t order[FSST_MAXSYMBOLS];
+} fsst_table;
+
+typedef struct fsst_candidate {
+	size_t gain;
+	uint8_t len;
+	uint8_t sym[FSST_MAXLEN];
+} fsst_candidate;
+
+static sql_column *
+get_newcolumn(sql_trans *tr, sql_column *c)
+{
+	sql_table *t = find_sql_table_id(tr, c->t->s, c->t->base.id);
+	if (t)
+		return find_sql_column(t, c->base.name);
+	return NULL;
+}
+
+static void
+fsst_index(fsst_table *t)
+{
+	uint16_t pos[256];
+
+	memset(t->first, 0, sizeof(t->first));
+	for (int c = 0; c < t->nsymbols; c++)
+		t->first[t->sym[c][0] + 1]++;
+	for (int i = 1; i <= 256; i++)
+		t->first[i] += t->first[i - 1];
+	memcpy(pos, t->first, sizeof(pos));
+	for (int l = FSST_MAXLEN; l > 0; l--)
+		for (int c = 0; c < t->nsymbols; c++)
+			if (t->len[c] == l)
+				t->order[pos[t->sym[c][0]]++] = (uint8_t) c;
+}
+
+/* longest symbol which is a prefix of s, or -1 */
+static inline int
+fsst_match(const fsst_table *t, const uint8_t *s, size_t n)
+{
+	for (int i = t->first[s[0]]; i < t->first[s[0] + 1]; i++) {
+		int c = t->order[i];
+		if (t->len[c] <= n && memcmp(t->sym[c], s, t->len[c]) == 0)
+			return c;
+	}
+	return -1;
+}
+
+/* out needs room for 2 * n bytes */
+static size_t
+fsst_encode(const fsst_table *t, const uint8_t *s, size_t n, uint8_t *out)
+{
+	uint8_t *o = out;
+
+	while (n > 0) {
+		int c = fsst_match(t, s, n);
+		if (c < 0) {
+			*o++ = FSST_ESCAPE;
+			*o++ = *s++;
+			n--;
+		} else {
+			*o++ = (uint8_t) c;
+			s += t->len[c];
+			n -= t->len[c];
+		}
+	}
+	return (size_t) (o - out);
+}
+
+/* out needs room for n * FSST_MAXLEN bytes, full symbols are copied */
+static size_t
+fsst_decode(const fsst_table *t, const uint8_t *in, size_t n, uint8_t *out)
+{
+	uint8_t *o = out;
+
+	for (size_t i = 0; i < n; i++) {
+		uint8_t c = in[i];
+		if (c == FSST_ESCAPE) {
+			*o++ = in[++i];
+		} else {
+			memcpy(o, t->sym[c], FSST_MAXLEN);
+			o += t->len[c];
+		}
+	}
+	return (size_t) (o - out);
+}
+
+/* the bytes of a symbol code or of a literal byte code (256 + byte) */
+static inline int
+fsst_code(const fsst_table *t, int c, uint8_t *sym)
+{
+	if (c >= 256) {
+		sym[0] = (uint8_t) (c - 256);
+		return 1;
+	}
+	memcpy(sym, t->sym[c], FSST_MAXLEN);
+	return t->len[c];
+}
+
+static int
+fsst_cand_bytes(const void *a, const void *b)
+{
+	const fsst_candidate *l = a, *r = b;
+
+	if (l->len != r->len)
+		return l->len < r->len ? -1 : 1;
+	return memcmp(l->sym, r->sym, l->len);
+}
+
+static int
+fsst_cand_gain(const void *a, const void *b)
+{
+	const fsst_candidate *l = a, *r = b;
+
+	if (l->gain != r->gain)
+		return l->gain > r->gain ? -1 : 1;
+	return fsst_cand_bytes(a, b);
+}
+
+/* Train the symbol table on a sample of the strings of b.  Each
+ * generation encodes the sample with the current table and counts how
+ * often each code and each pair of consecutive codes occurs.  The next
+ * table consists of the symbols and concatenations of two symbols with
+ * the highest gain (number of bytes they cover). */
+static gdk_return
+fsst_train(fsst_table *t, BAT *b)
+{
+	BATiter bi = bat_iterator(b);
+	BUN cnt = bi.count, step = cnt > FSST_SAMPLEROWS ? cnt / FSST_SAMPLEROWS : 1;
+	size_t nsample = 0, ssize = 0;
+	const char **sample = GDKmalloc(sizeof(const char *) * (cnt / step + 1));
+	uint32_t *count1 = GDKzalloc(sizeof(uint32_t) * FSST_CODES);
+	uint32_t *count2 = GDKmalloc(sizeof(uint32_t) * FSST_CODES * FSST_CODES);
+	fsst_candidate *cands = NULL;
+
+	t->nsymbols = 0;
+	if (sample == NULL || count1 == NULL || count2 == NULL)
+		goto bailout;
+	for (BUN p = 0; p < cnt && ssize < FSST_SAMPLESIZE; p += step) {
+		const char *s = BUNtvar(&bi, p);
+		if (!strNil(s) && *s) {
+			sample[nsample++] = s;
+			ssize += strlen(s);
+		}
+	}
+
+	for (int gen = 0; gen < FSST_GENERATIONS && nsample > 0; gen++) {
+		size_t ncands = 0, maxcands = FSST_CODES;
+
+		fsst_index(t);
+		memset(count1, 0, sizeof(uint32_t) * FSST_CODES);
+		memset(count2, 0, sizeof(uint32_t) * FSST_CODES * FSST_CODES);
+		for (size_t i = 0; i < nsample; i++) {
+			const uint8_t *s = (const uint8_t *) sample[i];
+			size_t n = strlen(sample[i]);
+			int prev = -1;
+
+			while (n > 0) {
+				int c = fsst_match(t, s, n);
+				size_t l = 1;
+				if (c < 0)
+					c = 256 + *s;
+				else
+					l = t->len[c];
+				count1[c]++;
+				if (prev >= 0)
+					count2[prev * FSST_CODES + c]++;
+				prev = c;
+				s += l;
+				n -= l;
+			}
+		}
+		for (int i = 0; i < FSST_CODES * FSST_CODES; i++)
+			maxcands += count2[i] != 0;
+		GDKfree(cands);
+		if ((cands = GDKmalloc(sizeof(fsst_candidate) * maxcands)) == NULL)
+			goto bailout;
+		for (int c = 0; c < FSST_CODES; c++) {
+			if (count1[c] == 0)
+				continue;
+
+			uint8_t csym[FSST_MAXLEN];
+			int clen = fsst_code(t, c, csym);
+			fsst_candidate *cd = &cands[ncands++];
+			cd->len = (uint8_t) clen;
+			cd->gain = (size_t) count1[c] * clen;
+			memcpy(cd->sym, csym, clen);
+			for (int d = 0; d < FSST_CODES; d++) {
+				uint32_t n = count2[c * FSST_CODES + d];
+				if (n == 0)
+					continue;
+				uint8_t dsym[FSST_MAXLEN];
+				int dlen = fsst_code(t, d, dsym);
+				if (clen + dlen > FSST_MAXLEN)
+					continue;
+				cd = &cands[ncands++];
+				cd->len = (uint8_t) (clen + dlen);
+				cd->gain = (size_t) n * cd->len;
+				memcpy(cd->sym, csym, clen);
+				memcpy(cd->sym + clen, dsym, dlen);
+			}
+		}
+		/* merge equal symbols, then keep the ones with the highest gain */
+		qsort(cands, ncands, sizeof(fsst_candidate), fsst_cand_bytes);
+		size_t m = 0;
+		for (size_t i = 0; i < ncands; i++) {
+			if (m > 0 && fsst_cand_bytes(&cands[m - 1], &cands[i]) == 0)
+				cands[m - 1].gain += cands[i].gain;
+			else
+				cands[m++] = cands[i];
+		}
+		qsort(cands, m, sizeof(fsst_candidate), fsst_cand_gain);
+		t->nsymbols = (int) MIN(m, FSST_MAXSYMBOLS);
+		for (int c = 0; c < t->nsymbols; c++) {
+			t->len[c] = cands[c].len;
+			memset(t->sym[c], 0, FSST_MAXLEN);
+			memcpy(t->sym[c], cands[c].sym, cands[c].len);
+		}
+	}
+	fsst_index(t);
+	bat_iterator_end(&bi);
+	GDKfree(sample);
+	GDKfree(count1);
+	GDKfree(count2);
+	GDKfree(cands);
+	return GDK_SUCCEED;
+
+  bailout:
+	bat_iterator_end(&bi);
+	GDKfree(sample);
+	GDKfree(count1);
+	GDKfree(count2);
+	GDKfree(cands);
+	return GDK_FAIL;
+}
+
+/* the serialized table: number of symbols, followed by length and bytes
+ * of each symbol */
+static blob *
+fsst_store(const fsst_table *t)
+{
+	size_t n = 1;
+	for (int c = 0; c < t->nsymbols; c++)
+		n += 1 + t->len[c];
+
+	blob *b = GDKmalloc(blobsize(n));
+	if (b == NULL)
+		return NULL;
+	b->nitems = n;
+	uint8_t *d = (uint8_t *) b->data;
+	*d++ = (uint8_t) t->nsymbols;
+	for (int c = 0; c < t->nsymbols; c++) {
+		*d++ = t->len[c];
+		memcpy(d, t->sym[c], t->len[c]);
+		d += t->len[c];
+	}
+	return b;
+}
+
+static gdk_return
+fsst_load(fsst_table *t, BAT *u)
+{
+	if (u->ttype != TYPE_blob || BATcount(u) != 1) {
+		GDKerror("invalid fsst symbol table\n");
+		return GDK_FAIL;
+	}
+	BATiter ui = bat_iterator(u);
+	const blob *b = BUNtvar(&ui, 0);
+	const uint8_t *d = (const uint8_t *) b->data, *e = d + b->nitems;
+
+	if (is_blob_nil(b) || b->nitems == 0) {
+		bat_iterator_end(&ui);
+		GDKerror("invalid fsst symbol table\n");
+		return GDK_FAIL;
+	}
+	t->nsymbols = *d++;
+	for (int c = 0; c < t->nsymbols; c++) {
+		if (d >= e || *d == 0 || *d > FSST_MAXLEN || d + 1 + *d > e) {
+			bat_iterator_end(&ui);
+			GDKerror("invalid fsst symbol table\n");
+			return GDK_FAIL;
+		}
+		t->len[c] = *d++;
+		memset(t->sym[c], 0, FSST_MAXLEN);
+		memcpy(t->sym[c], d, t->len[c]);
+		d += t->len[c];
+	}
+	bat_iterator_end(&ui);
+	fsst_index(t);
+	return GDK_SUCCEED;
+}
+
+static BAT *
+FSSTcompress_(const fsst_table *t, BAT *b, role_t role)
+{
+	BAT *o = COLnew(b->hseqbase, TYPE_blob, BATcount(b), role);
+	size_t bufsize = 1024;
+	blob *buf = GDKmalloc(blobsize(bufsize));
+
+	if (o == NULL || buf == NULL) {
+		bat_destroy(o);
+		GDKfree(buf);
+		return NULL;
+	}
+	BATiter bi = bat_iterator(b);
+	for (BUN p = 0; p < bi.count; p++) {
+		const char *s = BUNtvar(&bi, p);
+		const void *v = ATOMnilptr(TYPE_blob);
+
+		if (!strNil(s)) {
+			size_t n = strlen(s);
+			if (2 * n > bufsize) {
+				GDKfree(buf);
+				bufsize = 2 * n;
+				if ((buf = GDKmalloc(blobsize(bufsize))) == NULL)
+					goto bailout;
+			}
+			buf->nitems = fsst_encode(t, (const uint8_t *) s, n, (uint8_t *) buf->data);
+			v = buf;
+		}
+		if (BUNappend(o, v, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	bat_iterator_end(&bi);
+	GDKfree(buf);
+	return o;
+
+  bailout:
+	bat_iterator_end(&bi);
+	GDKfree(buf);
+	bat_destroy(o);
+	return NULL;
+}
+
+BAT *
+FSSTdecompress_(BAT *o, BAT *u, role_t role)
+{
+	fsst_table t;
+
+	if (fsst_load(&t, u) != GDK_SUCCEED)
+		return NULL;
+
+	BAT *b = COLnew(o->hseqbase, TYPE_str, BATcount(o), role);
+	size_t bufsize = 1024;
+	uint8_t *buf = GDKmalloc(bufsize);
+
+	if (b == NULL || buf == NULL) {
+		bat_destroy(b);
+		GDKfree(buf);
+		return NULL;
+	}
+	/* BUNappend maintains the tascii property of the result */
+	BATiter oi = bat_iterator(o);
+	for (BUN p = 0; p < oi.count; p++) {
+		const blob *v = BUNtvar(&oi, p);
+		const char *s = str_nil;
+
+		if (!is_blob_nil(v)) {
+			if (v->nitems * FSST_MAXLEN + 1 > bufsize) {
+				GDKfree(buf);
+				bufsize = v->nitems * FSST_MAXLEN + 1;
+				if ((buf = GDKmalloc(bufsize)) == NULL)
+					goto bailout;
+			}
+			buf[fsst_decode(&t, (const uint8_t *) v->data, v->nitems, buf)] = 0;
+			s = (const char *) buf;
+		}
+		if (BUNappend(b, s, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	bat_iterator_end(&oi);
+	GDKfree(buf);
+	b->tkey = oi.key;
+	return b;
+
+  bailout:
+	bat_iterator_end(&oi);
+	GDKfree(buf);
+	bat_destroy(b);
+	return NULL;
+}
+
+blob *
+FSSTencode_(BAT *u, const char *s)
+{
+	fsst_table t;
+	blob *b;
+
+	if (fsst_load(&t, u) != GDK_SUCCEED)
+		return NULL;
+	if (strNil(s)) {
+		if ((b = GDKmalloc(blobsize(0))) != NULL)
+			b->nitems = ~(size_t) 0;
+		return b;
+	}
+	size_t n = strlen(s);
+	if ((b = GDKmalloc(blobsize(2 * n))) != NULL)
+		b->nitems = fsst_encode(&t, (const uint8_t *) s, n, (uint8_t *) b->data);
+	return b;
+}
+
+int
+FSSTprepare4append(BAT **noffsets, BAT *vals, BAT *u)
+{
+	fsst_table t;
+
+	*noffsets = NULL;
+	if (fsst_load(&t, u) != GDK_SUCCEED ||
+		(*noffsets = FSSTcompress_(&t, vals, TRANSIENT)) == NULL)
+		return -1;
+	return 0;
+}
+
+/* the new values are returned as an array of blob pointers, which point
+ * into the same allocation */
+int
+FSSTprepare4append_vals(void **noffsets, void *vals, BUN cnt, BAT *u)
+{
+	fsst_table t;
+	const char **v = vals;
+	size_t sz = sizeof(blob *) * cnt;
+
+	*noffsets = NULL;
+	if (fsst_load(&t, u) != GDK_SUCCEED)
+		return -1;
+	for (BUN i = 0; i < cnt; i++)
+		sz += strNil(v[i]) ? blobsize(0) : (blobsize(2 * strlen(v[i])) + 7) & ~(size_t) 7;
+
+	blob **n = GDKmalloc(sz);
+	if (n == NULL)
+		return -1;
+	char *d = (char *) (n + cnt);
+	for (BUN i = 0; i < cnt; i++) {
+		blob *b = n[i] = (blob *) d;
+		if (strNil(v[i])) {
+			b->nitems = ~(size_t) 0;
+			d += blobsize(0);
+		} else {
+			size_t l = strlen(v[i]);
+			b->nitems = fsst_encode(&t, (const uint8_t *) v[i], l, (uint8_t *) b->data);
+			d += (blobsize(2 * l) + 7) & ~(size_t) 7;
+		}
+	}
+	*noffsets = n;
+	return 0;
+}
+
+/* let b, the decompressed values of o, use the strimp of the column o
+ * belongs to; the strimp is only an accelerator, so failures are
+ * ignored */
+static void
+fsst_strimps(BAT *b, BAT *o, BAT *u)
+{
+	BAT *p = o, *v;
+
+	if (VIEWtparent(o) && (p = BATdescriptor(VIEWtparent(o))) == NULL) {
+		GDKclrerr();
+		return;
+	}
+	if (BAThasstrimps(p) && !STRMPshare(b, p) &&
+		(v = FSSTdecompress_(p, u, TRANSIENT)) != NULL) {
+		if (STRMPcreatefrom(p, v) == GDK_SUCCEED)
+			(void) STRMPshare(b, p);
+		bat_destroy(v);
+	}
+	GDKclrerr();
+	if (p != o)
+		BBPunfix(p->batCacheid);
+}
+
+str
+FSSTdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	bat O = *getArgReference_bat(stk, pci, 1);
+	bat U = *getArgReference_bat(stk, pci, 2);
+
+	BAT *o = BATdescriptor(O);
+	BAT *u = BATdescriptor(U);
+	if (!o || !u) {
+		bat_destroy(o);
+		bat_destroy(u);
+		throw(SQL, "fsst.decompress", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	BAT *b = FSSTdecompress_(o, u, TRANSIENT);
+	if (b)
+		fsst_strimps(b, o, u);
+	bat_destroy(o);
+	bat_destroy(u);
+	if (!b)
+		throw(SQL, "fsst.decompress", GDK_EXCEPTION);
+	*r = b->batCacheid;
+	BBPkeepref(b);
+	return MAL_SUCCEED;
+}
+
+str
+FSSTencode(Client ctx, blob **r, const bat *U, const char *const *s)
+{
+	(void) ctx;
+	BAT *u = BATdescriptor(*U);
+
+	if (!u)
+		throw(SQL, "fsst.encode", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	*r = FSSTencode_(u, *s);
+	bat_destroy(u);
+	if (*r == NULL)
+		throw(SQL, "fsst.encode", GDK_EXCEPTION);
+	return MAL_SUCCEED;
+}
+
+str
+FSSTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)mb;
+	str msg = MAL_SUCCEED;
+	const char *sname = *getArgReference_str(stk, pci, 1);
+	const char *tname = *getArgReference_str(stk, pci, 2);
+	const char *cname = *getArgReference_str(stk, pci, 3);
+	backend *be = NULL;
+	sql_trans *tr = NULL;
+
+	if (!sname || !tname || !cname)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "fsst compress: invalid column name");
+	if (strNil(sname))
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tname))
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (strNil(cname))
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "Column name cannot be NULL");
+	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
+		return msg;
+	tr = be->mvc->session->tr;
+
+	sql_schema *s = find_sql_schema(tr, sname);
+	if (!s)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
+	sql_table *t = find_sql_table(tr, s, tname);
+	if (!t)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
+	if (!isTable(t))
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "%s '%s' is not persistent",
+			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "fsst.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+	sql_column *c = find_sql_column(t, cname);
+	if (!c)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
+	if (c->type.type->localtype != TYPE_str)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "fsst compress: for 'fsst' compression the column must be a string column");
+	if (c->storage_type)
+		throw(SQL, "fsst.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
+
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o = NULL, *u = NULL;
+	if( b == NULL)
+		throw(SQL,"fsst.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+
+	fsst_table st;
+	blob *sb = NULL;
+	if (fsst_train(&st, b) != GDK_SUCCEED ||
+		(sb = fsst_store(&st)) == NULL ||
+		(u = COLnew(0, TYPE_blob, 1, PERSISTENT)) == NULL ||
+		BUNappend(u, sb, false) != GDK_SUCCEED ||
+		(o = FSSTcompress_(&st, b, PERSISTENT)) == NULL) {
+		GDKfree(sb);
+		bat_destroy(b);
+		bat_destroy(u);
+		throw(SQL, "fsst.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	GDKfree(sb);
+	/* the strimp is recreated over the decoded strings when needed */
+	if (BAThasstrimps(b) && BATsetstrimps(o) != GDK_SUCCEED)
+		GDKclrerr();
+	bat_destroy(b);
+
+	switch (sql_trans_alter_storage(tr, c, "FSST")) {
+		case -1:
+			msg = createException(SQL, "fsst.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			break;
+		case -2:
+		case -3:
+			msg = createException(SQL, "fsst.compress", SQLSTATE(42000) "transaction conflict detected");
+			break;
+		default:
+			break;
+	}
+	if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+		msg = createException(SQL, "fsst.compress", SQLSTATE(HY013) "alter_storage failed");
+	if (msg == MAL_SUCCEED) {
+		switch (store->storage_api.col_compress(tr, c, ST_FSST, o, u)) {
+			case -1:
+				msg = createException(SQL, "fsst.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "fsst.compress", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+	}
+	bat_destroy(u);
+	bat_destroy(o);
+	return msg;
+}
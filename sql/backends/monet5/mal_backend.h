@@ -64,6 +64,10 @@ typedef struct backend {
 	lng rowcnt;
 	subbackend *subbackend;
 	str fimp; /* for recursive functions keep the to be generated MAL function name here */
+	char *plan_query; /* normalised query text, when the plan may be added to the plan cache */
+	char *result_query; /* normalised query text, when the result may be added to the result cache */
+	sqlid *result_tables; /* the tables read by the query */
+	int nr_result_tables;
 } backend;
 
 extern backend *backend_reset(backend *b);
@@ -2118,10 +2118,26 @@ exp_bin(backend *be, sql_exp *e, stmt *left, stmt *right, stmt *grp, stmt *ext,
 	return s;
 }
 
+/* the model of a delta compressed column, "DELTA-<base>-<step>", as arguments */
+static stmt *
+stmt_delta_col(backend *be, sql_column *c, stmt *sc)
+{
+	char *e;
+	lng base = strtoll(c->storage_type+6, &e, 10), step = strtoll(e+1, NULL, 10);
+	int ibase = (int) base;
+	atom *a = atom_general_ptr(be->mvc->sa, &c->type, ATOMstorage(c->type.type->localtype) == TYPE_int ? (void *) &ibase : (void *) &base);
+
+	if (!a)
+		return NULL;
+	return stmt_delta(be, sc, stmt_atom(be, a), stmt_atom_lng(be, step));
+}
+
 static stmt *
 stmt_col(backend *be, sql_column *c, stmt *del, int part)
 {
 	stmt *sc = stmt_bat(be, c, RDONLY, part);
+	/* delta compressed values depend on their position, ie decompress before projecting out the deletes */
+	bool delta = c->storage_type && strncmp(c->storage_type, "DELTA", 5) == 0;
 
 	if (isTable(c->t) && c->t->access != TABLE_READONLY &&
 	   (!isNew(c) || !isNew(c->t) /* alter */) &&
@@ -2129,16 +2145,26 @@ stmt_col(backend *be, sql_column *c, stmt *del, int part)
 		stmt *u = stmt_bat(be, c, RD_UPD_ID, part);
 		assert(u);
 		sc = stmt_project_delta(be, sc, u);
-		if (c->storage_type && c->storage_type[0] == 'D') {
+		if (c->storage_type && strcmp(c->storage_type, "DICT") == 0) {
 			stmt *v = stmt_bat(be, c, RD_EXT, part);
 			sc = stmt_dict(be, sc, v);
-		} else if (c->storage_type && c->storage_type[0] == 'F') {
+		} else if (c->storage_type && strncmp(c->storage_type, "FOR", 3) == 0) {
 			sc = stmt_for(be, sc, stmt_atom(be, atom_general(be->mvc->sa, &c->type, c->storage_type+4/*skip FOR-*/, be->mvc->timezone)));
+		} else if (delta) {
+			sc = stmt_delta_col(be, c, sc);
 		}
 		if (del)
 			sc = stmt_project(be, del, sc);
-	} else if (del) { /* always handle the deletes */
-		sc = stmt_project(be, del, sc);
+	} else {
+		if (delta)
+			sc = stmt_delta_col(be, c, sc);
+		if (del) /* always handle the deletes */
+			sc = stmt_project(be, del, sc);
+	}
+	/* fsst columns are also compressed in read only tables */
+	if (c->storage_type && strcmp(c->storage_type, "FSST") == 0) {
+		stmt *v = stmt_bat(be, c, RD_EXT, part);
+		sc = stmt_fsst(be, sc, v);
 	}
 	return sc;
 }
@@ -3327,6 +3353,64 @@ get_equi_joins_first(mvc *sql, list *exps, int *equality_only)
 	return new_exps;
 }
 
+/* Semijoin reduction of the left input of an inner equi-join.  When the
+ * right input is filtered, the (integer) keys it kept are passed to the
+ * left as a Bloom filter, which restricts the candidates of the left
+ * before its columns are projected and joined.  Only done when the left
+ * columns are not projected yet, ie a base table or a selection. */
+static stmt *
+rel2bin_bloomfilter(backend *be, sql_rel *rel, stmt *left, stmt *right)
+{
+	sql_rel *lrel = rel->l;
+	stmt *cand = NULL, *s;
+
+	if (rel->op != op_join || is_single(rel) || list_empty(rel->exps) ||
+		!left || !right || left->type != st_list || right->type != st_list ||
+		rel_is_ref(lrel) || (!left->cand && !is_basetable(lrel->op)))
+		return left;
+	for (node *n = rel->exps->h; n; n = n->next) {
+		sql_exp *e = n->data, *le, *re;
+		stmt *lc, *rc;
+
+		if (e->type != e_cmp || e->flag != cmp_equal || is_anti(e) || is_semantics(e))
+			continue;
+		le = e->l;
+		re = e->r;
+		if (le->type != e_column || re->type != e_column)
+			continue;
+		if ((lc = bin_find_column_nid(be, left, le->nid)) == NULL ||
+			(rc = bin_find_column_nid(be, right, re->nid)) == NULL) {
+			lc = bin_find_column_nid(be, left, re->nid);
+			rc = bin_find_column_nid(be, right, le->nid);
+		}
+		if (!lc || !rc || lc->nrcols == 0 || rc->nrcols == 0)
+			continue;
+		int tt = tail_type(lc)->type->localtype;
+		if (tt != tail_type(rc)->type->localtype)
+			continue;
+		switch (ATOMbasetype(tt)) {
+		case TYPE_bte:
+		case TYPE_sht:
+		case TYPE_int:
+		case TYPE_lng:
+#ifdef HAVE_HGE
+		case TYPE_hge:
+#endif
+			break;
+		default:
+			continue;
+		}
+		if ((cand = stmt_bloomfilter(be, lc, rc, cand ? cand : left->cand)) == NULL)
+			return NULL;
+	}
+	if (!cand)
+		return left;
+	if ((s = stmt_list(be, left->op4.lval)) == NULL)
+		return NULL;
+	s->cand = cand;
+	return s;
+}
+
 static stmt *
 rel2bin_join(backend *be, sql_rel *rel, list *refs)
 {
@@ -3342,6 +3426,10 @@ rel2bin_join(backend *be, sql_rel *rel, list *refs)
 		left = subrel_bin(be, rel->l, refs);
 	if (rel->r) /* first construct the right sub relation */
 		right = subrel_bin(be, rel->r, refs);
+	if (right && right->cand) { /* filtered right side, try to reduce the left */
+		right = subrel_project(be, right, refs, rel->r);
+		left = rel2bin_bloomfilter(be, rel, left, right);
+	}
 	left = subrel_project(be, left, refs, rel->l);
 	right = subrel_project(be, right, refs, rel->r);
 	if (!left || !right)
@@ -4925,6 +5013,32 @@ rel2bin_predicate(backend *be)
 	return const_column(be, stmt_bool(be, 1));
 }
 
+/* offer the predicates of a select directly on top of a file loader to
+ * the loader, which may use them to skip parts of the file */
+static void
+file_loader_filter(mvc *sql, sql_rel *rel)
+{
+	sql_rel *l = rel->l;
+	sql_exp *op;
+
+	if (!l || l->op != op_table || l->flag == TRIGGER_WRAPPER || rel_is_ref(l) || !(op = l->r) || !is_func(op->type))
+		return;
+
+	sql_subfunc *f = op->f;
+	list *args = op->l;
+	if (strcmp(f->func->base.name, "file_loader") != 0 || sql_func_mod(f->func)[0] || sql_func_imp(f->func)[0] ||
+		list_length(args) < 2)
+		return;
+
+	sql_exp *eexp = args->h->next->data;
+	atom *ea = eexp->l;
+	if (!is_atom(eexp->type) || !ea || ea->data.vtype != TYPE_str)
+		return;
+	file_loader_t *fl = fl_find(ea->data.val.sval);
+	if (fl && fl->filter)
+		fl->filter(sql, f, l->exps, rel->exps);
+}
+
 static stmt *
 rel2bin_select(backend *be, sql_rel *rel, list *refs)
 {
@@ -4934,6 +5048,7 @@ rel2bin_select(backend *be, sql_rel *rel, list *refs)
 	stmt *predicate = NULL;
 
 	if (rel->l) { /* first construct the sub relation */
+		file_loader_filter(sql, rel);
 		sub = subrel_bin(be, rel->l, refs);
 		if (!sub)
 			return NULL;
@@ -7355,14 +7470,16 @@ rel2bin_output(backend *be, sql_rel *rel, list *refs)
 		atom *natom = ((sql_exp*) argnode->next->next->next->data)->l;
 		const char *ns = natom->isnull ? "" : ma_strdup(sql->sa, natom->data.val.sval);
 
-		const char *fn = NULL;
+		const char *fn = NULL, *format = "csv";
 		int onclient = 0;
 		if (argnode->next->next->next->next) {
 			fn = E_ATOM_STRING(argnode->next->next->next->next->data);
 			fns = stmt_atom_string(be, ma_strdup(sql->sa, fn));
 			onclient = E_ATOM_INT(argnode->next->next->next->next->next->data);
+			if (argnode->next->next->next->next->next->next)
+				format = E_ATOM_STRING(argnode->next->next->next->next->next->next->data);
 		}
-		stmt *export = stmt_export(be, sub, tsep, rsep, ssep, ns, onclient, fns);
+		stmt *export = stmt_export(be, sub, tsep, rsep, ssep, ns, onclient, fns, format);
 		list_append(slist, export);
 	} else if (tpe == TYPE_int) {
 		endianness endian = take_atom_arg(&argnode, TYPE_int)->val.ival;
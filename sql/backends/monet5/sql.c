@@ -45,6 +45,8 @@
 #include "mal_instruction.h"
 #include "mal_resource.h"
 #include "mal_authorize.h"
+#include "mutils.h"
+#include "sql_resultcache.h"
 
 static inline void
 BBPnreclaim(int nargs, ...)
@@ -141,7 +143,8 @@ sql_symbol2relation(backend *be, symbol *sym)
 	rel = rel_semantic(query, sym);
 
 	lng t_begin = GDKusec();
-	storage_based_opt = value_based_opt && rel && !is_ddl(rel->op);
+	/* plans kept in the plan cache must not depend on the data */
+	storage_based_opt = value_based_opt && rel && !is_ddl(rel->op) && !be->plan_query;
 	if (rel && !(rel->op == op_ddl && rel->card == CARD_ATOM &&
 				 rel->flag == ddl_psm && (be->mvc->emod == mod_exec) != 0)) { /* no need to optimize exec */
 		if (rel)
@@ -178,6 +181,10 @@ sqlcleanup(backend *be, int err)
 	be->mvc->label = 0;
 	be->mvc->nid = 1;
 	be->no_mitosis = 0;
+	be->plan_query = NULL;
+	be->result_query = NULL;
+	be->result_tables = NULL;
+	be->nr_result_tables = 0;
 	mvc_query_processed(be->mvc);
 	return err;
 }
@@ -2507,6 +2514,8 @@ mvc_result_set_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	bat_iterator_end(&itertpe);
 	bat_iterator_end(&iterdig);
 	bat_iterator_end(&iterscl);
+	if (!msg)
+		sql_resultcache_insert(be, res);
 	/* now send it to the channel cntxt->fdout */
 	if (bstream_getoob(cntxt->fdin))
 		msg = createException(SQL, "sql.resultSet", SQLSTATE(HY000) "Query aboted");
@@ -2570,6 +2579,52 @@ wrap_onclient_compression(stream **inner, str context, int nr, bool binary)
 
 
 
+/* Write the result set to a file as Parquet or as Arrow IPC stream */
+static str
+mvc_export_columnar_file(backend *be, res_table *t, const char *filename, const char *format, int onclient)
+{
+	mvc *m = be->mvc;
+	stream *s;
+	str msg = MAL_SUCCEED;
+	int ok;
+
+	if (strcmp(filename, "stdout") == 0) {
+		msg = createException(SQL, "sql.export_table", SQLSTATE(42000) "%s output requires a file", format);
+		goto bailout;
+	}
+	if (onclient)
+		s = mapi_request_download(filename, true, m->scanner.rs, m->scanner.ws);
+	else
+		s = open_wstream(filename);
+	if (s == NULL || mnstr_errnr(s) != MNSTR_NO__ERROR) {
+		msg = createException(IO, "streams.open", SQLSTATE(42000) "%s", mnstr_peek_error(NULL));
+		close_stream(s);
+		goto bailout;
+	}
+	if ((msg = wrap_onclient_compression(&s, "sql.export_table", onclient, true)) != NULL) {
+		close_stream(s);
+		goto bailout;
+	}
+	if (strcmp(format, "parquet") == 0)
+		ok = mvc_export_parquet(s, t);
+	else if (strcmp(format, "arrow") == 0)
+		ok = mvc_export_arrow(s, t);
+	else {
+		GDKerror("unknown export format %s\n", format);
+		ok = -3;
+	}
+	if (ok == 0 && mnstr_flush(s, MNSTR_FLUSH_DATA) < 0)
+		ok = -4;
+	if (ok < 0)
+		msg = createException(SQL, "sql.export_table", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(be, s, ok));
+	close_stream(s);
+	if (msg && !onclient)	/* don't leave a truncated file behind */
+		(void) MT_remove(filename);
+  bailout:
+	be->results = res_tables_remove(be->results, t);
+	return msg;
+}
+
 /* Copy the result set into a CSV file */
 str
 mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
@@ -2602,8 +2657,6 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	res_table *t = NULL;
 	bool tostdout;
 
-	(void) format;
-
 	if ((msg = getBackendContext(cntxt, &be)) != NULL)
 		return msg;
 	m = be->mvc;
@@ -2663,6 +2716,11 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	if ( msg )
 		goto wrapup_result_set1;
 
+	if (strcmp(format, "csv") != 0) {
+		msg = mvc_export_columnar_file(be, t, filename, format, onclient);
+		goto wrapup_result_set1;
+	}
+
 	/* now select the file channel */
 	if ((tostdout = strcmp(filename,"stdout") == 0)) {
 		s = cntxt->fdout;
@@ -2776,6 +2834,8 @@ mvc_row_result_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	bat_iterator_end(&itertpe);
 	bat_iterator_end(&iterdig);
 	bat_iterator_end(&iterscl);
+	if (!msg)
+		sql_resultcache_insert(be, res);
 	if (!msg && (ok = mvc_export_result(cntxt->sqlcontext, cntxt->fdout, res, true, cntxt->qryctx.starttime, mb->optimize)) < 0)
 		msg = createException(SQL, "sql.resultSet", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(cntxt->sqlcontext, cntxt->fdout, ok));
   wrapup_result_set:
@@ -2825,7 +2885,6 @@ mvc_export_row_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	char buf[80];
 	ssize_t sz;
 
-	(void) format;
 	if ((msg = getBackendContext(cntxt, &be)) != NULL)
 		return msg;
 	m = be->mvc;
@@ -2887,6 +2946,10 @@ mvc_export_row_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	bat_iterator_end(&itertpe);
 	bat_iterator_end(&iterdig);
 	bat_iterator_end(&iterscl);
+	if (strcmp(format, "csv") != 0) {
+		msg = mvc_export_columnar_file(be, t, filename, format, onclient);
+		goto wrapup_result_set;
+	}
 	/* now select the file channel */
 	if ((tostdout = strcmp(filename,"stdout") == 0)) {
 		s = cntxt->fdout;
@@ -3129,6 +3192,7 @@ mvc_scalar_value_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		mb->optimize = 0;
 		throw(SQL, "sql.exportValue", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(be, be->out, ok));
 	}
+	sql_resultcache_insert(be, res_id);
 	if (be->output_format == OFMT_NONE) {
 		cntxt->qryctx.starttime = 0;
 		cntxt->qryctx.endtime = 0;
@@ -5475,6 +5539,10 @@ SQLstr_stop_vacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 #include "sql_transaction.h"
 #include "for.h"
 #include "dict.h"
+#include "fsst.h"
+#include "delta.h"
+#include "compression.h"
+#include "sql_plancache.h"
 #include "mel.h"
 
 
@@ -5782,6 +5850,7 @@ static mel_func sql_init_funcs[] = {
  pattern("sql", "analyze", sql_analyze, true, "Update statistics for schema", args(1,2, arg("",void),arg("sch",str))),
  pattern("sql", "analyze", sql_analyze, true, "Update statistics for table", args(1,3, arg("",void),arg("sch",str),arg("tbl",str))),
  pattern("sql", "analyze", sql_analyze, true, "Update statistics for column", args(1,4, arg("",void),arg("sch",str),arg("tbl",str),arg("col",str))),
+ pattern("sql", "analyze_group", sql_analyze_group, true, "Update the number of distinct combinations of values of a group of columns", args(1,4, arg("",void),arg("sch",str),arg("tbl",str),arg("cols",str))),
  pattern("sql", "set_count_distinct", sql_set_count_distinct, true, "Set count distinct for column", args(1,5, arg("",void),arg("sch",str),arg("tbl",str),arg("col",str),arg("val",lng))),
  pattern("sql", "set_min", sql_set_min, true, "Set min for column", args(1,5, arg("",void),arg("sch",str),arg("tbl",str),arg("col",str),argany("val",1))),
  pattern("sql", "set_max", sql_set_max, true, "Set max for column", args(1,5, arg("",void),arg("sch",str),arg("tbl",str),arg("col",str),argany("val",1))),
@@ -5820,6 +5889,20 @@ static mel_func sql_init_funcs[] = {
  pattern("dict", "thetaselect", DICTthetaselect, false, "thetaselect on a dictionary", args(1, 6, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), batargany("lv", 1), argany("val",1), arg("op", str))),
  pattern("dict", "renumber", DICTrenumber, false, "renumber offsets", args(1, 3, batargany("n", 1), batargany("o", 1), batargany("r", 1))),
  pattern("dict", "select", DICTselect, false, "value - range select on a dictionary", args(1, 10, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), batargany("lv", 1), argany("l", 1), argany("h", 1), arg("li", bit), arg("hi", bit), arg("anti", bit),  arg("unknown", bit))),
+ pattern("fsst", "compress", FSSTcompress_col, false, "compress a sql column", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
+ pattern("fsst", "decompress", FSSTdecompress, false, "decompress a fsst compressed (sub)column", args(1, 3, batarg("", str), batarg("o", blob), batarg("u", blob))),
+ command("fsst", "encode", FSSTencode, false, "fsst compress a value with the symbol table u", args(1, 3, arg("", blob), batarg("u", blob), arg("v", str))),
+ pattern("delta", "compress", DELTAcompress_col, false, "compress a sql column", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
+ pattern("delta", "decompress", DELTAdecompress, false, "decompress a delta compressed (sub)column", args(1, 4, batargany("", 1), batargany("o", 0), argany("base", 1), arg("step", lng))),
+ pattern("delta", "projection", DELTAprojection, false, "project the positions c from a delta compressed column", args(1, 5, batargany("", 1), batarg("c", oid), batargany("o", 0), argany("base", 1), arg("step", lng))),
+ pattern("delta", "thetaselect", DELTAthetaselect, false, "thetaselect on a delta compressed column", args(1, 7, batarg("", oid), batargany("o", 0), batarg("s", oid), argany("base", 1), arg("step", lng), argany("val", 1), arg("op", str))),
+ pattern("delta", "select", DELTAselect, false, "value - range select on a delta compressed column", args(1, 11, batarg("", oid), batargany("o", 0), batarg("s", oid), argany("base", 1), arg("step", lng), argany("l", 1), argany("h", 1), arg("li", bit), arg("hi", bit), arg("anti", bit), arg("unknown", bit))),
+ pattern("delta", "min", DELTAmin, false, "minimum of the positions c of a delta compressed column", args(1, 5, argany("", 1), batarg("c", oid), batargany("o", 0), argany("base", 1), arg("step", lng))),
+ pattern("delta", "max", DELTAmax, false, "maximum of the positions c of a delta compressed column", args(1, 5, argany("", 1), batarg("c", oid), batargany("o", 0), argany("base", 1), arg("step", lng))),
+ pattern("delta", "sum", DELTAsum, false, "sum of the positions c of a delta compressed column", args(1, 5, arg("", lng), batarg("c", oid), batargany("o", 0), arg("base", int), arg("step", lng))),
+#ifndef HAVE_HGE
+ pattern("delta", "sum", DELTAsum, false, "sum of the positions c of a delta compressed column", args(1, 5, arg("", lng), batarg("c", oid), batargany("o", 0), arg("base", lng), arg("step", lng))),
+#endif
  command("calc", "dec_round", bte_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, arg("",bte),arg("v",bte),arg("r",bte))),
  pattern("batcalc", "dec_round", bte_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, batarg("",bte),batarg("v",bte),arg("r",bte))),
  pattern("batcalc", "dec_round", bte_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,4, batarg("",bte),batarg("v",bte),arg("r",bte),batarg("s",oid))),
@@ -6467,6 +6550,7 @@ static mel_func sql_init_funcs[] = {
  pattern("sql", "transaction_begin", SQLtransaction_begin, true, "A transaction statement (type can be commit,release,rollback or start)", args(1,3, arg("",void),arg("chain",int),arg("name",str))),
 #ifdef HAVE_HGE
  /* sql_hge */
+ pattern("delta", "sum", DELTAsum, false, "sum of the positions c of a delta compressed column", args(1, 5, arg("", hge), batarg("c", oid), batargany("o", 0), arg("base", lng), arg("step", lng))),
  command("calc", "dec_round", hge_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, arg("",hge),arg("v",hge),arg("r",hge))),
  pattern("batcalc", "dec_round", hge_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, batarg("",hge),batarg("v",hge),arg("r",hge))),
  pattern("batcalc", "dec_round", hge_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,4, batarg("",hge),batarg("v",hge),arg("r",hge),batarg("s",oid))),
@@ -6612,6 +6696,16 @@ static mel_func sql_init_funcs[] = {
  pattern("sql", "vacuum", SQLstr_vacuum, true, "vacuum a string column", args(0,2, arg("sname",str),arg("tname",str))),
  pattern("sql", "vacuum", SQLstr_auto_vacuum, true, "auto vacuum string column of given table with interval(sec)", args(0,3, arg("sname",str),arg("tname",str),arg("interval", int))),
  pattern("sql", "stop_vacuum", SQLstr_stop_vacuum, true, "stop auto vacuum", args(0,2, arg("sname",str),arg("tname",str))),
+ pattern("sql", "compression_advisor", COMPRESSIONadvisor, true, "advise dict or for compression for all columns, and compress the advised columns if apply is set", args(0,1, arg("apply",bit))),
+ pattern("sql", "auto_compression", COMPRESSIONauto, true, "compress the advised cold columns in the background when idle, every interval(sec)", args(0,1, arg("interval",int))),
+ pattern("sql", "stop_auto_compression", COMPRESSIONstop_auto, true, "stop the background compression", args(1,1, arg("",void))),
+ pattern("sql", "compression_advice", COMPRESSIONadvice, false, "return the decisions of the compression advisor", args(9,9, batarg("column_id",int),batarg("rowcount",lng),batarg("uniques",lng),batarg("size",lng),batarg("compressed_size",lng),batarg("advice",str),batarg("applied",bit),batarg("reason",str),batarg("advised",timestamp))),
+ pattern("sql", "plan_cache", SQLplan_cache, false, "return the plans in the plan cache", args(9,9, batarg("user_id",int),batarg("role_id",int),batarg("schema_id",int),batarg("query",str),batarg("optimizer",str),batarg("hits",lng),batarg("compile_time",lng),batarg("created",timestamp),batarg("last_used",timestamp))),
+ pattern("sql", "plan_cache_stats", SQLplan_cache_stats, false, "return the statistics of the plan cache", args(8,8, batarg("size",int),batarg("entries",int),batarg("lookups",lng),batarg("hits",lng),batarg("misses",lng),batarg("inserts",lng),batarg("evictions",lng),batarg("invalidations",lng))),
+ pattern("sql", "plan_cache_size", SQLplan_cache_size, true, "set the number of plans kept in the plan cache", args(0,1, arg("size",int))),
+ pattern("sql", "result_cache", SQLresult_cache, false, "return the results in the result cache", args(10,10, batarg("user_id",int),batarg("role_id",int),batarg("schema_id",int),batarg("query",str),batarg("rows",lng),batarg("columns",int),batarg("memory",lng),batarg("hits",lng),batarg("created",timestamp),batarg("last_used",timestamp))),
+ pattern("sql", "result_cache_stats", SQLresult_cache_stats, false, "return the statistics of the result cache", args(9,9, batarg("size",int),batarg("entries",int),batarg("memory",lng),batarg("lookups",lng),batarg("hits",lng),batarg("misses",lng),batarg("inserts",lng),batarg("evictions",lng),batarg("invalidations",lng))),
+ pattern("sql", "result_cache_size", SQLresult_cache_size, true, "set the memory in MiB used by the result cache", args(0,1, arg("size",int))),
  pattern("sql", "check", SQLcheck, false, "Return sql string of check constraint.", args(1,3, arg("sql",str), arg("sname", str), arg("name", str))),
  pattern("sql", "read_dump_rel", SQLread_dump_rel, false, "Reads sql_rel string into sql_rel object and then writes it to the return value", args(1,2, arg("sql",str), arg("sql_rel", str))),
  pattern("sql", "normalize_monetdb_url", SQLnormalize_monetdb_url, false, "Normalize mapi:monetdb://, monetdb:// or monetdbs:// URL", args(1,2, arg("",str),arg("u",str))),
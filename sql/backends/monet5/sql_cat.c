@@ -1348,7 +1348,9 @@ alter_table(Client cntxt, mvc *sql, char *sname, sql_table *t)
 					if (!(b = BATdescriptor(nb->batCacheid)))
 						throw(SQL,"sql.alter_table",SQLSTATE(HY005) "Cannot access imprints index %s_%s_%s", s->base.name, t->base.name, i->base.name);
 				}
-				if(b->ttype == TYPE_str) {
+				/* the strimp of a fsst compressed column is over the decoded strings */
+				if (b->ttype == TYPE_str ||
+					(ic->c->storage_type && strcmp(ic->c->storage_type, "FSST") == 0)) {
 					if (t->access != TABLE_READONLY) {
 						BBPunfix(b->batCacheid);
 						throw(SQL, "sql.alter_TABLE", SQLSTATE(HY005) "Cannot create string imprint index %s on non read only table %s.%s", i->base.name, s->base.name, t->base.name);
@@ -0,0 +1,1777 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * Columnar export of result sets, ie.
+ *	COPY SELECT ... INTO 'file' PARQUET
+ *	COPY SELECT ... INTO 'file' ARROW
+ *
+ * The result is cut into batches of CX_BATCH rows.  The columns of a
+ * batch are encoded in parallel, each into its own buffer, straight
+ * from the BAT heaps, after which the buffers are written in column
+ * order.  There is no per row formatting of values.
+ *
+ * A Parquet file gets one row group per batch with a single column
+ * chunk per column.  The chunks consist of uncompressed PLAIN encoded
+ * data pages (v1) with min/max statistics, such that the row groups
+ * can be skipped by readers (including our own parquet loader).
+ *
+ * The Arrow output is an IPC stream (not the random access file
+ * format): a schema message followed by one record batch message per
+ * batch and the end-of-stream marker.  Fixed width columns are copied
+ * as they are, nils become nulls in the validity bitmaps.
+ */
+
+#include "monetdb_config.h"
+#include "sql_result.h"
+#include "gdk_time.h"
+
+#define CX_BATCH	((BUN) 1 << 20)	/* rows per row group / record batch */
+#define CX_PAGE		((BUN) 1 << 16)	/* rows per parquet data page */
+
+typedef enum cx_kind {
+	CX_BIT,
+	CX_BTE,
+	CX_SHT,
+	CX_INT,
+	CX_LNG,
+#ifdef HAVE_HGE
+	CX_HGE,
+#endif
+	CX_OID,
+	CX_FLT,
+	CX_DBL,
+	CX_DATE,
+	CX_TIME,
+	CX_TIMESTAMP,
+	CX_STR,
+	CX_BLOB,
+	CX_UUID,
+} cx_kind;
+
+typedef struct cx_col {
+	const char *name;
+	cx_kind kind;
+	sql_class eclass;
+	unsigned int digits, scale;
+	bool utc;			/* TIME/TIMESTAMP WITH TIME ZONE */
+	bool json;
+	BAT *b;
+	BATiter bi;
+} cx_col;
+
+typedef struct cx_buf {
+	char *buf;
+	size_t len, cap;
+	bool err;
+} cx_buf;
+
+/* the encoded column of a batch */
+typedef struct cx_part {
+	cx_buf data;			/* parquet: the pages, arrow: the buffers */
+	lng nulls;
+	const char *err;
+	/* parquet, where the chunk went and its statistics */
+	lng offset, size;
+	bool has_stats;
+	lng imin, imax;
+	ulng umin, umax;
+	dbl fmin, fmax;
+	const char *smin, *smax;	/* point into the string heap */
+	/* arrow, the buffers within data */
+	int nbufs;
+	lng bufoff[3], buflen[3];
+} cx_part;
+
+typedef struct cx_export {
+	int ncols;
+	cx_col *cols;
+	BUN nrows;
+	bool parquet;
+	date epoch;
+	/* the batch being encoded */
+	BUN start, cnt;
+	cx_part *parts;
+	ATOMIC_TYPE next;
+	QryCtx *qc;
+} cx_export;
+
+static const char cx_nomem[] = MAL_MALLOC_FAIL;
+
+static inline void
+st16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+}
+
+static inline void
+st32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+static inline void
+st64(uint8_t *p, uint64_t v)
+{
+	st32(p, (uint32_t) v);
+	st32(p + 4, (uint32_t) (v >> 32));
+}
+
+static char *
+cx_reserve(cx_buf *b, size_t n)
+{
+	if (b->err)
+		return NULL;
+	if (n > b->cap - b->len) {
+		size_t cap = MAX(b->cap + b->cap / 2, b->len + n);
+		char *p = GDKrealloc(b->buf, MAX(cap, 4096));
+		if (p == NULL) {
+			b->err = true;
+			return NULL;
+		}
+		b->buf = p;
+		b->cap = MAX(cap, 4096);
+	}
+	char *p = b->buf + b->len;
+	b->len += n;
+	return p;
+}
+
+static void
+cx_put(cx_buf *b, const void *p, size_t n)
+{
+	char *d = cx_reserve(b, n);
+	if (d && n)
+		memcpy(d, p, n);
+}
+
+static void
+cx_byte(cx_buf *b, uint8_t v)
+{
+	cx_put(b, &v, 1);
+}
+
+static void
+cx_varint(cx_buf *b, uint64_t v)
+{
+	uint8_t t[10];
+	int n = 0;
+
+	while (v >= 0x80) {
+		t[n++] = (uint8_t) (v | 0x80);
+		v >>= 7;
+	}
+	t[n++] = (uint8_t) v;
+	cx_put(b, t, n);
+}
+
+static void
+cx_le32(cx_buf *b, uint32_t v)
+{
+	uint8_t t[4];
+	st32(t, v);
+	cx_put(b, t, 4);
+}
+
+/* zero fill up to a multiple of align */
+static void
+cx_pad(cx_buf *b, size_t align)
+{
+	size_t n = (align - b->len % align) % align;
+	char *d = cx_reserve(b, n);
+	if (d && n)
+		memset(d, 0, n);
+}
+
+static void
+cx_free(cx_buf *b)
+{
+	GDKfree(b->buf);
+	*b = (cx_buf) {0};
+}
+
+static bool
+cx_write(stream *s, const void *p, size_t n)
+{
+	return n == 0 || mnstr_write(s, p, 1, n) == (ssize_t) n;
+}
+
+/*
+ * Thrift compact protocol, for the parquet page headers and footer.
+ */
+
+enum {
+	TC_TRUE = 1, TC_FALSE = 2, TC_BYTE = 3, TC_I32 = 5, TC_I64 = 6,
+	TC_BINARY = 8, TC_LIST = 9, TC_STRUCT = 12,
+};
+
+typedef struct tc {
+	cx_buf *b;
+	int depth;
+	int16_t last[16];		/* last field id per nesting level */
+} tc;
+
+static void
+tc_field(tc *t, int type, int16_t id)
+{
+	int16_t delta = id - t->last[t->depth];
+
+	if (delta > 0 && delta <= 15) {
+		cx_byte(t->b, (uint8_t) (delta << 4 | type));
+	} else {
+		cx_byte(t->b, (uint8_t) type);
+		cx_varint(t->b, (uint64_t) ((uint32_t) id << 1 ^ (uint32_t) (id >> 15)));
+	}
+	t->last[t->depth] = id;
+}
+
+static void
+tc_zigzag(tc *t, lng v)
+{
+	cx_varint(t->b, (uint64_t) v << 1 ^ (uint64_t) (v >> 63));
+}
+
+static void
+tc_i32(tc *t, int16_t id, int v)
+{
+	tc_field(t, TC_I32, id);
+	tc_zigzag(t, v);
+}
+
+static void
+tc_i64(tc *t, int16_t id, lng v)
+{
+	tc_field(t, TC_I64, id);
+	tc_zigzag(t, v);
+}
+
+static void
+tc_bool(tc *t, int16_t id, bool v)
+{
+	tc_field(t, v ? TC_TRUE : TC_FALSE, id);
+}
+
+static void
+tc_byte(tc *t, int16_t id, int8_t v)
+{
+	tc_field(t, TC_BYTE, id);
+	cx_byte(t->b, (uint8_t) v);
+}
+
+static void
+tc_binary(tc *t, int16_t id, const void *p, size_t n)
+{
+	tc_field(t, TC_BINARY, id);
+	cx_varint(t->b, n);
+	cx_put(t->b, p, n);
+}
+
+static void
+tc_string(tc *t, int16_t id, const char *s)
+{
+	tc_binary(t, id, s, strlen(s));
+}
+
+/* start a struct, either as field id or as list element (id 0) */
+static void
+tc_begin(tc *t, int16_t id)
+{
+	if (id)
+		tc_field(t, TC_STRUCT, id);
+	assert(t->depth < 15);
+	t->last[++t->depth] = 0;
+}
+
+static void
+tc_end(tc *t)
+{
+	cx_byte(t->b, 0);
+	t->depth--;
+}
+
+static void
+tc_list(tc *t, int16_t id, int type, size_t n)
+{
+	tc_field(t, TC_LIST, id);
+	if (n < 15) {
+		cx_byte(t->b, (uint8_t) (n << 4 | type));
+	} else {
+		cx_byte(t->b, (uint8_t) (0xF0 | type));
+		cx_varint(t->b, n);
+	}
+}
+
+/*
+ * Flatbuffers, for the arrow messages.  Like the official builders,
+ * the buffer is filled back to front, such that objects are created
+ * before the objects referring to them.  References to objects are
+ * their distance to the end of the buffer.
+ */
+
+typedef struct fb {
+	uint8_t *buf;			/* the data is at buf + cap - len */
+	size_t cap, len;
+	size_t minalign;
+	/* the table under construction */
+	uint32_t fields[8];
+	int nfields;
+	size_t tstart;
+	bool err;
+} fb;
+
+static uint8_t *
+fb_push(fb *f, size_t n)
+{
+	if (f->err)
+		return NULL;
+	if (n > f->cap - f->len) {
+		size_t cap = MAX(f->cap * 2, f->len + n + 256);
+		uint8_t *b = GDKmalloc(cap);
+		if (b == NULL) {
+			f->err = true;
+			return NULL;
+		}
+		if (f->len)
+			memcpy(b + cap - f->len, f->buf + f->cap - f->len, f->len);
+		GDKfree(f->buf);
+		f->buf = b;
+		f->cap = cap;
+	}
+	f->len += n;
+	return f->buf + f->cap - f->len;
+}
+
+/* align such that after n more bytes the data is aligned on a */
+static void
+fb_prep(fb *f, size_t a, size_t n)
+{
+	size_t pad = (a - (f->len + n) % a) % a;
+	uint8_t *p;
+
+	if (a > f->minalign)
+		f->minalign = a;
+	if (pad && (p = fb_push(f, pad)) != NULL)
+		memset(p, 0, pad);
+}
+
+static void
+fb_u8(fb *f, uint8_t v)
+{
+	uint8_t *p = fb_push(f, 1);
+	if (p)
+		*p = v;
+}
+
+static void
+fb_u16(fb *f, uint16_t v)
+{
+	fb_prep(f, 2, 2);
+	uint8_t *p = fb_push(f, 2);
+	if (p)
+		st16(p, v);
+}
+
+static void
+fb_u32(fb *f, uint32_t v)
+{
+	fb_prep(f, 4, 4);
+	uint8_t *p = fb_push(f, 4);
+	if (p)
+		st32(p, v);
+}
+
+static void
+fb_u64(fb *f, uint64_t v)
+{
+	fb_prep(f, 8, 8);
+	uint8_t *p = fb_push(f, 8);
+	if (p)
+		st64(p, v);
+}
+
+/* a reference is stored as the forward distance from where it is stored */
+static void
+fb_ref(fb *f, uint32_t ref)
+{
+	fb_prep(f, 4, 4);
+	fb_u32(f, (uint32_t) (f->len + 4 - ref));
+}
+
+static uint32_t
+fb_string(fb *f, const char *s)
+{
+	size_t n = strlen(s);
+	uint8_t *p;
+
+	fb_prep(f, 4, n + 1);
+	if ((p = fb_push(f, n + 1)) != NULL) {
+		memcpy(p, s, n);
+		p[n] = 0;
+	}
+	fb_u32(f, (uint32_t) n);
+	return (uint32_t) f->len;
+}
+
+static uint32_t
+fb_refs(fb *f, const uint32_t *refs, int n)
+{
+	fb_prep(f, 4, 4 * (size_t) n);
+	for (int i = n - 1; i >= 0; i--)
+		fb_ref(f, refs[i]);
+	fb_u32(f, (uint32_t) n);
+	return (uint32_t) f->len;
+}
+
+/* a vector of structs of two longs (arrow FieldNode and Buffer) */
+static uint32_t
+fb_pairs(fb *f, const lng *a, const lng *b, int n)
+{
+	fb_prep(f, 4, 16 * (size_t) n);
+	fb_prep(f, 8, 16 * (size_t) n);
+	for (int i = n - 1; i >= 0; i--) {
+		fb_u64(f, (uint64_t) b[i]);
+		fb_u64(f, (uint64_t) a[i]);
+	}
+	fb_u32(f, (uint32_t) n);
+	return (uint32_t) f->len;
+}
+
+static void
+fb_start(fb *f)
+{
+	f->nfields = 0;
+	f->tstart = f->len;
+}
+
+static void
+fb_slot(fb *f, int id)
+{
+	assert(id < 8);
+	while (f->nfields <= id)
+		f->fields[f->nfields++] = 0;
+	f->fields[id] = (uint32_t) f->len;
+}
+
+static void
+fb_field_u8(fb *f, int id, uint8_t v)
+{
+	fb_u8(f, v);
+	fb_slot(f, id);
+}
+
+static void
+fb_field_u16(fb *f, int id, uint16_t v)
+{
+	fb_u16(f, v);
+	fb_slot(f, id);
+}
+
+static void
+fb_field_u32(fb *f, int id, uint32_t v)
+{
+	fb_u32(f, v);
+	fb_slot(f, id);
+}
+
+static void
+fb_field_u64(fb *f, int id, uint64_t v)
+{
+	fb_u64(f, v);
+	fb_slot(f, id);
+}
+
+static void
+fb_field_ref(fb *f, int id, uint32_t ref)
+{
+	fb_ref(f, ref);
+	fb_slot(f, id);
+}
+
+static uint32_t
+fb_end(fb *f)
+{
+	fb_u32(f, 0);			/* the offset to the vtable */
+	uint32_t obj = (uint32_t) f->len;
+
+	for (int i = f->nfields - 1; i >= 0; i--)
+		fb_u16(f, (uint16_t) (f->fields[i] ? obj - f->fields[i] : 0));
+	fb_u16(f, (uint16_t) (obj - f->tstart));
+	fb_u16(f, (uint16_t) ((f->nfields + 2) * 2));
+	if (!f->err)
+		st32(f->buf + f->cap - obj, (uint32_t) (f->len - obj));
+	return obj;
+}
+
+static void
+fb_finish(fb *f, uint32_t root)
+{
+	fb_prep(f, MAX(f->minalign, 8), 4);
+	fb_ref(f, root);
+}
+
+/*
+ * The columns
+ */
+
+static bool
+cx_column(cx_col *c, res_col *rc)
+{
+	int tpe = ATOMstorage(c->b->ttype);
+
+	c->name = rc->name;
+	c->eclass = rc->type.type->eclass;
+	c->digits = rc->type.digits;
+	c->scale = rc->type.scale;
+	c->utc = EC_TEMP_TZ(c->eclass);
+	c->json = strcmp(rc->type.type->base.name, "json") == 0;
+	switch (c->b->ttype) {
+	case TYPE_bit: c->kind = CX_BIT; break;
+	case TYPE_bte: c->kind = CX_BTE; break;
+	case TYPE_sht: c->kind = CX_SHT; break;
+	case TYPE_int: c->kind = CX_INT; break;
+	case TYPE_lng: c->kind = CX_LNG; break;
+#ifdef HAVE_HGE
+	case TYPE_hge: c->kind = CX_HGE; break;
+#endif
+	case TYPE_oid: c->kind = CX_OID; break;
+	case TYPE_flt: c->kind = CX_FLT; break;
+	case TYPE_dbl: c->kind = CX_DBL; break;
+	case TYPE_str: c->kind = CX_STR; break;
+	default:
+		if (c->b->ttype == TYPE_date)
+			c->kind = CX_DATE;
+		else if (c->b->ttype == TYPE_daytime)
+			c->kind = CX_TIME;
+		else if (c->b->ttype == TYPE_timestamp)
+			c->kind = CX_TIMESTAMP;
+		else if (c->b->ttype == TYPE_uuid)
+			c->kind = CX_UUID;
+		else if (c->b->ttype == TYPE_blob)
+			c->kind = CX_BLOB;
+		else if (tpe == TYPE_str)	/* json, url, ... */
+			c->kind = CX_STR;
+		else			/* inet, geometries, ... */
+			return false;
+		break;
+	}
+	return true;
+}
+
+static inline lng
+cx_days(cx_export *x, date d)
+{
+	return date_diff(d, x->epoch);
+}
+
+static inline lng
+cx_usec(timestamp t)
+{
+	return timestamp_diff(t, unixepoch);
+}
+
+/*
+ * Parquet
+ */
+
+enum {
+	PQ_BOOLEAN = 0, PQ_INT32 = 1, PQ_INT64 = 2, PQ_FLOAT = 4, PQ_DOUBLE = 5,
+	PQ_BYTE_ARRAY = 6, PQ_FIXED_LEN_BYTE_ARRAY = 7,
+};
+
+static int
+pq_physical(const cx_col *c)
+{
+	switch (c->kind) {
+	case CX_BIT:
+		return PQ_BOOLEAN;
+	case CX_BTE:
+	case CX_SHT:
+	case CX_INT:
+	case CX_DATE:
+		return PQ_INT32;
+	case CX_LNG:
+	case CX_OID:
+	case CX_TIME:
+	case CX_TIMESTAMP:
+		return PQ_INT64;
+	case CX_FLT:
+		return PQ_FLOAT;
+	case CX_DBL:
+		return PQ_DOUBLE;
+	case CX_STR:
+	case CX_BLOB:
+		return PQ_BYTE_ARRAY;
+	default:
+		return PQ_FIXED_LEN_BYTE_ARRAY;
+	}
+}
+
+/* the SchemaElement of a column */
+static void
+pq_schema_element(tc *t, const cx_col *c)
+{
+	int ptype = pq_physical(c);
+	int ctype = -1, bits = 0;
+
+	tc_begin(t, 0);
+	tc_i32(t, 1, ptype);
+	if (ptype == PQ_FIXED_LEN_BYTE_ARRAY)
+		tc_i32(t, 2, 16);
+	tc_i32(t, 3, 1);		/* OPTIONAL */
+	tc_string(t, 4, c->name);
+	switch (c->kind) {
+	case CX_BTE:
+		bits = 8;
+		break;
+	case CX_SHT:
+		bits = 16;
+		break;
+	case CX_OID:
+		bits = -64;
+		break;
+	default:
+		break;
+	}
+	if (c->eclass == EC_DEC
+#ifdef HAVE_HGE
+		|| c->kind == CX_HGE
+#endif
+		) {
+		int precision = c->eclass == EC_DEC ? (int) c->digits : 38;
+		int scale = c->eclass == EC_DEC ? (int) c->scale : 0;
+
+		tc_i32(t, 6, 5);	/* DECIMAL */
+		tc_i32(t, 7, scale);
+		tc_i32(t, 8, precision);
+		tc_begin(t, 10);	/* LogicalType */
+		tc_begin(t, 5);		/* DecimalType */
+		tc_i32(t, 1, scale);
+		tc_i32(t, 2, precision);
+		tc_end(t);
+		tc_end(t);
+	} else if (bits && c->eclass != EC_MONTH && c->eclass != EC_SEC) {
+		ctype = bits == 8 ? 15 : bits == 16 ? 16 : 14;	/* INT_8, INT_16, UINT_64 */
+		tc_i32(t, 6, ctype);
+		tc_begin(t, 10);
+		tc_begin(t, 10);	/* IntType */
+		tc_byte(t, 1, (int8_t) (bits < 0 ? -bits : bits));
+		tc_bool(t, 2, bits > 0);
+		tc_end(t);
+		tc_end(t);
+	} else {
+		switch (c->kind) {
+		case CX_STR:
+			tc_i32(t, 6, c->json ? 19 : 0);	/* JSON, UTF8 */
+			tc_begin(t, 10);
+			tc_begin(t, c->json ? 12 : 1);
+			tc_end(t);
+			tc_end(t);
+			break;
+		case CX_DATE:
+			tc_i32(t, 6, 6);		/* DATE */
+			tc_begin(t, 10);
+			tc_begin(t, 6);
+			tc_end(t);
+			tc_end(t);
+			break;
+		case CX_TIME:
+		case CX_TIMESTAMP:
+			if (c->utc)		/* the converted types imply UTC */
+				tc_i32(t, 6, c->kind == CX_TIME ? 8 : 10);	/* TIME_MICROS, TIMESTAMP_MICROS */
+			tc_begin(t, 10);
+			tc_begin(t, c->kind == CX_TIME ? 7 : 8);
+			tc_bool(t, 1, c->utc);
+			tc_begin(t, 2);		/* TimeUnit */
+			tc_begin(t, 2);		/* MICROS */
+			tc_end(t);
+			tc_end(t);
+			tc_end(t);
+			tc_end(t);
+			break;
+		case CX_UUID:
+			tc_begin(t, 10);
+			tc_begin(t, 14);
+			tc_end(t);
+			tc_end(t);
+			break;
+		default:
+			break;
+		}
+	}
+	tc_end(t);
+}
+
+#define PQ_SETBIT(bm, i)	((bm)[(i) >> 3] |= (uint8_t) (1 << ((i) & 7)))
+
+/* PLAIN encode the non nil values of an integer column, keep track of
+ * the min/max */
+#define PQ_INTS(T, ISNIL, W)						\
+	do {								\
+		const T *v = (const T *) c->bi.base + p;		\
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * W); \
+		if (o == NULL)						\
+			return;						\
+		for (BUN i = 0; i < n; i++) {				\
+			if (ISNIL(v[i]))				\
+				continue;				\
+			PQ_SETBIT(bm, i);				\
+			lng iv = (lng) v[i];				\
+			if (iv < imin)					\
+				imin = iv;				\
+			if (iv > imax)					\
+				imax = iv;				\
+			if (W == 4)					\
+				st32(o + 4 * k, (uint32_t) iv);		\
+			else						\
+				st64(o + 8 * k, (uint64_t) iv);		\
+			k++;						\
+		}							\
+	} while (0)
+
+/* encode rows [p, p + n) of the batch as one data page */
+static void
+pq_page(cx_export *x, cx_col *c, cx_part *part, BUN p, BUN n, cx_buf *vals, cx_buf *defs)
+{
+	uint8_t *bm;
+	BUN k = 0;			/* number of non nil values */
+	size_t w = 0;			/* fixed size of the values */
+	lng imin = GDK_lng_max, imax = GDK_lng_min;
+	ulng umin = ~(ulng) 0, umax = 0;
+	dbl fmin = GDK_dbl_max, fmax = -GDK_dbl_max;
+	const char *smin = NULL, *smax = NULL;
+
+	vals->len = 0;
+	defs->len = 0;
+	if ((bm = (uint8_t *) cx_reserve(defs, (size_t) (n + 7) / 8)) == NULL)
+		return;
+	memset(bm, 0, (size_t) (n + 7) / 8);
+	switch (c->kind) {
+	case CX_BIT: {
+		const bit *v = (const bit *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) (n + 7) / 8);
+		if (o == NULL)
+			return;
+		memset(o, 0, (size_t) (n + 7) / 8);
+		for (BUN i = 0; i < n; i++) {
+			if (is_bit_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			if (v[i])
+				PQ_SETBIT(o, k);
+			k++;
+		}
+		vals->len = (size_t) (k + 7) / 8;
+		break;
+	}
+	case CX_BTE:
+		PQ_INTS(bte, is_bte_nil, 4);
+		w = 4;
+		break;
+	case CX_SHT:
+		PQ_INTS(sht, is_sht_nil, 4);
+		w = 4;
+		break;
+	case CX_INT:
+		PQ_INTS(int, is_int_nil, 4);
+		w = 4;
+		break;
+	case CX_LNG:
+		PQ_INTS(lng, is_lng_nil, 8);
+		w = 8;
+		break;
+	case CX_OID: {
+		const oid *v = (const oid *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * 8);
+		if (o == NULL)
+			return;
+		for (BUN i = 0; i < n; i++) {
+			if (is_oid_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			if (v[i] < umin)
+				umin = v[i];
+			if (v[i] > umax)
+				umax = v[i];
+			st64(o + 8 * k++, (uint64_t) v[i]);
+		}
+		w = 8;
+		break;
+	}
+#ifdef HAVE_HGE
+	case CX_HGE: {
+		/* big endian two's complement */
+		const hge *v = (const hge *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * 16);
+		if (o == NULL)
+			return;
+		for (BUN i = 0; i < n; i++) {
+			if (is_hge_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			uhge u = (uhge) v[i];
+			for (int j = 15; j >= 0; j--, u >>= 8)
+				o[16 * k + j] = (uint8_t) u;
+			k++;
+		}
+		w = 16;
+		break;
+	}
+#endif
+	case CX_FLT:
+	case CX_DBL: {
+		size_t fw = c->kind == CX_FLT ? 4 : 8;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * fw);
+		if (o == NULL)
+			return;
+		for (BUN i = 0; i < n; i++) {
+			dbl d;
+			if (c->kind == CX_FLT) {
+				flt f = ((const flt *) c->bi.base)[p + i];
+				if (is_flt_nil(f))
+					continue;
+				memcpy(o + 4 * k, &f, 4);
+				d = f;
+			} else {
+				d = ((const dbl *) c->bi.base)[p + i];
+				if (is_dbl_nil(d))
+					continue;
+				memcpy(o + 8 * k, &d, 8);
+			}
+			PQ_SETBIT(bm, i);
+			if (d < fmin)
+				fmin = d;
+			if (d > fmax)
+				fmax = d;
+			k++;
+		}
+		w = fw;
+		break;
+	}
+	case CX_DATE: {
+		const date *v = (const date *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * 4);
+		if (o == NULL)
+			return;
+		for (BUN i = 0; i < n; i++) {
+			if (is_date_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			lng d = cx_days(x, v[i]);
+			if (d < imin)
+				imin = d;
+			if (d > imax)
+				imax = d;
+			st32(o + 4 * k++, (uint32_t) d);
+		}
+		w = 4;
+		break;
+	}
+	case CX_TIME:
+		PQ_INTS(daytime, is_daytime_nil, 8);
+		w = 8;
+		break;
+	case CX_TIMESTAMP: {
+		const timestamp *v = (const timestamp *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(vals, (size_t) n * 8);
+		if (o == NULL)
+			return;
+		for (BUN i = 0; i < n; i++) {
+			if (is_timestamp_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			lng t = cx_usec(v[i]);
+			if (t < imin)
+				imin = t;
+			if (t > imax)
+				imax = t;
+			st64(o + 8 * k++, (uint64_t) t);
+		}
+		w = 8;
+		break;
+	}
+	case CX_STR:
+		for (BUN i = 0; i < n; i++) {
+			const char *s = BUNtvar(&c->bi, p + i);
+			if (strNil(s))
+				continue;
+			PQ_SETBIT(bm, i);
+			size_t l = strlen(s);
+			cx_le32(vals, (uint32_t) l);
+			cx_put(vals, s, l);
+			if (smin == NULL || strcmp(s, smin) < 0)
+				smin = s;
+			if (smax == NULL || strcmp(s, smax) > 0)
+				smax = s;
+			k++;
+		}
+		break;
+	case CX_BLOB:
+		for (BUN i = 0; i < n; i++) {
+			const blob *b = BUNtvar(&c->bi, p + i);
+			if (is_blob_nil(b))
+				continue;
+			PQ_SETBIT(bm, i);
+			cx_le32(vals, (uint32_t) b->nitems);
+			cx_put(vals, b->data, b->nitems);
+			k++;
+		}
+		break;
+	case CX_UUID: {
+		const uuid *v = (const uuid *) c->bi.base + p;
+		for (BUN i = 0; i < n; i++) {
+			if (is_uuid_nil(v[i]))
+				continue;
+			PQ_SETBIT(bm, i);
+			cx_put(vals, &v[i], 16);
+			k++;
+		}
+		break;
+	}
+	}
+	if (w)
+		vals->len = (size_t) k * w;
+	if (vals->err || defs->err)
+		return;
+
+	/* the page statistics are merged into those of the chunk */
+	if (k > 0 && smin) {
+		if (!part->has_stats || strcmp(smin, part->smin) < 0)
+			part->smin = smin;
+		if (!part->has_stats || strcmp(smax, part->smax) > 0)
+			part->smax = smax;
+		part->has_stats = true;
+	} else if (k > 0) {
+		if (!part->has_stats) {
+			part->imin = imin;
+			part->imax = imax;
+			part->umin = umin;
+			part->umax = umax;
+			part->fmin = fmin;
+			part->fmax = fmax;
+		} else {
+			part->imin = MIN(part->imin, imin);
+			part->imax = MAX(part->imax, imax);
+			part->umin = MIN(part->umin, umin);
+			part->umax = MAX(part->umax, umax);
+			part->fmin = MIN(part->fmin, fmin);
+			part->fmax = MAX(part->fmax, fmax);
+		}
+		part->has_stats = true;
+	}
+
+	/* definition levels, a single RLE run if there are no nulls,
+	 * bit packed otherwise */
+	cx_buf lv = {0};
+	if (k == n) {
+		cx_varint(&lv, (uint64_t) n << 1);
+		cx_byte(&lv, 1);
+	} else {
+		cx_varint(&lv, (uint64_t) (n + 7) / 8 << 1 | 1);
+		cx_put(&lv, defs->buf, (size_t) (n + 7) / 8);
+	}
+	part->nulls += (lng) (n - k);
+	if (lv.err) {
+		cx_free(&lv);
+		vals->err = true;
+		return;
+	}
+
+	size_t size = 4 + lv.len + vals->len;
+	tc t = {.b = &part->data};
+	tc_i32(&t, 1, 0);		/* DATA_PAGE */
+	tc_i32(&t, 2, (int) size);
+	tc_i32(&t, 3, (int) size);
+	tc_begin(&t, 5);		/* DataPageHeader */
+	tc_i32(&t, 1, (int) n);
+	tc_i32(&t, 2, 0);		/* PLAIN */
+	tc_i32(&t, 3, 3);		/* RLE */
+	tc_i32(&t, 4, 3);
+	tc_end(&t);
+	cx_byte(&part->data, 0);
+	cx_le32(&part->data, (uint32_t) lv.len);
+	cx_put(&part->data, lv.buf, lv.len);
+	cx_put(&part->data, vals->buf, vals->len);
+	cx_free(&lv);
+	if (size > (size_t) GDK_int_max)
+		part->err = "data page too large";
+}
+
+static void
+pq_chunk(cx_export *x, int col)
+{
+	cx_col *c = &x->cols[col];
+	cx_part *part = &x->parts[col];
+	cx_buf vals = {0}, defs = {0};
+
+	for (BUN p = 0; p < x->cnt && !part->err; p += CX_PAGE) {
+		pq_page(x, c, part, x->start + p, MIN(CX_PAGE, x->cnt - p), &vals, &defs);
+		if (vals.err || defs.err || part->data.err)
+			part->err = cx_nomem;
+	}
+	cx_free(&vals);
+	cx_free(&defs);
+}
+
+/* the min/max of a column chunk as PLAIN encoded values */
+static void
+pq_statistics(tc *t, const cx_col *c, const cx_part *p)
+{
+	uint8_t min[8], max[8];
+	size_t w = 8;
+
+	switch (c->kind) {
+	case CX_STR:
+		tc_binary(t, 5, p->smax, strlen(p->smax));
+		tc_binary(t, 6, p->smin, strlen(p->smin));
+		return;
+	case CX_OID:
+		st64(min, (uint64_t) p->umin);
+		st64(max, (uint64_t) p->umax);
+		break;
+	case CX_FLT: {
+		/* a zero min is written as -0.0, a zero max as +0.0 */
+		flt lo = p->fmin == 0 ? -0.0f : (flt) p->fmin;
+		flt hi = p->fmax == 0 ? 0.0f : (flt) p->fmax;
+		memcpy(min, &lo, 4);
+		memcpy(max, &hi, 4);
+		w = 4;
+		break;
+	}
+	case CX_DBL: {
+		dbl lo = p->fmin == 0 ? -0.0 : p->fmin;
+		dbl hi = p->fmax == 0 ? 0.0 : p->fmax;
+		memcpy(min, &lo, 8);
+		memcpy(max, &hi, 8);
+		break;
+	}
+	case CX_BTE:
+	case CX_SHT:
+	case CX_INT:
+	case CX_DATE:
+		w = 4;
+		/* fall through */
+	case CX_LNG:
+	case CX_TIME:
+	case CX_TIMESTAMP:
+		st64(min, (uint64_t) p->imin);
+		st64(max, (uint64_t) p->imax);
+		break;
+	default:			/* no (useful) ordering */
+		return;
+	}
+	tc_binary(t, 5, max, w);
+	tc_binary(t, 6, min, w);
+}
+
+static void
+pq_footer(cx_export *x, cx_buf *b, int nrg)
+{
+	tc t = {.b = b};
+
+	tc_i32(&t, 1, 1);		/* version */
+	tc_list(&t, 2, TC_STRUCT, (size_t) x->ncols + 1);
+	tc_begin(&t, 0);		/* the root */
+	tc_string(&t, 4, "schema");
+	tc_i32(&t, 5, x->ncols);
+	tc_end(&t);
+	for (int i = 0; i < x->ncols; i++)
+		pq_schema_element(&t, &x->cols[i]);
+	tc_i64(&t, 3, (lng) x->nrows);
+	tc_list(&t, 4, TC_STRUCT, (size_t) nrg);
+	for (int rg = 0; rg < nrg; rg++) {
+		cx_part *parts = x->parts + (size_t) rg * x->ncols;
+		lng size = 0;
+
+		tc_begin(&t, 0);
+		tc_list(&t, 1, TC_STRUCT, (size_t) x->ncols);
+		for (int i = 0; i < x->ncols; i++) {
+			cx_part *p = &parts[i];
+
+			size += p->size;
+			tc_begin(&t, 0);	/* ColumnChunk */
+			tc_i64(&t, 2, p->offset);
+			tc_begin(&t, 3);	/* ColumnMetaData */
+			tc_i32(&t, 1, pq_physical(&x->cols[i]));
+			tc_list(&t, 2, TC_I32, 2);
+			tc_zigzag(&t, 0);	/* PLAIN */
+			tc_zigzag(&t, 3);	/* RLE */
+			tc_list(&t, 3, TC_BINARY, 1);
+			cx_varint(b, strlen(x->cols[i].name));
+			cx_put(b, x->cols[i].name, strlen(x->cols[i].name));
+			tc_i32(&t, 4, 0);	/* UNCOMPRESSED */
+			tc_i64(&t, 5, (lng) MIN(CX_BATCH, x->nrows - (BUN) rg * CX_BATCH));
+			tc_i64(&t, 6, p->size);
+			tc_i64(&t, 7, p->size);
+			tc_i64(&t, 9, p->offset);
+			tc_begin(&t, 12);	/* Statistics */
+			tc_i64(&t, 3, p->nulls);
+			if (p->has_stats)
+				pq_statistics(&t, &x->cols[i], p);
+			tc_end(&t);
+			tc_end(&t);
+			tc_end(&t);
+		}
+		tc_i64(&t, 2, size);
+		tc_i64(&t, 3, (lng) MIN(CX_BATCH, x->nrows - (BUN) rg * CX_BATCH));
+		tc_end(&t);
+	}
+	tc_string(&t, 6, "MonetDB " MONETDB_VERSION);
+	/* without column orders readers ignore the min/max statistics */
+	tc_list(&t, 7, TC_STRUCT, (size_t) x->ncols);
+	for (int i = 0; i < x->ncols; i++) {
+		tc_begin(&t, 0);	/* ColumnOrder */
+		tc_begin(&t, 1);	/* TypeDefinedOrder */
+		tc_end(&t);
+		tc_end(&t);
+	}
+	cx_byte(b, 0);
+}
+
+/*
+ * Arrow
+ */
+
+enum {
+	AT_INT = 2, AT_FLOATINGPOINT = 3, AT_BINARY = 4, AT_UTF8 = 5,
+	AT_BOOL = 6, AT_DECIMAL = 7, AT_DATE = 8, AT_TIME = 9,
+	AT_TIMESTAMP = 10, AT_INTERVAL = 11, AT_FIXEDSIZEBINARY = 15,
+	AT_DURATION = 18,
+};
+
+/* create the type table of a column, returns the union type */
+static uint8_t
+at_type(fb *f, const cx_col *c, uint32_t *ref)
+{
+	uint32_t tz = 0;
+	int bits = 0;
+	bool sign = true;
+
+	if (c->eclass == EC_DEC
+#ifdef HAVE_HGE
+		|| c->kind == CX_HGE
+#endif
+		) {
+		fb_start(f);
+		fb_field_u32(f, 0, c->eclass == EC_DEC ? c->digits : 38);
+		fb_field_u32(f, 1, c->eclass == EC_DEC ? c->scale : 0);
+		fb_field_u32(f, 2, 128);
+		*ref = fb_end(f);
+		return AT_DECIMAL;
+	}
+	switch (c->kind) {
+	case CX_BIT:
+		fb_start(f);
+		*ref = fb_end(f);
+		return AT_BOOL;
+	case CX_BTE:
+		bits = 8;
+		break;
+	case CX_SHT:
+		bits = 16;
+		break;
+	case CX_INT:
+		if (c->eclass == EC_MONTH) {
+			fb_start(f);
+			fb_field_u16(f, 0, 0);	/* YEAR_MONTH */
+			*ref = fb_end(f);
+			return AT_INTERVAL;
+		}
+		bits = 32;
+		break;
+	case CX_LNG:
+		if (c->eclass == EC_SEC) {
+			fb_start(f);
+			fb_field_u16(f, 0, 1);	/* MILLISECOND */
+			*ref = fb_end(f);
+			return AT_DURATION;
+		}
+		bits = 64;
+		break;
+	case CX_OID:
+		bits = 64;
+		sign = false;
+		break;
+	case CX_FLT:
+	case CX_DBL:
+		fb_start(f);
+		fb_field_u16(f, 0, c->kind == CX_FLT ? 1 : 2);	/* SINGLE, DOUBLE */
+		*ref = fb_end(f);
+		return AT_FLOATINGPOINT;
+	case CX_DATE:
+		fb_start(f);
+		fb_field_u16(f, 0, 0);		/* DAY */
+		*ref = fb_end(f);
+		return AT_DATE;
+	case CX_TIME:
+		fb_start(f);
+		fb_field_u32(f, 1, 64);
+		fb_field_u16(f, 0, 2);		/* MICROSECOND */
+		*ref = fb_end(f);
+		return AT_TIME;
+	case CX_TIMESTAMP:
+		if (c->utc)
+			tz = fb_string(f, "UTC");
+		fb_start(f);
+		if (tz)
+			fb_field_ref(f, 1, tz);
+		fb_field_u16(f, 0, 2);		/* MICROSECOND */
+		*ref = fb_end(f);
+		return AT_TIMESTAMP;
+	case CX_STR:
+	case CX_BLOB:
+		fb_start(f);
+		*ref = fb_end(f);
+		return c->kind == CX_STR ? AT_UTF8 : AT_BINARY;
+	case CX_UUID:
+		fb_start(f);
+		fb_field_u32(f, 0, 16);
+		*ref = fb_end(f);
+		return AT_FIXEDSIZEBINARY;
+	default:
+		break;
+	}
+	fb_start(f);
+	fb_field_u8(f, 1, sign);
+	fb_field_u32(f, 0, (uint32_t) bits);
+	*ref = fb_end(f);
+	return AT_INT;
+}
+
+/* write a message, the flatbuffer is padded to a multiple of 8 */
+static bool
+at_message(stream *s, fb *f)
+{
+	uint8_t pre[8];
+
+	if (f->err)
+		return false;
+	st32(pre, 0xFFFFFFFF);
+	st32(pre + 4, (uint32_t) f->len);
+	assert(f->len % 8 == 0);
+	return cx_write(s, pre, 8) && cx_write(s, f->buf + f->cap - f->len, f->len);
+}
+
+static bool
+at_schema(stream *s, cx_export *x)
+{
+	fb f = {0};
+	uint32_t *fields = GDKmalloc(MAX(x->ncols, 1) * sizeof(uint32_t));
+	bool ok;
+
+	if (fields == NULL)
+		return false;
+	for (int i = 0; i < x->ncols; i++) {
+		cx_col *c = &x->cols[i];
+		uint32_t name = fb_string(&f, c->name), type, meta = 0;
+		uint8_t tt = at_type(&f, c, &type);
+		uint32_t children = fb_refs(&f, NULL, 0);
+
+		if (c->kind == CX_UUID) {	/* the canonical uuid extension type */
+			uint32_t kv[2], k, v;
+			v = fb_string(&f, "arrow.uuid");
+			k = fb_string(&f, "ARROW:extension:name");
+			fb_start(&f);
+			fb_field_ref(&f, 1, v);
+			fb_field_ref(&f, 0, k);
+			kv[0] = fb_end(&f);
+			v = fb_string(&f, "");
+			k = fb_string(&f, "ARROW:extension:metadata");
+			fb_start(&f);
+			fb_field_ref(&f, 1, v);
+			fb_field_ref(&f, 0, k);
+			kv[1] = fb_end(&f);
+			meta = fb_refs(&f, kv, 2);
+		}
+		fb_start(&f);
+		if (meta)
+			fb_field_ref(&f, 6, meta);
+		fb_field_ref(&f, 5, children);
+		fb_field_ref(&f, 3, type);
+		fb_field_ref(&f, 0, name);
+		fb_field_u8(&f, 2, tt);
+		fb_field_u8(&f, 1, 1);		/* nullable */
+		fields[i] = fb_end(&f);
+	}
+	uint32_t vec = fb_refs(&f, fields, x->ncols);
+	fb_start(&f);
+	fb_field_ref(&f, 1, vec);
+	fb_field_u16(&f, 0, 0);		/* Little endian */
+	uint32_t schema = fb_end(&f);
+	fb_start(&f);
+	fb_field_u64(&f, 3, 0);
+	fb_field_ref(&f, 2, schema);
+	fb_field_u16(&f, 0, 4);		/* V5 */
+	fb_field_u8(&f, 1, 1);		/* Schema */
+	fb_finish(&f, fb_end(&f));
+	ok = at_message(s, &f);
+	GDKfree(f.buf);
+	GDKfree(fields);
+	return ok;
+}
+
+/* add a buffer to the arrow part, padded to a multiple of 8 */
+static void
+at_buffer(cx_part *part, size_t start)
+{
+	part->bufoff[part->nbufs] = (lng) start;
+	part->buflen[part->nbufs] = (lng) (part->data.len - start);
+	part->nbufs++;
+	cx_pad(&part->data, 8);
+}
+
+static void
+at_column(cx_export *x, int col)
+{
+	cx_col *c = &x->cols[col];
+	cx_part *part = &x->parts[col];
+	cx_buf *b = &part->data;
+	BUN n = x->cnt, p = x->start;
+	size_t nb = (size_t) (n + 7) / 8, start;
+	uint8_t *valid;
+	int width = 0;
+
+	/* validity, only kept if there are nulls */
+	if ((valid = (uint8_t *) cx_reserve(b, nb)) == NULL) {
+		part->err = cx_nomem;
+		return;
+	}
+	memset(valid, 0xFF, nb);
+	switch (c->kind) {
+	case CX_BIT:
+	case CX_BTE:
+		width = 1;
+		break;
+	case CX_SHT:
+		width = 2;
+		break;
+	case CX_INT:
+	case CX_FLT:
+	case CX_DATE:
+		width = 4;
+		break;
+	case CX_LNG:
+	case CX_OID:
+	case CX_DBL:
+	case CX_TIME:
+	case CX_TIMESTAMP:
+		width = 8;
+		break;
+	default:
+		width = 16;
+		break;
+	}
+	if (c->kind != CX_STR && c->kind != CX_BLOB) {
+		const void *base = (const char *) c->bi.base + (size_t) p * c->bi.width;
+		for (BUN i = 0; i < n; i++) {
+			bool nil;
+			switch (c->kind) {
+			case CX_BIT: nil = is_bit_nil(((const bit *) base)[i]); break;
+			case CX_BTE: nil = is_bte_nil(((const bte *) base)[i]); break;
+			case CX_SHT: nil = is_sht_nil(((const sht *) base)[i]); break;
+			case CX_INT: nil = is_int_nil(((const int *) base)[i]); break;
+			case CX_LNG: nil = is_lng_nil(((const lng *) base)[i]); break;
+#ifdef HAVE_HGE
+			case CX_HGE: nil = is_hge_nil(((const hge *) base)[i]); break;
+#endif
+			case CX_OID: nil = is_oid_nil(((const oid *) base)[i]); break;
+			case CX_FLT: nil = is_flt_nil(((const flt *) base)[i]); break;
+			case CX_DBL: nil = is_dbl_nil(((const dbl *) base)[i]); break;
+			case CX_DATE: nil = is_date_nil(((const date *) base)[i]); break;
+			case CX_TIME: nil = is_daytime_nil(((const daytime *) base)[i]); break;
+			case CX_TIMESTAMP: nil = is_timestamp_nil(((const timestamp *) base)[i]); break;
+			case CX_UUID: nil = is_uuid_nil(((const uuid *) base)[i]); break;
+			default: nil = false; break;
+			}
+			if (nil) {
+				valid[i >> 3] &= (uint8_t) ~(1 << (i & 7));
+				part->nulls++;
+			}
+		}
+	} else {
+		for (BUN i = 0; i < n; i++) {
+			const void *v = BUNtvar(&c->bi, p + i);
+			if (c->kind == CX_STR ? strNil(v) : is_blob_nil((const blob *) v)) {
+				valid[i >> 3] &= (uint8_t) ~(1 << (i & 7));
+				part->nulls++;
+			}
+		}
+	}
+	if (part->nulls == 0) {
+		b->len = 0;
+		part->bufoff[0] = part->buflen[0] = 0;
+		part->nbufs = 1;
+	} else {
+		at_buffer(part, 0);
+	}
+
+	start = b->len;
+	switch (c->kind) {
+	case CX_BIT: {
+		const bit *v = (const bit *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(b, nb);
+		if (o == NULL)
+			break;
+		memset(o, 0, nb);
+		for (BUN i = 0; i < n; i++)
+			if (v[i] == 1)
+				PQ_SETBIT(o, i);
+		at_buffer(part, start);
+		break;
+	}
+	case CX_DATE: {
+		const date *v = (const date *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(b, (size_t) n * 4);
+		if (o == NULL)
+			break;
+		for (BUN i = 0; i < n; i++)
+			st32(o + 4 * i, is_date_nil(v[i]) ? 0 : (uint32_t) cx_days(x, v[i]));
+		at_buffer(part, start);
+		break;
+	}
+	case CX_TIMESTAMP: {
+		const timestamp *v = (const timestamp *) c->bi.base + p;
+		uint8_t *o = (uint8_t *) cx_reserve(b, (size_t) n * 8);
+		if (o == NULL)
+			break;
+		for (BUN i = 0; i < n; i++)
+			st64(o + 8 * i, is_timestamp_nil(v[i]) ? 0 : (uint64_t) cx_usec(v[i]));
+		at_buffer(part, start);
+		break;
+	}
+	case CX_STR:
+	case CX_BLOB: {
+		uint8_t *o = (uint8_t *) cx_reserve(b, (size_t) (n + 1) * 4);
+		size_t off = 0;
+		if (o == NULL)
+			break;
+		st32(o, 0);
+		for (BUN i = 0; i < n; i++) {
+			const void *v = BUNtvar(&c->bi, p + i);
+			if (c->kind == CX_STR) {
+				if (!strNil(v))
+					off += strlen(v);
+			} else if (!is_blob_nil((const blob *) v)) {
+				off += ((const blob *) v)->nitems;
+			}
+			if (off > (size_t) GDK_int_max) {
+				part->err = "string data of record batch too large";
+				return;
+			}
+			st32(o + 4 * (i + 1), (uint32_t) off);
+		}
+		at_buffer(part, start);
+		start = b->len;
+		if (cx_reserve(b, off) == NULL)
+			break;
+		b->len = start;
+		for (BUN i = 0; i < n; i++) {
+			const void *v = BUNtvar(&c->bi, p + i);
+			if (c->kind == CX_STR) {
+				if (!strNil(v))
+					cx_put(b, v, strlen(v));
+			} else if (!is_blob_nil((const blob *) v)) {
+				cx_put(b, ((const blob *) v)->data, ((const blob *) v)->nitems);
+			}
+		}
+		at_buffer(part, start);
+		break;
+	}
+	default:
+		if (c->eclass == EC_DEC && width < 16) {
+			/* sign extend to 128 bits */
+			uint8_t *o = (uint8_t *) cx_reserve(b, (size_t) n * 16);
+			if (o == NULL)
+				break;
+			for (BUN i = 0; i < n; i++) {
+				lng v;
+				switch (c->kind) {
+				case CX_BTE: v = ((const bte *) c->bi.base)[p + i]; break;
+				case CX_SHT: v = ((const sht *) c->bi.base)[p + i]; break;
+				case CX_INT: v = ((const int *) c->bi.base)[p + i]; break;
+				default: v = ((const lng *) c->bi.base)[p + i]; break;
+				}
+				st64(o + 16 * i, (uint64_t) v);
+				st64(o + 16 * i + 8, v < 0 ? ~(uint64_t) 0 : 0);
+			}
+		} else {
+			/* the BAT values are the arrow values */
+#ifdef WORDS_BIGENDIAN
+			if (width > 1 && c->kind != CX_UUID) {
+				part->err = "arrow export is only supported on little endian hosts";
+				return;
+			}
+#endif
+			cx_put(b, (const char *) c->bi.base + (size_t) p * width, (size_t) n * width);
+		}
+		at_buffer(part, start);
+		break;
+	}
+	if (b->err)
+		part->err = cx_nomem;
+}
+
+static bool
+at_batch(stream *s, cx_export *x)
+{
+	fb f = {0};
+	int nbufs = 0;
+	lng off = 0, *len, *nulls, *bo, *bl;
+	bool ok;
+
+	for (int i = 0; i < x->ncols; i++)
+		nbufs += x->parts[i].nbufs;
+	len = GDKmalloc(MAX(x->ncols, 1) * sizeof(lng));
+	nulls = GDKmalloc(MAX(x->ncols, 1) * sizeof(lng));
+	bo = GDKmalloc(MAX(nbufs, 1) * sizeof(lng));
+	bl = GDKmalloc(MAX(nbufs, 1) * sizeof(lng));
+	if (len == NULL || nulls == NULL || bo == NULL || bl == NULL) {
+		GDKfree(len);
+		GDKfree(nulls);
+		GDKfree(bo);
+		GDKfree(bl);
+		return false;
+	}
+	nbufs = 0;
+	for (int i = 0; i < x->ncols; i++) {
+		cx_part *p = &x->parts[i];
+		len[i] = (lng) x->cnt;
+		nulls[i] = p->nulls;
+		for (int j = 0; j < p->nbufs; j++, nbufs++) {
+			bo[nbufs] = off + p->bufoff[j];
+			bl[nbufs] = p->buflen[j];
+		}
+		off += (lng) p->data.len;
+	}
+	uint32_t buffers = fb_pairs(&f, bo, bl, nbufs);
+	uint32_t nodes = fb_pairs(&f, len, nulls, x->ncols);
+	fb_start(&f);
+	fb_field_u64(&f, 0, (uint64_t) x->cnt);
+	fb_field_ref(&f, 2, buffers);
+	fb_field_ref(&f, 1, nodes);
+	uint32_t rb = fb_end(&f);
+	fb_start(&f);
+	fb_field_u64(&f, 3, (uint64_t) off);
+	fb_field_ref(&f, 2, rb);
+	fb_field_u16(&f, 0, 4);		/* V5 */
+	fb_field_u8(&f, 1, 3);		/* RecordBatch */
+	fb_finish(&f, fb_end(&f));
+	ok = at_message(s, &f);
+	for (int i = 0; ok && i < x->ncols; i++)
+		ok = cx_write(s, x->parts[i].data.buf, x->parts[i].data.len);
+	GDKfree(f.buf);
+	GDKfree(len);
+	GDKfree(nulls);
+	GDKfree(bo);
+	GDKfree(bl);
+	return ok;
+}
+
+/*
+ * Driver
+ */
+
+static void
+cx_worker(void *arg)
+{
+	cx_export *x = arg;
+	int col;
+
+	MT_thread_set_qry_ctx(x->qc);
+	while ((col = (int) ATOMIC_ADD(&x->next, 1)) < x->ncols) {
+		if (x->parquet)
+			pq_chunk(x, col);
+		else
+			at_column(x, col);
+	}
+	MT_thread_set_qry_ctx(NULL);
+}
+
+/* encode all columns of the current batch, in parallel if worthwhile */
+static void
+cx_encode(cx_export *x)
+{
+	int nthreads = (int) MIN((BUN) MIN(GDKnr_threads, x->ncols), (x->cnt * x->ncols) / (CX_PAGE / 4) + 1);
+	MT_Id tids[64];
+	int n = 0;
+	char name[MT_NAME_LEN];
+
+	ATOMIC_SET(&x->next, 0);
+	nthreads = MIN(nthreads, 64);
+	for (int i = 1; i < nthreads; i++) {
+		snprintf(name, sizeof(name), "colexp%d", i);
+		if (MT_create_thread(&tids[n], cx_worker, x, MT_THR_JOINABLE, name) < 0)
+			break;
+		n++;
+	}
+	/* the calling thread helps out */
+	QryCtx *qc = MT_thread_get_qry_ctx();
+	cx_worker(x);
+	MT_thread_set_qry_ctx(qc);
+	for (int i = 0; i < n; i++)
+		MT_join_thread(tids[i]);
+}
+
+static int
+cx_run(stream *s, res_table *t, bool parquet)
+{
+	cx_export x = {
+		.ncols = t->nr_cols,
+		.parquet = parquet,
+		.epoch = date_create(1970, 1, 1),
+		.qc = MT_thread_get_qry_ctx(),
+		.nrows = BUN_NONE,
+	};
+	int res = 0, nbatch = 0;
+	size_t nparts = 0;
+	lng pos = 0;
+
+	ATOMIC_INIT(&x.next, 0);
+	if ((x.cols = GDKzalloc(MAX(x.ncols, 1) * sizeof(cx_col))) == NULL) {
+		res = -1;
+		goto bailout;
+	}
+	for (int i = 0; i < x.ncols; i++) {
+		cx_col *c = &x.cols[i];
+		BAT *b = BATdescriptor(t->cols[i].b);
+
+		if (b == NULL) {
+			res = -2;
+			goto bailout;
+		}
+		if (b->ttype == TYPE_void) {
+			/* a dense (or nil) oid sequence */
+			BAT *m = COLcopy(b, TYPE_oid, true, TRANSIENT);
+			BBPunfix(b->batCacheid);
+			if ((b = m) == NULL) {
+				res = -3;
+				goto bailout;
+			}
+		}
+		c->b = b;
+		if (!cx_column(c, &t->cols[i])) {
+			GDKerror("%s: column %s: type %s not supported\n", parquet ? "parquet" : "arrow", t->cols[i].name, t->cols[i].type.type->base.name);
+			res = -3;
+			goto bailout;
+		}
+		c->bi = bat_iterator(b);
+		x.nrows = MIN(x.nrows, c->bi.count);
+	}
+	if (x.nrows == BUN_NONE)
+		x.nrows = 0;
+	nbatch = (int) ((x.nrows + CX_BATCH - 1) / CX_BATCH);
+	/* parquet keeps the metadata of all row groups for the footer */
+	nparts = (size_t) (parquet ? MAX(nbatch, 1) : 1) * MAX(x.ncols, 1);
+	if ((x.parts = GDKzalloc(nparts * sizeof(cx_part))) == NULL) {
+		res = -1;
+		goto bailout;
+	}
+
+	if (parquet) {
+		if (!cx_write(s, "PAR1", 4)) {
+			res = -4;
+			goto bailout;
+		}
+		pos = 4;
+	} else if (!at_schema(s, &x)) {
+		res = mnstr_errnr(s) != MNSTR_NO__ERROR ? -4 : -1;
+		goto bailout;
+	}
+
+	cx_part *parts = x.parts;
+	for (int rg = 0; rg < nbatch; rg++) {
+		x.start = (BUN) rg * CX_BATCH;
+		x.cnt = MIN(CX_BATCH, x.nrows - x.start);
+		if (parquet)
+			x.parts = parts + (size_t) rg * x.ncols;
+		cx_encode(&x);
+		for (int i = 0; i < x.ncols; i++) {
+			if (x.parts[i].err) {
+				GDKerror("%s: column %s: %s\n", parquet ? "parquet" : "arrow", x.cols[i].name, x.parts[i].err);
+				res = x.parts[i].err == cx_nomem ? -1 : -3;
+				goto bailout;
+			}
+		}
+		if (parquet) {
+			for (int i = 0; i < x.ncols; i++) {
+				cx_part *p = &x.parts[i];
+				p->offset = pos;
+				p->size = (lng) p->data.len;
+				if (!cx_write(s, p->data.buf, p->data.len)) {
+					res = -4;
+					goto bailout;
+				}
+				pos += p->size;
+				cx_free(&p->data);
+			}
+		} else {
+			if (!at_batch(s, &x)) {
+				res = mnstr_errnr(s) != MNSTR_NO__ERROR ? -4 : -1;
+				goto bailout;
+			}
+			for (int i = 0; i < x.ncols; i++) {
+				cx_free(&x.parts[i].data);
+				x.parts[i] = (cx_part) {0};
+			}
+		}
+	}
+	x.parts = parts;
+
+	if (parquet) {
+		cx_buf footer = {0};
+		uint8_t tail[8];
+
+		pq_footer(&x, &footer, nbatch);
+		st32(tail, (uint32_t) footer.len);
+		memcpy(tail + 4, "PAR1", 4);
+		if (footer.err)
+			res = -1;
+		else if (!cx_write(s, footer.buf, footer.len) || !cx_write(s, tail, 8))
+			res = -4;
+		cx_free(&footer);
+	} else {
+		static const uint8_t eos[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+		if (!cx_write(s, eos, 8))
+			res = -4;
+	}
+
+  bailout:
+	if (x.parts) {
+		for (size_t i = 0; i < nparts; i++)
+			cx_free(&x.parts[i].data);
+		GDKfree(x.parts);
+	}
+	if (x.cols) {
+		for (int i = 0; i < x.ncols; i++) {
+			if (x.cols[i].b) {
+				if (x.cols[i].bi.b)
+					bat_iterator_end(&x.cols[i].bi);
+				BBPunfix(x.cols[i].b->batCacheid);
+			}
+		}
+		GDKfree(x.cols);
+	}
+	return res;
+}
+
+int
+mvc_export_parquet(stream *s, res_table *t)
+{
+	return cx_run(s, t, true);
+}
+
+int
+mvc_export_arrow(stream *s, res_table *t)
+{
+	return cx_run(s, t, false);
+}
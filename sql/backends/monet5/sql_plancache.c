@@ -0,0 +1,914 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/* The plan cache keeps the optimized MAL plans of read only queries for
+ * all sessions of the server, such that a query which was compiled by
+ * one session is not parsed, optimized and compiled again by the next.
+ *
+ * A plan is found by its normalised query text (white space outside
+ * quotes and comments collapsed) together with the session properties
+ * which influence the compilation (user, role, schema, optimizer and
+ * type settings).  The cached plans are never executed themselves, a
+ * session executes a private copy.  A plan is compiled for a version of
+ * the catalog; when the catalog changes (the commit of DDL, including
+ * grants and revokes) the plans of older versions are dropped.  The
+ * version of the catalog for the caches is the sum of the schema version
+ * and the cache version, which is only raised by DDL while a plan or
+ * result cache is in use, so that the prepared statements of the
+ * sessions are not affected.  As the
+ * data may change between uses, the plans are compiled without the
+ * storage based optimizations of the relational optimizer, like the
+ * plans of prepared statements.
+ *
+ * The cache is disabled by default; the number of plans it keeps is set
+ * with the plan_cache_size server option or sys.plan_cache_size(n).
+ * sys.plan_cache shows the cached plans, sys.plan_cache_stats the hit
+ * rate.
+ *
+ * Queries which differ only in the literals they compare columns with
+ * are reused per session through the query cache of prepared statements.
+ * These literals are replaced by parameters in the parse tree, the first
+ * query of such a form is prepared, the next ones are executed as an
+ * EXEC of the prepared statement with their literals.  As for explicitly
+ * prepared statements, the value based optimizations are not used.  A
+ * literal is only passed when its conversion to the type of the column
+ * does not change its value, otherwise the query is compiled as usual.
+ * The number of query forms prepared per session is set with the
+ * auto_prepare server option, by default none. */
+
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+#include "mal_instruction.h"
+#include "gdk_time.h"
+
+#include "sql_plancache.h"
+#include "sql_resultcache.h"
+#include "sql_optimizer.h"
+#include "sql_gencode.h"
+#include "rel_exp.h"
+#include "rel_psm.h"
+
+typedef struct plan {
+	char *query;				/* normalised query text */
+	BUN hash;
+	sqlid user_id;
+	sqlid role_id;
+	sqlid schema_id;
+	int sql_optimizer;
+	int timezone;
+	unsigned int div_min_scale;
+	bool no_int128;
+	const char *pipe;			/* the MAL optimizer pipeline */
+	ATOMIC_BASE_TYPE version;	/* catalog version of the plan */
+	MalBlkPtr mb;				/* the optimized plan, only copied */
+	int nr_tables;
+	sqlid *tables;				/* read by the plan, for the result cache */
+	lng hits;
+	lng compile;				/* usec spent to compile the plan */
+	ulng tick;					/* of the last use, for the LRU eviction */
+	timestamp created;
+	timestamp used;
+} plan;
+
+static MT_Lock plancache_lock = MT_LOCK_INITIALIZER(plancache_lock);
+static plan *plans = NULL;
+static int nr_plans = 0, sz_plans = -1;
+static ulng plancache_tick = 0;
+static ATOMIC_BASE_TYPE plancache_version = 0;
+static lng plancache_lookups = 0, plancache_hits = 0, plancache_inserts = 0;
+static lng plancache_evictions = 0, plancache_invalidations = 0;
+
+/* A plan or result cache was switched on or off.  Switching a cache on
+ * raises the cache version, such that transactions which started while
+ * DDL did not raise it cannot add plans or results. */
+void
+sql_cache_switched(sql_catalog *cat, bool on)
+{
+	if (on) {
+		ATOMIC_INC(&cat->caches);
+		ATOMIC_INC(&cat->cache_version);
+	} else {
+		ATOMIC_DEC(&cat->caches);
+	}
+}
+
+ATOMIC_BASE_TYPE
+sql_cache_version(sql_catalog *cat)
+{
+	return ATOMIC_GET(&cat->schema_version) + ATOMIC_GET(&cat->cache_version);
+}
+
+/* call with the plancache_lock set */
+static int
+plancache_size(sql_catalog *cat)
+{
+	if (sz_plans < 0) {
+		sz_plans = MAX(GDKgetenv_int("plan_cache_size", 0), 0);
+		if (sz_plans > 0)
+			sql_cache_switched(cat, true);
+	}
+	return sz_plans;
+}
+
+static void
+plan_destroy(plan *p)
+{
+	GDKfree(p->query);
+	GDKfree((char *) p->pipe);
+	GDKfree(p->tables);
+	if (p->mb)
+		freeMalBlk(p->mb);
+}
+
+/* call with the plancache_lock set */
+static void
+plan_remove(int i)
+{
+	plan_destroy(plans + i);
+	plans[i] = plans[--nr_plans];
+}
+
+/* call with the plancache_lock set */
+static void
+plancache_invalidate(ATOMIC_BASE_TYPE version)
+{
+	if (version == plancache_version)
+		return;
+	for (int i = 0; i < nr_plans; ) {
+		if (plans[i].version != version) {
+			plan_remove(i);
+			plancache_invalidations++;
+		} else {
+			i++;
+		}
+	}
+	plancache_version = version;
+}
+
+/* call with the plancache_lock set */
+static void
+plancache_evict(int size)
+{
+	while (nr_plans > size) {
+		int lru = 0;
+
+		for (int i = 1; i < nr_plans; i++)
+			if (plans[i].tick < plans[lru].tick)
+				lru = i;
+		plan_remove(lru);
+		plancache_evictions++;
+	}
+}
+
+/* Collapse the white space outside quotes and comments and strip the
+ * trailing semicolons, such that the same query formatted differently
+ * finds the same plan or result.  Backslash escapes make the end of a quoted
+ * string ambiguous, queries with backslashes are only stripped. */
+char *
+sql_normalise_query(allocator *sa, const char *query)
+{
+	char *r = ma_alloc(sa, strlen(query) + 1), *d = r;
+	bool verbatim = strchr(query, '\\') != NULL, space = false;
+	char quote = 0;
+
+	if (!r)
+		return NULL;
+	while (isspace((unsigned char) *query))
+		query++;
+	for (const char *s = query; *s; s++) {
+		if (verbatim || quote) {
+			if (*s == quote)
+				quote = 0;
+			*d++ = *s;
+			continue;
+		}
+		if (isspace((unsigned char) *s)) {
+			space = true;
+			continue;
+		}
+		if (space)
+			*d++ = ' ';
+		space = false;
+		if (s[0] == '-' && s[1] == '-') {
+			/* keep the line comment, including its end */
+			while (*s && *s != '\n')
+				*d++ = *s++;
+			if (!*s)
+				break;
+			*d++ = *s;
+		} else if (s[0] == '/' && s[1] == '*') {
+			const char *e = strstr(s + 2, "*/");
+			size_t l = e ? (size_t) (e - s) + 2 : strlen(s);
+
+			memcpy(d, s, l);
+			d += l;
+			s += l - 1;
+		} else {
+			if (*s == '\'' || *s == '"')
+				quote = *s;
+			*d++ = *s;
+		}
+	}
+	while (d > r && (d[-1] == ';' || isspace((unsigned char) d[-1])))
+		d--;
+	*d = 0;
+	return r;
+}
+
+/* only queries, which are not explained, traced or prepared */
+bool
+sql_plancache_statement(backend *be)
+{
+	mvc *m = be->mvc;
+
+	if (m->emode != m_normal || m->emod != mod_none || m->trace ||
+		be->subbackend || !m->sym)
+		return false;
+	switch (m->sym->token) {
+	case SQL_SELECT:
+	case SQL_JOIN:
+	case SQL_UNION:
+	case SQL_EXCEPT:
+	case SQL_INTERSECT:
+	case SQL_VALUES:
+	case SQL_WITH:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* The transaction sees the latest catalog, without changes of its own */
+bool
+sql_plancache_current(mvc *m, ATOMIC_BASE_TYPE *version)
+{
+	sql_trans *tr = m->session->tr;
+
+	*version = ATOMIC_GET(&m->session->schema_version) + ATOMIC_GET(&m->session->cache_version);
+	return !tr->parent && list_empty(tr->changes) &&
+		*version == sql_cache_version(tr->cat);
+}
+
+static void
+plan_key(plan *p, mvc *m, const char *query, ATOMIC_BASE_TYPE version)
+{
+	*p = (plan) {
+		.query = (char *) query,
+		.hash = strHash(query),
+		.user_id = m->user_id,
+		.role_id = m->role_id,
+		.schema_id = m->session->schema->base.id,
+		.sql_optimizer = m->sql_optimizer,
+		.timezone = m->timezone,
+		.div_min_scale = m->div_min_scale,
+		.no_int128 = m->no_int128,
+		.pipe = getSQLoptimizer(m),
+		.version = version,
+	};
+}
+
+static bool
+plan_match(const plan *p, const plan *k)
+{
+	return p->hash == k->hash &&
+		p->version == k->version &&
+		p->user_id == k->user_id &&
+		p->role_id == k->role_id &&
+		p->schema_id == k->schema_id &&
+		p->sql_optimizer == k->sql_optimizer &&
+		p->timezone == k->timezone &&
+		p->div_min_scale == k->div_min_scale &&
+		p->no_int128 == k->no_int128 &&
+		strcmp(p->pipe, k->pipe) == 0 &&
+		strcmp(p->query, k->query) == 0;
+}
+
+/* Plans which call MAL functions of the session (SQL functions,
+ * remote tables) or use temporary tables cannot be shared.  Neither can
+ * plans with pointer constants, like those of the file loaders (CSV,
+ * Parquet), which point into the memory of the query that compiled them. */
+static bool
+plan_shareable(MalBlkPtr mb)
+{
+	for (int i = 1; i < mb->stop; i++) {
+		InstrPtr p = getInstrPtr(mb, i);
+
+		if (p->blk)
+			return false;
+		for (int j = p->retc; j < p->argc; j++) {
+			int a = getArg(p, j);
+
+			if (!isVarConstant(mb, a))
+				continue;
+			if (getArgType(mb, p, j) == TYPE_ptr)
+				return false;
+			if (getModuleId(p) == sqlRef && getArgType(mb, p, j) == TYPE_str &&
+				getVarConstant(mb, a).val.sval &&
+				strcmp(getVarConstant(mb, a).val.sval, "tmp") == 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+/* Look for the plan of the query.  On a hit the program of the client is
+ * replaced by a copy of the cached plan, on a miss be->plan_query is set
+ * when the plan may be added to the cache once it is compiled. */
+bool
+sql_plancache_lookup(backend *be, const char *query)
+{
+	mvc *m = be->mvc;
+	Client c = be->client;
+	ATOMIC_BASE_TYPE version;
+	MalBlkPtr mb = NULL, old;
+	plan key;
+	char *q;
+
+	be->plan_query = NULL;
+	if (!query || !sql_plancache_statement(be) || !sql_plancache_current(m, &version))
+		return false;
+	MT_lock_set(&plancache_lock);
+	if (plancache_size(m->session->tr->cat) == 0) {
+		MT_lock_unset(&plancache_lock);
+		return false;
+	}
+	MT_lock_unset(&plancache_lock);
+	if ((q = sql_normalise_query(m->sa, query)) == NULL)
+		return false;
+	plan_key(&key, m, q, version);
+
+	MT_lock_set(&plancache_lock);
+	plancache_invalidate(sql_cache_version(m->session->tr->cat));
+	plancache_lookups++;
+	for (int i = 0; i < nr_plans; i++) {
+		plan *p = plans + i;
+
+		if (plan_match(p, &key)) {
+			if ((mb = copyMalBlk(p->mb)) != NULL) {
+				if (be->result_query && p->nr_tables > 0 &&
+					(be->result_tables = ma_alloc(m->sa, p->nr_tables * sizeof(sqlid))) != NULL) {
+					memcpy(be->result_tables, p->tables, p->nr_tables * sizeof(sqlid));
+					be->nr_result_tables = p->nr_tables;
+				}
+				p->hits++;
+				p->tick = ++plancache_tick;
+				p->used = timestamp_current();
+				plancache_hits++;
+			}
+			break;
+		}
+	}
+	MT_lock_unset(&plancache_lock);
+
+	if (mb == NULL) {
+		be->plan_query = q;
+		return false;
+	}
+	MT_lock_set(&mal_contextLock);
+	old = c->curprg->def;
+	c->curprg->def = mb;
+	MT_lock_unset(&mal_contextLock);
+	freeMalBlk(old);
+	return true;
+}
+
+/* Add the just compiled plan of the query to the cache */
+void
+sql_plancache_insert(backend *be, sql_rel *r, MalBlkPtr mb)
+{
+	mvc *m = be->mvc;
+	Client c = be->client;
+	ATOMIC_BASE_TYPE version;
+	sqlid *tables;
+	plan n;
+
+	if (!be->plan_query || m->type != Q_TABLE || !r || m->recursive ||
+		is_modify(r->op) || is_ddl(r->op) ||
+		!sql_plancache_current(m, &version) || !plan_shareable(mb))
+		return;
+	plan_key(&n, m, be->plan_query, version);
+	n.query = GDKstrdup(n.query);
+	n.pipe = GDKstrdup(n.pipe);
+	n.mb = copyMalBlk(mb);
+	if ((n.nr_tables = sql_resultcache_tables(m, r, &tables)) > 0 &&
+		(n.tables = GDKmalloc(n.nr_tables * sizeof(sqlid))) != NULL)
+		memcpy(n.tables, tables, n.nr_tables * sizeof(sqlid));
+	else
+		n.nr_tables = 0;
+	n.compile = GDKusec() - c->qryctx.starttime;
+	n.tick = 0;
+	n.created = n.used = timestamp_current();
+	if (n.query == NULL || n.pipe == NULL || n.mb == NULL) {
+		plan_destroy(&n);
+		return;
+	}
+
+	MT_lock_set(&plancache_lock);
+	plancache_invalidate(sql_cache_version(m->session->tr->cat));
+	for (int i = 0; i < nr_plans; i++) {
+		if (plan_match(plans + i, &n)) {
+			/* another session was first */
+			MT_lock_unset(&plancache_lock);
+			plan_destroy(&n);
+			return;
+		}
+	}
+	int size = plancache_size(m->session->tr->cat);
+	if (size == 0 || n.version != plancache_version) {
+		MT_lock_unset(&plancache_lock);
+		plan_destroy(&n);
+		return;
+	}
+	plancache_evict(size - 1);
+	if (plans == NULL && (plans = GDKmalloc(size * sizeof(plan))) == NULL) {
+		MT_lock_unset(&plancache_lock);
+		plan_destroy(&n);
+		return;
+	}
+	n.tick = ++plancache_tick;
+	plans[nr_plans++] = n;
+	plancache_inserts++;
+	MT_lock_unset(&plancache_lock);
+}
+
+#define AUTO_PREPARE_MAXPARAMS 64
+
+static int auto_prepare = -1;
+
+typedef struct literal {
+	dnode *n;					/* where the literal was in the parse tree */
+	symbol *s;
+} literal;
+
+static bool
+literal_operand(dnode *n)
+{
+	symbol *s = n->data.sym;
+
+	return n->type == type_symbol && s && s->token == SQL_ATOM &&
+		((AtomNode *) s)->a && !atom_null(((AtomNode *) s)->a);
+}
+
+static bool
+column_operand(dnode *n)
+{
+	return n->type == type_symbol && n->data.sym && n->data.sym->token == SQL_COLUMN;
+}
+
+static void
+lift_literal(mvc *m, dnode *n, literal *lits, int *nr)
+{
+	symbol *p;
+
+	if (*nr >= AUTO_PREPARE_MAXPARAMS ||
+		(p = symbol_create_int(m->sa, SQL_PARAMETER, *nr)) == NULL)
+		return;
+	sql_add_param(m, NULL, NULL);
+	lits[*nr] = (literal) { .n = n, .s = n->data.sym };
+	n->data.sym = p;
+	(*nr)++;
+}
+
+static void lift_symbol(mvc *m, symbol *s, literal *lits, int *nr);
+
+static void
+lift_dlist(mvc *m, dlist *l, literal *lits, int *nr)
+{
+	if (!l)
+		return;
+	for (dnode *n = l->h; n; n = n->next) {
+		if (n->type == type_symbol)
+			lift_symbol(m, n->data.sym, lits, nr);
+		else if (n->type == type_list)
+			lift_dlist(m, n->data.lval, lits, nr);
+	}
+}
+
+/* Replace the literals compared with a column, such that the type of the
+ * parameter is the type of the column. */
+static void
+lift_symbol(mvc *m, symbol *s, literal *lits, int *nr)
+{
+	dnode *n;
+
+	if (!s)
+		return;
+	switch (s->token) {
+	case SQL_SELECT: {
+		SelectNode *sn = (SelectNode *) s;
+
+		lift_dlist(m, sn->selection, lits, nr);
+		lift_symbol(m, sn->from, lits, nr);
+		lift_symbol(m, sn->where, lits, nr);
+		lift_symbol(m, sn->groupby, lits, nr);
+		lift_symbol(m, sn->having, lits, nr);
+		lift_symbol(m, sn->qualify, lits, nr);
+		lift_symbol(m, sn->orderby, lits, nr);
+		return;
+	}
+	case SQL_ATOM:
+		return;
+	case SQL_COMPARE:
+		/* a = 1, but not a = any (...) or a is distinct from 1 */
+		n = s->data.lval->h;
+		if (dlist_length(s->data.lval) == 3) {
+			if (column_operand(n) && literal_operand(n->next->next))
+				lift_literal(m, n->next->next, lits, nr);
+			else if (literal_operand(n) && column_operand(n->next->next))
+				lift_literal(m, n, lits, nr);
+		}
+		break;
+	case SQL_BETWEEN:
+	case SQL_NOT_BETWEEN:
+		n = s->data.lval->h;
+		if (column_operand(n)) {
+			if (literal_operand(n->next->next))
+				lift_literal(m, n->next->next, lits, nr);
+			if (literal_operand(n->next->next->next))
+				lift_literal(m, n->next->next->next, lits, nr);
+		}
+		break;
+	case SQL_IN:
+	case SQL_NOT_IN:
+		n = s->data.lval->h;
+		if (column_operand(n) && n->next->type == type_list && n->next->data.lval) {
+			for (dnode *v = n->next->data.lval->h; v; v = v->next)
+				if (literal_operand(v))
+					lift_literal(m, v, lits, nr);
+		}
+		break;
+	case SQL_LIKE:
+		n = s->data.lval->h;
+		if (column_operand(n) && n->next->data.sym->token == SQL_ESCAPE) {
+			dnode *p = n->next->data.sym->data.lval->h;
+
+			if (literal_operand(p))
+				lift_literal(m, p, lits, nr);
+		}
+		break;
+	default:
+		break;
+	}
+	if (s->type == type_symbol)
+		lift_symbol(m, s->data.sym, lits, nr);
+	else if (s->type == type_list)
+		lift_dlist(m, s->data.lval, lits, nr);
+}
+
+static void
+restore_literals(mvc *m, literal *lits, int nr)
+{
+	for (int i = 0; i < nr; i++)
+		lits[i].n->data.sym = lits[i].s;
+	m->params = NULL;
+}
+
+/* The value of the literal for the parameter, only when it compares the
+ * same as the literal would. */
+/* check up front whether a number fits the parameter rather than letting
+ * the conversion fail */
+static bool
+exactnum_fits(atom *a, sql_subtype *pt)
+{
+	sql_class lc = a->tpe.type->eclass, pc = pt->type->eclass;
+	int ls = lc == EC_DEC ? (int) a->tpe.scale : 0;
+
+	if (pc == EC_NUM) {
+		if (lc == EC_NUM)
+			return atom_digits(a) <= pt->digits;
+		return ls == 0 && (int) atom_num_digits(a) <= (int) pt->digits / 3;
+	}
+	return ls <= (int) pt->scale &&
+		(int) atom_num_digits(a) - ls <= (int) pt->digits - (int) pt->scale;
+}
+
+static atom *
+literal_value(allocator *sa, atom *a, sql_subtype *pt)
+{
+	sql_class lc = a->tpe.type->eclass, pc;
+	atom *v, *b;
+
+	if (!pt->type)
+		return NULL;
+	pc = pt->type->eclass;
+	if (EC_VARCHAR(lc) && EC_VARCHAR(pc))	/* only when it fits */
+		return atom_cast(sa, a, pt);
+	if (lc == pc || (EC_EXACTNUM(lc) && EC_EXACTNUM(pc))) {
+		if (EC_EXACTNUM(lc) && !exactnum_fits(a, pt))
+			return NULL;
+		/* the value must survive the round trip */
+		if ((v = atom_cast(sa, a, pt)) == NULL || (b = atom_cast(sa, v, &a->tpe)) == NULL ||
+			atom_cmp(a, b) != 0)
+			return NULL;
+		return v;
+	}
+	/* the conversions done for the literals of a query anyway */
+	if ((EC_EXACTNUM(lc) && pc == EC_FLT && pt->type->localtype == TYPE_dbl) ||
+		(EC_VARCHAR(lc) && EC_TEMP(pc)))
+		return atom_cast(sa, a, pt);
+	return NULL;
+}
+
+static list *
+literal_values(mvc *m, literal *lits, int nr, list *params)
+{
+	list *exps = sa_list(m->sa);
+	node *n = params ? params->h : NULL;
+
+	if (!exps || list_length(params) != nr)
+		return NULL;
+	for (int i = 0; i < nr; i++, n = n->next) {
+		sql_arg *p = n->data;
+		atom *v = literal_value(m->sa, ((AtomNode *) lits[i].s)->a, &p->type);
+		sql_exp *e;
+
+		if (!v || (e = exp_atom(m->sa, v)) == NULL)
+			return NULL;
+		append(exps, e);
+	}
+	return exps;
+}
+
+static sql_rel *
+auto_exec(backend *be, cq *q, list *exps)
+{
+	mvc *m = be->mvc;
+	sql_subfunc *f = sql_dup_subfunc(m->sa, q->f, NULL, NULL);
+	sql_exp *e;
+
+	if (!f || (e = exp_op(m->sa, list_empty(exps) ? NULL : exps, f)) == NULL)
+		return NULL;
+	m->type = q->type;
+	m->emod |= mod_exec;
+	if (be->result_query)	/* the literals are part of the query text */
+		be->nr_result_tables = sql_resultcache_tables(m, q->rel, &be->result_tables);
+	return rel_psm_stmt(m->sa, e);
+}
+
+/* call with the allocator of the statement handed over to q */
+static bool
+auto_prepare_insert(backend *be, sql_rel *r)
+{
+	mvc *m = be->mvc;
+	Client c = be->client;
+	cq *q, *o = NULL;
+	int n = 0;
+
+	for (cq *p = m->qc->q; p; p = p->next) {
+		if (p->auto_prepared) {
+			o = p;
+			n++;
+		}
+	}
+	if (o && n >= auto_prepare)	/* the oldest one makes place */
+		qc_delete(m->qc, o);
+	if ((q = qc_insert(m->qc, m->sa, r, m->sym, m->params, m->type, c->query, be->no_mitosis)) == NULL)
+		return false;
+	q->auto_prepared = true;
+	be->q = q;
+	if (backend_dumpproc(be, c, q, r) < 0) {
+		/* keep the allocator of the statement */
+		q->sa = NULL;
+		qc_delete(m->qc, q);
+		be->q = NULL;
+		return false;
+	}
+	be->q = NULL;
+	return true;
+}
+
+/* Execute the query with its column compared literals as parameters of a
+ * prepared statement, prepared now if needed.  Returns the relation to
+ * execute it or NULL to compile the query as usual. */
+sql_rel *
+sql_auto_prepare(backend *be)
+{
+	mvc *m = be->mvc;
+	literal lits[AUTO_PREPARE_MAXPARAMS];
+	int nr = 0, status = m->session->status;
+	list *exps;
+	sql_rel *r;
+	cq *q;
+
+	if (auto_prepare < 0) {
+		MT_lock_set(&plancache_lock);
+		if (auto_prepare < 0)
+			auto_prepare = MAX(GDKgetenv_int("auto_prepare", 0), 0);
+		MT_lock_unset(&plancache_lock);
+	}
+	if (auto_prepare == 0 || !m->qc || m->params || !sql_plancache_statement(be))
+		return NULL;
+	lift_symbol(m, m->sym, lits, &nr);
+	if (nr == 0)
+		return NULL;
+
+	if ((q = qc_match(m->qc, m, m->sym)) != NULL) {
+		if ((exps = literal_values(m, lits, nr, q->f->ops)) != NULL &&
+			(r = auto_exec(be, q, exps)) != NULL) {
+			m->params = NULL;
+			return r;
+		}
+		restore_literals(m, lits, nr);
+		return NULL;
+	}
+
+	m->emode = m_prepare;
+	m->auto_prepare = true;
+	r = sql_symbol2relation(be, m->sym);
+	m->auto_prepare = false;
+	if (!r || mvc_status(m) || *m->errstr ||
+		(exps = literal_values(m, lits, nr, m->params)) == NULL ||
+		!auto_prepare_insert(be, r)) {
+		/* not this query, compile it as usual */
+		m->emode = m_normal;
+		m->type = Q_PARSE;
+		*m->errstr = 0;
+		m->session->status = status;
+		be->no_mitosis = 0;
+		restore_literals(m, lits, nr);
+		return NULL;
+	}
+	m->emode = m_normal;
+
+	/* the prepared statement owns the allocator of the statement now */
+	eb_init(ma_get_eb(m->sa));
+	m->sa = create_allocator("MA_mvc", false);
+	m->sym = NULL;
+	m->runs = NULL;
+	m->params = NULL;
+	if (m->sa == NULL) {
+		(void) sql_error(m, 02, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return NULL;
+	}
+	q = m->qc->q;	/* inserted at the head */
+	if ((exps = literal_values(m, lits, nr, q->f->ops)) == NULL)
+		return NULL;
+	return auto_exec(be, q, exps);
+}
+
+str
+SQLplan_cache(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *user, *role, *schema, *query, *pipe, *hits, *compile, *created, *used;
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	MT_lock_set(&plancache_lock);
+	user = COLnew(0, TYPE_int, nr_plans, TRANSIENT);
+	role = COLnew(0, TYPE_int, nr_plans, TRANSIENT);
+	schema = COLnew(0, TYPE_int, nr_plans, TRANSIENT);
+	query = COLnew(0, TYPE_str, nr_plans, TRANSIENT);
+	pipe = COLnew(0, TYPE_str, nr_plans, TRANSIENT);
+	hits = COLnew(0, TYPE_lng, nr_plans, TRANSIENT);
+	compile = COLnew(0, TYPE_lng, nr_plans, TRANSIENT);
+	created = COLnew(0, TYPE_timestamp, nr_plans, TRANSIENT);
+	used = COLnew(0, TYPE_timestamp, nr_plans, TRANSIENT);
+	if (user == NULL || role == NULL || schema == NULL || query == NULL || pipe == NULL ||
+		hits == NULL || compile == NULL || created == NULL || used == NULL) {
+		msg = createException(SQL, "sql.plan_cache", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (int i = 0; i < nr_plans; i++) {
+		plan *p = plans + i;
+
+		if (BUNappend(user, &p->user_id, false) != GDK_SUCCEED ||
+			BUNappend(role, &p->role_id, false) != GDK_SUCCEED ||
+			BUNappend(schema, &p->schema_id, false) != GDK_SUCCEED ||
+			BUNappend(query, p->query, false) != GDK_SUCCEED ||
+			BUNappend(pipe, p->pipe, false) != GDK_SUCCEED ||
+			BUNappend(hits, &p->hits, false) != GDK_SUCCEED ||
+			BUNappend(compile, &p->compile, false) != GDK_SUCCEED ||
+			BUNappend(created, &p->created, false) != GDK_SUCCEED ||
+			BUNappend(used, &p->used, false) != GDK_SUCCEED) {
+			msg = createException(SQL, "sql.plan_cache", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	MT_lock_unset(&plancache_lock);
+
+	*getArgReference_bat(stk, pci, 0) = user->batCacheid;
+	BBPkeepref(user);
+	*getArgReference_bat(stk, pci, 1) = role->batCacheid;
+	BBPkeepref(role);
+	*getArgReference_bat(stk, pci, 2) = schema->batCacheid;
+	BBPkeepref(schema);
+	*getArgReference_bat(stk, pci, 3) = query->batCacheid;
+	BBPkeepref(query);
+	*getArgReference_bat(stk, pci, 4) = pipe->batCacheid;
+	BBPkeepref(pipe);
+	*getArgReference_bat(stk, pci, 5) = hits->batCacheid;
+	BBPkeepref(hits);
+	*getArgReference_bat(stk, pci, 6) = compile->batCacheid;
+	BBPkeepref(compile);
+	*getArgReference_bat(stk, pci, 7) = created->batCacheid;
+	BBPkeepref(created);
+	*getArgReference_bat(stk, pci, 8) = used->batCacheid;
+	BBPkeepref(used);
+	return MAL_SUCCEED;
+
+  bailout:
+	MT_lock_unset(&plancache_lock);
+	BBPreclaim(user);
+	BBPreclaim(role);
+	BBPreclaim(schema);
+	BBPreclaim(query);
+	BBPreclaim(pipe);
+	BBPreclaim(hits);
+	BBPreclaim(compile);
+	BBPreclaim(created);
+	BBPreclaim(used);
+	return msg;
+}
+
+str
+SQLplan_cache_stats(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *b[8] = { NULL };
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+	int size, entries;
+	lng lookups, hits, misses, inserts, evictions, invalidations;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	MT_lock_set(&plancache_lock);
+	size = plancache_size(m->session->tr->cat);
+	entries = nr_plans;
+	lookups = plancache_lookups;
+	hits = plancache_hits;
+	misses = plancache_lookups - plancache_hits;
+	inserts = plancache_inserts;
+	evictions = plancache_evictions;
+	invalidations = plancache_invalidations;
+	MT_lock_unset(&plancache_lock);
+
+	if ((b[0] = BATconstant(0, TYPE_int, &size, 1, TRANSIENT)) == NULL ||
+		(b[1] = BATconstant(0, TYPE_int, &entries, 1, TRANSIENT)) == NULL ||
+		(b[2] = BATconstant(0, TYPE_lng, &lookups, 1, TRANSIENT)) == NULL ||
+		(b[3] = BATconstant(0, TYPE_lng, &hits, 1, TRANSIENT)) == NULL ||
+		(b[4] = BATconstant(0, TYPE_lng, &misses, 1, TRANSIENT)) == NULL ||
+		(b[5] = BATconstant(0, TYPE_lng, &inserts, 1, TRANSIENT)) == NULL ||
+		(b[6] = BATconstant(0, TYPE_lng, &evictions, 1, TRANSIENT)) == NULL ||
+		(b[7] = BATconstant(0, TYPE_lng, &invalidations, 1, TRANSIENT)) == NULL) {
+		for (int i = 0; i < 8; i++)
+			BBPreclaim(b[i]);
+		throw(SQL, "sql.plan_cache_stats", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	for (int i = 0; i < 8; i++) {
+		*getArgReference_bat(stk, pci, i) = b[i]->batCacheid;
+		BBPkeepref(b[i]);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+SQLplan_cache_size(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int size = *getArgReference_int(stk, pci, 1);
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (is_int_nil(size) || size < 0)
+		throw(SQL, "sql.plan_cache_size", SQLSTATE(42000) "The size of the plan cache cannot be negative");
+
+	MT_lock_set(&plancache_lock);
+	plancache_evict(size);
+	if ((size > 0) != (plancache_size(m->session->tr->cat) > 0))
+		sql_cache_switched(m->session->tr->cat, size > 0);
+	if (size != sz_plans) {
+		plan *np = NULL;
+
+		if (size > 0 && (np = GDKmalloc(size * sizeof(plan))) == NULL) {
+			MT_lock_unset(&plancache_lock);
+			throw(SQL, "sql.plan_cache_size", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		}
+		if (nr_plans > 0)
+			memcpy(np, plans, nr_plans * sizeof(plan));
+		GDKfree(plans);
+		plans = np;
+		sz_plans = size;
+	}
+	MT_lock_unset(&plancache_lock);
+	return MAL_SUCCEED;
+}
@@ -0,0 +1,29 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _SQL_PLANCACHE_H_
+#define _SQL_PLANCACHE_H_
+
+#include "sql.h"
+
+extern char *sql_normalise_query(allocator *sa, const char *query);
+extern bool sql_plancache_statement(backend *be);
+extern bool sql_plancache_current(mvc *m, ATOMIC_BASE_TYPE *version);
+extern void sql_cache_switched(sql_catalog *cat, bool on);
+extern ATOMIC_BASE_TYPE sql_cache_version(sql_catalog *cat);
+extern bool sql_plancache_lookup(backend *be, const char *query);
+extern void sql_plancache_insert(backend *be, sql_rel *r, MalBlkPtr mb);
+extern sql_rel *sql_auto_prepare(backend *be);
+
+extern str SQLplan_cache(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str SQLplan_cache_stats(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str SQLplan_cache_size(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+#endif /* _SQL_PLANCACHE_H_ */
@@ -33,6 +33,11 @@ extern int mvc_export_chunk(backend *b, stream *s, int res_id, BUN offset, BUN n
 	__attribute__((__visibility__("hidden")));
 extern int mvc_export_bin_chunk(backend *b, stream *s, int res_id, BUN offset, BUN nr)
 	__attribute__((__visibility__("hidden")));
+/* sql_colexport.c: COPY SELECT ... INTO file PARQUET/ARROW */
+extern int mvc_export_parquet(stream *s, res_table *t)
+	__attribute__((__visibility__("hidden")));
+extern int mvc_export_arrow(stream *s, res_table *t)
+	__attribute__((__visibility__("hidden")));
 
 extern int mvc_export_prepare(backend *b, stream *s)
 	__attribute__((__visibility__("hidden")));
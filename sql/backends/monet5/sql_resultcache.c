@@ -0,0 +1,622 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/* The result cache keeps the result sets of read only queries for all
+ * sessions of the server, such that a query over tables which did not
+ * change since it was run last is answered without executing it.
+ *
+ * A result is found by the normalised query text, together with the
+ * session properties which influence it (user, role, schema, time zone
+ * and type settings) and the catalog version, as in the plan cache.  The
+ * literals of the query, and so its parameters, are part of the query
+ * text.  With the result the commit times of the data of the tables it
+ * read are kept; the result is only used by a transaction which sees the
+ * same commit times and has no changes of its own.  A result computed
+ * from data which was changed since is dropped at its next lookup.
+ *
+ * Only queries reading persistent tables through built-in functions
+ * without side effects, variables or the current time are cached.  The
+ * cached columns are copies, the result sets of a cache hit share them.
+ *
+ * The cache is disabled by default; the memory it may use (in MiB) is set
+ * with the result_cache_size server option or sys.result_cache_size(n),
+ * beyond it the least recently used results are dropped.
+ * sys.result_cache shows the cached results, sys.result_cache_stats the
+ * hit rate. */
+
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+#include "gdk_time.h"
+
+#include "sql_resultcache.h"
+#include "sql_plancache.h"
+#include "sql_result.h"
+#include "rel_rel.h"
+#include "rel_exp.h"
+
+typedef struct result_col {
+	char *tn;
+	char *name;
+	char *type;
+	int digits;
+	int scale;
+	bat b;						/* read only copy of the column */
+} result_col;
+
+typedef struct result {
+	char *query;				/* normalised query text */
+	BUN hash;
+	sqlid user_id;
+	sqlid role_id;
+	sqlid schema_id;
+	int timezone;
+	unsigned int div_min_scale;
+	bool no_int128;
+	ATOMIC_BASE_TYPE version;	/* catalog version of the result */
+	int nr_tables;
+	sqlid *tables;				/* the tables read */
+	ulng *ts;					/* and the commit times of their data */
+	int nr_cols;
+	result_col *cols;
+	BUN rows;
+	size_t memory;
+	lng hits;
+	ulng tick;					/* of the last use, for the LRU eviction */
+	timestamp created;
+	timestamp used;
+	struct result *next;
+} result;
+
+static MT_Lock resultcache_lock = MT_LOCK_INITIALIZER(resultcache_lock);
+static result *results = NULL;
+static int nr_results = 0, sz_results = -1;	/* in MiB */
+static size_t resultcache_memory = 0;
+static ulng resultcache_tick = 0;
+static ATOMIC_BASE_TYPE resultcache_version = 0;
+static lng resultcache_lookups = 0, resultcache_hits = 0, resultcache_inserts = 0;
+static lng resultcache_evictions = 0, resultcache_invalidations = 0;
+
+/* call with the resultcache_lock set */
+static int
+resultcache_size(sql_catalog *cat)
+{
+	if (sz_results < 0) {
+		sz_results = MAX(GDKgetenv_int("result_cache_size", 0), 0);
+		if (sz_results > 0)
+			sql_cache_switched(cat, true);
+	}
+	return sz_results;
+}
+
+/* The cached BATs outlive the query that created them, so their memory
+ * is not charged to (nor released from) the query context of the
+ * client that happens to create or drop them. */
+static void
+result_destroy(result *r)
+{
+	if (r->cols) {
+		QryCtx *qc = MT_thread_get_qry_ctx();
+
+		MT_thread_set_qry_ctx(NULL);
+		for (int i = 0; i < r->nr_cols; i++) {
+			result_col *c = r->cols + i;
+
+			GDKfree(c->tn);
+			GDKfree(c->name);
+			GDKfree(c->type);
+			if (c->b)
+				BBPrelease(c->b);
+		}
+		MT_thread_set_qry_ctx(qc);
+	}
+	GDKfree(r->cols);
+	GDKfree(r->tables);
+	GDKfree(r->ts);
+	GDKfree(r->query);
+	GDKfree(r);
+}
+
+/* call with the resultcache_lock set */
+static void
+result_remove(result *r)
+{
+	result **p = &results;
+
+	while (*p != r)
+		p = &(*p)->next;
+	*p = r->next;
+	resultcache_memory -= r->memory;
+	nr_results--;
+	result_destroy(r);
+}
+
+/* call with the resultcache_lock set */
+static void
+resultcache_invalidate(ATOMIC_BASE_TYPE version)
+{
+	if (version == resultcache_version)
+		return;
+	for (result *r = results, *n; r; r = n) {
+		n = r->next;
+		if (r->version != version) {
+			result_remove(r);
+			resultcache_invalidations++;
+		}
+	}
+	resultcache_version = version;
+}
+
+/* call with the resultcache_lock set */
+static void
+resultcache_evict(size_t memory)
+{
+	while (results && resultcache_memory > memory) {
+		result *lru = results;
+
+		for (result *r = results->next; r; r = r->next)
+			if (r->tick < lru->tick)
+				lru = r;
+		result_remove(lru);
+		resultcache_evictions++;
+	}
+}
+
+static void
+result_key(result *r, mvc *m, const char *query, ATOMIC_BASE_TYPE version)
+{
+	*r = (result) {
+		.query = (char *) query,
+		.hash = strHash(query),
+		.user_id = m->user_id,
+		.role_id = m->role_id,
+		.schema_id = m->session->schema->base.id,
+		.timezone = m->timezone,
+		.div_min_scale = m->div_min_scale,
+		.no_int128 = m->no_int128,
+		.version = version,
+	};
+}
+
+static bool
+result_match(const result *r, const result *k)
+{
+	return r->hash == k->hash &&
+		r->version == k->version &&
+		r->user_id == k->user_id &&
+		r->role_id == k->role_id &&
+		r->schema_id == k->schema_id &&
+		r->timezone == k->timezone &&
+		r->div_min_scale == k->div_min_scale &&
+		r->no_int128 == k->no_int128 &&
+		strcmp(r->query, k->query) == 0;
+}
+
+/* The commit time of the data of a table as seen by the transaction, 0
+ * when it is not known */
+static ulng
+table_ts(sql_trans *tr, sqlid id)
+{
+	sqlstore *store = tr->store;
+	sql_table *t = sql_trans_find_table(tr, id);
+
+	return t ? store->storage_api.commit_ts_tab(tr, t) : 0;
+}
+
+typedef struct reads {
+	list *tables;
+	bool cacheable;
+} reads;
+
+static sql_rel *
+result_rel(visitor *v, sql_rel *rel)
+{
+	reads *rd = v->data;
+
+	switch (rel->op) {
+	case op_basetable: {
+		sql_table *t = rel->l;
+
+		if (!t || !isTable(t) || isTempTable(t))
+			rd->cacheable = false;
+		else if (!list_find_base_id(rd->tables, t->base.id))
+			list_append(rd->tables, t);
+		break;
+	}
+	case op_table:
+		if (rel->flag != TABLE_FROM_RELATION)
+			rd->cacheable = false;	/* table returning functions */
+		break;
+	case op_ddl:
+	case op_sample:
+	case op_insert:
+	case op_update:
+	case op_delete:
+	case op_truncate:
+		rd->cacheable = false;
+		break;
+	default:
+		break;
+	}
+	return rel;
+}
+
+static sql_exp *
+result_exp(visitor *v, sql_rel *rel, sql_exp *e, int depth)
+{
+	reads *rd = v->data;
+
+	(void) rel;
+	(void) depth;
+	switch (e->type) {
+	case e_func:
+	case e_aggr: {
+		sql_func *f = ((sql_subfunc *) e->f)->func;
+
+		if (f->side_effect || !f->system ||
+			(f->lang != FUNC_LANG_INT && f->lang != FUNC_LANG_MAL) ||
+			(f->imp && (strncmp(f->imp, "current_", 8) == 0 || strcmp(f->imp, "get_value") == 0)))
+			rd->cacheable = false;
+		break;
+	}
+	case e_atom:
+		if (e->r)	/* a variable */
+			rd->cacheable = false;
+		break;
+	case e_psm:
+		if (!exp_is_rel(e))
+			rd->cacheable = false;
+		break;
+	default:
+		break;
+	}
+	return e;
+}
+
+/* The ids of the tables read by the relational plan of a query, or 0 when
+ * its result cannot be cached */
+int
+sql_resultcache_tables(mvc *m, sql_rel *r, sqlid **tables)
+{
+	reads rd = { .tables = sa_list(m->sa), .cacheable = true };
+	visitor v = { .sql = m, .data = &rd };
+	int nr = 0;
+
+	*tables = NULL;
+	if (!r || !rd.tables)
+		return 0;
+	(void) rel_visitor_topdown(&v, r, &result_rel);
+	if (rd.cacheable)
+		(void) rel_exp_visitor_topdown(&v, r, &result_exp, true);
+	if (!rd.cacheable || list_empty(rd.tables) ||
+		(*tables = ma_alloc(m->sa, list_length(rd.tables) * sizeof(sqlid))) == NULL)
+		return 0;
+	for (node *n = rd.tables->h; n; n = n->next)
+		(*tables)[nr++] = ((sql_table *) n->data)->base.id;
+	return nr;
+}
+
+/* Look for the result of the query.  On a hit the result set is added to
+ * the results of the session and its id returned, on a miss
+ * be->result_query is set when the result may be added to the cache once
+ * it is computed. */
+int
+sql_resultcache_lookup(backend *be, const char *query)
+{
+	mvc *m = be->mvc;
+	Client c = be->client;
+	sql_trans *tr = m->session->tr;
+	ATOMIC_BASE_TYPE version;
+	result key, *r;
+	char *q;
+	int res_id = -1;
+
+	be->result_query = NULL;
+	be->result_tables = NULL;
+	be->nr_result_tables = 0;
+	if (!query || !sql_plancache_statement(be) || !sql_plancache_current(m, &version))
+		return -1;
+	MT_lock_set(&resultcache_lock);
+	if (resultcache_size(tr->cat) == 0) {
+		MT_lock_unset(&resultcache_lock);
+		return -1;
+	}
+	MT_lock_unset(&resultcache_lock);
+	if ((q = sql_normalise_query(m->sa, query)) == NULL)
+		return -1;
+	result_key(&key, m, q, version);
+
+	MT_lock_set(&resultcache_lock);
+	resultcache_invalidate(sql_cache_version(tr->cat));
+	resultcache_lookups++;
+	for (r = results; r; r = r->next)
+		if (result_match(r, &key))
+			break;
+	for (int i = 0; r && i < r->nr_tables; i++) {
+		ulng ts = table_ts(tr, r->tables[i]);
+
+		if (ts != r->ts[i]) {
+			if (ts) {	/* the data changed since */
+				result_remove(r);
+				resultcache_invalidations++;
+			}
+			r = NULL;
+		}
+	}
+	if (r) {
+		(void) runtimeProfileSetTag(c);
+		if ((res_id = mvc_result_table(be, c->curprg->def->tag, r->nr_cols, Q_TABLE)) >= 0) {
+			for (int i = 0; i < r->nr_cols && res_id >= 0; i++) {
+				result_col *rc = r->cols + i;
+				BAT *b = BATdescriptor(rc->b);
+
+				if (b == NULL || mvc_result_column(be, rc->tn, rc->name, rc->type, rc->digits, rc->scale, b) != 0) {
+					be->results = res_tables_remove(be->results, be->results);
+					res_id = -1;
+				}
+				BBPreclaim(b);
+			}
+		}
+		if (res_id >= 0) {
+			r->hits++;
+			r->tick = ++resultcache_tick;
+			r->used = timestamp_current();
+			resultcache_hits++;
+		}
+	}
+	MT_lock_unset(&resultcache_lock);
+
+	if (res_id < 0)
+		be->result_query = q;
+	return res_id;
+}
+
+/* Add the result set of the query, just computed, to the cache */
+void
+sql_resultcache_insert(backend *be, int res_id)
+{
+	mvc *m = be->mvc;
+	sql_trans *tr = m->session->tr;
+	ATOMIC_BASE_TYPE version;
+	res_table *t;
+	result *n;
+
+	if (!be->result_query || be->nr_result_tables == 0 ||
+		(t = res_tables_find(be->results, res_id)) == NULL ||
+		!sql_plancache_current(m, &version))
+		return;
+	if ((n = GDKmalloc(sizeof(result))) == NULL)
+		return;
+	result_key(n, m, be->result_query, version);
+	be->result_query = NULL;	/* only the first result set of the query */
+	n->query = GDKstrdup(n->query);
+	n->nr_tables = be->nr_result_tables;
+	n->tables = GDKmalloc(n->nr_tables * sizeof(sqlid));
+	n->ts = GDKmalloc(n->nr_tables * sizeof(ulng));
+	n->cols = GDKzalloc(t->nr_cols * sizeof(result_col));
+	n->nr_cols = t->nr_cols;
+	n->rows = t->nr_rows;
+	n->created = n->used = timestamp_current();
+	if (n->query == NULL || n->tables == NULL || n->ts == NULL || n->cols == NULL) {
+		result_destroy(n);
+		return;
+	}
+	n->memory = strlen(n->query) + 1;
+	for (int i = 0; i < n->nr_tables; i++) {
+		n->tables[i] = be->result_tables[i];
+		if ((n->ts[i] = table_ts(tr, n->tables[i])) == 0) {
+			result_destroy(n);
+			return;
+		}
+	}
+	for (int i = 0; i < t->nr_cols; i++) {
+		res_col *c = t->cols + i;
+		result_col *rc = n->cols + i;
+		BAT *b, *cb;
+
+		rc->tn = GDKstrdup(c->tn);
+		rc->name = GDKstrdup(c->name);
+		rc->type = GDKstrdup(c->type.type->base.name);
+		rc->digits = c->type.digits;
+		rc->scale = c->type.scale;
+		if (rc->tn == NULL || rc->name == NULL || rc->type == NULL ||
+			(b = BATdescriptor(c->b)) == NULL) {
+			result_destroy(n);
+			return;
+		}
+		QryCtx *qc = MT_thread_get_qry_ctx();
+		MT_thread_set_qry_ctx(NULL);
+		cb = COLcopy(b, b->ttype, true, TRANSIENT);
+		MT_thread_set_qry_ctx(qc);
+		BBPunfix(b->batCacheid);
+		if (cb == NULL) {
+			result_destroy(n);
+			return;
+		}
+		n->memory += cb->theap->free + (cb->tvheap ? cb->tvheap->free : 0);
+		rc->b = cb->batCacheid;
+		BBPkeepref(cb);
+	}
+
+	MT_lock_set(&resultcache_lock);
+	resultcache_invalidate(sql_cache_version(tr->cat));
+	size_t size = (size_t) resultcache_size(tr->cat) << 20;
+	bool found = false;
+
+	for (result *r = results; r && !found; r = r->next)
+		found = result_match(r, n);	/* another session was first */
+	if (found || n->version != resultcache_version || n->memory > size) {
+		MT_lock_unset(&resultcache_lock);
+		result_destroy(n);
+		return;
+	}
+	resultcache_evict(size - n->memory);
+	n->tick = ++resultcache_tick;
+	n->next = results;
+	results = n;
+	nr_results++;
+	resultcache_memory += n->memory;
+	resultcache_inserts++;
+	MT_lock_unset(&resultcache_lock);
+}
+
+str
+SQLresult_cache(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *user, *role, *schema, *query, *rows, *cols, *memory, *hits, *created, *used;
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	MT_lock_set(&resultcache_lock);
+	user = COLnew(0, TYPE_int, nr_results, TRANSIENT);
+	role = COLnew(0, TYPE_int, nr_results, TRANSIENT);
+	schema = COLnew(0, TYPE_int, nr_results, TRANSIENT);
+	query = COLnew(0, TYPE_str, nr_results, TRANSIENT);
+	rows = COLnew(0, TYPE_lng, nr_results, TRANSIENT);
+	cols = COLnew(0, TYPE_int, nr_results, TRANSIENT);
+	memory = COLnew(0, TYPE_lng, nr_results, TRANSIENT);
+	hits = COLnew(0, TYPE_lng, nr_results, TRANSIENT);
+	created = COLnew(0, TYPE_timestamp, nr_results, TRANSIENT);
+	used = COLnew(0, TYPE_timestamp, nr_results, TRANSIENT);
+	if (user == NULL || role == NULL || schema == NULL || query == NULL || rows == NULL ||
+		cols == NULL || memory == NULL || hits == NULL || created == NULL || used == NULL) {
+		msg = createException(SQL, "sql.result_cache", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (result *r = results; r; r = r->next) {
+		lng nrows = (lng) r->rows, mem = (lng) r->memory;
+
+		if (BUNappend(user, &r->user_id, false) != GDK_SUCCEED ||
+			BUNappend(role, &r->role_id, false) != GDK_SUCCEED ||
+			BUNappend(schema, &r->schema_id, false) != GDK_SUCCEED ||
+			BUNappend(query, r->query, false) != GDK_SUCCEED ||
+			BUNappend(rows, &nrows, false) != GDK_SUCCEED ||
+			BUNappend(cols, &r->nr_cols, false) != GDK_SUCCEED ||
+			BUNappend(memory, &mem, false) != GDK_SUCCEED ||
+			BUNappend(hits, &r->hits, false) != GDK_SUCCEED ||
+			BUNappend(created, &r->created, false) != GDK_SUCCEED ||
+			BUNappend(used, &r->used, false) != GDK_SUCCEED) {
+			msg = createException(SQL, "sql.result_cache", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	MT_lock_unset(&resultcache_lock);
+
+	*getArgReference_bat(stk, pci, 0) = user->batCacheid;
+	BBPkeepref(user);
+	*getArgReference_bat(stk, pci, 1) = role->batCacheid;
+	BBPkeepref(role);
+	*getArgReference_bat(stk, pci, 2) = schema->batCacheid;
+	BBPkeepref(schema);
+	*getArgReference_bat(stk, pci, 3) = query->batCacheid;
+	BBPkeepref(query);
+	*getArgReference_bat(stk, pci, 4) = rows->batCacheid;
+	BBPkeepref(rows);
+	*getArgReference_bat(stk, pci, 5) = cols->batCacheid;
+	BBPkeepref(cols);
+	*getArgReference_bat(stk, pci, 6) = memory->batCacheid;
+	BBPkeepref(memory);
+	*getArgReference_bat(stk, pci, 7) = hits->batCacheid;
+	BBPkeepref(hits);
+	*getArgReference_bat(stk, pci, 8) = created->batCacheid;
+	BBPkeepref(created);
+	*getArgReference_bat(stk, pci, 9) = used->batCacheid;
+	BBPkeepref(used);
+	return MAL_SUCCEED;
+
+  bailout:
+	MT_lock_unset(&resultcache_lock);
+	BBPreclaim(user);
+	BBPreclaim(role);
+	BBPreclaim(schema);
+	BBPreclaim(query);
+	BBPreclaim(rows);
+	BBPreclaim(cols);
+	BBPreclaim(memory);
+	BBPreclaim(hits);
+	BBPreclaim(created);
+	BBPreclaim(used);
+	return msg;
+}
+
+str
+SQLresult_cache_stats(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *b[9] = { NULL };
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+	int size, entries;
+	lng memory, lookups, hits, misses, inserts, evictions, invalidations;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	MT_lock_set(&resultcache_lock);
+	size = resultcache_size(m->session->tr->cat);
+	entries = nr_results;
+	memory = (lng) resultcache_memory;
+	lookups = resultcache_lookups;
+	hits = resultcache_hits;
+	misses = resultcache_lookups - resultcache_hits;
+	inserts = resultcache_inserts;
+	evictions = resultcache_evictions;
+	invalidations = resultcache_invalidations;
+	MT_lock_unset(&resultcache_lock);
+
+	if ((b[0] = BATconstant(0, TYPE_int, &size, 1, TRANSIENT)) == NULL ||
+		(b[1] = BATconstant(0, TYPE_int, &entries, 1, TRANSIENT)) == NULL ||
+		(b[2] = BATconstant(0, TYPE_lng, &memory, 1, TRANSIENT)) == NULL ||
+		(b[3] = BATconstant(0, TYPE_lng, &lookups, 1, TRANSIENT)) == NULL ||
+		(b[4] = BATconstant(0, TYPE_lng, &hits, 1, TRANSIENT)) == NULL ||
+		(b[5] = BATconstant(0, TYPE_lng, &misses, 1, TRANSIENT)) == NULL ||
+		(b[6] = BATconstant(0, TYPE_lng, &inserts, 1, TRANSIENT)) == NULL ||
+		(b[7] = BATconstant(0, TYPE_lng, &evictions, 1, TRANSIENT)) == NULL ||
+		(b[8] = BATconstant(0, TYPE_lng, &invalidations, 1, TRANSIENT)) == NULL) {
+		for (int i = 0; i < 9; i++)
+			BBPreclaim(b[i]);
+		throw(SQL, "sql.result_cache_stats", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	for (int i = 0; i < 9; i++) {
+		*getArgReference_bat(stk, pci, i) = b[i]->batCacheid;
+		BBPkeepref(b[i]);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+SQLresult_cache_size(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int size = *getArgReference_int(stk, pci, 1);
+	str msg = MAL_SUCCEED;
+	mvc *m = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (is_int_nil(size) || size < 0)
+		throw(SQL, "sql.result_cache_size", SQLSTATE(42000) "The size of the result cache cannot be negative");
+
+	MT_lock_set(&resultcache_lock);
+	resultcache_evict((size_t) size << 20);
+	if ((size > 0) != (resultcache_size(m->session->tr->cat) > 0))
+		sql_cache_switched(m->session->tr->cat, size > 0);
+	sz_results = size;
+	MT_lock_unset(&resultcache_lock);
+	return MAL_SUCCEED;
+}
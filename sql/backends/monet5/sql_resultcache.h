@@ -0,0 +1,24 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _SQL_RESULTCACHE_H_
+#define _SQL_RESULTCACHE_H_
+
+#include "sql.h"
+
+extern int sql_resultcache_tables(mvc *m, sql_rel *r, sqlid **tables);
+extern int sql_resultcache_lookup(backend *be, const char *query);
+extern void sql_resultcache_insert(backend *be, int res_id);
+
+extern str SQLresult_cache(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str SQLresult_cache_stats(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str SQLresult_cache_size(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+#endif /* _SQL_RESULTCACHE_H_ */
@@ -31,6 +31,8 @@
 #include "sql_user.h"
 #include "sql_datetime.h"
 #include "sql_import.h"
+#include "sql_plancache.h"
+#include "sql_resultcache.h"
 #include "mal.h"
 #include "mal_instruction.h"
 #include "mal_interpreter.h"
@@ -1411,7 +1413,7 @@ SQLparser_body(Client c, backend *be)
 
 	int pstatus = m->session->status;
 
-	int err = 0;
+	int err = 0, res_id;
 	m->type = Q_PARSE;
 	m->emode = m_normal;
 	m->emod = mod_none;
@@ -1492,8 +1494,25 @@ SQLparser_body(Client c, backend *be)
 			msg = createException(PARSE, "SQLparser", SQLSTATE(45000) "Export operation failed: %s", mvc_export_error(be, c->fdout, err));
 		sqlcleanup(be, 0);
 		return msg;
+	} else if ((res_id = sql_resultcache_lookup(be, c->query)) >= 0) {
+		/* the result of another run of the query is in the result cache */
+		m->type = Q_TABLE;
+		mvc_query_processed(m);
+		if ((err = mvc_export_result(be, c->fdout, res_id, true, c->qryctx.starttime, 0)) < 0)
+			msg = createException(PARSE, "SQLparser", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(be, c->fdout, err));
+	} else if (sql_plancache_lookup(be, c->query)) {
+		/* the optimized plan of another run of the query is in the plan cache */
+		(void)runtimeProfileSetTag(c);
+		m->type = Q_TABLE;
+		mvc_query_processed(m);
 	} else {
-		sql_rel *r = sql_symbol2relation(be, m->sym);
+		sql_rel *r = sql_auto_prepare(be);
+
+		if (!r && !mvc_status(m)) {
+			r = sql_symbol2relation(be, m->sym);
+			if (r && be->result_query)
+				be->nr_result_tables = sql_resultcache_tables(m, r, &be->result_tables);
+		}
 
 		if (!r || (err = mvc_status(m) && m->type != Q_TRANS && *m->errstr)) {
 			if (strlen(m->errstr) > 6 && m->errstr[5] == '!')
@@ -1574,6 +1593,8 @@ SQLparser_body(Client c, backend *be)
 						freeVariables(c, c->curprg->def, NULL, oldvtop);
 						goto finalize;
 					}
+					if (!c->curprg->def->errors)
+						sql_plancache_insert(be, r, c->curprg->def);
 				} else if (msg == MAL_SUCCEED && !opt) {
 					c->curprg->def->vsize = c->curprg->def->vtop; /* no optimizations, ie no need for extra variables */
 				}
@@ -1743,6 +1764,8 @@ SQLengine_(Client c)
 
 	if (m->type == Q_SCHEMA && m->qc != NULL)
 		qc_clean(m->qc);
+	if (m->type == Q_SCHEMA && !msg && !list_empty(m->session->tr->changes))
+		m->catalog_changed = true;	/* invalidates the plan cache at commit */
 	be->q = NULL;
 	if (msg)
 		m->session->status = -10;
@@ -697,6 +697,8 @@ stmt_bat(backend *be, sql_column *c, int access, int partition)
 			goto bailout;
 		}
 		tt = b->ttype;
+	} else if (c->storage_type && strcmp(c->storage_type, "FSST") == 0) {
+		tt = TYPE_blob; /* the symbol table */
 	}
 	if (access == RD_UPD_ID) {
 		q = pushReturn(mb, q, newTmpVariable(mb, newBatType(tt)));
@@ -2412,6 +2414,52 @@ stmt_tinter(backend *be, stmt *op1, stmt *op2, bool single)
 	return NULL;
 }
 
+/* candidates of op1 (restricted to lcand) whose value may occur in op2,
+ * used to reduce the left input of an equi-join before it is projected */
+stmt *
+stmt_bloomfilter(backend *be, stmt *op1, stmt *op2, stmt *lcand)
+{
+	InstrPtr q = NULL;
+	MalBlkPtr mb = be->mb;
+
+	if (op1 == NULL || op2 == NULL || op1->nr < 0 || op2->nr < 0)
+		goto bailout;
+	q = newStmt(mb, algebraRef, bloomfilterRef);
+	if (q == NULL)
+		goto bailout;
+	q = pushArgument(mb, q, op1->nr); /* left */
+	q = pushArgument(mb, q, op2->nr); /* right */
+	if (lcand)
+		q = pushArgument(mb, q, lcand->nr); /* left candidate */
+	else
+		q = pushNilBat(mb, q); /* left candidate */
+	q = pushNilBat(mb, q); /* right candidate */
+
+	bool enabled = ma_get_eb(be->mvc->sa)->enabled;
+	ma_get_eb(be->mvc->sa)->enabled = false;
+	stmt *s = stmt_create(be->mvc->sa, st_tinter);
+	ma_get_eb(be->mvc->sa)->enabled = enabled;
+	if (s == NULL) {
+		freeInstruction(be->mb, q);
+		goto bailout;
+	}
+
+	s->op1 = op1;
+	s->op2 = op2;
+	s->nrcols = op1->nrcols;
+	s->key = op1->key;
+	s->aggr = op1->aggr;
+	s->nr = getDestVar(q);
+	s->q = q;
+	pushInstruction(mb, q);
+	return s;
+
+  bailout:
+	if (ma_get_eb(be->mvc->sa)->enabled)
+		eb_error(ma_get_eb(be->mvc->sa), be->mvc->errstr[0] ? be->mvc->errstr : mb->errors ? mb->errors : *GDKerrbuf ? GDKerrbuf : "out of memory", 1000);
+	return NULL;
+}
+
 stmt *
 stmt_join_cand(backend *be, stmt *op1, stmt *op2, stmt *lcand, stmt *rcand, int anti, comp_type cmptype, int need_left, int is_semantics, bool single, bool inner)
 {
@@ -2830,6 +2878,92 @@ stmt_for(backend *be, stmt *op1, stmt *min_val)
 	return NULL;
 }
 
+stmt *
+stmt_delta(backend *be, stmt *op1, stmt *base, stmt *step)
+{
+	MalBlkPtr mb = be->mb;
+	InstrPtr q = NULL;
+
+	if (op1 == NULL || base == NULL || step == NULL || op1->nr < 0)
+		return NULL;
+
+	q = newStmt(mb, deltaRef, decompressRef);
+	if (q == NULL)
+		goto bailout;
+	q = pushArgument(mb, q, op1->nr);
+	q = pushArgument(mb, q, base->nr);
+	q = pushArgument(mb, q, step->nr);
+
+	bool enabled = ma_get_eb(be->mvc->sa)->enabled;
+	ma_get_eb(be->mvc->sa)->enabled = false;
+	stmt *s = stmt_create(be->mvc->sa, st_join);
+	ma_get_eb(be->mvc->sa)->enabled = enabled;
+	if (s == NULL) {
+		freeInstruction(be->mb, q);
+		return NULL;
+	}
+
+	s->op1 = op1;
+	s->op2 = base;
+	s->op3 = step;
+	s->flag = cmp_project;
+	s->key = 0;
+	s->nrcols = op1->nrcols;
+	s->nr = getDestVar(q);
+	s->q = q;
+	s->tname = op1->tname;
+	s->cname = op1->cname;
+	pushInstruction(mb, q);
+	return s;
+
+  bailout:
+	if (ma_get_eb(be->mvc->sa)->enabled)
+		eb_error(ma_get_eb(be->mvc->sa), be->mvc->errstr[0] ? be->mvc->errstr : mb->errors ? mb->errors : *GDKerrbuf ? GDKerrbuf : "out of memory", 1000);
+	return NULL;
+}
+
+stmt *
+stmt_fsst(backend *be, stmt *op1, stmt *op2)
+{
+	MalBlkPtr mb = be->mb;
+	InstrPtr q = NULL;
+
+	if (op1 == NULL || op2 == NULL || op1->nr < 0 || op2->nr < 0)
+		return NULL;
+
+	q = newStmt(mb, fsstRef, decompressRef);
+	if (q == NULL)
+		goto bailout;
+	q = pushArgument(mb, q, op1->nr);
+	q = pushArgument(mb, q, op2->nr);
+
+	bool enabled = ma_get_eb(be->mvc->sa)->enabled;
+	ma_get_eb(be->mvc->sa)->enabled = false;
+	stmt *s = stmt_create(be->mvc->sa, st_join);
+	ma_get_eb(be->mvc->sa)->enabled = enabled;
+	if (s == NULL) {
+		freeInstruction(be->mb, q);
+		return NULL;
+	}
+
+	s->op1 = op1;
+	s->op2 = op2;
+	s->flag = cmp_project;
+	s->key = 0;
+	s->nrcols = op1->nrcols;
+	s->nr = getDestVar(q);
+	s->q = q;
+	s->tname = op1->tname;
+	s->cname = op1->cname;
+	pushInstruction(mb, q);
+	return s;
+
+  bailout:
+	if (ma_get_eb(be->mvc->sa)->enabled)
+		eb_error(ma_get_eb(be->mvc->sa), be->mvc->errstr[0] ? be->mvc->errstr : mb->errors ? mb->errors : *GDKerrbuf ? GDKerrbuf : "out of memory", 1000);
+	return NULL;
+}
+
 stmt *
 stmt_join2(backend *be, stmt *l, stmt *ra, stmt *rb, int cmp, int anti, int symmetric, int swapped)
 {
@@ -3053,7 +3187,7 @@ dump_export_header(mvc *sql, MalBlkPtr mb, list *l, int file, const char * forma
 
 
 stmt *
-stmt_export(backend *be, stmt *t, const char *sep, const char *rsep, const char *ssep, const char *null_string, int onclient, stmt *file)
+stmt_export(backend *be, stmt *t, const char *sep, const char *rsep, const char *ssep, const char *null_string, int onclient, stmt *file, const char *format)
 {
 	MalBlkPtr mb = be->mb;
 	InstrPtr q = NULL;
@@ -3076,7 +3210,7 @@ stmt_export(backend *be, stmt *t, const char *sep, const char *rsep, const char
 		pushInstruction(mb, q);
 	}
 	if (t->type == st_list) {
-		if (dump_export_header(be->mvc, mb, l, fnr, "csv", sep, rsep, ssep, null_string, onclient) < 0)
+		if (dump_export_header(be->mvc, mb, l, fnr, format, sep, rsep, ssep, null_string, onclient) < 0)
 			goto bailout;
 	} else {
 		q = newStmt(mb, sqlRef, raiseRef);
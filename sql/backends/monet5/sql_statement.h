@@ -178,7 +178,7 @@ extern stmt *stmt_table_clear(backend *be, sql_table *t, int restart_sequences);
 extern stmt *stmt_pack(backend *be, stmt *c, int nr);
 extern stmt *stmt_pack_add(backend *be, stmt *c, stmt *values);
 
-extern stmt *stmt_export(backend *be, stmt *t, const char *sep, const char *rsep, const char *ssep, const char *null_string, int onclient, stmt *file);
+extern stmt *stmt_export(backend *be, stmt *t, const char *sep, const char *rsep, const char *ssep, const char *null_string, int onclient, stmt *file, const char *format);
 extern stmt *stmt_export_bin(backend *be, stmt *colstmt, bool byteswap, const char *filename, int on_client);
 extern stmt *stmt_trans(backend *b, int type, stmt *chain, stmt *name);
 extern stmt *stmt_catalog(backend *be, int type, stmt *args);
@@ -209,6 +209,7 @@ extern stmt *stmt_tunion(backend *be, stmt *op1, stmt *op2);
 extern stmt *stmt_tdiff(backend *be, stmt *op1, stmt *op2, stmt *lcand);
 extern stmt *stmt_tdiff2(backend *be, stmt *op1, stmt *op2, stmt *lcand, bool is_semantics, bool any);
 extern stmt *stmt_tinter(backend *be, stmt *op1, stmt *op2, bool single);
+extern stmt *stmt_bloomfilter(backend *be, stmt *op1, stmt *op2, stmt *lcand);
 
 extern stmt *stmt_join(backend *be, stmt *op1, stmt *op2, int anti, comp_type cmptype, int need_left, int is_semantics, bool single);
 extern stmt *stmt_join2(backend *be, stmt *l, stmt *ra, stmt *rb, int cmp, int anti, int symmetric, int swapped);
@@ -222,6 +223,8 @@ extern stmt *stmt_project_delta(backend *be, stmt *col, stmt *upd);
 extern stmt *stmt_left_project(backend *be, stmt *op1, stmt *op2, stmt *op3);
 extern stmt *stmt_dict(backend *be, stmt *op1, stmt *op2);
 extern stmt *stmt_for(backend *be, stmt *op1, stmt *minval);
+extern stmt *stmt_fsst(backend *be, stmt *op1, stmt *symtab);
+extern stmt *stmt_delta(backend *be, stmt *op1, stmt *base, stmt *step);
 
 sql_export stmt *stmt_list(backend *be, list *l);
 extern void stmt_set_nrcols(stmt *s);
@@ -75,6 +75,149 @@ sql_set_max(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return sql_set_stats(cntxt, mb, stk, pci, 2);
 }
 
+#define HISTOGRAM_SAMPLE	30000	/* values sampled per column */
+#define HISTOGRAM_BUCKETS	100	/* equi-depth buckets per column */
+#define HISTOGRAM_MCVS		20	/* most common values per column */
+
+/* Collect the histogram and most common values of column c, with values
+ * b, from a sorted sample of b, and store them for the optimizer.  The
+ * most common values are the values which occur clearly more often than
+ * average in the sample, they are kept out of the buckets.  The other
+ * values are split over buckets with about the same number of rows, a
+ * value does not span buckets. */
+static str
+sql_analyze_histogram(sql_trans *tr, sql_column *c, BAT *b)
+{
+	BUN cnt = BATcount(b), n, nils = 0, nruns = 0, *runs = NULL, *lens = NULL;
+	BAT *s = NULL, *v = NULL, *sorted = NULL;
+	int tpe = b->ttype, (*cmp)(const void *, const void *) = ATOMcompare(tpe);
+	const void *nil = ATOMnilptr(tpe);
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state = ma_open(ta);
+	sql_histogram *h = NULL;
+	str msg = MAL_SUCCEED;
+
+	if (cnt == 0) {
+		if (sql_trans_set_col_histogram(tr, c, NULL) != LOG_OK)
+			msg = createException(SQL, "sql.analyze", SQLSTATE(42000) "Could not store statistics of column '%s'", c->base.name);
+		ma_close(&ta_state);
+		return msg;
+	}
+	if (cnt > HISTOGRAM_SAMPLE) {
+		if (!(s = BATsample(b, HISTOGRAM_SAMPLE)) || !(v = BATproject(s, b)))
+			goto bailout;
+	} else {
+		v = b;
+	}
+	if (BATsort(&sorted, NULL, NULL, v, NULL, NULL, false, false, false) != GDK_SUCCEED)
+		goto bailout;
+	n = BATcount(sorted);
+
+	BATiter si = bat_iterator(sorted);
+	/* the nils sort first, then the runs of equal values */
+	while (nils < n && cmp(BUNtail(&si, nils), nil) == 0)
+		nils++;
+	runs = ma_alloc(ta, (n - nils + 1) * sizeof(BUN));
+	lens = ma_alloc(ta, (n - nils + 1) * sizeof(BUN));
+	if (!runs || !lens) {
+		bat_iterator_end(&si);
+		goto bailout;
+	}
+	for (BUN i = nils; i < n; i++) {
+		if (i == nils || cmp(BUNtail(&si, i), BUNtail(&si, runs[nruns - 1])) != 0) {
+			runs[nruns] = i;
+			lens[nruns++] = 0;
+		}
+		lens[nruns - 1]++;
+	}
+
+	/* the most common values, by descending frequency */
+	BUN mcv[HISTOGRAM_MCVS], nmcvs = 0, mcvrows = 0;
+	double avg = nruns ? (double) (n - nils) / nruns : 0;
+	for (BUN r = 0; r < nruns; r++) {
+		BUN j;
+
+		if (lens[r] < 2 || lens[r] <= 1.25 * avg || (nmcvs == HISTOGRAM_MCVS && lens[mcv[nmcvs - 1]] >= lens[r]))
+			continue;
+		if (nmcvs < HISTOGRAM_MCVS)
+			nmcvs++;
+		for (j = nmcvs - 1; j > 0 && lens[mcv[j - 1]] < lens[r]; j--)
+			mcv[j] = mcv[j - 1];
+		mcv[j] = r;
+	}
+	for (BUN j = 0; j < nmcvs; j++)
+		mcvrows += lens[mcv[j]];
+
+	/* scale the sample to the column, the distinct values of the buckets
+	 * by the estimated number of distinct values of the column */
+	double scale = (double) cnt / n, dscale = 1;
+	if (n < cnt && nruns > nmcvs) {
+		BUN est = BATguess_uniques(b, NULL);
+
+		if (est > nruns)
+			dscale = (double) (est - nmcvs) / (nruns - nmcvs);
+	}
+	BUN depth = (n - nils - mcvrows + HISTOGRAM_BUCKETS - 1) / HISTOGRAM_BUCKETS;
+	if (!(h = sql_histogram_create(ta, HISTOGRAM_BUCKETS + 1, (int) nmcvs))) {
+		bat_iterator_end(&si);
+		goto bailout;
+	}
+	for (BUN j = 0; j < nmcvs; j++) {
+		if (!VALinit(ta, &h->mcvs[j], tpe, BUNtail(&si, runs[mcv[j]]))) {
+			bat_iterator_end(&si);
+			goto bailout;
+		}
+		h->mcv_rows[j] = (lng) (lens[mcv[j]] * scale + 0.5);
+		h->total += h->mcv_rows[j];
+	}
+	h->nr_mcvs = (int) nmcvs;
+	h->nils = (lng) (nils * scale + 0.5);
+	h->total += h->nils;
+	BUN rows = 0, distinct = 0, first = 0, last = 0;
+	for (BUN r = 0; r < nruns; r++) {
+		bool common = false;
+
+		for (BUN j = 0; j < nmcvs && !common; j++)
+			common = mcv[j] == r;
+		if (!common) {
+			if (rows == 0)
+				first = r;
+			last = r;
+			rows += lens[r];
+			distinct++;
+		}
+		if (rows > 0 && (rows >= depth || r == nruns - 1)) {
+			int i = h->nr_buckets++;
+
+			if (!VALinit(ta, &h->lower[i], tpe, BUNtail(&si, runs[first])) ||
+				!VALinit(ta, &h->upper[i], tpe, BUNtail(&si, runs[last]))) {
+				bat_iterator_end(&si);
+				goto bailout;
+			}
+			h->rows[i] = (lng) (rows * scale + 0.5);
+			h->distinct[i] = MIN(MAX((lng) (distinct * dscale + 0.5), 1), h->rows[i]);
+			h->total += h->rows[i];
+			rows = distinct = 0;
+		}
+	}
+	bat_iterator_end(&si);
+	if (sql_trans_set_col_histogram(tr, c, h) != LOG_OK)
+		msg = createException(SQL, "sql.analyze", SQLSTATE(42000) "Could not store statistics of column '%s'", c->base.name);
+	BBPreclaim(s);
+	if (v != b)
+		BBPreclaim(v);
+	BBPreclaim(sorted);
+	ma_close(&ta_state);
+	return msg;
+  bailout:
+	BBPreclaim(s);
+	if (v != b)
+		BBPreclaim(v);
+	BBPreclaim(sorted);
+	ma_close(&ta_state);
+	throw(SQL, "sql.analyze", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+}
+
 str
 sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -179,7 +322,7 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					if (col && strcmp(c->base.name, col))
 						continue;
 
-					int access = c->storage_type && c->storage_type[0] == 'D' ? RD_EXT : RDONLY;
+					int access = c->storage_type && strcmp(c->storage_type, "DICT") == 0 ? RD_EXT : RDONLY;
 					if (!(b = store->storage_api.bind_col(tr, c, access)))
 						continue; /* At the moment we ignore the error, but maybe we can change this */
 					if (VIEWtparent(b)) { /* If it is a view get the parent BAT */
@@ -209,6 +352,14 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					GDKfree(mn);
 					mx = BATmax(b, NULL);
 					GDKfree(mx);
+
+					/* Collect the value distribution, not kept for
+					 * system and temporary tables */
+					if (!t->system && !isTempTable(t) && !store_readonly(store) && b->ttype == c->type.type->localtype &&
+						(msg = sql_analyze_histogram(tr, c, b)) != MAL_SUCCEED) {
+						BBPunfix(b->batCacheid);
+						return msg;
+					}
 					BBPunfix(b->batCacheid);
 				}
 			}
@@ -217,6 +368,91 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return MAL_SUCCEED;
 }
 
+/* Count the distinct combinations of values of a group of columns of a
+ * table, for the estimates of the optimizer of predicates, groupings and
+ * joins on correlated columns. */
+str
+sql_analyze_group(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	mvc *m = NULL;
+	str sch = *getArgReference_str(stk, pci, 1), tbl = *getArgReference_str(stk, pci, 2), cols = *getArgReference_str(stk, pci, 3);
+	str msg = MAL_SUCCEED;
+	BAT *g = NULL, *e = NULL;
+	sql_column **cs;
+	sqlid *ids;
+	int nr = 0;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (strNil(sch) || strNil(tbl) || strNil(cols))
+		throw(SQL, "sql.analyze_group", SQLSTATE(42000) "Schema, table and column names cannot be NULL");
+
+	sql_trans *tr = m->session->tr;
+	sqlstore *store = tr->store;
+	sql_schema *s = mvc_bind_schema(m, sch);
+	if (!s)
+		throw(SQL, "sql.analyze_group", SQLSTATE(3F000) "Schema '%s' does not exist", sch);
+	sql_table *t = mvc_bind_table(m, s, tbl);
+	if (!t)
+		throw(SQL, "sql.analyze_group", SQLSTATE(42S02) "Table '%s' does not exist", tbl);
+	if (!isTable(t) || isTempTable(t))
+		throw(SQL, "sql.analyze_group", SQLSTATE(42S02) "%s '%s' is not persistent", TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (!(ids = ma_alloc(m->sa, (strlen(cols) / 2 + 1) * sizeof(sqlid))) ||
+		!(cs = ma_alloc(m->sa, (strlen(cols) / 2 + 1) * sizeof(sql_column *))))
+		throw(SQL, "sql.analyze_group", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	/* the comma separated column names */
+	for (const char *p = cols; *p; ) {
+		const char *q = strchr(p, ',');
+		size_t len = q ? (size_t) (q - p) : strlen(p);
+		char *name;
+		sql_column *c;
+
+		while (len > 0 && isspace((unsigned char) *p)) {
+			p++;
+			len--;
+		}
+		while (len > 0 && isspace((unsigned char) p[len - 1]))
+			len--;
+		if (!(name = ma_strndup(m->sa, p, len)))
+			throw(SQL, "sql.analyze_group", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		if (!(c = mvc_bind_column(m, t, name)) || (!table_privs(m, t, PRIV_SELECT) && !column_privs(m, c, PRIV_SELECT)))
+			throw(SQL, "sql.analyze_group", SQLSTATE(38000) "Column '%s' does not exist", name);
+		for (int i = 0; i < nr; i++)
+			if (ids[i] == c->base.id)
+				throw(SQL, "sql.analyze_group", SQLSTATE(42000) "Column '%s' is listed more than once", name);
+		cs[nr] = c;
+		ids[nr++] = c->base.id;
+		p = q ? q + 1 : p + len;
+	}
+	if (nr < 2)
+		throw(SQL, "sql.analyze_group", SQLSTATE(42000) "A column group needs at least two columns");
+
+	for (int i = 0; i < nr && msg == MAL_SUCCEED; i++) {
+		BAT *b, *ng, *ne;
+
+		if (!(b = store->storage_api.bind_col(tr, cs[i], RDONLY))) {
+			msg = createException(SQL, "sql.analyze_group", SQLSTATE(HY005) "Cannot access column descriptor");
+			break;
+		}
+		if (BATgroup(&ng, &ne, NULL, b, NULL, g, e, NULL) != GDK_SUCCEED)
+			msg = createException(SQL, "sql.analyze_group", GDK_EXCEPTION);
+		BBPunfix(b->batCacheid);
+		if (msg == MAL_SUCCEED) {
+			BBPreclaim(g);
+			BBPreclaim(e);
+			g = ng;
+			e = ne;
+		}
+	}
+	if (msg == MAL_SUCCEED && sql_trans_set_group_distinct(tr, t, nr, ids, (lng) BATcount(e)) != LOG_OK)
+		msg = createException(SQL, "sql.analyze_group", SQLSTATE(42000) "Could not store statistics of table '%s'", t->base.name);
+	BBPreclaim(g);
+	BBPreclaim(e);
+	return msg;
+}
+
 str
 sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -351,7 +587,7 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							continue;
 						int w;
 						lng cnt;
-						bit un, hnils, issorted, isrevsorted, dict;
+						bit un, hnils, issorted, isrevsorted, dict, fsst = false, delta = false;
 						BAT *qd = NULL, *fb = NULL, *re = NULL;
 
 						if (cname && strcmp(c->base.name, cname))
@@ -363,7 +599,7 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 						}
 						BATiter qdi = bat_iterator(qd);
 						BATiter posi;
-						if ((dict = (c->storage_type && c->storage_type[0] == 'D'))) {
+						if ((dict = (c->storage_type && strcmp(c->storage_type, "DICT") == 0))) {
 							if (!(re = store->storage_api.bind_col(tr, c, RD_EXT))) {
 								bat_iterator_end(&qdi);
 								msg = createException(SQL, "sql.statistics", SQLSTATE(HY005) "Cannot access column descriptor");
@@ -387,15 +623,19 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							posi = bat_iterator_copy(&rei);
 							bat_iterator_end(&rei);
 						} else {
-							issorted = qdi.sorted;
-							isrevsorted = qdi.revsorted;
+							/* fsst compression does not preserve the order of the strings,
+							 * the residuals of delta compression neither the order nor the uniqueness */
+							fsst = c->storage_type && strcmp(c->storage_type, "FSST") == 0;
+							delta = c->storage_type && strncmp(c->storage_type, "DELTA", 5) == 0;
+							issorted = qdi.sorted && !fsst && !delta;
+							isrevsorted = qdi.revsorted && !fsst && !delta;
 							hnils = !qdi.nonil || qdi.nil;
 							posi = bat_iterator_copy(&qdi);
 						}
 
 						w = qdi.width;
 						cnt = qdi.count;
-						un = qdi.key;
+						un = qdi.key && !delta;
 						bat_iterator_end(&qdi);
 
 						if (BUNappend(cid, &c->base.id, false) != GDK_SUCCEED ||
@@ -414,7 +654,7 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							goto bailout;
 						}
 
-						if (posi.minpos != BUN_NONE || posi.maxpos != BUN_NONE) {
+						if (!fsst && !delta && (posi.minpos != BUN_NONE || posi.maxpos != BUN_NONE)) {
 							bat_iterator_end(&posi);
 							if (dict) {
 								fb = re;
@@ -5525,6 +5525,129 @@ sql_update_default(Client c, mvc *sql, sql_schema *s)
 		}
 	}
 	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select keyword from sys.keywords where keyword in ('ARROW', 'PARQUET');\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query1[] =
+			"ALTER TABLE sys.keywords SET READ WRITE;\n"
+			"COMMIT;\n";
+		static const char query2[] =
+			"INSERT INTO sys.keywords VALUES ('ARROW'), ('PARQUET');\n"
+			"COMMIT;\n";
+		static const char query3[] = "ALTER TABLE sys.keywords SET READ ONLY;\n";
+		printf("Running database upgrade commands:\n%s%s%s\n", query1, query2, query3);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query1, "update", true, false, NULL);
+		if (err == MAL_SUCCEED) {
+			err = SQLstatementIntern(c, query2, "update", true, false, NULL);
+			if (err == MAL_SUCCEED) {
+				err = SQLstatementIntern(c, query3, "update", true, false, NULL);
+			}
+		}
+	}
+	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select id from sys.functions where name = 'compression_advisor' and schema_id = 2000;\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query[] =
+			"create procedure sys.compression_advisor(apply boolean) external name sql.compression_advisor;\n"
+			"create procedure sys.auto_compression(\"interval\" int) external name sql.auto_compression;\n"
+			"create procedure sys.stop_auto_compression() external name sql.stop_auto_compression;\n"
+			"create function sys.compression_advice() returns table(\"column_id\" int, \"rowcount\" bigint, \"uniques\" bigint, \"size\" bigint, \"compressed_size\" bigint, \"advice\" string, \"applied\" boolean, \"reason\" string, \"advised\" timestamp) external name sql.compression_advice;\n"
+			"create view sys.compression_advice as select s.name as \"schema\", t.name as \"table\", c.name as \"column\", c.type, c.storage, a.rowcount, a.uniques, a.size, a.compressed_size, a.advice, a.applied, a.reason, a.advised from sys.compression_advice() a join sys._columns c on a.column_id = c.id join sys._tables t on c.table_id = t.id join sys.schemas s on t.schema_id = s.id;\n"
+			"update sys.functions set system = true where not system and schema_id = 2000 and name in ('compression_advisor', 'auto_compression', 'stop_auto_compression', 'compression_advice');\n"
+			"update sys._tables set system = true where not system and schema_id = 2000 and name = 'compression_advice';\n";
+		printf("Running database upgrade commands:\n%s\n", query);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query, "update", true, false, NULL);
+	}
+	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select id from sys.functions where name = 'memory_claims' and schema_id = 2000;\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query[] =
+			"create function sys.memory_claims() returns table(\"sessionid\" int, \"username\" string, \"tag\" bigint, \"status\" string, \"queued\" timestamp, \"budget\" int, \"claimed\" int, \"allocated\" int) external name sysmon.memory_claims;\n"
+			"grant execute on function sys.memory_claims() to public;\n"
+			"create view sys.memory_claims as select * from sys.memory_claims();\n"
+			"grant select on sys.memory_claims to public;\n"
+			"create function sys.memory_budget() returns table(\"budget\" bigint, \"reserved\" bigint, \"spills\" bigint) external name sysmon.memory_budget;\n"
+			"grant execute on function sys.memory_budget() to public;\n"
+			"update sys.functions set system = true where not system and schema_id = 2000 and name in ('memory_claims', 'memory_budget');\n"
+			"update sys._tables set system = true where not system and schema_id = 2000 and name = 'memory_claims';\n";
+		printf("Running database upgrade commands:\n%s\n", query);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query, "update", true, false, NULL);
+	}
+	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select id from sys.functions where name = 'plan_cache' and schema_id = 2000;\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query[] =
+			"create function sys.plan_cache() returns table(\"user_id\" int, \"role_id\" int, \"schema_id\" int, \"query\" string, \"optimizer\" string, \"hits\" bigint, \"compile_time\" bigint, \"created\" timestamp, \"last_used\" timestamp) external name sql.plan_cache;\n"
+			"create view sys.plan_cache as select u.name as \"username\", r.name as \"role\", s.name as \"schema\", p.\"query\", p.\"optimizer\", p.\"hits\", p.\"compile_time\", p.\"created\", p.\"last_used\" from sys.plan_cache() p left outer join sys.auths u on p.\"user_id\" = u.id left outer join sys.auths r on p.\"role_id\" = r.id left outer join sys.schemas s on p.\"schema_id\" = s.id;\n"
+			"create function sys.plan_cache_stats() returns table(\"size\" int, \"entries\" int, \"lookups\" bigint, \"hits\" bigint, \"misses\" bigint, \"inserts\" bigint, \"evictions\" bigint, \"invalidations\" bigint) external name sql.plan_cache_stats;\n"
+			"create view sys.plan_cache_stats as select *, case when \"lookups\" > 0 then cast(\"hits\" as double) / \"lookups\" else null end as \"hit_rate\" from sys.plan_cache_stats();\n"
+			"create procedure sys.plan_cache_size(\"size\" int) external name sql.plan_cache_size;\n"
+			"update sys.functions set system = true where not system and schema_id = 2000 and name in ('plan_cache', 'plan_cache_stats', 'plan_cache_size');\n"
+			"update sys._tables set system = true where not system and schema_id = 2000 and name in ('plan_cache', 'plan_cache_stats');\n";
+		printf("Running database upgrade commands:\n%s\n", query);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query, "update", true, false, NULL);
+	}
+	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select id from sys.functions where name = 'result_cache' and schema_id = 2000;\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query[] =
+			"create function sys.result_cache() returns table(\"user_id\" int, \"role_id\" int, \"schema_id\" int, \"query\" string, \"rows\" bigint, \"columns\" int, \"memory\" bigint, \"hits\" bigint, \"created\" timestamp, \"last_used\" timestamp) external name sql.result_cache;\n"
+			"create view sys.result_cache as select u.name as \"username\", r.name as \"role\", s.name as \"schema\", c.\"query\", c.\"rows\", c.\"columns\", c.\"memory\", c.\"hits\", c.\"created\", c.\"last_used\" from sys.result_cache() c left outer join sys.auths u on c.\"user_id\" = u.id left outer join sys.auths r on c.\"role_id\" = r.id left outer join sys.schemas s on c.\"schema_id\" = s.id;\n"
+			"create function sys.result_cache_stats() returns table(\"size\" int, \"entries\" int, \"memory\" bigint, \"lookups\" bigint, \"hits\" bigint, \"misses\" bigint, \"inserts\" bigint, \"evictions\" bigint, \"invalidations\" bigint) external name sql.result_cache_stats;\n"
+			"create view sys.result_cache_stats as select *, case when \"lookups\" > 0 then cast(\"hits\" as double) / \"lookups\" else null end as \"hit_rate\" from sys.result_cache_stats();\n"
+			"create procedure sys.result_cache_size(\"size\" int) external name sql.result_cache_size;\n"
+			"update sys.functions set system = true where not system and schema_id = 2000 and name in ('result_cache', 'result_cache_stats', 'result_cache_size');\n"
+			"update sys._tables set system = true where not system and schema_id = 2000 and name in ('result_cache', 'result_cache_stats');\n";
+		printf("Running database upgrade commands:\n%s\n", query);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query, "update", true, false, NULL);
+	}
+	res_table_destroy(output);
+	if (err != MAL_SUCCEED)
+		return err;
+
+	if ((err = SQLstatementIntern(c, "select id from sys._tables where name = 'statistics_histograms' and schema_id = 2000;\n", "update", true, false, &output)))
+		return err;
+	if ((b = BBPquickdesc(output->cols[0].b)) && BATcount(b) == 0) {
+		static const char query[] =
+			"create table sys.statistics_histograms(\"column_id\" int, \"bucket\" int, \"lower\" string, \"upper\" string, \"rows\" bigint, \"distinct\" bigint);\n"
+			"grant select on sys.statistics_histograms to public;\n"
+			"create table sys.statistics_mcvs(\"column_id\" int, \"value\" string, \"rows\" bigint);\n"
+			"grant select on sys.statistics_mcvs to public;\n"
+			"create table sys.statistics_groups(\"table_id\" int, \"columns\" string, \"distinct\" bigint);\n"
+			"grant select on sys.statistics_groups to public;\n"
+			"create procedure sys.analyze_group(\"sname\" varchar(1024), \"tname\" varchar(1024), \"columns\" string) external name sql.analyze_group;\n"
+			"grant execute on procedure sys.analyze_group(varchar(1024),varchar(1024),string) to public;\n"
+			"update sys.functions set system = true where not system and schema_id = 2000 and name = 'analyze_group';\n"
+			"update sys._tables set system = true where not system and schema_id = 2000 and name in ('statistics_histograms', 'statistics_mcvs', 'statistics_groups');\n";
+		printf("Running database upgrade commands:\n%s\n", query);
+		fflush(stdout);
+		err = SQLstatementIntern(c, query, "update", true, false, NULL);
+	}
+	res_table_destroy(output);
 
 	return err;
 }
@@ -38,7 +38,8 @@ next_delim(const char *s, const char *e, char delim, char quote)
 {
 	if (s && e) {
 		bool inquote = false;
-		for(;  s < e; s++) {
+		/* jump from quote to quote and delimiter */
+		for(;  (s = strfind3(s, e, quote, delim, delim)) < e; s++) {
 			if (*s == quote)
 				inquote = !inquote;
 			else if (!inquote && *s == delim)
@@ -577,9 +578,9 @@ CSVprelude(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
 	(void)cntxt; (void)mb; (void)stk; (void)pci;
 
-	fl_register("csv", &csv_relation, &csv_load);
-	fl_register("tsv", &csv_relation, &csv_load);
-	fl_register("psv", &csv_relation, &csv_load);
+	fl_register("csv", &csv_relation, &csv_load, NULL);
+	fl_register("tsv", &csv_relation, &csv_load, NULL);
+	fl_register("psv", &csv_relation, &csv_load, NULL);
 	return MAL_SUCCEED;
 }
 
@@ -0,0 +1,301 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * Parquet file loader, ie select * from 'file.parquet'.
+ *
+ * Each column of the file is read by its own parquet.read instruction,
+ * such that columns which aren't used are removed by the dead code
+ * optimizer and the used ones are decoded in parallel by the dataflow
+ * scheduler.  Simple predicates of a select directly on top of the
+ * file are offered to the loader (see rel2bin_select), these are used
+ * to skip row groups whose min/max statistics show they cannot hold
+ * qualifying rows.  The select itself stays, the result is the same.
+ */
+
+#include "monetdb_config.h"
+#include "rel_file_loader.h"
+#include "rel_exp.h"
+
+#include "mal_instruction.h"
+#include "mal_interpreter.h"
+#include "mal_parser.h"
+#include "mal_builder.h"
+#include "mal_namespace.h"
+#include "mal_exception.h"
+#include "mal_linker.h"
+#include "mal_backend.h"
+#include "sql_types.h"
+#include "rel_bin.h"
+#include "sql_storage.h"
+
+#include "parquet_reader.h"
+
+typedef struct pq_coltype {
+	int mtype;
+	unsigned int digits, scale;
+} pq_coltype;
+
+typedef struct pq_t {
+	char sname[1];
+	int ncols;
+	pq_coltype *types;		/* as seen when the query was compiled */
+	int nfilters;
+	pq_filter *filters;
+} pq_t;
+
+/*
+ * returns an error string (static or via tmp sa_allocator allocated), NULL on success
+ *
+ * Extend the subfunc f with result columns, ie.
+	f->res = typelist;
+	f->coltypes = typelist;
+	f->colnames = nameslist; use tname if passed, for the relation name
+ * Fill the list res_exps, with one result expressions per resulting column.
+ */
+static str
+parquet_relation(mvc *sql, sql_subfunc *f, char *filename, list *res_exps, char *tname, lng *est)
+{
+	char err[256];
+	pq_file *pf = pq_open(filename, err, sizeof(err));
+
+	if (pf == NULL)
+		return sa_message(sql->sa, "%s", err);
+	if (!tname)
+		tname = "parquet";
+	f->tname = tname;
+
+	pq_t *r = (pq_t *) ma_alloc(sql->sa, sizeof(pq_t));
+	list *typelist = sa_list(sql->sa);
+	list *nameslist = sa_list(sql->sa);
+	if (!r || !typelist || !nameslist ||
+		!(r->types = ma_alloc(sql->sa, MAX(pf->ncols, 1) * sizeof(pq_coltype)))) {
+		pq_close(pf);
+		return MAL_MALLOC_FAIL;
+	}
+	for (int col = 0; col < pf->ncols; col++) {
+		pq_column *c = &pf->cols[col];
+		sql_subtype *t = sql_bind_subtype(sql->sa, c->sqlname, c->digits, c->dscale);
+		char *name = ma_strdup(sql->sa, c->name);
+		sql_type *et;
+
+		if (!t && (et = mvc_bind_type(sql, c->sqlname)) != NULL && (t = SA_ZNEW(sql->sa, sql_subtype)) != NULL)
+			sql_init_subtype(t, et, 0, 0); /* an external type, ie uuid */
+
+		if (!t || !name) {
+			str msg = t ? MAL_MALLOC_FAIL : sa_message(sql->sa, "parquet type %s not found\n", c->sqlname);
+			pq_close(pf);
+			return msg;
+		}
+		append(nameslist, name);
+		list_append(typelist, t);
+		sql_exp *ne = exp_column(sql->sa, tname, name, t, CARD_MULTI, 1, 0, 0);
+		set_basecol(ne);
+		ne->alias.label = -(sql->nid++);
+		list_append(res_exps, ne);
+		r->types[col] = (pq_coltype) {.mtype = c->mtype, .digits = c->digits, .scale = c->dscale};
+	}
+	*est = pf->num_rows;
+	r->sname[0] = 0;
+	r->ncols = pf->ncols;
+	r->nfilters = 0;
+	r->filters = NULL;
+	pq_close(pf);
+
+	f->res = typelist;
+	f->coltypes = typelist;
+	f->colnames = nameslist;
+	f->sname = (char *) r; /* pass schema++ */
+	return MAL_SUCCEED;
+}
+
+/* the value of a literal of the column's type, NULL otherwise */
+static const void *
+parquet_filter_value(sql_exp *e, sql_subtype *ct)
+{
+	atom *a;
+
+	if (!e || !is_simple_atom(e) || !(a = e->l) || a->isnull ||
+		a->tpe.type->localtype != ct->type->localtype ||
+		a->tpe.type->eclass != ct->type->eclass || a->tpe.scale != ct->scale)
+		return NULL;
+	return VALptr(&a->data);
+}
+
+/* keep the simple (range) comparisons of columns with literals, these
+ * are used to skip row groups */
+static void
+parquet_filter(mvc *sql, sql_subfunc *f, list *cols, list *exps)
+{
+	pq_t *r = (pq_t *) f->sname;
+	pq_filter *filters;
+	int n = 0;
+
+	if (!r || list_empty(exps) ||
+		!(filters = ma_alloc(sql->sa, (list_length(exps) + r->nfilters) * sizeof(pq_filter))))
+		return;
+	for (int i = 0; i < r->nfilters; i++)
+		filters[n++] = r->filters[i];
+	for (node *en = exps->h; en; en = en->next) {
+		sql_exp *e = en->data, *c = e->l, *ce;
+
+		if (e->type != e_cmp || is_anti(e) || is_semantics(e) || !c || c->type != e_column ||
+			!(ce = exps_bind_nid(cols, c->nid)))
+			continue;
+
+		int col = list_position(cols, ce);
+		sql_subtype *ct = list_fetch(f->coltypes, col);
+		const void *lo = NULL, *hi = NULL;
+		bool lo_incl = true, hi_incl = true;
+
+		if (!ct)
+			continue;
+		if (e->f) {		/* range */
+			if (!(lo = parquet_filter_value(e->r, ct)) || !(hi = parquet_filter_value(e->f, ct)))
+				continue;
+			lo_incl = (e->flag & 1) != 0;
+			hi_incl = (e->flag & 2) != 0;
+		} else {
+			const void *v = parquet_filter_value(e->r, ct);
+			if (!v)
+				continue;
+			switch (e->flag) {
+			case cmp_equal:
+				lo = hi = v;
+				break;
+			case cmp_gt:
+				lo_incl = false;
+				/* fall through */
+			case cmp_gte:
+				lo = v;
+				break;
+			case cmp_lt:
+				hi_incl = false;
+				/* fall through */
+			case cmp_lte:
+				hi = v;
+				break;
+			default:
+				continue;
+			}
+		}
+		filters[n++] = (pq_filter) {.col = col, .lo = lo, .hi = hi, .lo_incl = lo_incl, .hi_incl = hi_incl};
+	}
+	r->filters = filters;
+	r->nfilters = n;
+}
+
+static void *
+parquet_load(void *BE, sql_subfunc *f, char *filename, sql_exp *topn)
+{
+	backend *be = (backend *) BE;
+	pq_t *r = (pq_t *) f->sname;
+	stmt *tn = NULL;
+	list *l = sa_list(be->mvc->sa);
+
+	if (!l)
+		return NULL;
+	if (topn && !(tn = exp_bin(be, topn, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, 0)))
+		return NULL;
+
+	int col = 0;
+	for (node *n = f->coltypes->h, *nn = f->colnames->h; n && nn; col++, n = n->next, nn = nn->next) {
+		const char *name = nn->data;
+		sql_subtype *tp = n->data;
+		InstrPtr q = newStmtArgs(be->mb, "parquet", "read", 5);
+
+		if (q == NULL)
+			return NULL;
+		getArg(q, 0) = newTmpVariable(be->mb, newBatType(tp->type->localtype));
+		q = pushStr(be->mb, q, filename);
+		q = pushPtr(be->mb, q, r);
+		q = pushInt(be->mb, q, col);
+		if (tn)
+			q = pushArgument(be->mb, q, tn->nr);
+		else
+			q = pushLng(be->mb, q, -1);
+		pushInstruction(be->mb, q);
+		stmt *s = stmt_blackbox_result(be, q, 0, tp);
+		s = stmt_alias(be, s, col + 1, f->tname, name);
+		list_append(l, s);
+	}
+	return stmt_list(be, l);
+}
+
+static str
+PARQUETread(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	bat *ret = getArgReference_bat(stk, pci, 0);
+	const char *fname = *getArgReference_str(stk, pci, 1);
+	pq_t *r = *(pq_t **) getArgReference_ptr(stk, pci, 2);
+	int col = *getArgReference_int(stk, pci, 3);
+	lng topn = *getArgReference_lng(stk, pci, 4);
+	char err[256];
+	const char *msg;
+	BAT *b = NULL;
+	str res = MAL_SUCCEED;
+
+	(void) cntxt;
+	pq_file *pf = pq_open(fname, err, sizeof(err));
+	if (pf == NULL)
+		throw(SQL, "parquet.read", SQLSTATE(42000) "%s", err);
+	if (pf->ncols != r->ncols || col < 0 || col >= pf->ncols ||
+		pf->cols[col].mtype != r->types[col].mtype ||
+		pf->cols[col].digits != r->types[col].digits ||
+		pf->cols[col].dscale != r->types[col].scale ||
+		pf->cols[col].mtype != getBatType(getArgType(mb, pci, 0))) {
+		pq_close(pf);
+		throw(SQL, "parquet.read", SQLSTATE(42000) "file %s changed since the query was compiled", fname);
+	}
+	if ((msg = pq_read(pf, col, r->filters, r->nfilters, is_lng_nil(topn) ? -1 : topn, &b)) != NULL)
+		res = createException(SQL, "parquet.read", SQLSTATE(42000) "%s: %s", fname, msg);
+	pq_close(pf);
+	if (res == MAL_SUCCEED) {
+		*ret = b->batCacheid;
+		BBPkeepref(b);
+	}
+	return res;
+}
+
+static str
+PARQUETprelude(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt; (void)mb; (void)stk; (void)pci;
+
+	fl_register("parquet", &parquet_relation, &parquet_load, &parquet_filter);
+	return MAL_SUCCEED;
+}
+
+static str
+PARQUETepilogue(Client cntxt, void *ret)
+{
+	(void) cntxt;
+	fl_unregister("parquet");
+	(void)ret;
+	return MAL_SUCCEED;
+}
+
+#include "sql_scenario.h"
+#include "mel.h"
+
+static mel_func parquet_init_funcs[] = {
+	pattern("parquet", "prelude", PARQUETprelude, false, "", noargs),
+	command("parquet", "epilogue", PARQUETepilogue, false, "", noargs),
+	pattern("parquet", "read", PARQUETread, false, "Read a column of a parquet file, skipping the row groups excluded by the filters", args(1,5, batargany("",1),arg("fname",str),arg("pq",ptr),arg("col",int),arg("topn",lng))),
+{ .imp=NULL }
+};
+
+#include "mal_import.h"
+#ifdef _MSC_VER
+#undef read
+#pragma section(".CRT$XCU",read)
+#endif
+LIB_STARTUP_FUNC(init_parquet_mal)
+{ mal_module("parquet", NULL, parquet_init_funcs); }
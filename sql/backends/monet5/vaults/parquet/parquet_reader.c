@@ -0,0 +1,2431 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+/*
+ * A reader for flat Apache Parquet files, without external
+ * dependencies.
+ *
+ * The whole file is memory mapped.  The footer is decoded using a small
+ * thrift compact protocol decoder, only the fields we need are kept.
+ * Column chunks are decoded page by page, straight into the tail (and
+ * for strings the vheap) of the result BAT.  Values of dictionary
+ * encoded pages are converted (and for strings put into the vheap) once
+ * per dictionary, the data pages then only gather (offsets of) the
+ * dictionary entries.
+ *
+ * Supported are the PLAIN, (PLAIN|RLE)_DICTIONARY, RLE (booleans),
+ * DELTA_BINARY_PACKED, DELTA_LENGTH_BYTE_ARRAY, DELTA_BYTE_ARRAY and
+ * BYTE_STREAM_SPLIT encodings, version 1 and 2 data pages and the
+ * UNCOMPRESSED, SNAPPY, LZ4_RAW and (if zlib is available) GZIP codecs.
+ * Only flat schemas, ie REQUIRED or OPTIONAL columns at the top level,
+ * are supported.
+ */
+
+#include "monetdb_config.h"
+#include "parquet_reader.h"
+#include "mutils.h"
+#include "mstring.h"
+#include "mal_errors.h"
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+/* physical types */
+enum {
+	PT_BOOLEAN,
+	PT_INT32,
+	PT_INT64,
+	PT_INT96,
+	PT_FLOAT,
+	PT_DOUBLE,
+	PT_BYTE_ARRAY,
+	PT_FIXED_LEN_BYTE_ARRAY,
+};
+
+/* converted types (the deprecated type annotations) */
+enum {
+	CT_UTF8 = 0,
+	CT_ENUM = 4,
+	CT_DECIMAL = 5,
+	CT_DATE = 6,
+	CT_TIME_MILLIS = 7,
+	CT_TIME_MICROS = 8,
+	CT_TIMESTAMP_MILLIS = 9,
+	CT_TIMESTAMP_MICROS = 10,
+	CT_UINT_8 = 11,
+	CT_UINT_16 = 12,
+	CT_UINT_32 = 13,
+	CT_UINT_64 = 14,
+	CT_INT_8 = 15,
+	CT_INT_16 = 16,
+	CT_INT_32 = 17,
+	CT_INT_64 = 18,
+	CT_JSON = 19,
+	CT_BSON = 20,
+};
+
+/* logical types, the field ids of the LogicalType union */
+enum {
+	LT_STRING = 1,
+	LT_ENUM = 4,
+	LT_DECIMAL = 5,
+	LT_DATE = 6,
+	LT_TIME = 7,
+	LT_TIMESTAMP = 8,
+	LT_INTEGER = 10,
+	LT_JSON = 12,
+	LT_BSON = 13,
+	LT_UUID = 14,
+	LT_FLOAT16 = 15,
+};
+
+enum {
+	REP_REQUIRED,
+	REP_OPTIONAL,
+	REP_REPEATED,
+};
+
+enum {
+	PAGE_DATA,
+	PAGE_INDEX,
+	PAGE_DICTIONARY,
+	PAGE_DATA_V2,
+};
+
+enum {
+	ENC_PLAIN = 0,
+	ENC_PLAIN_DICTIONARY = 2,
+	ENC_RLE = 3,
+	ENC_DELTA_BINARY_PACKED = 5,
+	ENC_DELTA_LENGTH_BYTE_ARRAY = 6,
+	ENC_DELTA_BYTE_ARRAY = 7,
+	ENC_RLE_DICTIONARY = 8,
+	ENC_BYTE_STREAM_SPLIT = 9,
+};
+
+enum {
+	CODEC_UNCOMPRESSED,
+	CODEC_SNAPPY,
+	CODEC_GZIP,
+	CODEC_LZO,
+	CODEC_BROTLI,
+	CODEC_LZ4,
+	CODEC_ZSTD,
+	CODEC_LZ4_RAW,
+};
+
+static const char *codec_names[] = {
+	"UNCOMPRESSED", "SNAPPY", "GZIP", "LZO", "BROTLI", "LZ4", "ZSTD", "LZ4_RAW",
+};
+
+#define CORRUPT		"corrupt parquet file"
+
+static inline uint32_t
+ld32(const uint8_t *p)
+{
+	return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static inline uint64_t
+ld64(const uint8_t *p)
+{
+	return (uint64_t) ld32(p) | (uint64_t) ld32(p + 4) << 32;
+}
+
+static inline void
+st32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+static inline void
+st64(uint8_t *p, uint64_t v)
+{
+	st32(p, (uint32_t) v);
+	st32(p + 4, (uint32_t) (v >> 32));
+}
+
+static const uint8_t *
+pq_varint(const uint8_t *p, const uint8_t *e, uint64_t *v)
+{
+	uint64_t r = 0;
+	for (int shift = 0; p < e && shift < 64; shift += 7) {
+		uint8_t b = *p++;
+		r |= (uint64_t) (b & 0x7F) << shift;
+		if ((b & 0x80) == 0) {
+			*v = r;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+static inline int64_t
+unzigzag(uint64_t v)
+{
+	return (int64_t) (v >> 1) ^ -(int64_t) (v & 1);
+}
+
+/*
+ * thrift compact protocol
+ */
+
+enum {
+	TC_STOP,
+	TC_TRUE,
+	TC_FALSE,
+	TC_BYTE,
+	TC_I16,
+	TC_I32,
+	TC_I64,
+	TC_DOUBLE,
+	TC_BINARY,
+	TC_LIST,
+	TC_SET,
+	TC_MAP,
+	TC_STRUCT,
+};
+
+typedef struct tc {
+	const uint8_t *p, *e;
+	int depth;
+	bool err;
+	bool oom;
+} tc;
+
+static uint64_t
+tc_varint(tc *t)
+{
+	uint64_t v = 0;
+	const uint8_t *p = t->err ? NULL : pq_varint(t->p, t->e, &v);
+	if (p == NULL) {
+		t->err = true;
+		return 0;
+	}
+	t->p = p;
+	return v;
+}
+
+/* next field of a struct, returns its type, TC_STOP at the end of the
+ * struct (or on errors) */
+static int
+tc_field(tc *t, int *id)
+{
+	if (t->err || t->p >= t->e) {
+		t->err = true;
+		return TC_STOP;
+	}
+	uint8_t b = *t->p++;
+	int type = b & 0x0F;
+	if (type == TC_STOP)
+		return TC_STOP;
+	if (b >> 4)
+		*id += b >> 4;
+	else
+		*id = (int) unzigzag(tc_varint(t));
+	return t->err ? TC_STOP : type;
+}
+
+static int64_t
+tc_int(tc *t, int type)
+{
+	switch (type) {
+	case TC_BYTE:
+		if (t->p >= t->e)
+			break;
+		return (int8_t) *t->p++;
+	case TC_I16:
+	case TC_I32:
+	case TC_I64:
+		return unzigzag(tc_varint(t));
+	default:
+		break;
+	}
+	t->err = true;
+	return 0;
+}
+
+static bool
+tc_bool(tc *t, int type)
+{
+	if (type != TC_TRUE && type != TC_FALSE)
+		t->err = true;
+	return type == TC_TRUE;
+}
+
+static const uint8_t *
+tc_binary(tc *t, int type, uint32_t *len)
+{
+	uint64_t l = type == TC_BINARY ? tc_varint(t) : 0;
+	if (type != TC_BINARY || t->err || l > (uint64_t) (t->e - t->p)) {
+		t->err = true;
+		*len = 0;
+		return NULL;
+	}
+	const uint8_t *s = t->p;
+	t->p += l;
+	*len = (uint32_t) l;
+	return s;
+}
+
+static uint32_t
+tc_list(tc *t, int type, int *etype)
+{
+	if (t->err || (type != TC_LIST && type != TC_SET) || t->p >= t->e) {
+		t->err = true;
+		return 0;
+	}
+	uint8_t b = *t->p++;
+	uint64_t n = b >> 4;
+	*etype = b & 0x0F;
+	if (n == 15)
+		n = tc_varint(t);
+	/* each element takes at least one byte */
+	if (t->err || n > (uint64_t) (t->e - t->p)) {
+		t->err = true;
+		return 0;
+	}
+	return (uint32_t) n;
+}
+
+static void
+tc_skip(tc *t, int type)
+{
+	if (t->err || ++t->depth > 64) {
+		t->err = true;
+		return;
+	}
+	switch (type) {
+	case TC_TRUE:
+	case TC_FALSE:
+		break;
+	case TC_BYTE:
+		if (t->p >= t->e)
+			t->err = true;
+		else
+			t->p++;
+		break;
+	case TC_I16:
+	case TC_I32:
+	case TC_I64:
+		(void) tc_varint(t);
+		break;
+	case TC_DOUBLE:
+		if (t->e - t->p < 8)
+			t->err = true;
+		else
+			t->p += 8;
+		break;
+	case TC_BINARY: {
+		uint32_t len;
+		(void) tc_binary(t, type, &len);
+		break;
+	}
+	case TC_LIST:
+	case TC_SET: {
+		int et;
+		uint32_t n = tc_list(t, type, &et);
+		for (uint32_t i = 0; i < n && !t->err; i++)
+			/* booleans in containers take a byte */
+			tc_skip(t, et == TC_TRUE || et == TC_FALSE ? TC_BYTE : et);
+		break;
+	}
+	case TC_MAP: {
+		uint64_t n = tc_varint(t);
+		if (n > 0 && !t->err) {
+			if (t->p >= t->e) {
+				t->err = true;
+				break;
+			}
+			uint8_t kv = *t->p++;
+			int kt = kv >> 4, vt = kv & 0x0F;
+			if (kt == TC_TRUE || kt == TC_FALSE)
+				kt = TC_BYTE;
+			if (vt == TC_TRUE || vt == TC_FALSE)
+				vt = TC_BYTE;
+			for (uint64_t i = 0; i < n && !t->err; i++) {
+				tc_skip(t, kt);
+				tc_skip(t, vt);
+			}
+		}
+		break;
+	}
+	case TC_STRUCT: {
+		int id = 0, ft;
+		while ((ft = tc_field(t, &id)) != TC_STOP)
+			tc_skip(t, ft);
+		break;
+	}
+	default:
+		t->err = true;
+		break;
+	}
+	t->depth--;
+}
+
+/* skip a (union) struct, returning the id of its first field */
+static int
+tc_union(tc *t, int type)
+{
+	int id = 0, ft, first = 0;
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return 0;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		if (!first)
+			first = id;
+		tc_skip(t, ft);
+	}
+	return first;
+}
+
+static void
+tc_logical_type(tc *t, int type, pq_column *c)
+{
+	int id = 0, ft;
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		if (ft != TC_STRUCT) {
+			tc_skip(t, ft);
+			continue;
+		}
+		int fid = 0, f;
+		c->ltype = id;
+		switch (id) {
+		case LT_DECIMAL:
+			while ((f = tc_field(t, &fid)) != TC_STOP) {
+				if (fid == 1)
+					c->scale = (int) tc_int(t, f);
+				else if (fid == 2)
+					c->precision = (int) tc_int(t, f);
+				else
+					tc_skip(t, f);
+			}
+			break;
+		case LT_TIME:
+		case LT_TIMESTAMP:
+			while ((f = tc_field(t, &fid)) != TC_STOP) {
+				if (fid == 1)
+					c->utc = tc_bool(t, f);
+				else if (fid == 2)
+					c->unit = tc_union(t, f);
+				else
+					tc_skip(t, f);
+			}
+			break;
+		case LT_INTEGER:
+			while ((f = tc_field(t, &fid)) != TC_STOP) {
+				if (fid == 1)
+					c->bitwidth = (int) tc_int(t, f);
+				else if (fid == 2)
+					c->is_signed = tc_bool(t, f);
+				else
+					tc_skip(t, f);
+			}
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+static void
+tc_schema_element(tc *t, int type, pq_column *c)
+{
+	int id = 0, ft;
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 1:
+			c->ptype = (int) tc_int(t, ft);
+			break;
+		case 2:
+			c->type_length = (int) tc_int(t, ft);
+			break;
+		case 3:
+			c->repetition = (int) tc_int(t, ft);
+			break;
+		case 4: {
+			uint32_t len;
+			const uint8_t *s = tc_binary(t, ft, &len);
+			if (s && c->name == NULL && (c->name = GDKstrndup((const char *) s, len)) == NULL)
+				t->oom = t->err = true;
+			break;
+		}
+		case 5:
+			c->num_children = (int) tc_int(t, ft);
+			break;
+		case 6:
+			c->ctype = (int) tc_int(t, ft);
+			break;
+		case 7:
+			c->scale = (int) tc_int(t, ft);
+			break;
+		case 8:
+			c->precision = (int) tc_int(t, ft);
+			break;
+		case 10:
+			tc_logical_type(t, ft, c);
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+/* the deprecated min and max statistics use a signed comparison, only
+ * usable for signed numbers */
+static bool
+pq_signed_stats(const pq_column *c)
+{
+	if (c == NULL)
+		return false;
+	switch (c->ptype) {
+	case PT_INT32:
+	case PT_INT64:
+		if (c->ltype == LT_INTEGER)
+			return c->is_signed;
+		return c->ctype < CT_UINT_8 || c->ctype > CT_UINT_64;
+	case PT_FLOAT:
+	case PT_DOUBLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void
+tc_statistics(tc *t, int type, pq_stats *s, const pq_column *c)
+{
+	int id = 0, ft;
+	bool signed_stats = pq_signed_stats(c);
+	uint32_t len;
+	const uint8_t *v;
+
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 1:		/* deprecated max */
+		case 5:		/* max_value */
+			v = tc_binary(t, ft, &len);
+			if (v && (id == 5 || (!s->has_max && signed_stats))) {
+				s->max = v;
+				s->maxlen = len;
+				s->has_max = true;
+			}
+			break;
+		case 2:		/* deprecated min */
+		case 6:		/* min_value */
+			v = tc_binary(t, ft, &len);
+			if (v && (id == 6 || (!s->has_min && signed_stats))) {
+				s->min = v;
+				s->minlen = len;
+				s->has_min = true;
+			}
+			break;
+		case 3:
+			s->null_count = tc_int(t, ft);
+			s->has_null_count = true;
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+static void
+tc_column_meta(tc *t, int type, pq_chunk *ch, const pq_column *c)
+{
+	int id = 0, ft;
+	lng data_offset = -1, dict_offset = -1;
+
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 4:
+			ch->codec = (int) tc_int(t, ft);
+			break;
+		case 5:
+			ch->num_values = tc_int(t, ft);
+			break;
+		case 7:
+			ch->size = tc_int(t, ft);
+			break;
+		case 9:
+			data_offset = tc_int(t, ft);
+			break;
+		case 11:
+			dict_offset = tc_int(t, ft);
+			break;
+		case 12:
+			tc_statistics(t, ft, &ch->stats, c);
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+	/* some writers set the dictionary page offset to 0 when there is none */
+	ch->offset = dict_offset > 0 && dict_offset < data_offset ? dict_offset : data_offset;
+}
+
+static void
+tc_column_chunk(tc *t, int type, pq_chunk *ch, const pq_column *c)
+{
+	int id = 0, ft;
+	uint32_t len;
+
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 1:
+			(void) tc_binary(t, ft, &len);
+			ch->external = true;
+			break;
+		case 3:
+			tc_column_meta(t, ft, ch, c);
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+static void
+tc_row_group(tc *t, int type, pq_rowgroup *rg, const pq_file *pf)
+{
+	int id = 0, ft, et;
+	uint32_t n;
+
+	if (type != TC_STRUCT) {
+		t->err = true;
+		return;
+	}
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 1:
+			n = tc_list(t, ft, &et);
+			if (t->err || rg->chunks) {
+				t->err = true;
+				break;
+			}
+			if ((rg->chunks = GDKzalloc(MAX(n, 1) * sizeof(pq_chunk))) == NULL) {
+				t->oom = t->err = true;
+				break;
+			}
+			rg->nchunks = (int) n;
+			for (uint32_t i = 0; i < n && !t->err; i++)
+				tc_column_chunk(t, et, &rg->chunks[i],
+						(int) i + 1 < pf->nschema ? &pf->schema[i + 1] : NULL);
+			break;
+		case 3:
+			rg->num_rows = tc_int(t, ft);
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+static void
+tc_file_metadata(tc *t, pq_file *pf)
+{
+	int id = 0, ft, et;
+	uint32_t n;
+
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 2:
+			n = tc_list(t, ft, &et);
+			if (t->err || pf->schema) {
+				t->err = true;
+				break;
+			}
+			if ((pf->schema = GDKzalloc(MAX(n, 1) * sizeof(pq_column))) == NULL) {
+				t->oom = t->err = true;
+				break;
+			}
+			pf->nschema = (int) n;
+			for (uint32_t i = 0; i < n && !t->err; i++) {
+				pf->schema[i].ctype = -1;
+				pf->schema[i].is_signed = true;
+				tc_schema_element(t, et, &pf->schema[i]);
+			}
+			break;
+		case 3:
+			pf->num_rows = tc_int(t, ft);
+			break;
+		case 4:
+			n = tc_list(t, ft, &et);
+			if (t->err || pf->rowgroups) {
+				t->err = true;
+				break;
+			}
+			if ((pf->rowgroups = GDKzalloc(MAX(n, 1) * sizeof(pq_rowgroup))) == NULL) {
+				t->oom = t->err = true;
+				break;
+			}
+			pf->nrowgroups = (int) n;
+			for (uint32_t i = 0; i < n && !t->err; i++)
+				tc_row_group(t, et, &pf->rowgroups[i], pf);
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+}
+
+typedef struct pq_page {
+	int type;
+	int32_t usize, csize;
+	int32_t num_values, num_nulls;
+	int encoding, def_encoding;
+	int32_t def_len, rep_len;
+	bool is_compressed;
+} pq_page;
+
+static void
+tc_page_header(tc *t, pq_page *h)
+{
+	int id = 0, ft, fid, f;
+
+	*h = (pq_page) {.type = -1, .is_compressed = true, .def_encoding = ENC_RLE};
+	while ((ft = tc_field(t, &id)) != TC_STOP) {
+		switch (id) {
+		case 1:
+			h->type = (int) tc_int(t, ft);
+			break;
+		case 2:
+			h->usize = (int32_t) tc_int(t, ft);
+			break;
+		case 3:
+			h->csize = (int32_t) tc_int(t, ft);
+			break;
+		case 5:		/* DataPageHeader */
+		case 7:		/* DictionaryPageHeader */
+			if (ft != TC_STRUCT) {
+				t->err = true;
+				break;
+			}
+			fid = 0;
+			while ((f = tc_field(t, &fid)) != TC_STOP) {
+				if (fid == 1)
+					h->num_values = (int32_t) tc_int(t, f);
+				else if (fid == 2)
+					h->encoding = (int) tc_int(t, f);
+				else if (fid == 3 && id == 5)
+					h->def_encoding = (int) tc_int(t, f);
+				else
+					tc_skip(t, f);
+			}
+			break;
+		case 8:		/* DataPageHeaderV2 */
+			if (ft != TC_STRUCT) {
+				t->err = true;
+				break;
+			}
+			fid = 0;
+			while ((f = tc_field(t, &fid)) != TC_STOP) {
+				switch (fid) {
+				case 1:
+					h->num_values = (int32_t) tc_int(t, f);
+					break;
+				case 2:
+					h->num_nulls = (int32_t) tc_int(t, f);
+					break;
+				case 4:
+					h->encoding = (int) tc_int(t, f);
+					break;
+				case 5:
+					h->def_len = (int32_t) tc_int(t, f);
+					break;
+				case 6:
+					h->rep_len = (int32_t) tc_int(t, f);
+					break;
+				case 7:
+					h->is_compressed = tc_bool(t, f);
+					break;
+				default:
+					tc_skip(t, f);
+					break;
+				}
+			}
+			break;
+		default:
+			tc_skip(t, ft);
+			break;
+		}
+	}
+	if (h->usize < 0 || h->csize < 0 || h->num_values < 0 || h->def_len < 0 || h->rep_len < 0)
+		t->err = true;
+}
+
+/*
+ * mapping of the parquet types onto MonetDB types
+ */
+
+static int
+pq_decimal_type(unsigned int digits)
+{
+	if (digits <= 2)
+		return TYPE_bte;
+	if (digits <= 4)
+		return TYPE_sht;
+	if (digits <= 9)
+		return TYPE_int;
+	if (digits <= 18)
+		return TYPE_lng;
+#ifdef HAVE_HGE
+	return TYPE_hge;
+#else
+	return TYPE_void;
+#endif
+}
+
+static int
+pq_integer_type(int bits)
+{
+	switch (bits) {
+	case 8:
+		return TYPE_bte;
+	case 16:
+		return TYPE_sht;
+	case 32:
+		return TYPE_int;
+	case 64:
+		return TYPE_lng;
+#ifdef HAVE_HGE
+	case 128:
+		return TYPE_hge;
+#endif
+	default:
+		return TYPE_void;
+	}
+}
+
+static const char *
+pq_integer_name(int tpe)
+{
+	switch (tpe) {
+	case TYPE_bte:
+		return "tinyint";
+	case TYPE_sht:
+		return "smallint";
+	case TYPE_int:
+		return "int";
+	case TYPE_lng:
+		return "bigint";
+	default:
+		return "hugeint";
+	}
+}
+
+static const char *
+pq_column_type(pq_file *pf, pq_column *c)
+{
+	bool decimal = c->ltype == LT_DECIMAL || (c->ltype == 0 && c->ctype == CT_DECIMAL);
+	int unit = c->unit;
+
+	if (c->ltype == 0) {
+		/* map the converted type onto the logical type */
+		switch (c->ctype) {
+		case CT_UTF8:
+			c->ltype = LT_STRING;
+			break;
+		case CT_ENUM:
+			c->ltype = LT_ENUM;
+			break;
+		case CT_DATE:
+			c->ltype = LT_DATE;
+			break;
+		case CT_TIME_MILLIS:
+		case CT_TIME_MICROS:
+			c->ltype = LT_TIME;
+			unit = c->ctype == CT_TIME_MILLIS ? 1 : 2;
+			break;
+		case CT_TIMESTAMP_MILLIS:
+		case CT_TIMESTAMP_MICROS:
+			c->ltype = LT_TIMESTAMP;
+			c->utc = true;
+			unit = c->ctype == CT_TIMESTAMP_MILLIS ? 1 : 2;
+			break;
+		case CT_UINT_8:
+		case CT_UINT_16:
+		case CT_UINT_32:
+		case CT_UINT_64:
+			c->ltype = LT_INTEGER;
+			c->is_signed = false;
+			c->bitwidth = 8 << (c->ctype - CT_UINT_8);
+			break;
+		case CT_INT_8:
+		case CT_INT_16:
+		case CT_INT_32:
+		case CT_INT_64:
+			c->ltype = LT_INTEGER;
+			c->is_signed = true;
+			c->bitwidth = 8 << (c->ctype - CT_INT_8);
+			break;
+		case CT_JSON:
+			c->ltype = LT_JSON;
+			break;
+		case CT_BSON:
+			c->ltype = LT_BSON;
+			break;
+		default:
+			break;
+		}
+	}
+	c->unit = unit;
+	c->mtype = TYPE_void;
+	c->digits = c->dscale = 0;
+	if (decimal) {
+		if (c->precision < 1 || c->precision > 38 || c->scale < 0 || c->scale > c->precision) {
+			snprintf(pf->err, sizeof(pf->err), "column %s: invalid decimal(%d,%d)", c->name, c->precision, c->scale);
+			return pf->err;
+		}
+		c->conv = c->ptype == PT_INT32 || c->ptype == PT_INT64 ? PQ_INT : PQ_DECIMAL;
+		c->mtype = pq_decimal_type((unsigned int) c->precision);
+		c->sqlname = "decimal";
+		c->digits = (unsigned int) c->precision;
+		c->dscale = (unsigned int) c->scale;
+		if (c->mtype == TYPE_void) {
+			snprintf(pf->err, sizeof(pf->err), "column %s: decimal(%d,%d) not supported", c->name, c->precision, c->scale);
+			return pf->err;
+		}
+		if (c->ptype != PT_INT32 && c->ptype != PT_INT64 &&
+			c->ptype != PT_BYTE_ARRAY && c->ptype != PT_FIXED_LEN_BYTE_ARRAY)
+			c->mtype = TYPE_void;
+	} else {
+		switch (c->ptype) {
+		case PT_BOOLEAN:
+			c->conv = PQ_BOOL;
+			c->mtype = TYPE_bit;
+			c->sqlname = "boolean";
+			break;
+		case PT_INT32:
+		case PT_INT64:
+			if (c->ltype == LT_DATE && c->ptype == PT_INT32) {
+				c->conv = PQ_DATE;
+				c->mtype = TYPE_date;
+				c->sqlname = "date";
+			} else if (c->ltype == LT_TIME && unit >= 1 && unit <= 3 && (unit == 1) == (c->ptype == PT_INT32)) {
+				c->conv = unit == 1 ? PQ_TIME_MS : unit == 2 ? PQ_TIME_US : PQ_TIME_NS;
+				c->mtype = TYPE_daytime;
+				c->sqlname = "time";
+				c->digits = unit == 1 ? 3 + 1 : 6 + 1;
+			} else if (c->ltype == LT_TIMESTAMP && unit >= 1 && unit <= 3 && c->ptype == PT_INT64) {
+				c->conv = unit == 1 ? PQ_TS_MS : unit == 2 ? PQ_TS_US : PQ_TS_NS;
+				c->mtype = TYPE_timestamp;
+				c->sqlname = c->utc ? "timestamptz" : "timestamp";
+				c->digits = unit == 1 ? 3 + 1 : 6 + 1;
+			} else if (c->ltype == LT_INTEGER) {
+				c->conv = PQ_INT;
+				if (c->bitwidth > (c->ptype == PT_INT32 ? 32 : 64))
+					break;
+				c->mtype = pq_integer_type(c->is_signed ? c->bitwidth : 2 * c->bitwidth);
+				c->sqlname = pq_integer_name(c->mtype);
+			} else if (c->ltype == 0) {
+				c->conv = PQ_INT;
+				c->mtype = c->ptype == PT_INT32 ? TYPE_int : TYPE_lng;
+				c->sqlname = pq_integer_name(c->mtype);
+			}
+			break;
+		case PT_INT96:
+			c->conv = PQ_INT96;
+			c->mtype = TYPE_timestamp;
+			c->sqlname = "timestamp";
+			c->digits = 6 + 1;
+			break;
+		case PT_FLOAT:
+			c->conv = PQ_FLT;
+			c->mtype = TYPE_flt;
+			c->sqlname = "real";
+			break;
+		case PT_DOUBLE:
+			c->conv = PQ_DBL;
+			c->mtype = TYPE_dbl;
+			c->sqlname = "double";
+			break;
+		case PT_BYTE_ARRAY:
+		case PT_FIXED_LEN_BYTE_ARRAY:
+			if (c->ptype == PT_FIXED_LEN_BYTE_ARRAY && c->type_length <= 0)
+				break;
+			if (c->ltype == LT_STRING || c->ltype == LT_ENUM || c->ltype == LT_JSON) {
+				c->conv = PQ_STR;
+				c->mtype = TYPE_str;
+				c->sqlname = "varchar";
+			} else if (c->ltype == LT_UUID && c->type_length == 16) {
+				c->conv = PQ_UUID;
+				c->mtype = TYPE_uuid;
+				c->sqlname = "uuid";
+			} else if (c->ltype == LT_FLOAT16 && c->type_length == 2) {
+				c->conv = PQ_FLOAT16;
+				c->mtype = TYPE_flt;
+				c->sqlname = "real";
+			} else if (c->ltype == 0 || c->ltype == LT_BSON) {
+				c->conv = PQ_BLOB;
+				c->mtype = TYPE_blob;
+				c->sqlname = "blob";
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	if (c->mtype == TYPE_void) {
+		snprintf(pf->err, sizeof(pf->err), "column %s: type not supported", c->name);
+		return pf->err;
+	}
+	return NULL;
+}
+
+void
+pq_close(pq_file *pf)
+{
+	if (pf == NULL)
+		return;
+	if (pf->base)
+		GDKmunmap(pf->base, MMAP_READ, pf->size);
+	for (int i = 0; i < pf->nschema; i++)
+		GDKfree(pf->schema[i].name);
+	GDKfree(pf->schema);
+	for (int i = 0; i < pf->nrowgroups; i++)
+		GDKfree(pf->rowgroups[i].chunks);
+	GDKfree(pf->rowgroups);
+	GDKfree(pf->filename);
+	GDKfree(pf);
+}
+
+pq_file *
+pq_open(const char *filename, char *errbuf, size_t errlen)
+{
+	struct stat st;
+	pq_file *pf;
+
+	if (MT_stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) {
+		snprintf(errbuf, errlen, "cannot open file %s", filename);
+		return NULL;
+	}
+	if (st.st_size < 12) {
+		snprintf(errbuf, errlen, "%s is not a parquet file", filename);
+		return NULL;
+	}
+	if ((pf = GDKzalloc(sizeof(pq_file))) == NULL ||
+		(pf->filename = GDKstrdup(filename)) == NULL) {
+		GDKfree(pf);
+		snprintf(errbuf, errlen, "out of memory");
+		return NULL;
+	}
+	pf->size = (size_t) st.st_size;
+	if ((pf->base = GDKmmap(filename, MMAP_READ, pf->size)) == NULL) {
+		snprintf(errbuf, errlen, "cannot map file %s", filename);
+		pq_close(pf);
+		return NULL;
+	}
+	const uint8_t *tail = pf->base + pf->size - 8;
+	uint32_t mlen = ld32(tail);
+	if (memcmp(pf->base, "PAR1", 4) != 0 || memcmp(tail + 4, "PAR1", 4) != 0) {
+		snprintf(errbuf, errlen, "%s is not a parquet file (or is encrypted)", filename);
+		pq_close(pf);
+		return NULL;
+	}
+	if (mlen > pf->size - 12) {
+		snprintf(errbuf, errlen, CORRUPT " %s", filename);
+		pq_close(pf);
+		return NULL;
+	}
+
+	tc t = (tc) {.p = tail - mlen, .e = tail};
+	tc_file_metadata(&t, pf);
+	if (t.err) {
+		snprintf(errbuf, errlen, "%s %s", t.oom ? "out of memory reading" : CORRUPT, filename);
+		pq_close(pf);
+		return NULL;
+	}
+	if (pf->nschema < 1 || pf->schema[0].num_children != pf->nschema - 1) {
+		snprintf(errbuf, errlen, "%s: nested columns are not supported", filename);
+		pq_close(pf);
+		return NULL;
+	}
+	pf->cols = pf->schema + 1;
+	pf->ncols = pf->nschema - 1;
+	for (int i = 0; i < pf->ncols; i++) {
+		pq_column *c = &pf->cols[i];
+
+		if (c->name == NULL || c->num_children > 0 || c->repetition == REP_REPEATED) {
+			snprintf(errbuf, errlen, "%s: nested columns are not supported", filename);
+			pq_close(pf);
+			return NULL;
+		}
+		if (pq_column_type(pf, c) != NULL) {
+			snprintf(errbuf, errlen, "%s: %s", filename, pf->err);
+			pq_close(pf);
+			return NULL;
+		}
+	}
+	for (int i = 0; i < pf->nrowgroups; i++) {
+		if (pf->rowgroups[i].nchunks != pf->ncols || pf->rowgroups[i].num_rows < 0) {
+			snprintf(errbuf, errlen, CORRUPT " %s", filename);
+			pq_close(pf);
+			return NULL;
+		}
+	}
+	return pf;
+}
+
+/*
+ * conversion of the physical values into MonetDB values
+ */
+
+/* days since the epoch to date, using the civil from days algorithm */
+static inline date
+pq_date(int64_t z)
+{
+	if (z < -(1 << 30) || z > (1 << 30))
+		return date_nil;
+	z += 719468;
+	int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+	int64_t doe = z - era * 146097;
+	int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	int64_t mp = (5 * doy + 2) / 153;
+	int d = (int) (doy - (153 * mp + 2) / 5 + 1);
+	int m = (int) (mp < 10 ? mp + 3 : mp - 9);
+	int y = (int) (yoe + era * 400) + (m <= 2);
+	return date_create(y, m, d);
+}
+
+static inline timestamp
+pq_timestamp(int64_t usec)
+{
+	int64_t days = usec / DAY_USEC, rem = usec % DAY_USEC;
+	if (rem < 0) {
+		rem += DAY_USEC;
+		days--;
+	}
+	return timestamp_create(pq_date(days), rem);
+}
+
+static inline int64_t
+pq_floordiv(int64_t v, int64_t d)
+{
+	return v / d - (v % d < 0);
+}
+
+static inline daytime
+pq_daytime(int64_t usec)
+{
+	return usec >= 0 && usec < DAY_USEC ? usec : daytime_nil;
+}
+
+static inline flt
+pq_half(uint16_t h)
+{
+	int e = (h >> 10) & 0x1F;
+	flt m = (flt) (h & 0x3FF);
+	flt v;
+
+	if (e == 0)
+		v = ldexpf(m, -24);
+	else if (e == 31)
+		v = m == 0 ? INFINITY : NAN;
+	else
+		v = ldexpf(m + 1024, e - 25);
+	return h & 0x8000 ? -v : v;
+}
+
+typedef struct pq_bytes {
+	const uint8_t *s;
+	uint32_t len;
+} pq_bytes;
+
+typedef struct pq_decoder {
+	pq_file *pf;
+	const pq_column *col;
+	int pwidth;			/* of fixed size physical values */
+	BAT *b;
+	size_t width;			/* of the MonetDB values */
+	BUN pos;			/* next row to write */
+	bool hasnil;
+	var_t niloff;			/* offset of the nil value in the vheap */
+	bool has_niloff;
+	BUN ndict;
+	uint8_t *dict;			/* converted values (or offsets) of the dictionary */
+	size_t dictlen;
+	/* scratch space */
+	uint8_t *page, *vals, *idx, *defs, *bytes, *buf, *offs, *prefixed;
+	size_t pagelen, valslen, idxlen, defslen, byteslen, buflen, offslen, prefixedlen;
+} pq_decoder;
+
+static void *
+pq_grow(uint8_t **buf, size_t *len, size_t need)
+{
+	if (need > *len) {
+		size_t nlen = MAX(need, *len + *len / 2);
+		uint8_t *n = GDKmalloc(MAX(nlen, 64));
+		if (n == NULL)
+			return NULL;
+		GDKfree(*buf);
+		*buf = n;
+		*len = MAX(nlen, 64);
+	}
+	return *buf;
+}
+
+#define PQ_GROW(d, f, n)	pq_grow(&(d)->f, &(d)->f##len, (n))
+
+/* convert fixed size physical values to MonetDB values */
+static void
+pq_convert(const pq_decoder *d, const uint8_t *v, BUN n, void *dst)
+{
+	const pq_column *c = d->col;
+
+	switch (c->conv) {
+	case PQ_BOOL:
+		memcpy(dst, v, n);
+		break;
+	case PQ_INT: {
+#ifndef WORDS_BIGENDIAN
+		/* unsigned values are always widened */
+		if ((size_t) d->pwidth == d->width) {
+			memcpy(dst, v, n * d->width);
+			break;
+		}
+#endif
+#define CONVERT_INT(TPE)						\
+		do {							\
+			TPE *o = dst;					\
+			if (d->pwidth == 8)				\
+				for (BUN i = 0; i < n; i++)		\
+					o[i] = (TPE) ld64(v + 8 * i);	\
+			else if (c->is_signed)				\
+				for (BUN i = 0; i < n; i++)		\
+					o[i] = (TPE) (int32_t) ld32(v + 4 * i); \
+			else						\
+				for (BUN i = 0; i < n; i++)		\
+					o[i] = (TPE) ld32(v + 4 * i);	\
+		} while (0)
+		switch (d->width) {
+		case 1:
+			CONVERT_INT(bte);
+			break;
+		case 2:
+			CONVERT_INT(sht);
+			break;
+		case 4:
+			CONVERT_INT(int);
+			break;
+		case 8:
+			CONVERT_INT(lng);
+			break;
+#ifdef HAVE_HGE
+		case 16: {
+			hge *o = dst;
+			if (c->is_signed)
+				for (BUN i = 0; i < n; i++)
+					o[i] = (hge) (int64_t) ld64(v + 8 * i);
+			else
+				for (BUN i = 0; i < n; i++)
+					o[i] = (hge) ld64(v + 8 * i);
+			break;
+		}
+#endif
+		default:
+			MT_UNREACHABLE();
+		}
+		break;
+	}
+	case PQ_DATE: {
+		date *o = dst;
+		for (BUN i = 0; i < n; i++)
+			o[i] = pq_date((int32_t) ld32(v + 4 * i));
+		break;
+	}
+	case PQ_TIME_MS: {
+		daytime *o = dst;
+		for (BUN i = 0; i < n; i++)
+			o[i] = pq_daytime((int64_t) (int32_t) ld32(v + 4 * i) * 1000);
+		break;
+	}
+	case PQ_TIME_US:
+	case PQ_TIME_NS: {
+		daytime *o = dst;
+		int64_t div = c->conv == PQ_TIME_NS ? 1000 : 1;
+		for (BUN i = 0; i < n; i++)
+			o[i] = pq_daytime(pq_floordiv((int64_t) ld64(v + 8 * i), div));
+		break;
+	}
+	case PQ_TS_MS: {
+		timestamp *o = dst;
+		for (BUN i = 0; i < n; i++) {
+			int64_t ms = (int64_t) ld64(v + 8 * i);
+			o[i] = ms > INT64_MAX / 1000 || ms < INT64_MIN / 1000 ? timestamp_nil : pq_timestamp(ms * 1000);
+		}
+		break;
+	}
+	case PQ_TS_US:
+	case PQ_TS_NS: {
+		timestamp *o = dst;
+		int64_t div = c->conv == PQ_TS_NS ? 1000 : 1;
+		for (BUN i = 0; i < n; i++)
+			o[i] = pq_timestamp(pq_floordiv((int64_t) ld64(v + 8 * i), div));
+		break;
+	}
+	case PQ_INT96: {
+		timestamp *o = dst;
+		for (BUN i = 0; i < n; i++) {
+			int64_t nanos = (int64_t) ld64(v + 12 * i);
+			int64_t days = (int64_t) ld32(v + 12 * i + 8) - 2440588; /* julian day of the epoch */
+			if (nanos >= 0 && nanos < DAY_USEC * 1000)
+				o[i] = timestamp_create(pq_date(days), nanos / 1000);
+			else
+				o[i] = timestamp_nil;
+		}
+		break;
+	}
+	case PQ_FLT: {
+#ifndef WORDS_BIGENDIAN
+		memcpy(dst, v, n * sizeof(flt));
+#else
+		flt *o = dst;
+		for (BUN i = 0; i < n; i++) {
+			uint32_t u = ld32(v + 4 * i);
+			memcpy(&o[i], &u, sizeof(flt));
+		}
+#endif
+		break;
+	}
+	case PQ_DBL: {
+#ifndef WORDS_BIGENDIAN
+		memcpy(dst, v, n * sizeof(dbl));
+#else
+		dbl *o = dst;
+		for (BUN i = 0; i < n; i++) {
+			uint64_t u = ld64(v + 8 * i);
+			memcpy(&o[i], &u, sizeof(dbl));
+		}
+#endif
+		break;
+	}
+	default:
+		MT_UNREACHABLE();
+	}
+}
+
+/* convert byte array values to fixed size MonetDB values */
+static const char *
+pq_convert_bytes(pq_decoder *d, const pq_bytes *v, BUN n, void *dst)
+{
+	const pq_column *c = d->col;
+
+	for (BUN i = 0; i < n; i++) {
+		const uint8_t *s = v[i].s;
+		uint32_t len = v[i].len;
+
+		switch (c->conv) {
+		case PQ_DECIMAL: {
+			/* big endian two's complement, drop superfluous sign bytes */
+			bool neg = len > 0 && (s[0] & 0x80);
+#ifdef HAVE_HGE
+			hge r;
+#else
+			lng r;
+#endif
+			while (len > sizeof(r) && s[0] == (neg ? 0xFF : 0))
+				s++, len--;
+			if (len > sizeof(r)) {
+				snprintf(d->pf->err, sizeof(d->pf->err), "column %s: decimal value out of range", c->name);
+				return d->pf->err;
+			}
+			/* accumulate the complement of negative numbers, which
+			 * cannot overflow */
+			r = 0;
+			for (uint32_t k = 0; k < len; k++)
+				r = r * 256 + (uint8_t) (neg ? ~s[k] : s[k]);
+			if (neg)
+				r = -r - 1;
+			switch (d->width) {
+			case 1:
+				((bte *) dst)[i] = (bte) r;
+				break;
+			case 2:
+				((sht *) dst)[i] = (sht) r;
+				break;
+			case 4:
+				((int *) dst)[i] = (int) r;
+				break;
+			case 8:
+				((lng *) dst)[i] = (lng) r;
+				break;
+#ifdef HAVE_HGE
+			case 16:
+				((hge *) dst)[i] = r;
+				break;
+#endif
+			default:
+				MT_UNREACHABLE();
+			}
+			break;
+		}
+		case PQ_UUID:
+			if (len != 16)
+				return CORRUPT;
+			memcpy(((uuid *) dst)[i].u, s, 16);
+			break;
+		case PQ_FLOAT16:
+			if (len != 2)
+				return CORRUPT;
+			((flt *) dst)[i] = pq_half((uint16_t) (s[0] | s[1] << 8));
+			break;
+		default:
+			MT_UNREACHABLE();
+		}
+	}
+	return NULL;
+}
+
+/* put byte array values into the vheap, returning their offsets */
+static const char *
+pq_put_bytes(pq_decoder *d, const pq_bytes *v, BUN n, var_t *offs)
+{
+	const pq_column *c = d->col;
+	BAT *b = d->b;
+	const char *msg = NULL;
+
+	MT_lock_set(&b->theaplock);
+	for (BUN i = 0; i < n && msg == NULL; i++) {
+		uint32_t len = v[i].len;
+		size_t need = c->conv == PQ_STR ? (size_t) len + 1 : blobsize(len);
+
+		if (PQ_GROW(d, buf, need) == NULL) {
+			msg = MAL_MALLOC_FAIL;
+			break;
+		}
+		if (c->conv == PQ_STR) {
+			char *s = (char *) d->buf;
+			memcpy(s, v[i].s, len);
+			s[len] = 0;
+			if (strlen(s) != len || !checkUTF8(s)) {
+				snprintf(d->pf->err, sizeof(d->pf->err), "column %s: invalid UTF-8 string", c->name);
+				msg = d->pf->err;
+				break;
+			}
+		} else {
+			blob *bl = (blob *) d->buf;
+			bl->nitems = len;
+			memcpy(bl->data, v[i].s, len);
+		}
+		if (ATOMputVAR(b, &offs[i], d->buf) != GDK_SUCCEED)
+			msg = GDK_EXCEPTION;
+	}
+	MT_lock_unset(&b->theaplock);
+	return msg;
+}
+
+/* write the offsets of n rows into the tail, upgrading its width
+ * once if needed, rows without value (defs[i] == 0) get nil */
+static const char *
+pq_put_offsets(pq_decoder *d, const var_t *offs, const uint8_t *defs, BUN n)
+{
+	BAT *b = d->b;
+	var_t max = 0;
+	BUN nv = 0;
+
+	if (defs) {
+		for (BUN i = 0; i < n; i++)
+			nv += defs[i];
+		if (nv < n && !d->has_niloff) {
+			MT_lock_set(&b->theaplock);
+			gdk_return rc = ATOMputVAR(b, &d->niloff, ATOMnilptr(b->ttype));
+			MT_lock_unset(&b->theaplock);
+			if (rc != GDK_SUCCEED)
+				return GDK_EXCEPTION;
+			d->has_niloff = true;
+		}
+		if (nv < n)
+			max = d->niloff;
+	} else {
+		nv = n;
+	}
+	for (BUN i = 0; i < nv; i++)
+		if (offs[i] > max)
+			max = offs[i];
+	if (b->twidth < SIZEOF_VAR_T &&
+	    (b->twidth <= 2 ? max - GDK_VAROFFSET : max) >= ((size_t) 1 << (8 << b->tshift))) {
+		MT_lock_set(&b->theaplock);
+		gdk_return rc = GDKupgradevarheap(b, max, 0, d->pos);
+		MT_lock_unset(&b->theaplock);
+		if (rc != GDK_SUCCEED)
+			return GDK_EXCEPTION;
+	}
+#define PUT_OFFSETS(TPE, OFF)						\
+	do {								\
+		TPE *o = (TPE *) b->theap->base + d->pos;		\
+		if (defs) {						\
+			for (BUN i = 0, j = 0; i < n; i++)		\
+				o[i] = (TPE) ((defs[i] ? offs[j++] : d->niloff) - OFF); \
+		} else {						\
+			for (BUN i = 0; i < n; i++)			\
+				o[i] = (TPE) (offs[i] - OFF);		\
+		}							\
+	} while (0)
+	switch (b->twidth) {
+	case 1:
+		PUT_OFFSETS(uint8_t, GDK_VAROFFSET);
+		break;
+	case 2:
+		PUT_OFFSETS(uint16_t, GDK_VAROFFSET);
+		break;
+	case 4:
+		PUT_OFFSETS(uint32_t, 0);
+		break;
+#if SIZEOF_VAR_T == 8
+	case 8:
+		PUT_OFFSETS(uint64_t, 0);
+		break;
+#endif
+	default:
+		MT_UNREACHABLE();
+	}
+	return NULL;
+}
+
+/* spread nv values stored at the start of dst over n rows, in place,
+ * rows without value (defs[i] == 0) get nil */
+static void
+pq_expand(uint8_t *dst, size_t width, const uint8_t *defs, BUN n, BUN nv, const void *nil)
+{
+	BUN j = nv;
+
+#define EXPAND(TPE)							\
+	do {								\
+		TPE *o = (TPE *) dst, nv = *(const TPE *) nil;		\
+		for (BUN i = n; i-- > 0; )				\
+			o[i] = defs[i] ? o[--j] : nv;			\
+	} while (0)
+	switch (width) {
+	case 1:
+		EXPAND(bte);
+		break;
+	case 2:
+		EXPAND(sht);
+		break;
+	case 4:
+		EXPAND(int);
+		break;
+	case 8:
+		EXPAND(lng);
+		break;
+	default:
+		for (BUN i = n; i-- > 0; ) {
+			if (defs[i]) {
+				if (--j != i)
+					memcpy(dst + i * width, dst + j * width, width);
+			} else {
+				memcpy(dst + i * width, nil, width);
+			}
+		}
+		break;
+	}
+}
+
+/* unpack n values of bw (<= 32) bits, least significant bits first */
+static const uint8_t *
+pq_unpack(const uint8_t *p, const uint8_t *e, int bw, uint32_t *out, BUN n)
+{
+	uint64_t acc = 0;
+	int nb = 0;
+	uint32_t mask = bw == 32 ? UINT32_MAX : ((uint32_t) 1 << bw) - 1;
+
+	for (BUN i = 0; i < n; i++) {
+		while (nb < bw) {
+			if (p >= e)
+				return NULL;
+			acc |= (uint64_t) *p++ << nb;
+			nb += 8;
+		}
+		out[i] = (uint32_t) acc & mask;
+		acc >>= bw;
+		nb -= bw;
+	}
+	return p;
+}
+
+/* unpack n values of bw (<= 64) bits, least significant bits first */
+static const uint8_t *
+pq_unpack64(const uint8_t *p, const uint8_t *e, int bw, uint64_t *out, BUN n)
+{
+	size_t bit = 0;
+
+	if ((size_t) (e - p) * 8 < n * (size_t) bw)
+		return NULL;
+	for (BUN i = 0; i < n; i++) {
+		uint64_t v = 0;
+		for (int got = 0; got < bw; ) {
+			int off = (int) (bit & 7), take = MIN(8 - off, bw - got);
+			v |= (uint64_t) ((p[bit >> 3] >> off) & ((1 << take) - 1)) << got;
+			got += take;
+			bit += (size_t) take;
+		}
+		out[i] = v;
+	}
+	return p + (bit + 7) / 8;
+}
+
+/* decode n values of the RLE/bit-packing hybrid encoding */
+static const char *
+pq_hybrid(const uint8_t *p, const uint8_t *e, int bw, uint32_t *out, BUN n)
+{
+	if (bw < 0 || bw > 32)
+		return CORRUPT;
+	for (BUN i = 0; i < n; ) {
+		uint64_t h;
+		if ((p = pq_varint(p, e, &h)) == NULL || (h >> 1) == 0)
+			return CORRUPT;
+		if (h & 1) {
+			uint64_t groups = h >> 1;
+			BUN cnt = (BUN) MIN(groups * 8, (uint64_t) (n - i));
+			const uint8_t *q = pq_unpack(p, e, bw, out + i, cnt);
+			if (q == NULL)
+				return CORRUPT;
+			/* the run may be padded */
+			p = groups * (uint64_t) bw < (uint64_t) (e - p) ? p + groups * bw : e;
+			i += cnt;
+		} else {
+			BUN cnt = (BUN) MIN(h >> 1, (uint64_t) (n - i));
+			int nbytes = (bw + 7) / 8;
+			uint32_t v = 0;
+			if (e - p < nbytes)
+				return CORRUPT;
+			for (int k = 0; k < nbytes; k++)
+				v |= (uint32_t) p[k] << (8 * k);
+			p += nbytes;
+			for (BUN k = 0; k < cnt; k++)
+				out[i++] = v;
+		}
+	}
+	return NULL;
+}
+
+/* decode a DELTA_BINARY_PACKED stream into pwidth (4 or 8) byte little
+ * endian integers in d->vals, *pp is set to the end of the stream */
+static const char *
+pq_delta(pq_decoder *d, const uint8_t **pp, const uint8_t *e, int pwidth, BUN *cnt)
+{
+	const uint8_t *p = *pp;
+	uint64_t block, nmini, total, first;
+
+	if ((p = pq_varint(p, e, &block)) == NULL ||
+		(p = pq_varint(p, e, &nmini)) == NULL ||
+		(p = pq_varint(p, e, &total)) == NULL ||
+		(p = pq_varint(p, e, &first)) == NULL ||
+		nmini == 0 || block == 0 || block % nmini != 0 || (block / nmini) % 8 != 0 ||
+		block > (1 << 20) || total > (uint64_t) BUN_MAX / 8)
+		return CORRUPT;
+
+	uint64_t vpm = block / nmini;	/* values per miniblock */
+	uint8_t *out = PQ_GROW(d, vals, MAX(total, 1) * pwidth);
+	uint64_t *deltas = PQ_GROW(d, idx, vpm * sizeof(uint64_t));
+	if (out == NULL || deltas == NULL)
+		return MAL_MALLOC_FAIL;
+	uint64_t prev = (uint64_t) unzigzag(first);
+	BUN i = 0;
+	if (total > 0) {
+		if (pwidth == 4)
+			st32(out, (uint32_t) prev);
+		else
+			st64(out, prev);
+		i = 1;
+	}
+	while (i < total) {
+		uint64_t md;
+		if ((p = pq_varint(p, e, &md)) == NULL || (uint64_t) (e - p) < nmini)
+			return CORRUPT;
+		int64_t min_delta = unzigzag(md);
+		const uint8_t *widths = p;
+		p += nmini;
+		for (uint64_t m = 0; m < nmini && i < total; m++) {
+			int bw = widths[m];
+			BUN take = (BUN) MIN(vpm, total - i);
+			if (bw > 64 || pq_unpack64(p, e, bw, deltas, take) == NULL)
+				return CORRUPT;
+			size_t nbytes = vpm * bw / 8;
+			p = nbytes < (size_t) (e - p) ? p + nbytes : e;
+			for (BUN k = 0; k < take; k++, i++) {
+				prev += (uint64_t) min_delta + deltas[k];
+				if (pwidth == 4)
+					st32(out + 4 * i, (uint32_t) prev);
+				else
+					st64(out + 8 * i, prev);
+			}
+		}
+	}
+	*pp = p;
+	*cnt = (BUN) total;
+	return NULL;
+}
+
+/* decode n values into either fixed size little endian physical values
+ * (*vals) or byte arrays (d->bytes) */
+static const char *
+pq_values(pq_decoder *d, int enc, const uint8_t *p, const uint8_t *e, BUN n, const uint8_t **vals)
+{
+	const pq_column *c = d->col;
+	const char *msg;
+	BUN cnt;
+
+	switch (enc) {
+	case ENC_PLAIN:
+	case ENC_PLAIN_DICTIONARY:	/* dictionary pages */
+		if (c->ptype == PT_BOOLEAN) {
+			uint8_t *o = PQ_GROW(d, vals, MAX(n, 1));
+			if (o == NULL)
+				return MAL_MALLOC_FAIL;
+			if ((size_t) (e - p) < (n + 7) / 8)
+				return CORRUPT;
+			for (BUN i = 0; i < n; i++)
+				o[i] = (p[i >> 3] >> (i & 7)) & 1;
+			*vals = o;
+		} else if (c->ptype == PT_BYTE_ARRAY) {
+			pq_bytes *o = PQ_GROW(d, bytes, MAX(n, 1) * sizeof(pq_bytes));
+			if (o == NULL)
+				return MAL_MALLOC_FAIL;
+			for (BUN i = 0; i < n; i++) {
+				if (e - p < 4)
+					return CORRUPT;
+				uint32_t len = ld32(p);
+				p += 4;
+				if (len > (size_t) (e - p))
+					return CORRUPT;
+				o[i] = (pq_bytes) {.s = p, .len = len};
+				p += len;
+			}
+		} else if (c->ptype == PT_FIXED_LEN_BYTE_ARRAY) {
+			pq_bytes *o = PQ_GROW(d, bytes, MAX(n, 1) * sizeof(pq_bytes));
+			if (o == NULL)
+				return MAL_MALLOC_FAIL;
+			if ((size_t) (e - p) / (size_t) c->type_length < n)
+				return CORRUPT;
+			for (BUN i = 0; i < n; i++)
+				o[i] = (pq_bytes) {.s = p + i * c->type_length, .len = (uint32_t) c->type_length};
+		} else {
+			if ((size_t) (e - p) / (size_t) d->pwidth < n)
+				return CORRUPT;
+			*vals = p;
+		}
+		return NULL;
+	case ENC_RLE: {
+		if (c->ptype != PT_BOOLEAN)
+			break;
+		if (e - p < 4 || ld32(p) > (size_t) (e - p - 4))
+			return CORRUPT;
+		uint32_t *lv = PQ_GROW(d, idx, MAX(n, 1) * sizeof(uint32_t));
+		uint8_t *o = PQ_GROW(d, vals, MAX(n, 1));
+		if (lv == NULL || o == NULL)
+			return MAL_MALLOC_FAIL;
+		if ((msg = pq_hybrid(p + 4, p + 4 + ld32(p), 1, lv, n)) != NULL)
+			return msg;
+		for (BUN i = 0; i < n; i++)
+			o[i] = (uint8_t) lv[i];
+		*vals = o;
+		return NULL;
+	}
+	case ENC_DELTA_BINARY_PACKED:
+		if (c->ptype != PT_INT32 && c->ptype != PT_INT64)
+			break;
+		if ((msg = pq_delta(d, &p, e, d->pwidth, &cnt)) != NULL)
+			return msg;
+		if (cnt < n)
+			return CORRUPT;
+		*vals = d->vals;
+		return NULL;
+	case ENC_DELTA_LENGTH_BYTE_ARRAY:
+	case ENC_DELTA_BYTE_ARRAY: {
+		if (c->ptype != PT_BYTE_ARRAY && (enc == ENC_DELTA_LENGTH_BYTE_ARRAY || c->ptype != PT_FIXED_LEN_BYTE_ARRAY))
+			break;
+		BUN nprefix = 0;
+		uint8_t *prefix = NULL;
+		if (enc == ENC_DELTA_BYTE_ARRAY) {
+			/* prefix lengths, followed by the suffixes as DELTA_LENGTH_BYTE_ARRAY */
+			if ((msg = pq_delta(d, &p, e, 4, &nprefix)) != NULL)
+				return msg;
+			if (nprefix < n)
+				return CORRUPT;
+			/* keep the prefix lengths, pq_delta reuses d->vals */
+			prefix = d->vals;
+			d->vals = NULL;
+			d->valslen = 0;
+		}
+		if ((msg = pq_delta(d, &p, e, 4, &cnt)) != NULL || cnt < n) {
+			GDKfree(prefix);
+			return msg ? msg : CORRUPT;
+		}
+		pq_bytes *o = PQ_GROW(d, bytes, MAX(n, 1) * sizeof(pq_bytes));
+		if (o == NULL) {
+			GDKfree(prefix);
+			return MAL_MALLOC_FAIL;
+		}
+		if (enc == ENC_DELTA_LENGTH_BYTE_ARRAY) {
+			for (BUN i = 0; i < n; i++) {
+				uint32_t len = ld32(d->vals + 4 * i);
+				if (len > (size_t) (e - p))
+					return CORRUPT;
+				o[i] = (pq_bytes) {.s = p, .len = len};
+				p += len;
+			}
+			return NULL;
+		}
+		/* reconstruct the values from the previous value's prefix
+		 * and the suffix, first compute the space needed */
+		size_t need = 0, plen = 0;
+		const uint8_t *q = p;
+		for (BUN i = 0; i < n; i++) {
+			uint32_t pl = ld32(prefix + 4 * i), sl = ld32(d->vals + 4 * i);
+			if (pl > plen || sl > (size_t) (e - q)) {
+				GDKfree(prefix);
+				return CORRUPT;
+			}
+			q += sl;
+			plen = (size_t) pl + sl;
+			need += plen;
+		}
+		uint8_t *buf = PQ_GROW(d, prefixed, MAX(need, 1));
+		if (buf == NULL) {
+			GDKfree(prefix);
+			return MAL_MALLOC_FAIL;
+		}
+		const uint8_t *last = NULL;
+		for (BUN i = 0; i < n; i++) {
+			uint32_t pl = ld32(prefix + 4 * i), sl = ld32(d->vals + 4 * i);
+			if (pl)
+				memcpy(buf, last, pl);
+			memcpy(buf + pl, p, sl);
+			p += sl;
+			o[i] = (pq_bytes) {.s = buf, .len = pl + sl};
+			last = buf;
+			buf += pl + sl;
+		}
+		GDKfree(prefix);
+		if (c->ptype == PT_FIXED_LEN_BYTE_ARRAY)
+			for (BUN i = 0; i < n; i++)
+				if (o[i].len != (uint32_t) c->type_length)
+					return CORRUPT;
+		return NULL;
+	}
+	case ENC_BYTE_STREAM_SPLIT: {
+		size_t w = c->ptype == PT_FIXED_LEN_BYTE_ARRAY ? (size_t) c->type_length : (size_t) d->pwidth;
+		if (c->ptype == PT_BOOLEAN || c->ptype == PT_BYTE_ARRAY || c->ptype == PT_INT96)
+			break;
+		/* the page holds the streams of all values, n may be less */
+		size_t total = (size_t) (e - p) / w;
+		if (total < n)
+			return CORRUPT;
+		uint8_t *o = PQ_GROW(d, vals, MAX(n, 1) * w);
+		if (o == NULL)
+			return MAL_MALLOC_FAIL;
+		for (size_t k = 0; k < w; k++)
+			for (BUN i = 0; i < n; i++)
+				o[i * w + k] = p[k * total + i];
+		if (c->ptype == PT_FIXED_LEN_BYTE_ARRAY) {
+			pq_bytes *b = PQ_GROW(d, bytes, MAX(n, 1) * sizeof(pq_bytes));
+			if (b == NULL)
+				return MAL_MALLOC_FAIL;
+			for (BUN i = 0; i < n; i++)
+				b[i] = (pq_bytes) {.s = o + i * w, .len = (uint32_t) w};
+		}
+		*vals = o;
+		return NULL;
+	}
+	default:
+		break;
+	}
+	snprintf(d->pf->err, sizeof(d->pf->err), "column %s: encoding %d not supported", c->name, enc);
+	return d->pf->err;
+}
+
+static inline bool
+pq_bytes_domain(const pq_column *c)
+{
+	return c->ptype == PT_BYTE_ARRAY || c->ptype == PT_FIXED_LEN_BYTE_ARRAY;
+}
+
+static inline bool
+pq_var_target(const pq_column *c)
+{
+	return c->conv == PQ_STR || c->conv == PQ_BLOB;
+}
+
+static const char *
+pq_snappy(const uint8_t *p, size_t len, uint8_t *out, size_t olen)
+{
+	const uint8_t *e = p + len;
+	uint64_t ulen;
+	size_t o = 0;
+
+	if ((p = pq_varint(p, e, &ulen)) == NULL || ulen != olen)
+		return CORRUPT;
+	while (p < e) {
+		uint8_t tag = *p++;
+		size_t l, off;
+
+		switch (tag & 3) {
+		case 0:
+			l = tag >> 2;
+			if (l >= 60) {
+				int nb = (int) l - 59;
+				if (e - p < nb)
+					return CORRUPT;
+				l = 0;
+				for (int k = 0; k < nb; k++)
+					l |= (size_t) p[k] << (8 * k);
+				p += nb;
+			}
+			l++;
+			if (l > (size_t) (e - p) || l > olen - o)
+				return CORRUPT;
+			memcpy(out + o, p, l);
+			o += l;
+			p += l;
+			continue;
+		case 1:
+			if (p >= e)
+				return CORRUPT;
+			l = ((tag >> 2) & 7) + 4;
+			off = (size_t) (tag >> 5) << 8 | *p++;
+			break;
+		case 2:
+			if (e - p < 2)
+				return CORRUPT;
+			l = (size_t) (tag >> 2) + 1;
+			off = (size_t) p[0] | (size_t) p[1] << 8;
+			p += 2;
+			break;
+		default:
+			if (e - p < 4)
+				return CORRUPT;
+			l = (size_t) (tag >> 2) + 1;
+			off = ld32(p);
+			p += 4;
+			break;
+		}
+		if (off == 0 || off > o || l > olen - o)
+			return CORRUPT;
+		if (off >= l) {
+			memcpy(out + o, out + o - off, l);
+		} else {
+			for (size_t k = 0; k < l; k++)
+				out[o + k] = out[o + k - off];
+		}
+		o += l;
+	}
+	return o == olen ? NULL : CORRUPT;
+}
+
+static const char *
+pq_lz4(const uint8_t *p, size_t len, uint8_t *out, size_t olen)
+{
+	const uint8_t *e = p + len;
+	size_t o = 0;
+
+	while (p < e) {
+		uint8_t token = *p++;
+		size_t l = token >> 4, off;
+		if (l == 15) {
+			uint8_t b;
+			do {
+				if (p >= e)
+					return CORRUPT;
+				b = *p++;
+				l += b;
+			} while (b == 255);
+		}
+		if (l > (size_t) (e - p) || l > olen - o)
+			return CORRUPT;
+		memcpy(out + o, p, l);
+		o += l;
+		p += l;
+		if (p >= e)	/* the last sequence only has literals */
+			break;
+		if (e - p < 2)
+			return CORRUPT;
+		off = (size_t) p[0] | (size_t) p[1] << 8;
+		p += 2;
+		l = token & 15;
+		if (l == 15) {
+			uint8_t b;
+			do {
+				if (p >= e)
+					return CORRUPT;
+				b = *p++;
+				l += b;
+			} while (b == 255);
+		}
+		l += 4;
+		if (off == 0 || off > o || l > olen - o)
+			return CORRUPT;
+		for (size_t k = 0; k < l; k++)
+			out[o + k] = out[o + k - off];
+		o += l;
+	}
+	return o == olen ? NULL : CORRUPT;
+}
+
+static const char *
+pq_decompress(pq_decoder *d, int codec, const uint8_t *src, size_t slen, size_t dlen, const uint8_t **out)
+{
+	const char *msg;
+
+	if (codec == CODEC_UNCOMPRESSED) {
+		if (slen < dlen)
+			return CORRUPT;
+		*out = src;
+		return NULL;
+	}
+	if (PQ_GROW(d, page, MAX(dlen, 1)) == NULL)
+		return MAL_MALLOC_FAIL;
+	switch (codec) {
+	case CODEC_SNAPPY:
+		msg = pq_snappy(src, slen, d->page, dlen);
+		break;
+	case CODEC_LZ4_RAW:
+		msg = pq_lz4(src, slen, d->page, dlen);
+		break;
+#ifdef HAVE_LIBZ
+	case CODEC_GZIP: {
+		z_stream zs = (z_stream) {0};
+		int rc;
+		if (inflateInit2(&zs, 15 + 32) != Z_OK)
+			return MAL_MALLOC_FAIL;
+		zs.next_in = (Bytef *) src;
+		zs.avail_in = (uInt) slen;
+		zs.next_out = (Bytef *) d->page;
+		zs.avail_out = (uInt) dlen;
+		rc = inflate(&zs, Z_FINISH);
+		msg = rc == Z_STREAM_END && zs.total_out == dlen ? NULL : CORRUPT;
+		inflateEnd(&zs);
+		break;
+	}
+#endif
+	default:
+		snprintf(d->pf->err, sizeof(d->pf->err), "compression codec %s not supported",
+				 codec >= 0 && codec < (int) (sizeof(codec_names) / sizeof(codec_names[0])) ? codec_names[codec] : "unknown");
+		return d->pf->err;
+	}
+	*out = d->page;
+	return msg;
+}
+
+static const char *
+pq_dictionary_page(pq_decoder *d, const pq_page *h, const uint8_t *p, const uint8_t *e)
+{
+	const pq_column *c = d->col;
+	const uint8_t *vals = NULL;
+	BUN n = (BUN) h->num_values;
+	const char *msg;
+
+	if (h->encoding != ENC_PLAIN && h->encoding != ENC_PLAIN_DICTIONARY)
+		return CORRUPT;
+	if ((msg = pq_values(d, ENC_PLAIN, p, e, n, &vals)) != NULL)
+		return msg;
+	size_t w = pq_var_target(c) ? sizeof(var_t) : d->width;
+	if (PQ_GROW(d, dict, MAX(n, 1) * w) == NULL)
+		return MAL_MALLOC_FAIL;
+	if (pq_var_target(c))
+		msg = pq_put_bytes(d, (const pq_bytes *) d->bytes, n, (var_t *) d->dict);
+	else if (pq_bytes_domain(c))
+		msg = pq_convert_bytes(d, (const pq_bytes *) d->bytes, n, d->dict);
+	else
+		pq_convert(d, vals, n, d->dict);
+	d->ndict = msg ? 0 : n;
+	return msg;
+}
+
+/* gather dictionary values (or offsets) for n indices */
+static const char *
+pq_gather(pq_decoder *d, const uint32_t *idx, BUN n, void *dst, size_t w)
+{
+	for (BUN i = 0; i < n; i++)
+		if (idx[i] >= d->ndict)
+			return CORRUPT;
+#define GATHER(TPE)							\
+	do {								\
+		TPE *o = dst;						\
+		const TPE *v = (const TPE *) d->dict;			\
+		for (BUN i = 0; i < n; i++)				\
+			o[i] = v[idx[i]];				\
+	} while (0)
+	switch (w) {
+	case 1:
+		GATHER(bte);
+		break;
+	case 2:
+		GATHER(sht);
+		break;
+	case 4:
+		GATHER(int);
+		break;
+	case 8:
+		GATHER(lng);
+		break;
+	default:
+		for (BUN i = 0; i < n; i++)
+			memcpy((uint8_t *) dst + i * w, d->dict + idx[i] * w, w);
+		break;
+	}
+	return NULL;
+}
+
+/* decode the values of a data page: n rows, of which the ones with
+ * defs[i] == 0 (if defs is set) are null */
+static const char *
+pq_page_values(pq_decoder *d, int enc, const uint8_t *p, const uint8_t *e, BUN n, const uint8_t *defs)
+{
+	const pq_column *c = d->col;
+	BUN nv = n;
+	const char *msg = NULL;
+	const uint8_t *vals = NULL;
+
+	if (defs) {
+		nv = 0;
+		for (BUN i = 0; i < n; i++)
+			nv += defs[i];
+		if (nv == n)
+			defs = NULL;
+		else
+			d->hasnil = true;
+	}
+
+	bool dict = enc == ENC_PLAIN_DICTIONARY || enc == ENC_RLE_DICTIONARY;
+	uint32_t *idx = NULL;
+	if (dict) {
+		if (d->ndict == 0 && nv > 0)
+			return CORRUPT;
+		if ((idx = PQ_GROW(d, idx, MAX(nv, 1) * sizeof(uint32_t))) == NULL)
+			return MAL_MALLOC_FAIL;
+		if (nv > 0) {
+			if (p >= e)
+				return CORRUPT;
+			int bw = *p++;
+			if ((msg = pq_hybrid(p, e, bw, idx, nv)) != NULL)
+				return msg;
+		}
+	} else if ((msg = pq_values(d, enc, p, e, nv, &vals)) != NULL) {
+		return msg;
+	}
+
+	if (pq_var_target(c)) {
+		var_t *offs = PQ_GROW(d, offs, MAX(nv, 1) * sizeof(var_t));
+		if (offs == NULL)
+			return MAL_MALLOC_FAIL;
+		if (dict)
+			msg = pq_gather(d, idx, nv, offs, sizeof(var_t));
+		else
+			msg = pq_put_bytes(d, (const pq_bytes *) d->bytes, nv, offs);
+		if (msg == NULL)
+			msg = pq_put_offsets(d, offs, defs, n);
+	} else {
+		uint8_t *dst = (uint8_t *) Tloc(d->b, d->pos);
+		if (dict)
+			msg = pq_gather(d, idx, nv, dst, d->width);
+		else if (pq_bytes_domain(c))
+			msg = pq_convert_bytes(d, (const pq_bytes *) d->bytes, nv, dst);
+		else
+			pq_convert(d, vals, nv, dst);
+		if (msg == NULL && defs)
+			pq_expand(dst, d->width, defs, n, nv, ATOMnilptr(d->b->ttype));
+	}
+	if (msg == NULL)
+		d->pos += n;
+	return msg;
+}
+
+/* decode the definition levels of an optional column (max level 1) */
+static const char *
+pq_levels(pq_decoder *d, const uint8_t *p, const uint8_t *e, BUN n, const uint8_t **defs)
+{
+	uint32_t *lv = PQ_GROW(d, idx, MAX(n, 1) * sizeof(uint32_t));
+	uint8_t *o = PQ_GROW(d, defs, MAX(n, 1));
+	const char *msg;
+
+	if (lv == NULL || o == NULL)
+		return MAL_MALLOC_FAIL;
+	if ((msg = pq_hybrid(p, e, 1, lv, n)) != NULL)
+		return msg;
+	for (BUN i = 0; i < n; i++)
+		o[i] = lv[i] != 0;
+	*defs = o;
+	return NULL;
+}
+
+static const char *
+pq_data_page(pq_decoder *d, int codec, const pq_page *h, const uint8_t *body, BUN end)
+{
+	const pq_column *c = d->col;
+	const uint8_t *p, *e, *defs = NULL;
+	const char *msg;
+	BUN n = (BUN) h->num_values;
+
+	if (h->type == PAGE_DATA) {
+		if ((msg = pq_decompress(d, codec, body, (size_t) h->csize, (size_t) h->usize, &p)) != NULL)
+			return msg;
+		e = p + h->usize;
+		if (c->repetition == REP_OPTIONAL) {
+			if (h->def_encoding != ENC_RLE)
+				return "deprecated BIT_PACKED definition levels not supported";
+			if (e - p < 4 || ld32(p) > (size_t) (e - p - 4))
+				return CORRUPT;
+			uint32_t len = ld32(p);
+			if ((msg = pq_levels(d, p + 4, p + 4 + len, n, &defs)) != NULL)
+				return msg;
+			p += 4 + len;
+		}
+	} else {
+		size_t lvl = (size_t) h->def_len + (size_t) h->rep_len;
+		if (lvl > (size_t) h->csize || lvl > (size_t) h->usize)
+			return CORRUPT;
+		if (h->rep_len > 0)
+			return "repeated columns are not supported";
+		if (c->repetition == REP_OPTIONAL && h->num_nulls > 0 &&
+			(msg = pq_levels(d, body, body + h->def_len, n, &defs)) != NULL)
+			return msg;
+		if ((msg = pq_decompress(d, h->is_compressed ? codec : CODEC_UNCOMPRESSED,
+								 body + lvl, (size_t) h->csize - lvl,
+								 (size_t) h->usize - lvl, &p)) != NULL)
+			return msg;
+		e = p + (h->usize - lvl);
+	}
+	/* rows beyond the end (topn) are not needed */
+	if (n > end - d->pos)
+		n = end - d->pos;
+	return pq_page_values(d, h->encoding, p, e, n, defs);
+}
+
+static const char *
+pq_read_chunk(pq_decoder *d, const pq_chunk *ch, BUN nrows)
+{
+	pq_file *pf = d->pf;
+	BUN end = d->pos + nrows;
+	const char *msg = NULL;
+
+	if (ch->external)
+		return "column chunks in other files are not supported";
+	if (ch->offset < 4 || ch->size < 0 || (size_t) ch->offset > pf->size ||
+		(size_t) ch->size > pf->size - (size_t) ch->offset)
+		return CORRUPT;
+
+	const uint8_t *p = pf->base + ch->offset, *e = p + ch->size;
+	d->ndict = 0;
+	while (d->pos < end && msg == NULL) {
+		pq_page h;
+		tc t = (tc) {.p = p, .e = e};
+
+		tc_page_header(&t, &h);
+		if (t.err || h.csize > e - t.p)
+			return CORRUPT;
+		p = t.p + h.csize;
+		switch (h.type) {
+		case PAGE_DICTIONARY: {
+			const uint8_t *v;
+			if ((msg = pq_decompress(d, ch->codec, t.p, (size_t) h.csize, (size_t) h.usize, &v)) == NULL)
+				msg = pq_dictionary_page(d, &h, v, v + h.usize);
+			break;
+		}
+		case PAGE_DATA:
+		case PAGE_DATA_V2:
+			msg = pq_data_page(d, ch->codec, &h, t.p, end);
+			break;
+		default:	/* skip index pages */
+			break;
+		}
+	}
+	return msg;
+}
+
+/* decode a statistics value, into v which is large enough for any
+ * fixed size type, strings are returned as a GDKmalloced copy */
+static bool
+pq_stat_value(pq_decoder *d, const uint8_t *s, uint32_t len, void *v, char **str)
+{
+	const pq_column *c = d->col;
+
+	if (pq_var_target(c)) {
+		if (c->conv != PQ_STR || (*str = GDKstrndup((const char *) s, len)) == NULL)
+			return false;
+		return true;
+	}
+	if (pq_bytes_domain(c)) {
+		pq_bytes b = {.s = s, .len = len};
+		return pq_convert_bytes(d, &b, 1, v) == NULL;
+	}
+	if ((int) len != d->pwidth)
+		return false;
+	pq_convert(d, s, 1, v);
+	return true;
+}
+
+static int
+pq_pwidth(const pq_column *c)
+{
+	switch (c->ptype) {
+	case PT_BOOLEAN:
+		return 1;
+	case PT_INT32:
+	case PT_FLOAT:
+		return 4;
+	case PT_INT64:
+	case PT_DOUBLE:
+		return 8;
+	case PT_INT96:
+		return 12;
+	default:
+		return c->type_length;
+	}
+}
+
+bool
+pq_rowgroup_skip(pq_file *pf, int rg, const pq_filter *filters, int nfilters)
+{
+	const pq_rowgroup *g = &pf->rowgroups[rg];
+
+	for (int i = 0; i < nfilters; i++) {
+		const pq_filter *f = &filters[i];
+		if (f->col < 0 || f->col >= pf->ncols)
+			continue;
+		const pq_column *c = &pf->cols[f->col];
+		const pq_stats *s = &g->chunks[f->col].stats;
+
+		/* comparisons with nulls never hold */
+		if (s->has_null_count && g->num_rows > 0 && s->null_count >= g->num_rows)
+			return true;
+		/* skip types without a usable sort order */
+		if (c->conv == PQ_INT96 || c->conv == PQ_UUID || c->conv == PQ_BLOB || c->conv == PQ_FLOAT16)
+			continue;
+
+		pq_decoder d = {.pf = pf, .col = c, .pwidth = pq_pwidth(c), .width = ATOMsize(c->mtype)};
+		const void *nil = ATOMnilptr(c->mtype);
+		union {
+#ifdef HAVE_HGE
+			hge h;
+#endif
+			lng l;
+			dbl d;
+		} minv, maxv;
+		char *mins = NULL, *maxs = NULL;
+		const void *min = NULL, *max = NULL;
+		bool skip = false;
+
+		if (s->has_min && pq_stat_value(&d, s->min, s->minlen, &minv, &mins))
+			min = mins ? (const void *) mins : (const void *) &minv;
+		if (s->has_max && pq_stat_value(&d, s->max, s->maxlen, &maxv, &maxs))
+			max = maxs ? (const void *) maxs : (const void *) &maxv;
+		if (min && ATOMcmp(c->mtype, min, nil) == 0)
+			min = NULL;
+		if (max && ATOMcmp(c->mtype, max, nil) == 0)
+			max = NULL;
+		if (f->lo && max) {
+			int r = ATOMcmp(c->mtype, max, f->lo);
+			skip |= r < 0 || (r == 0 && !f->lo_incl);
+		}
+		if (f->hi && min) {
+			int r = ATOMcmp(c->mtype, min, f->hi);
+			skip |= r > 0 || (r == 0 && !f->hi_incl);
+		}
+		GDKfree(mins);
+		GDKfree(maxs);
+		if (skip)
+			return true;
+	}
+	return false;
+}
+
+const char *
+pq_read(pq_file *pf, int col, const pq_filter *filters, int nfilters, lng topn, BAT **ret)
+{
+	if (col < 0 || col >= pf->ncols)
+		return "column number out of range";
+
+	const pq_column *c = &pf->cols[col];
+	BUN total = 0, left = topn < 0 || (ulng) topn > (ulng) BUN_MAX ? BUN_MAX : (BUN) topn;
+	for (int i = 0; i < pf->nrowgroups && total < left; i++) {
+		if (!pq_rowgroup_skip(pf, i, filters, nfilters))
+			total += (BUN) MIN((ulng) pf->rowgroups[i].num_rows, (ulng) (left - total));
+	}
+
+	BAT *b = COLnew(0, c->mtype, total, TRANSIENT);
+	if (b == NULL)
+		return GDK_EXCEPTION;
+
+	pq_decoder d = {
+		.pf = pf,
+		.col = c,
+		.pwidth = pq_pwidth(c),
+		.b = b,
+		.width = ATOMsize(c->mtype),
+	};
+	const char *msg = NULL;
+	for (int i = 0; i < pf->nrowgroups && d.pos < total && msg == NULL; i++) {
+		if (pq_rowgroup_skip(pf, i, filters, nfilters))
+			continue;
+		BUN n = (BUN) MIN((ulng) pf->rowgroups[i].num_rows, (ulng) (total - d.pos));
+		msg = pq_read_chunk(&d, &pf->rowgroups[i].chunks[col], n);
+	}
+	GDKfree(d.dict);
+	GDKfree(d.page);
+	GDKfree(d.vals);
+	GDKfree(d.idx);
+	GDKfree(d.defs);
+	GDKfree(d.bytes);
+	GDKfree(d.buf);
+	GDKfree(d.prefixed);
+	GDKfree(d.offs);
+	if (msg) {
+		BBPreclaim(b);
+		return msg;
+	}
+	if (d.pos != total) {
+		BBPreclaim(b);
+		return CORRUPT;
+	}
+
+	BATsetcount(b, total);
+	b->tnil = d.hasnil;
+	/* all conversions but these may produce nils of their own */
+	b->tnonil = !d.hasnil && (c->conv == PQ_BOOL || c->conv == PQ_STR || c->conv == PQ_BLOB);
+	b->tsorted = b->trevsorted = false;
+	b->tkey = false;
+	BATsettrivprop(b);
+	*ret = b;
+	return NULL;
+}
@@ -0,0 +1,111 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * For copyright information, see the file debian/copyright.
+ */
+
+#ifndef _PARQUET_READER_H_
+#define _PARQUET_READER_H_
+
+#include "gdk.h"
+#include "gdk_time.h"
+
+/* A self contained reader for flat Apache Parquet files.  The file is
+ * memory mapped, the footer (thrift compact protocol) is decoded into
+ * the structures below and columns are decoded one column chunk at a
+ * time straight into BATs. */
+
+typedef enum pq_conv {
+	PQ_BOOL,		/* BOOLEAN */
+	PQ_INT,			/* INT32/INT64 (also decimals) to an integer of any width */
+	PQ_DATE,		/* INT32 days since the epoch */
+	PQ_TIME_MS,		/* INT32 milli seconds since midnight */
+	PQ_TIME_US,		/* INT64 micro seconds since midnight */
+	PQ_TIME_NS,		/* INT64 nano seconds since midnight */
+	PQ_TS_MS,		/* INT64 milli seconds since the epoch */
+	PQ_TS_US,		/* INT64 micro seconds since the epoch */
+	PQ_TS_NS,		/* INT64 nano seconds since the epoch */
+	PQ_INT96,		/* legacy nano seconds of the julian day timestamps */
+	PQ_FLT,
+	PQ_DBL,
+	PQ_FLOAT16,		/* FIXED_LEN_BYTE_ARRAY(2) half precision floats */
+	PQ_DECIMAL,		/* big endian two's complement byte arrays */
+	PQ_UUID,
+	PQ_STR,
+	PQ_BLOB,
+} pq_conv;
+
+typedef struct pq_column {
+	char *name;
+	int ptype;			/* physical type */
+	int type_length;		/* for FIXED_LEN_BYTE_ARRAY */
+	int repetition;
+	int num_children;
+	int ctype;			/* converted type, -1 if absent */
+	int scale, precision;
+	int ltype;			/* logical type (union field id), 0 if absent */
+	int unit;			/* TIME/TIMESTAMP unit: 1 millis, 2 micros, 3 nanos */
+	bool utc;			/* TIME/TIMESTAMP isAdjustedToUTC */
+	int bitwidth;			/* INTEGER logical type */
+	bool is_signed;
+	/* the MonetDB side of the column */
+	pq_conv conv;
+	int mtype;
+	const char *sqlname;
+	unsigned int digits, dscale;
+} pq_column;
+
+typedef struct pq_stats {
+	const uint8_t *min, *max;	/* pointers into the mapped file */
+	uint32_t minlen, maxlen;
+	bool has_min, has_max;		/* min_value/max_value, or the deprecated min/max if usable */
+	bool has_null_count;
+	lng null_count;
+} pq_stats;
+
+typedef struct pq_chunk {
+	int codec;
+	bool external;			/* column chunk lives in another file */
+	lng num_values;
+	lng offset, size;		/* all pages of the column chunk */
+	pq_stats stats;
+} pq_chunk;
+
+typedef struct pq_rowgroup {
+	lng num_rows;
+	int nchunks;
+	pq_chunk *chunks;
+} pq_rowgroup;
+
+typedef struct pq_file {
+	char *filename;
+	uint8_t *base;			/* the memory mapped file */
+	size_t size;
+	lng num_rows;
+	int ncols;
+	pq_column *cols;		/* the leaf columns */
+	int nschema;
+	pq_column *schema;		/* all schema elements, cols points into this */
+	int nrowgroups;
+	pq_rowgroup *rowgroups;
+	char err[256];
+} pq_file;
+
+/* a simple predicate on a column, bounds are values of the column's
+ * MonetDB type, a NULL bound is open */
+typedef struct pq_filter {
+	int col;
+	const void *lo, *hi;
+	bool lo_incl, hi_incl;
+} pq_filter;
+
+extern pq_file *pq_open(const char *filename, char *errbuf, size_t errlen);
+extern void pq_close(pq_file *pf);
+extern bool pq_rowgroup_skip(pq_file *pf, int rg, const pq_filter *filters, int nfilters);
+extern const char *pq_read(pq_file *pf, int col, const pq_filter *filters, int nfilters, lng topn, BAT **ret);
+
+#endif /*_PARQUET_READER_H_*/
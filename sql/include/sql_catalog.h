@@ -311,6 +311,8 @@ typedef struct sql_schema {
 
 typedef struct sql_catalog {
 	ATOMIC_TYPE schema_version;
+	ATOMIC_TYPE cache_version;	/* raised by the commit of DDL while plans or results are cached */
+	ATOMIC_TYPE caches;		/* number of plan and result caches in use */
 
 	struct objectset *schemas;
 	struct objectset *objects;
@@ -636,6 +638,20 @@ typedef struct sql_sequence {
 	MT_Lock lock;		/* lock protecting concurrent writes to the changes list */
 } sql_sequence;
 
+/* value distribution of a column, as collected by analyze */
+typedef struct sql_histogram {
+	int nr_buckets;		/* equi-depth buckets, in ascending order */
+	ValRecord *lower;	/* smallest value in the bucket */
+	ValRecord *upper;	/* largest value in the bucket */
+	lng *rows;		/* estimated number of rows in the bucket */
+	lng *distinct;		/* estimated number of distinct values in the bucket */
+	int nr_mcvs;		/* most common values, not in the buckets */
+	ValRecord *mcvs;
+	lng *mcv_rows;
+	lng nils;		/* estimated number of nils */
+	lng total;		/* nils, mcv rows and bucket rows together */
+} sql_histogram;
+
 typedef struct sql_column {
 	sql_base base;
 	sql_subtype type;
@@ -648,6 +664,8 @@ typedef struct sql_column {
 	size_t dcount;
 	void *min;
 	void *max;
+	sql_histogram *hist;	/* cached from sys.statistics_histograms */
+	ulng hist_ts;		/* commit time of the statistics it was read from */
 
 	struct sql_table *t;
 	MT_Lock lock;		/* lock protecting concurrent writes to the changes list */
@@ -782,6 +800,7 @@ typedef struct sql_session {
 	char *schema_name; /* transaction's schema name */
 	sql_schema *schema;
 	ATOMIC_TYPE schema_version;
+	ATOMIC_TYPE cache_version;
 
 	char ac_on_commit;	/* if 1, auto_commit should be enabled on
 	                           commit, rollback, etc. */
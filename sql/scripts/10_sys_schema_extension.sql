@@ -22,6 +22,7 @@ INSERT INTO sys.keywords (keyword) VALUES
   ('ANALYZE'),
   ('AND'),
   ('ANY'),
+  ('ARROW'),
   ('ASC'),
   ('ASYMMETRIC'),
   ('AT'),
@@ -194,6 +195,7 @@ INSERT INTO sys.keywords (keyword) VALUES
   ('OTHERS'),
   ('OUTER'),
   ('OVER'),
+  ('PARQUET'),
   ('PARTIAL'),
   ('PARTITION'),
   ('PASSWORD'),
@@ -146,6 +146,92 @@ grant execute on function sys.prepared_statements_args to public;
 create view sys.prepared_statements_args as select * from sys.prepared_statements_args();
 grant select on sys.prepared_statements_args to public;
 
+-- the plans shared by all sessions (see the plan_cache_size option)
+create function sys.plan_cache()
+returns table(
+	"user_id" int,
+	"role_id" int,
+	"schema_id" int,
+	"query" string,		-- normalised query text
+	"optimizer" string,
+	"hits" bigint,
+	"compile_time" bigint,	-- in usec
+	"created" timestamp,
+	"last_used" timestamp
+)
+external name sql.plan_cache;
+
+create view sys.plan_cache as
+select u.name as "username", r.name as "role", s.name as "schema", p."query", p."optimizer", p."hits", p."compile_time", p."created", p."last_used"
+from sys.plan_cache() p
+left outer join sys.auths u on p."user_id" = u.id
+left outer join sys.auths r on p."role_id" = r.id
+left outer join sys.schemas s on p."schema_id" = s.id;
+
+create function sys.plan_cache_stats()
+returns table(
+	"size" int,
+	"entries" int,
+	"lookups" bigint,
+	"hits" bigint,
+	"misses" bigint,
+	"inserts" bigint,
+	"evictions" bigint,
+	"invalidations" bigint
+)
+external name sql.plan_cache_stats;
+
+create view sys.plan_cache_stats as
+select *, case when "lookups" > 0 then cast("hits" as double) / "lookups" else null end as "hit_rate"
+from sys.plan_cache_stats();
+
+create procedure sys.plan_cache_size("size" int)
+external name sql.plan_cache_size;
+
+-- the result sets shared by all sessions (see the result_cache_size option)
+create function sys.result_cache()
+returns table(
+	"user_id" int,
+	"role_id" int,
+	"schema_id" int,
+	"query" string,		-- normalised query text
+	"rows" bigint,
+	"columns" int,
+	"memory" bigint,	-- in bytes
+	"hits" bigint,
+	"created" timestamp,
+	"last_used" timestamp
+)
+external name sql.result_cache;
+
+create view sys.result_cache as
+select u.name as "username", r.name as "role", s.name as "schema", c."query", c."rows", c."columns", c."memory", c."hits", c."created", c."last_used"
+from sys.result_cache() c
+left outer join sys.auths u on c."user_id" = u.id
+left outer join sys.auths r on c."role_id" = r.id
+left outer join sys.schemas s on c."schema_id" = s.id;
+
+create function sys.result_cache_stats()
+returns table(
+	"size" int,		-- in MiB
+	"entries" int,
+	"memory" bigint,	-- in bytes
+	"lookups" bigint,
+	"hits" bigint,
+	"misses" bigint,
+	"inserts" bigint,
+	"evictions" bigint,
+	"invalidations" bigint
+)
+external name sql.result_cache_stats;
+
+create view sys.result_cache_stats as
+select *, case when "lookups" > 0 then cast("hits" as double) / "lookups" else null end as "hit_rate"
+from sys.result_cache_stats();
+
+create procedure sys.result_cache_size("size" int)
+external name sql.result_cache_size;
+
 create function sys.current_sessionid() returns int
 external name clients.current_sessionid;
 grant execute on function sys.current_sessionid to public;
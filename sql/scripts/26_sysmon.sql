@@ -58,6 +58,33 @@ external name sysmon.resume;
 create procedure sys.stop(tag bigint, username string)
 external name sysmon.stop;
 
+-- memory budgets of the queries that are running or waiting for their
+-- budget (see sys.setmemorylimit and the max_memory of users)
+create function sys.memory_claims()
+returns table(
+	"sessionid" int,
+	"username" string,
+	"tag" bigint,
+	"status" string,	-- waiting, running
+	"queued" timestamp,	-- when the query asked for its budget
+	"budget" int,		-- memory budget of the query in MB
+	"claimed" int,		-- memory claimed by its running instructions in MB
+	"allocated" int		-- memory allocated for its intermediates in MB
+)
+external name sysmon.memory_claims;
+grant execute on function sys.memory_claims() to public;
+create view sys.memory_claims as select * from sys.memory_claims();
+grant select on sys.memory_claims to public;
+-- the memory budget for all queries together and the part reserved
+create function sys.memory_budget()
+returns table(
+	"budget" bigint,	-- in MB, see the query_memory_budget option
+	"reserved" bigint,	-- in MB, by the running queries
+	"spills" bigint		-- partitions spilled to disk since the server started
+)
+external name sysmon.memory_budget;
+grant execute on function sys.memory_budget() to public;
+
 -- we collect some aggregated user information
 create function sys.user_statistics()
 returns table(
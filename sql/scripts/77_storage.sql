@@ -14,3 +14,32 @@ RETURNS TABLE(
 )
 EXTERNAL NAME sql.persist_unlogged;
 GRANT EXECUTE ON FUNCTION sys.persist_unlogged(string, string) TO PUBLIC;
+
+-- compression advisor
+CREATE PROCEDURE sys.compression_advisor(apply BOOLEAN)
+EXTERNAL NAME sql.compression_advisor;
+CREATE PROCEDURE sys.auto_compression("interval" INT)
+EXTERNAL NAME sql.auto_compression;
+CREATE PROCEDURE sys.stop_auto_compression()
+EXTERNAL NAME sql.stop_auto_compression;
+
+CREATE FUNCTION sys.compression_advice()
+RETURNS TABLE(
+	"column_id" INT,
+	"rowcount" BIGINT,
+	"uniques" BIGINT,
+	"size" BIGINT,
+	"compressed_size" BIGINT,
+	"advice" STRING,
+	"applied" BOOLEAN,
+	"reason" STRING,
+	"advised" TIMESTAMP
+)
+EXTERNAL NAME sql.compression_advice;
+CREATE VIEW sys.compression_advice AS
+SELECT s.name AS "schema", t.name AS "table", c.name AS "column", c.type, c.storage,
+	a.rowcount, a.uniques, a.size, a.compressed_size, a.advice, a.applied, a.reason, a.advised
+	FROM sys.compression_advice() a
+	JOIN sys._columns c ON a.column_id = c.id
+	JOIN sys._tables t ON c.table_id = t.id
+	JOIN sys.schemas s ON t.schema_id = s.id;
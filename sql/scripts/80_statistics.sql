@@ -26,6 +26,21 @@ create procedure sys."analyze"("sname" varchar(1024), "tname" varchar(1024), "cn
 external name sql."analyze";
 grant execute on procedure sys."analyze"(varchar(1024),varchar(1024),varchar(1024)) to public;
 
+-- The value distributions collected by analyze and used by the optimizer:
+-- equi-depth histograms and the most common values (a NULL value counts
+-- the nils) per column, and the number of distinct combinations of values
+-- of groups of columns, identified by their sorted, comma separated ids.
+create table sys.statistics_histograms("column_id" int, "bucket" int, "lower" string, "upper" string, "rows" bigint, "distinct" bigint);
+grant select on sys.statistics_histograms to public;
+create table sys.statistics_mcvs("column_id" int, "value" string, "rows" bigint);
+grant select on sys.statistics_mcvs to public;
+create table sys.statistics_groups("table_id" int, "columns" string, "distinct" bigint);
+grant select on sys.statistics_groups to public;
+
+create procedure sys.analyze_group("sname" varchar(1024), "tname" varchar(1024), "columns" string)
+external name sql.analyze_group;
+grant execute on procedure sys.analyze_group(varchar(1024),varchar(1024),string) to public;
+
 create function sys."statistics"()
 returns table (
 	"column_id" integer,
@@ -34,7 +34,7 @@ fl_unregister(char *name)
 }
 
 int
-fl_register(char *name, fl_add_types_fptr add_types, fl_load_fptr load)
+fl_register(char *name, fl_add_types_fptr add_types, fl_load_fptr load, fl_filter_fptr filter)
 {
 	file_loader_t *fl = fl_find(name);
 	if (fl) {
@@ -48,6 +48,7 @@ fl_register(char *name, fl_add_types_fptr add_types, fl_load_fptr load)
 			file_loaders[i].name = GDKstrdup(name);
 			file_loaders[i].add_types = add_types;
 			file_loaders[i].load = load;
+			file_loaders[i].filter = filter;
 			return 0;
 		}
 	}
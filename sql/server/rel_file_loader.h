@@ -16,14 +16,16 @@
 
 typedef str (*fl_add_types_fptr)(mvc *sql, sql_subfunc *f, char *filename, list *res_exps, char *name, lng *est);
 typedef void *(*fl_load_fptr)(void *be, sql_subfunc *f, char *filename, sql_exp *topn); /* use void * as both return type and be argument are unknown types at this layer */
+typedef void (*fl_filter_fptr)(mvc *sql, sql_subfunc *f, list *cols, list *exps); /* optional, offers the predicates of a select on top of the loader */
 
 typedef struct file_loader_t {
 	char *name;
 	fl_add_types_fptr add_types;
 	fl_load_fptr load;
+	fl_filter_fptr filter;
 } file_loader_t;
 
-sql_export int fl_register(char *name, fl_add_types_fptr add_types, fl_load_fptr fl_load);
+sql_export int fl_register(char *name, fl_add_types_fptr add_types, fl_load_fptr fl_load, fl_filter_fptr fl_filter);
 sql_export void fl_unregister(char *name);
 extern file_loader_t* fl_find(char *name);
 
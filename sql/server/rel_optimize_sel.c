@@ -13,6 +13,7 @@
 #include "rel_exp.h"
 #include "rel_select.h"
 #include "rel_rewriter.h"
+#include "rel_statistics.h"
 
 /* Split_select optimizer splits case statements in select expressions. This is a step needed for cse */
 static void select_split_exps(mvc *sql, list *exps, sql_rel *rel);
@@ -2047,10 +2048,17 @@ order_join_expressions(mvc *sql, list *dje, list *rels)
 			sql_rel *l = find_rel(rels, e->l);
 			sql_rel *r = find_rel(rels, e->r);
 
+			dbl sel;
+
 			if (l && is_select(l->op) && l->exps)
 				keys[i] += list_length(l->exps)*10 + exps_count(l->exps);
 			if (r && is_select(r->op) && r->exps)
 				keys[i] += list_length(r->exps)*10 + exps_count(r->exps);
+			/* and more for selections known to be selective from the histograms */
+			if (l && is_select(l->op) && l->exps && (sel = rel_select_selectivity(sql, l)) >= 0)
+				keys[i] += (int) (-5 * log2(MAX(sel, 1e-6)));
+			if (r && is_select(r->op) && r->exps && (sel = rel_select_selectivity(sql, r)) >= 0)
+				keys[i] += (int) (-5 * log2(MAX(sel, 1e-6)));
 		}
 		data[i] = n->data;
 	}
@@ -2862,17 +2870,319 @@ bind_join_order(visitor *v, global_props *gp)
 		gp->cnt[op_right] || gp->cnt[op_full]) && (flag & join_order) ? rel_join_order : NULL;
 }
 
+/* Once the statistics are gathered the trees of inner joins of up to
+ * JOIN_ENUM_MAX relations are enumerated for the cheapest (bushy) join
+ * order without cross products, by dynamic programming over the connected
+ * subsets of the join graph.  The cost of a tree is the sum of the
+ * estimated cardinalities of its joins.  The cardinalities of the
+ * relations are those of the statistics, the selectivity of an equi-join
+ * is one over the largest number of distinct values of its sides.  The
+ * tree of the heuristic join order is kept, unless a cheaper one is found,
+ * also for larger join graphs or join expressions over more than two
+ * relations. */
+#define JOIN_ENUM_MAX 12
+
+typedef struct join_graph {
+	int nr_rels, nr_exps;
+	sql_rel *rels[JOIN_ENUM_MAX];
+	list *exps;
+	sql_exp **exps_a;
+	uint16_t *exp_mask;	/* the relations of each join expression */
+	uint16_t adj[JOIN_ENUM_MAX];	/* the relations joined with each relation */
+	dbl *card;		/* estimated cardinality of each subset */
+	dbl *cost;
+	uint16_t *split;	/* left part of the best join tree of each subset */
+} join_graph;
+
+static inline bool
+is_join_region(sql_rel *rel, bool top)
+{
+	return is_innerjoin(rel->op) && !is_single(rel) && (top || !rel_is_ref(rel)) && list_empty(rel->attr) && !is_dependent(rel) && rel->flag == 0;
+}
+
+/* the joins of a region are not enumerated again, also not as part of a
+ * smaller region */
+static void
+join_region_done(sql_rel *rel, bool top)
+{
+	if (is_join_region(rel, top)) {
+		rel->used |= join_enumerated;
+		join_region_done(rel->l, false);
+		join_region_done(rel->r, false);
+	}
+}
+
+static bool
+join_graph_region(join_graph *g, sql_rel *rel, bool top)
+{
+	if (is_join_region(rel, top)) {
+		if (!join_graph_region(g, rel->l, false) || !join_graph_region(g, rel->r, false))
+			return false;
+		if (!list_empty(rel->exps))
+			for (node *n = rel->exps->h; n; n = n->next)
+				list_append(g->exps, n->data);
+		return true;
+	}
+	if (g->nr_rels == JOIN_ENUM_MAX || get_rel_count(rel) == BUN_NONE)
+		return false;
+	g->rels[g->nr_rels++] = rel;
+	return true;
+}
+
+/* the relations of the columns of e, or 0 when not found in exactly one */
+static uint16_t
+join_graph_exp_rel(join_graph *g, sql_exp *e)
+{
+	uint16_t mask = 0;
+
+	for (int i = 0; i < g->nr_rels; i++) {
+		if (rel_has_exp(g->rels[i], e, false) == 0) {
+			if (mask)
+				return 0;
+			mask = 1 << i;
+		}
+	}
+	return mask;
+}
+
+static dbl
+join_exp_selectivity(join_graph *g, sql_exp *e)
+{
+	sql_exp *l = e->l, *r = e->r;
+
+	if (e->flag == cmp_equal && !e->f) {
+		uint16_t lm = join_graph_exp_rel(g, l), rm = join_graph_exp_rel(g, r);
+		dbl lu = g->card[lm], ru = g->card[rm];
+		prop *p;
+
+		if ((p = find_prop(l->p, PROP_NUNIQUES)) && p->value.dval >= 1)
+			lu = MIN(lu, p->value.dval);
+		if ((p = find_prop(r->p, PROP_NUNIQUES)) && p->value.dval >= 1)
+			ru = MIN(ru, p->value.dval);
+		return 1.0 / MAX(MAX(lu, ru), 1);
+	}
+	return e->flag == cmp_notequal ? 1.0 : 1.0 / 3;
+}
+
+static bool
+join_graph_init(join_graph *g, allocator *ta)
+{
+	int n = g->nr_rels, nsets = 1 << n, i = 0;
+
+	g->nr_exps = list_length(g->exps);
+	g->exps_a = SA_NEW_ARRAY(ta, sql_exp*, g->nr_exps);
+	g->exp_mask = SA_NEW_ARRAY(ta, uint16_t, g->nr_exps);
+	g->card = SA_NEW_ARRAY(ta, dbl, nsets);
+	g->cost = SA_NEW_ARRAY(ta, dbl, nsets);
+	g->split = SA_ZNEW_ARRAY(ta, uint16_t, nsets);
+	if (!g->exps_a || !g->exp_mask || !g->card || !g->cost || !g->split)
+		return false;
+	for (node *m = g->exps->h; m; m = m->next, i++) {
+		sql_exp *e = m->data;
+		uint16_t mask = 0, lm, rm, fm = 0;
+
+		/* only comparisons between the columns of two relations */
+		if (e->type != e_cmp || is_complex_exp(e->flag) ||
+			!(lm = join_graph_exp_rel(g, e->l)) || !(rm = join_graph_exp_rel(g, e->r)) ||
+			(e->f && !(fm = join_graph_exp_rel(g, e->f))))
+			return false;
+		mask = lm | rm | fm;
+		if (popcount64(mask) != 2)
+			return false;
+		g->exps_a[i] = e;
+		g->exp_mask[i] = mask;
+	}
+	memset(g->adj, 0, sizeof(g->adj));
+	for (i = 0; i < g->nr_exps; i++)
+		for (int j = 0; j < n; j++)
+			if (g->exp_mask[i] & (1 << j))
+				g->adj[j] |= g->exp_mask[i] & ~(1 << j);
+	for (i = 0; i < n; i++)
+		g->card[1 << i] = (dbl) get_rel_count(g->rels[i]);
+	/* the cardinality of a subset, the product of the cardinalities of
+	 * its relations and the selectivities of its join expressions */
+	for (int s = 1; s < nsets; s++) {
+		if (popcount64(s) == 1)
+			continue;
+		int low = s & -s;
+		g->card[s] = g->card[low] * g->card[s ^ low];
+	}
+	for (i = 0; i < g->nr_exps; i++) {
+		dbl sel = join_exp_selectivity(g, g->exps_a[i]);
+
+		for (int s = 1; s < nsets; s++)
+			if ((s & g->exp_mask[i]) == g->exp_mask[i])
+				g->card[s] *= sel;
+	}
+	return true;
+}
+
+static bool
+join_graph_connected(join_graph *g, uint16_t s)
+{
+	uint16_t seen = s & -s, next = seen;
+
+	while (next) {
+		uint16_t reach = 0;
+
+		for (int i = 0; i < g->nr_rels; i++)
+			if (next & (1 << i))
+				reach |= g->adj[i];
+		next = reach & s & ~seen;
+		seen |= next;
+	}
+	return seen == s;
+}
+
+static uint16_t
+join_graph_neighbours(join_graph *g, uint16_t s)
+{
+	uint16_t res = 0;
+
+	for (int i = 0; i < g->nr_rels; i++)
+		if (s & (1 << i))
+			res |= g->adj[i];
+	return res & ~s;
+}
+
+/* the cheapest join tree of each connected subset, from its connected
+ * parts joined by at least one expression */
+static bool
+join_graph_enumerate(join_graph *g, allocator *ta)
+{
+	int nsets = 1 << g->nr_rels;
+	bool *connected = SA_NEW_ARRAY(ta, bool, nsets);
+
+	if (!connected)
+		return false;
+	for (int s = 1; s < nsets; s++) {
+		connected[s] = join_graph_connected(g, (uint16_t) s);
+		g->cost[s] = popcount64(s) == 1 ? 0 : -1;
+	}
+	for (int s = 1; s < nsets; s++) {
+		if (popcount64(s) == 1 || !connected[s])
+			continue;
+		int low = s & -s;
+		/* the parts with the lowest relation are the left ones, the
+		 * trees are mirrored by the construction */
+		for (int s1 = (s - 1) & s; s1; s1 = (s1 - 1) & s) {
+			int s2 = s ^ s1;
+
+			if (!(s1 & low) || !connected[s1] || !connected[s2] || !(join_graph_neighbours(g, (uint16_t) s1) & s2))
+				continue;
+			dbl cost = g->cost[s1] + g->cost[s2] + g->card[s];
+			if (g->cost[s] < 0 || cost < g->cost[s]) {
+				g->cost[s] = cost;
+				g->split[s] = (uint16_t) s1;
+			}
+		}
+	}
+	return g->cost[nsets - 1] >= 0;
+}
+
+/* the cost of the current join tree */
+static dbl
+join_graph_tree_cost(join_graph *g, sql_rel *rel, uint16_t *mask)
+{
+	for (int i = 0; i < g->nr_rels; i++) {
+		if (g->rels[i] == rel) {
+			*mask = 1 << i;
+			return 0;
+		}
+	}
+	uint16_t lm = 0, rm = 0;
+	dbl cost = join_graph_tree_cost(g, rel->l, &lm) + join_graph_tree_cost(g, rel->r, &rm);
+	*mask = lm | rm;
+	return cost + g->card[*mask];
+}
+
+static void
+join_graph_release(mvc *sql, join_graph *g, sql_rel *rel)
+{
+	for (int i = 0; i < g->nr_rels; i++)
+		if (g->rels[i] == rel)
+			return;
+	join_graph_release(sql, g, rel->l);
+	join_graph_release(sql, g, rel->r);
+	rel->l = rel->r = NULL;
+	rel->exps = NULL;
+	rel_destroy(sql, rel);
+}
+
+static sql_rel *
+join_graph_build(mvc *sql, join_graph *g, uint16_t s)
+{
+	if (popcount64(s) == 1) {
+		int i = 0;
+
+		while (!(s & (1 << i)))
+			i++;
+		return g->rels[i];
+	}
+
+	uint16_t s1 = g->split[s], s2 = s ^ s1;
+	sql_rel *l = join_graph_build(sql, g, s1), *r = join_graph_build(sql, g, s2);
+
+	/* the larger input on the left */
+	if (g->card[s1] < g->card[s2]) {
+		sql_rel *t = l;
+		l = r;
+		r = t;
+	}
+	sql_rel *j = rel_crossproduct(sql->sa, l, r, op_join);
+	for (int i = 0; i < g->nr_exps; i++) {
+		uint16_t m = g->exp_mask[i];
+
+		if ((m & s) == m && (m & s1) != m && (m & s2) != m)
+			rel_join_add_exp(sql->sa, j, g->exps_a[i]);
+	}
+	set_count_prop(sql->sa, j, g->card[s] >= (dbl) BUN_MAX ? BUN_MAX - 1 : (BUN) g->card[s]);
+	j->used |= join_enumerated;
+	return j;
+}
+
+static sql_rel *
+rel_join_enumerate_(visitor *v, sql_rel *rel)
+{
+	if (!is_innerjoin(rel->op) || is_join_enumerated(rel->used))
+		return rel;
+
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state = ma_open(ta);
+	join_graph g = { .exps = sa_list(ta) };
+	sql_rel *res = rel;
+	uint16_t mask;
+
+	if (!rel_is_ref(rel) && join_graph_region(&g, rel, true) && g.nr_rels > 2 &&
+		join_graph_init(&g, ta) && join_graph_enumerate(&g, ta)) {
+		uint16_t all = (uint16_t) ((1 << g.nr_rels) - 1);
+		dbl cost = join_graph_tree_cost(&g, rel, &mask);
+
+		if (g.cost[all] < cost * 0.99) {
+			join_graph_release(v->sql, &g, rel);
+			res = join_graph_build(v->sql, &g, all);
+			v->changes++;
+		}
+	}
+	ma_close(&ta_state);
+	join_region_done(res, true);
+	return res;
+}
+
+static sql_rel *
+rel_join_enumerate(visitor *v, global_props *gp, sql_rel *rel)
+{
+	(void) gp;
+	return rel_visitor_topdown(v, rel, &rel_join_enumerate_);
+}
+
 /* this join order is to be done once after statistics are gathered */
 run_optimizer
 bind_join_order2(visitor *v, global_props *gp)
 {
-	/*int flag = v->sql->sql_optimizer;
-	return gp->opt_level == 1 && !gp->has_special_modify && !gp->cnt[op_update] && (gp->cnt[op_join] || gp->cnt[op_left] ||
-		gp->cnt[op_right] || gp->cnt[op_full]) && (flag & join_order) ? rel_join_order : NULL;*/
-	/* TODO we have to propagate count statistics here */
-	(void) v;
-	(void) gp;
-	return NULL;
+	int flag = v->sql->sql_optimizer;
+	return gp->opt_level == 1 && !gp->cnt[op_update] && gp->cnt[op_join] > 1 &&
+		(flag & join_order) ? rel_join_enumerate : NULL;
 }
 
 
@@ -44,6 +44,7 @@ typedef struct sql_optimizer {
 #define statistics_gathered       (1 << 3)
 #define rel_remote_func_used      (1 << 4)
 #define rewrite_gt_zero_used      (1 << 5)
+#define join_enumerated           (1 << 6)
 
 #define is_rewrite_fix_count_used(X)    ((X & rewrite_fix_count_used) == rewrite_fix_count_used)
 #define is_rewrite_values_used(X)       ((X & rewrite_values_used) == rewrite_values_used)
@@ -51,6 +52,7 @@ typedef struct sql_optimizer {
 #define are_statistics_gathered(X)      ((X & statistics_gathered) == statistics_gathered)
 #define is_rel_remote_func_used(X)      ((X & rel_remote_func_used) == rel_remote_func_used)
 #define is_rewrite_gt_zero_used(X)      ((X & rewrite_gt_zero_used) == rewrite_gt_zero_used)
+#define is_join_enumerated(X)           ((X & join_enumerated) == join_enumerated)
 
 /* At the moment the following optimizers 'packs' can be disabled,
    later we could disable individual optimizers from the 'pack' */
@@ -274,7 +274,9 @@ sql_column_get_statistics(mvc *sql, sql_column *c, sql_exp *e)
 		}
 		VALclear(&min);
 	}
-	if (digits)
+	/* the parameters of an automatically prepared statement keep the column
+	 * type, to fit the literals of the next queries as well */
+	if (digits && !sql->auto_prepare)
 		et->digits = digits;
 	if (et->type->eclass == EC_DEC && et->digits <= et->scale)
 		et->digits = et->scale + 1;
@@ -699,6 +701,193 @@ trivial_project_exp_card(sql_exp *e)
 	return e->type == e_atom && e->f ? (BUN) list_length(e->f) : 1;
 }
 
+/* a numeric histogram bound, to interpolate within a bucket */
+static bool
+histogram_dbl(const ValRecord *v, dbl *d)
+{
+	switch (ATOMstorage(v->vtype)) {
+	case TYPE_bte:
+		*d = v->val.btval;
+		return true;
+	case TYPE_sht:
+		*d = v->val.shval;
+		return true;
+	case TYPE_int:
+		*d = v->val.ival;
+		return true;
+	case TYPE_lng:
+		*d = (dbl) v->val.lval;
+		return true;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		*d = (dbl) v->val.hval;
+		return true;
+#endif
+	case TYPE_flt:
+		*d = v->val.fval;
+		return true;
+	case TYPE_dbl:
+		*d = v->val.dval;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* the fraction of the rows with a value below v, or equal to v when inclusive */
+static dbl
+histogram_below(sql_histogram *h, const ValRecord *v, bool inclusive)
+{
+	dbl rows = 0;
+
+	for (int i = 0; i < h->nr_mcvs; i++) {
+		int c = VALcmp(&h->mcvs[i], v);
+
+		if (c < 0 || (inclusive && c == 0))
+			rows += h->mcv_rows[i];
+	}
+	for (int i = 0; i < h->nr_buckets; i++) {
+		int cl = VALcmp(v, &h->lower[i]), cu = VALcmp(v, &h->upper[i]);
+		dbl lo, hi, x;
+
+		if (cu > 0 || (inclusive && cu == 0)) {
+			rows += h->rows[i];
+		} else if (cl > 0 || (inclusive && cl == 0)) { /* within the bucket */
+			if (histogram_dbl(&h->lower[i], &lo) && histogram_dbl(&h->upper[i], &hi) && histogram_dbl(v, &x) && hi > lo)
+				rows += h->rows[i] * (x - lo) / (hi - lo);
+			else
+				rows += h->rows[i] / 2.0;
+		}
+	}
+	return rows / h->total;
+}
+
+/* the fraction of the rows equal to v */
+static dbl
+histogram_equal(sql_histogram *h, const ValRecord *v)
+{
+	for (int i = 0; i < h->nr_mcvs; i++)
+		if (VALcmp(&h->mcvs[i], v) == 0)
+			return (dbl) h->mcv_rows[i] / h->total;
+	for (int i = 0; i < h->nr_buckets; i++)
+		if (VALcmp(v, &h->lower[i]) >= 0 && VALcmp(v, &h->upper[i]) <= 0)
+			return (dbl) h->rows[i] / MAX(h->distinct[i], 1) / h->total;
+	return 0;
+}
+
+/* the value of constant e, of the type of column c */
+static ValRecord *
+histogram_value(mvc *sql, sql_column *c, sql_exp *e)
+{
+	atom *a = exp_value(sql, e);
+
+	if (!a || VALisnil(&a->data))
+		return NULL;
+	if (subtype_cmp(&a->tpe, &c->type) != 0 && !(a = atom_cast(sql->sa, atom_copy(sql->sa, a), &c->type)))
+		return NULL;
+	return a->data.vtype == c->type.type->localtype ? &a->data : NULL;
+}
+
+/* The fraction of the rows of rel matching the comparison e of a column
+ * with constants, from the histogram of the column collected by analyze,
+ * or -1 when unknown */
+static dbl
+exp_histogram_selectivity(mvc *sql, sql_rel *rel, sql_exp *e, sql_column **col)
+{
+	sql_exp *l = e->l;
+	sql_column *c;
+	sql_histogram *h;
+	ValRecord *lo, *hi;
+	dbl sel = -1, nonil;
+
+	if (e->type != e_cmp || is_anti(e) || (is_complex_exp(e->flag) && e->flag != cmp_in && e->flag != cmp_notin))
+		return -1;
+	if (l->type != e_column || !(c = exp_find_column(rel, l, -2)) || !(h = mvc_col_histogram(sql, c)))
+		return -1;
+	nonil = (dbl) (h->total - h->nils) / h->total;
+	if (e->f) { /* range */
+		if ((lo = histogram_value(sql, c, e->r)) && (hi = histogram_value(sql, c, e->f)))
+			sel = histogram_below(h, hi, range2rcompare(e->flag) == cmp_lte) - histogram_below(h, lo, range2lcompare(e->flag) == cmp_gt);
+	} else if (e->flag == cmp_in || e->flag == cmp_notin) {
+		sel = 0;
+		for (node *n = ((list *) e->r)->h; n && sel >= 0; n = n->next)
+			sel = (lo = histogram_value(sql, c, n->data)) ? sel + histogram_equal(h, lo) : -1;
+		if (sel >= 0 && e->flag == cmp_notin)
+			sel = nonil - sel;
+	} else if ((lo = histogram_value(sql, c, e->r))) {
+		switch (e->flag) {
+		case cmp_equal:
+			sel = histogram_equal(h, lo);
+			break;
+		case cmp_notequal:
+			sel = nonil - histogram_equal(h, lo);
+			break;
+		case cmp_lt:
+			sel = histogram_below(h, lo, false);
+			break;
+		case cmp_lte:
+			sel = histogram_below(h, lo, true);
+			break;
+		case cmp_gt:
+			sel = nonil - histogram_below(h, lo, true);
+			break;
+		case cmp_gte:
+			sel = nonil - histogram_below(h, lo, false);
+			break;
+		default:
+			break;
+		}
+	}
+	if (sel < 0)
+		return -1;
+	if (col)
+		*col = c;
+	return MIN(MAX(sel, 0), 1);
+}
+
+/* The fraction of the rows of select rel matching its predicates, from the
+ * histograms of the columns, the predicates without histogram are left
+ * out.  Equality predicates on a group of columns of the same table, of
+ * which the number of distinct combinations is known, are taken together
+ * as they may be correlated.  Returns -1 when nothing is known. */
+dbl
+rel_select_selectivity(mvc *sql, sql_rel *rel)
+{
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state = ma_open(ta);
+	int nr = 0, neq = 0;
+	sqlid *eqs = SA_NEW_ARRAY(ta, sqlid, list_length(rel->exps));
+	sql_table *t = NULL;
+	dbl sel = 1, eqsel = 1;
+
+	for (node *n = rel->exps->h; n && eqs; n = n->next) {
+		sql_exp *e = n->data;
+		sql_column *c = NULL;
+		dbl s = exp_histogram_selectivity(sql, rel, e, &c);
+
+		if (s < 0)
+			continue;
+		nr++;
+		sel *= s;
+		if (e->flag == cmp_equal && !e->f) {
+			if (neq == 0)
+				t = c->t;
+			else if (t != c->t)
+				t = NULL;
+			eqs[neq++] = c->base.id;
+			eqsel *= s;
+		}
+	}
+	if (t && neq > 1) {
+		lng distinct = mvc_group_distinct(sql, t, neq, eqs);
+
+		if (distinct > 0 && eqsel > 0 && eqsel < 1.0 / distinct)
+			sel = sel / eqsel / distinct;
+	}
+	ma_close(&ta_state);
+	return nr ? sel : -1;
+}
+
 static BUN
 rel_calc_nuniques(mvc *sql, sql_rel *l, list *exps)
 {
@@ -706,6 +895,31 @@ rel_calc_nuniques(mvc *sql, sql_rel *l, list *exps)
 
 	if (lv == 0)
 		return 0;
+	if (list_length(exps) > 1) {
+		/* the distinct combinations of a group of columns of a table, if analyzed */
+		allocator *ta = MT_thread_getallocator();
+		allocator_state ta_state = ma_open(ta);
+		sqlid *cols = SA_NEW_ARRAY(ta, sqlid, list_length(exps));
+		sql_table *t = NULL;
+		lng distinct = -1;
+		int nr = 0;
+
+		for (node *n = exps->h; n && cols; n = n->next) {
+			sql_column *c = exp_find_column(l, n->data, -2);
+
+			if (!c || (t && c->t != t)) {
+				cols = NULL;
+				break;
+			}
+			t = c->t;
+			cols[nr++] = c->base.id;
+		}
+		if (cols)
+			distinct = mvc_group_distinct(sql, t, nr, cols);
+		ma_close(&ta_state);
+		if (distinct >= 0)
+			return MIN((BUN) distinct, lv);
+	}
 	if (!list_empty(exps)) {
 		BUN nuniques = 1;
 		/* compute the highest number of unique values */
@@ -1034,9 +1248,14 @@ rel_get_statistics_(visitor *v, sql_rel *rel)
 			} else {
 				if (!list_empty(rel->exps) && !is_single(rel)) {
 					BUN cnt = get_rel_count(l), u = 1;
+					dbl sel = is_select(rel->op) ? rel_select_selectivity(v->sql, rel) : -1;
+
 					for (node *n = rel->exps->h ; n ; n = n->next) {
 						sql_exp *e = n->data, *el = e->l, *er = e->r;
 
+						/* predicates estimated from the histograms of the columns are left out */
+						if (sel >= 0 && exp_histogram_selectivity(v->sql, rel, e, NULL) >= 0)
+							continue;
 						/* simple expressions first */
 						if (e->type == e_cmp && e->flag == cmp_equal && exp_is_atom(er)) {
 							/* use selectivity */
@@ -1057,7 +1276,10 @@ rel_get_statistics_(visitor *v, sql_rel *rel)
 						}
 					}
 					/* u is an *estimate*, so don't set count_prop to 0 unless cnt is 0 */
-					set_count_prop(v->sql->sa, rel, cnt == 0 ? 0 : u == 0 || u > cnt ? 2 : cnt/u +1);
+					if (sel >= 0)
+						set_count_prop(v->sql->sa, rel, cnt == 0 ? 0 : (BUN) (cnt * sel / MAX(u, 1)) + 1);
+					else
+						set_count_prop(v->sql->sa, rel, cnt == 0 ? 0 : u == 0 || u > cnt ? 2 : cnt/u +1);
 				} else {
 					set_count_prop(v->sql->sa, rel, get_rel_count(l));
 				}
@@ -1346,6 +1568,10 @@ score_se(visitor *v, sql_rel *rel, sql_exp *e)
 		score += score_se_base(v, rel, l);
 	}
 	score += exp_keyvalue(e);
+	/* the more selective, the earlier, by the histogram of the column */
+	dbl sel = exp_histogram_selectivity(v->sql, rel, e, NULL);
+	if (sel >= 0)
+		score += (int) (-20 * log2(MAX(sel, 1e-6)));
 	return score;
 }
 
@@ -1978,12 +1978,12 @@ copyfromloader(sql_query *query, dlist *qname, symbol *fcall)
 }
 
 static sql_rel *
-copyto(sql_query *query, symbol *sq, const char *filename, dlist *seps, const char *null_string, int onclient)
+copyto(sql_query *query, symbol *sq, const char *filename, dlist *seps, const char *null_string, int onclient, const char *format)
 {
 	mvc *sql = query->sql;
-	const char *tsep = seps->h->data.sval;
-	const char *rsep = seps->h->next->data.sval;
-	const char *ssep = (seps->h->next->next)?seps->h->next->next->data.sval:"\"";
+	const char *tsep = seps?seps->h->data.sval:"|";
+	const char *rsep = seps?seps->h->next->data.sval:"\n";
+	const char *ssep = (seps && seps->h->next->next)?seps->h->next->next->data.sval:"\"";
 	const char *ns = (null_string)?null_string:"null";
 	sql_exp *tsep_e, *rsep_e, *ssep_e, *ns_e, *fname_e, *oncl_e;
 	exp_kind ek = {type_value, card_relation, TRUE};
@@ -2022,7 +2022,8 @@ copyto(sql_query *query, symbol *sq, const char *filename, dlist *seps, const ch
 		return NULL;
 
 	/* With regular COPY INTO <file>, the first argument is a string.
-	   With COPY INTO BINARY, it is an int. */
+	   With COPY INTO BINARY, it is an int. COPY INTO <file> PARQUET/ARROW
+	   adds the format after the file. */
 	append(exps, tsep_e);
 	append(exps, rsep_e);
 	append(exps, ssep_e);
@@ -2030,6 +2031,8 @@ copyto(sql_query *query, symbol *sq, const char *filename, dlist *seps, const ch
 	if (fname_e) {
 		append(exps, fname_e);
 		append(exps, oncl_e);
+		if (format)
+			append(exps, exp_atom_clob(sql->sa, format));
 	}
 	rel->l = r;
 	rel->r = NULL;
@@ -2228,7 +2231,7 @@ rel_updates(sql_query *query, symbol *s)
 	{
 		dlist *l = s->data.lval;
 
-		ret = copyto(query, l->h->data.sym, l->h->next->data.sval, l->h->next->next->data.lval, l->h->next->next->next->data.sval, l->h->next->next->next->next->data.i_val);
+		ret = copyto(query, l->h->data.sym, l->h->next->data.sval, l->h->next->next->data.lval, l->h->next->next->next->data.sval, l->h->next->next->next->next->data.i_val, l->h->next->next->next->next->next->data.sval);
 		sql->type = Q_UPDATE;
 	}
 		break;
@@ -495,6 +495,22 @@ mvc_trans(mvc *m)
 	return res;
 }
 
+/* Not all DDL changes versioned catalog objects (eg privileges), so after
+ * the commit of a transaction which executed DDL the cache version is
+ * raised, which invalidates the cached plans and results of all sessions.
+ * Without plan or result caches there is nothing to invalidate. */
+static void
+mvc_catalog_committed(mvc *m)
+{
+	if (m->catalog_changed) {
+		sqlstore *store = m->store;
+
+		if (ATOMIC_GET(&store->cat->caches) > 0)
+			ATOMIC_INC(&store->cat->cache_version);
+		m->catalog_changed = false;
+	}
+}
+
 str
 mvc_commit(mvc *m, int chain, const char *name, bool enabling_auto_commit)
 {
@@ -549,6 +565,7 @@ mvc_commit(mvc *m, int chain, const char *name, bool enabling_auto_commit)
 			default:
 				break;
 		}
+		mvc_catalog_committed(m);
 		if (chain) {
 			if (sql_trans_begin(m->session) < 0)
 				return createException(SQL, "sql.commit", SQLSTATE(40000) "%s finished successfully, but the session's schema could not be found while starting the next transaction", operation);
@@ -608,6 +625,7 @@ mvc_commit(mvc *m, int chain, const char *name, bool enabling_auto_commit)
 		default:
 			break;
 	}
+	mvc_catalog_committed(m);
 	if (chain) {
 		if (sql_trans_begin(m->session) < 0) {
 			if (!msg)
@@ -668,6 +686,7 @@ mvc_rollback(mvc *m, int chain, const char *name, bool disabling_auto_commit)
 			tr->status = 1;
 
 		(void) sql_trans_end(m->session, SQL_ERR);
+		m->catalog_changed = false;
 
 		if (chain) {
 			if (sql_trans_begin(m->session) < 0) {
@@ -1550,6 +1569,20 @@ mvc_col_stats(mvc *m, sql_column *col, bool *nonil, bool *unique, double *unique
 	return sql_trans_col_stats(m->session->tr, col, nonil, unique, unique_est, min, max);
 }
 
+sql_histogram *
+mvc_col_histogram(mvc *m, sql_column *col)
+{
+	TRC_DEBUG(SQL_TRANS, "Retrieving column histogram for: %s\n", col->base.name);
+	return sql_trans_col_histogram(m->session->tr, col, m->sa);
+}
+
+lng
+mvc_group_distinct(mvc *m, sql_table *t, int nr, const sqlid *cols)
+{
+	TRC_DEBUG(SQL_TRANS, "Retrieving column group distinct count for: %s\n", t->base.name);
+	return sql_trans_group_distinct(m->session->tr, t, nr, cols);
+}
+
 int
 mvc_copy_column(mvc *m, sql_table *t, sql_column *c, sql_column **cres)
 {
@@ -1610,11 +1643,8 @@ dnode_cmp(mvc *sql, dnode *d1, dnode *d2)
 		switch (d1->type) {
 			case type_int:
 				return (d1->data.i_val - d2->data.i_val);
-			case type_lng: {
-				lng c = d1->data.l_val - d2->data.l_val;
-				assert((lng) GDK_int_min <= c && c <= (lng) GDK_int_max);
-				return (int) c;
-			}
+			case type_lng:
+				return (d1->data.l_val > d2->data.l_val) - (d1->data.l_val < d2->data.l_val);
 			case type_string:
 				if (d1->data.sval == d2->data.sval)
 					return 0;
@@ -1659,7 +1689,8 @@ AtomNodeCmp(AtomNode *a1, AtomNode *a2)
 		return 0;
 	if (!a1 || !a2)
 		return -1;
-	if (a1->a && a2->a)
+	/* the same value of another type (1 and 1.0) is another literal */
+	if (a1->a && a2->a && subtype_cmp(&a1->a->tpe, &a2->a->tpe) == 0)
 		return atom_cmp(a1->a, a2->a);
 	return -1;
 }
@@ -1685,6 +1716,7 @@ SelectNodeCmp(mvc *sql, SelectNode *s1, SelectNode *s2)
 		symbol_cmp(sql, s1->where, s2->where) == 0 &&
 		symbol_cmp(sql, s1->from, s2->from) == 0 &&
 		symbol_cmp(sql, s1->window, s2->window) == 0 &&
+		symbol_cmp(sql, s1->qualify, s2->qualify) == 0 &&
 		dlist_cmp(sql, s1->selection, s2->selection) == 0)
 		return 0;
 	return -1;
@@ -1702,11 +1734,8 @@ _symbol_cmp(mvc *sql, symbol *s1, symbol *s2)
 	switch (s1->type) {
 		case type_int:
 			return (s1->data.i_val - s2->data.i_val);
-		case type_lng: {
-			lng c = s1->data.l_val - s2->data.l_val;
-			assert((lng) GDK_int_min <= c && c <= (lng) GDK_int_max);
-			return (int) c;
-		}
+		case type_lng:
+			return (s1->data.l_val > s2->data.l_val) - (s1->data.l_val < s2->data.l_val);
 		case type_string:
 			if (s1->data.sval == s2->data.sval)
 				return 0;
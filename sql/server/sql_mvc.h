@@ -150,7 +150,9 @@ typedef struct mvc {
 	bool use_views:1,
 		schema_path_has_sys:1,  /* speed up object search */
 		schema_path_has_tmp:1,
-		no_int128:1;
+		no_int128:1,
+		catalog_changed:1,		/* the transaction executed DDL */
+		auto_prepare:1;			/* compiling an automatically prepared statement */
 	struct qc *qc;
 	int clientid;		        /* id of the owner */
 
@@ -256,6 +258,8 @@ extern int mvc_is_sorted(mvc *c, sql_column *col);
 extern int mvc_is_unique(mvc *m, sql_column *col);
 extern int mvc_is_duplicate_eliminated(mvc *c, sql_column *col);
 extern int mvc_col_stats(mvc *m, sql_column *col, bool *nonil, bool *unique, double *unique_est, ValPtr min, ValPtr max);
+extern sql_histogram *mvc_col_histogram(mvc *m, sql_column *col);
+extern lng mvc_group_distinct(mvc *m, sql_table *t, int nr, const sqlid *cols);
 
 extern int mvc_create_ukey(sql_key **kres, mvc *m, sql_table *t, const char *name, key_type kt, const char* check);
 extern int mvc_create_fkey(sql_fkey **kres, mvc *m, sql_table *t, const char *name, key_type kt, sql_key *rkey, int on_delete, int on_update);
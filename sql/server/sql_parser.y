@@ -623,6 +623,7 @@ int yydebug=1;
 	sqlBOOL BOOL_FALSE BOOL_TRUE
 	CURRENT_DATE CURRENT_TIMESTAMP CURRENT_TIME LOCALTIMESTAMP LOCALTIME
 	BIG LITTLE NATIVE ENDIAN
+	PARQUET ARROW
 	LEX_ERROR
 
 /* the tokens used in geom */
@@ -3388,6 +3389,31 @@ copyto_stmt:
 			append_list(l, $6);
 			append_string(l, $7);
 			append_int(l, $5);
+			append_string(l, NULL);
+			$$ = _symbol_create_list( SQL_COPYINTO, l );
+		}
+		/* 1 2          3       4      5               6 */
+	|	COPY SelectStmt INTO_LA string opt_on_location PARQUET
+		{
+			dlist *l = L();
+			append_symbol(l, $2);
+			append_string(l, $4);
+			append_list(l, NULL);
+			append_string(l, NULL);
+			append_int(l, $5);
+			append_string(l, "parquet");
+			$$ = _symbol_create_list( SQL_COPYINTO, l );
+		}
+		/* 1 2          3       4      5               6 */
+	|	COPY SelectStmt INTO_LA string opt_on_location ARROW
+		{
+			dlist *l = L();
+			append_symbol(l, $2);
+			append_string(l, $4);
+			append_list(l, NULL);
+			append_string(l, NULL);
+			append_int(l, $5);
+			append_string(l, "arrow");
 			$$ = _symbol_create_list( SQL_COPYINTO, l );
 		}
 		/* 1 2          3       4      5        6 */
@@ -3399,6 +3425,7 @@ copyto_stmt:
 			append_list(l, $5);
 			append_string(l, $6);
 			append_int(l, 0);
+			append_string(l, NULL);
 			$$ = _symbol_create_list( SQL_COPYINTO, l );
 		}
 		/* 1 2          3       4              5      6                7 */
@@ -6798,6 +6825,7 @@ non_reserved_keyword:
 	|	WHITESPACE    { $$ = "whitespace"; }
 
 	|	ACTION        { $$ = "action"; }
+	|	ARROW         { $$ = "arrow"; }
 	|	AUTO_COMMIT   { $$ = "auto_commit"; }
 	|	BIG           { $$ = "big"; }
 	|	sqlBOOL       { $$ = "bool"; }
@@ -6832,6 +6860,7 @@ non_reserved_keyword:
 	|	OBJECT        { $$ = "object"; }
 	|	OPTIMIZER     { $$ = "optimizer"; }
 	|	OPTIONS       { $$ = "options"; }
+	|	PARQUET       { $$ = "parquet"; }
 	|	PASSWORD      { $$ = "password"; }
 	|	PATH          { $$ = "path"; }
 	|	PREP          { $$ = "prep"; }
@@ -88,8 +88,14 @@ void
 qc_restart(qc *cache)
 {
 	if (cache) {
-		for (cq *q = cache->q; q; q = q->next)
-			cq_restart(cache->clientid, q);
+		for (cq *q = cache->q, *n; q; q = n) {
+			n = q->next;
+			/* without the query text these are prepared again on their next use */
+			if (q->auto_prepared)
+				qc_delete(cache, q);
+			else
+				cq_restart(cache->clientid, q);
+		}
 	}
 }
 
@@ -125,6 +131,23 @@ qc_find(qc *cache, int id)
 	return NULL;
 }
 
+/* find the automatically prepared query with the same parse tree */
+cq *
+qc_match(qc *cache, mvc *sql, symbol *s)
+{
+	cq *q;
+
+	if (cache) {
+		for (q = cache->q; q; q = q->next) {
+			if (q->auto_prepared && symbol_cmp(sql, q->s, s) == 0) {
+				q->count++;
+				return q;
+			}
+		}
+	}
+	return NULL;
+}
+
 cq *
 qc_insert(qc *cache, allocator *sa, sql_rel *r, symbol *s, list *params, mapi_query_t type, char *cmd, int no_mitosis)
 {
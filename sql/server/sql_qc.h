@@ -29,6 +29,7 @@ typedef struct cq {
 	const char *name;	/* name of cached query */
 	int no_mitosis;		/* run query without mitosis */
 	int count;			/* number of times the query is matched */
+	bool auto_prepared;	/* prepared from the literals of an ad-hoc query */
 	timestamp created;	/* when the query was created */
 	sql_func *f;
 } cq;
@@ -45,6 +46,7 @@ extern void qc_clean(qc *cache);
 extern void qc_restart(qc *cache);
 extern void qc_destroy(qc *cache);
 sql_export cq *qc_find(qc *cache, int id);
+extern cq *qc_match(qc *cache, mvc *sql, symbol *s);
 sql_export cq *qc_insert(qc *cache, allocator *sa, sql_rel *r, symbol *s, list *params, mapi_query_t type, char *codedstr, int no_mitosis);
 sql_export void qc_delete(qc *cache, cq *q);
 extern int qc_size(qc *cache);
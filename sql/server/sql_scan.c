@@ -266,6 +266,8 @@ scanner_init_keywords(void)
 	failed += keywords_insert("LITTLE", LITTLE);
 	failed += keywords_insert("NATIVE", NATIVE);
 	failed += keywords_insert("ENDIAN", ENDIAN);
+	failed += keywords_insert("PARQUET", PARQUET);
+	failed += keywords_insert("ARROW", ARROW);
 
 	failed += keywords_insert("REFERENCES", REFERENCES);
 
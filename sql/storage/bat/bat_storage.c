@@ -936,7 +936,7 @@ bind_updates(sql_trans *tr, sql_column *c, BAT **ui, BAT **uv)
 		unlock_column(tr->store, c);
 		return LOG_ERR;
 	}
-	if (d->cs.st == ST_DICT) {
+	if (d->cs.st == ST_DICT || d->cs.st == ST_FSST) {
 		BAT *b = quick_descriptor(d->cs.bid);
 
 		type = b->ttype;
@@ -993,7 +993,7 @@ bind_col(sql_trans *tr, sql_column *c, int access)
 	size_t cnt = count_col(tr, c, 0);
 	assert (access != RD_UPD_ID && access != RD_UPD_VAL);
 	BAT *b = cs_bind_bat( &d->cs, access, cnt, true);
-	assert(!b || ((c->storage_type && access != RD_EXT) || b->ttype == c->type.type->localtype) || (access == QUICK && b->ttype < 0));
+	assert(!b || ((c->storage_type && access != RD_EXT) || b->ttype == c->type.type->localtype) || (access == QUICK && b->ttype < 0) || (access == RD_EXT && d->cs.st == ST_FSST));
 	return b;
 }
 
@@ -1014,7 +1014,7 @@ bind_col_no_view(sql_trans *tr, sql_column *c, int access)
 		return cs_bind_bat(&d->cs, access, cnt, false);
 	}
 	BAT *b = cs_bind_bat( &d->cs, access, cnt, false);
-	assert(!b || ((c->storage_type && access != RD_EXT) || b->ttype == c->type.type->localtype) || (access == QUICK && b->ttype < 0));
+	assert(!b || ((c->storage_type && access != RD_EXT) || b->ttype == c->type.type->localtype) || (access == QUICK && b->ttype < 0) || (access == RD_EXT && d->cs.st == ST_FSST));
 	return b;
 }
 
@@ -1306,6 +1306,102 @@ for_append_bat(column_storage *cs, BAT *i, char *storage_type)
 	return i;
 }
 
+static BAT *
+fsst_append_bat(column_storage *cs, BAT *i)
+{
+	BAT *newoffsets = NULL;
+	BAT *u = temp_descriptor(cs->ebid);
+
+	if (!u)
+		return NULL;
+	/* the escape code covers any string, so there is no need to decompress */
+	if (FSSTprepare4append(&newoffsets, i, u) < 0)
+		newoffsets = NULL;
+	bat_destroy(u);
+	return newoffsets;
+}
+
+/* the residuals of a delta compressed column depend on the position and
+ * the model kept in the storage type, "DELTA-<base>-<step>" */
+static void
+delta_enc_model(char *storage_type, lng *base, lng *step)
+{
+	char *e;
+
+	*base = strtoll(storage_type+6, &e, 10);
+	*step = strtoll(e+1, NULL, 10);
+}
+
+static int
+delta_enc_decompress(column_storage *cs, char *storage_type, int tt)
+{
+	BAT *b = NULL, *n = NULL;
+	lng base, step;
+
+	delta_enc_model(storage_type, &base, &step);
+	if (!(b = temp_descriptor(cs->bid)))
+		return LOG_ERR;
+	n = DELTAdecompress_(b, base, step, tt, PERSISTENT);
+	bat_destroy(b);
+	if (!n)
+		return LOG_ERR;
+	if (cs->ucnt) {
+		BAT *ui = NULL, *uv = NULL;
+		if (cs_real_update_bats(cs, &ui, &uv) != LOG_OK) {
+			bat_destroy(n);
+			return LOG_ERR;
+		}
+		if (BATupdate(n, ui, uv, true) != GDK_SUCCEED) {
+			bat_destroy(ui);
+			bat_destroy(uv);
+			bat_destroy(n);
+			return LOG_ERR;
+		}
+		bat_destroy(ui);
+		bat_destroy(uv);
+	}
+	if (cs->bid)
+		temp_destroy(cs->bid);
+	n = transfer_to_systrans(n);
+	if (n == NULL)
+		return LOG_ERR;
+	bat_set_access(n, BAT_READ);
+	cs->bid = temp_create(n);
+	bat_destroy(n);
+	cs->ucnt = 0;
+	if (cs->uibid)
+		temp_destroy(cs->uibid);
+	if (cs->uvbid)
+		temp_destroy(cs->uvbid);
+	cs->uibid = cs->uvbid = 0;
+	cs->st = ST_DEFAULT;
+	/* at append_col the column's storage type is cleared */
+	cs->cleared = true;
+	return LOG_OK;
+}
+
+/* returns the residuals to append, or the values themselves after the
+ * column was decompressed because they don't fit the model */
+static BAT *
+delta_enc_append_bat(column_storage *cs, BUN offset, BAT *offsets, BAT *i, char *storage_type)
+{
+	BAT *newoffsets = NULL, *b = NULL;
+	lng base, step;
+	int rt;
+
+	delta_enc_model(storage_type, &base, &step);
+	if (!(b = quick_descriptor(cs->bid)))
+		return NULL;
+	rt = b->ttype;
+	if (DELTAprepare4append(&newoffsets, i, offset, offsets, base, step, rt) < 0)
+		return NULL;
+	if (newoffsets)
+		return newoffsets;
+	if (delta_enc_decompress(cs, storage_type, i->ttype) != LOG_OK)
+		return NULL;
+	return i;
+}
+
 /*
  * Returns LOG_OK, LOG_ERR or LOG_CONFLICT
  */
@@ -1354,6 +1450,16 @@ cs_update_bat( sql_trans *tr, sql_delta **batp, sql_table *t, BAT *tids, BAT *up
 				bat_destroy(tids);
 			return LOG_ERR;
 		}
+	} else if (cs->st == ST_FSST) {
+		BAT *nupdates = fsst_append_bat(cs, updates);
+		if (oupdates != updates)
+			bat_destroy(updates);
+		updates = nupdates;
+		if (!updates) {
+			if (otids != tids)
+				bat_destroy(tids);
+			return LOG_ERR;
+		}
 	}
 
 	/* When we go to smaller grained update structures we should check for concurrent updates on this column ! */
@@ -1842,6 +1948,41 @@ for_append_val(column_storage *cs, void *i, BUN cnt, char *storage_type, int tt)
 	return i;
 }
 
+static void *
+fsst_append_val(column_storage *cs, void *i, BUN cnt)
+{
+	void *newoffsets = NULL;
+	BAT *u = temp_descriptor(cs->ebid);
+
+	if (!u)
+		return NULL;
+	if (FSSTprepare4append_vals(&newoffsets, i, cnt, u) < 0)
+		newoffsets = NULL;
+	bat_destroy(u);
+	return newoffsets;
+}
+
+static void *
+delta_enc_append_val(column_storage *cs, BUN offset, BAT *offsets, void *i, BUN cnt, char *storage_type, int tt)
+{
+	void *newoffsets = NULL;
+	BAT *b = NULL;
+	lng base, step;
+	int rt;
+
+	delta_enc_model(storage_type, &base, &step);
+	if (!(b = quick_descriptor(cs->bid)))
+		return NULL;
+	rt = b->ttype;
+	if (DELTAprepare4append_vals(&newoffsets, i, cnt, offset, offsets, base, step, tt, rt) < 0)
+		return NULL;
+	if (newoffsets)
+		return newoffsets;
+	if (delta_enc_decompress(cs, storage_type, tt) != LOG_OK)
+		return NULL;
+	return i;
+}
+
 static int
 cs_update_val( sql_trans *tr, sql_delta **batp, sql_table *t, oid rid, void *upd, int is_new)
 {
@@ -1859,6 +2000,15 @@ cs_update_val( sql_trans *tr, sql_delta **batp, sql_table *t, oid rid, void *upd
 		cs = &bat->cs;
 		if (!upd)
 			return LOG_ERR;
+	} else if (cs->st == ST_FSST) {
+		BAT *u = temp_descriptor(cs->ebid);
+
+		if (!u)
+			return LOG_ERR;
+		upd = FSSTencode_(u, upd);
+		bat_destroy(u);
+		if (!upd)
+			return LOG_ERR;
 	}
 
 	/* check if rid is insert ? */
@@ -2054,6 +2204,14 @@ update_col(sql_trans *tr, sql_column *c, void *tids, void *upd, bool isbat)
 	if (odelta != delta)
 		trans_add_table(tr, &c->base, c->t, delta, &tc_gc_upd_col, &commit_update_col, NOT_TO_BE_LOGGED(c->t) ? NULL : &log_update_col);
 
+	if (delta->cs.st == ST_DELTA) {
+		/* the updated values are unlikely to fit the model */
+		lock_column(tr->store, c);
+		res = delta_enc_decompress(&delta->cs, c->storage_type, c->type.type->localtype);
+		unlock_column(tr->store, c);
+		if (res != LOG_OK)
+			return res;
+	}
 	odelta = delta;
 	if ((res = update_col_execute(tr, &delta, c->t, isNew(c), tids, upd, isbat)) != LOG_OK)
 		return res;
@@ -2161,6 +2319,29 @@ delta_append_bat(sql_trans *tr, sql_delta **batp, BUN offset, BAT *offsets, BAT
 			return LOG_ERR;
 		}
 	}
+	if (bat->cs.st == ST_FSST) {
+		BAT *ni = fsst_append_bat(&bat->cs, oi);
+		if (oi != i) /* oi will be replaced, so destroy possible unmask reference */
+			bat_destroy(oi);
+		oi = ni;
+		if (!oi) {
+			return LOG_ERR;
+		}
+	}
+	if (bat->cs.st == ST_DELTA) {
+		/* the values are returned unchanged if the column got decompressed */
+		BAT *ni = delta_enc_append_bat(&bat->cs, offset, offsets, oi, storage_type);
+		if (!ni) {
+			if (oi != i)
+				bat_destroy(oi);
+			return LOG_ERR;
+		}
+		if (ni != oi) {
+			if (oi != i)
+				bat_destroy(oi);
+			oi = ni;
+		}
+	}
 
 	b = temp_descriptor(bat->cs.bid);
 	if (b == NULL) {
@@ -2237,6 +2418,20 @@ delta_append_val(sql_trans *tr, sql_delta **batp, BUN offset, BAT *offsets, void
 			return LOG_ERR;
 		}
 	}
+	if (bat->cs.st == ST_FSST) {
+		/* a new array of compressed values is returned */
+		i = fsst_append_val(&bat->cs, i, cnt);
+		if (!i) {
+			return LOG_ERR;
+		}
+	}
+	if (bat->cs.st == ST_DELTA) {
+		/* possibly a new array is returned */
+		i = delta_enc_append_val(&bat->cs, offset, offsets, i, cnt, storage_type, tt);
+		if (!i) {
+			return LOG_ERR;
+		}
+	}
 
 	b = temp_descriptor(bat->cs.bid);
 	if (b == NULL) {
@@ -2342,7 +2537,7 @@ append_col(sql_trans *tr, sql_column *c, BUN offset, BAT *offsets, void *data, B
 	if ((delta = bind_col_data(tr, c, NULL)) == NULL)
 		return LOG_ERR;
 
-	assert(delta->cs.st == ST_DEFAULT || delta->cs.st == ST_DICT || delta->cs.st == ST_FOR);
+	assert(delta->cs.st == ST_DEFAULT || delta->cs.st == ST_DICT || delta->cs.st == ST_FOR || delta->cs.st == ST_FSST || delta->cs.st == ST_DELTA);
 
 	odelta = delta;
 	if ((res = append_col_execute(tr, &delta, c, offset, offsets, data, cnt, isbat, tpe, c->storage_type)) != LOG_OK)
@@ -2660,6 +2855,7 @@ bind_del_data(sql_trans *tr, sql_table *t, bool *clear)
 	}
 	bat->cs.cleared = true;
 	bat->cs.ts = tr->tid;
+	bat->data_ts = obat->data_ts;
 	/* only one writer else abort */
 	bat->next = obat;
 	if (!ATOMIC_PTR_CAS(&t->data, (void**)&bat->next, bat)) {
@@ -2774,7 +2970,7 @@ min_max_col(sql_trans *tr, sql_column *c)
 	if (c->min && c->max)
 		return 1;
 	if ((d = ATOMIC_PTR_GET(&c->data))) {
-		if (d->cs.st == ST_FOR)
+		if (d->cs.st == ST_FOR || d->cs.st == ST_FSST || d->cs.st == ST_DELTA)
 			return 0;
 		int access = d->cs.st == ST_DICT ? RD_EXT : RDONLY;
 		lock_column(tr->store, c);
@@ -2836,6 +3032,18 @@ count_del(sql_trans *tr, sql_table *t, int access)
 	return count_deletes(d->segs->h, tr);
 }
 
+/* The commit time of the last change of the data of the table, if the
+ * transaction sees it, otherwise 0 */
+static ulng
+commit_ts_tab(sql_trans *tr, sql_table *t)
+{
+	storage *s = ATOMIC_PTR_GET(&t->data);
+
+	if (!isTable(t) || isTempTable(t) || !s || s->data_ts > tr->ts)
+		return 0;
+	return s->data_ts;
+}
+
 static int
 sorted_col(sql_trans *tr, sql_column *col)
 {
@@ -2858,12 +3066,13 @@ static int
 unique_col(sql_trans *tr, sql_column *col)
 {
 	int distinct = 0;
+	sql_delta *d;
 
 	assert(tr->active);
 	if (!isTable(col->t) || !col->t->s)
 		return 0;
 
-	if (col && ATOMIC_PTR_GET(&col->data)) {
+	if (col && (d = ATOMIC_PTR_GET(&col->data)) != NULL && d->cs.st != ST_DELTA /* unique residuals don't imply unique values */) {
 		BAT *b = bind_col(tr, col, QUICK);
 
 		if (b)
@@ -2919,10 +3128,24 @@ col_stats(sql_trans *tr, sql_column *c, bool *nonil, bool *unique, double *uniqu
 		return ok;
 
 	if ((d = ATOMIC_PTR_GET(&c->data))) {
-		if (d->cs.st == ST_FOR) {
+		if (d->cs.st == ST_FOR || d->cs.st == ST_DELTA) {
 			*nonil = true; /* TODO for min/max. I will do it later */
 			return ok;
 		}
+		if (d->cs.st == ST_FSST) {
+			/* equal strings have equal encodings, but the order is lost */
+			if ((b = bind_col_no_view(tr, c, RDONLY))) {
+				BATiter bi = bat_iterator(b);
+				*nonil = bi.nonil && !bi.nil && d->cs.ucnt == 0;
+				if (d->cs.ucnt == 0) {
+					*unique = bi.key;
+					*unique_est = bi.unique_est;
+				}
+				bat_iterator_end(&bi);
+				bat_destroy(b);
+			}
+			return ok;
+		}
 		int eclass = c->type.type->eclass;
 		int access = d->cs.st == ST_DICT ? RD_EXT : RDONLY;
 		if ((b = bind_col_no_view(tr, c, access))) {
@@ -3191,8 +3414,17 @@ create_col(sql_trans *tr, sql_column *c)
 					return LOG_ERR;
 				bat->cs.ebid = temp_dup(bid);
 				bat->cs.st = ST_DICT;
+			} else if (strcmp(c->storage_type, "FSST") == 0) {
+				sqlstore *store = tr->store;
+				int bid = log_find_bat(store->logger, -c->base.id);
+				if (bid <= 0)
+					return LOG_ERR;
+				bat->cs.ebid = temp_dup(bid);
+				bat->cs.st = ST_FSST;
 			} else if (strncmp(c->storage_type, "FOR", 3) == 0) {
 				bat->cs.st = ST_FOR;
+			} else if (strncmp(c->storage_type, "DELTA", 5) == 0) {
+				bat->cs.st = ST_DELTA;
 			}
 		}
 		return ok;
@@ -3493,6 +3725,7 @@ create_del(sql_trans *tr, sql_table *t)
 
 	if (!isNew(t) && !isTempTable(t)) {
 		bat->cs.ts = tr->ts;
+		bat->data_ts = tr->ts;
 		return load_storage(tr, t, bat, t->base.id);
 	} else if (bat->cs.bid) {
 		return ok;
@@ -3622,6 +3855,7 @@ commit_create_del( sql_trans *tr, sql_change *change, ulng commit_ts, ulng oldes
 	merge_segments(dbat, tr, change, commit_ts, commit_ts/* create is we are alone */ /*oldest*/);
 	assert(dbat->cs.ts == tr->tid);
 	dbat->cs.ts = commit_ts;
+	dbat->data_ts = commit_ts;
 	if (ok == LOG_OK) {
 		for(node *n = ol_first_node(t->columns); n && ok == LOG_OK; n = n->next) {
 			sql_column *c = n->data;
@@ -3804,7 +4038,7 @@ clear_cs(sql_trans *tr, column_storage *cs, bool renew, bool temp)
 	BUN sz = 0;
 
 	(void)tr;
-	assert(cs->st == ST_DEFAULT || cs->st == ST_DICT || cs->st == ST_FOR);
+	assert(cs->st == ST_DEFAULT || cs->st == ST_DICT || cs->st == ST_FOR || cs->st == ST_FSST || cs->st == ST_DELTA);
 	if (cs->bid && renew) {
 		b = quick_descriptor(cs->bid);
 		if (b) {
@@ -3826,6 +4060,14 @@ clear_cs(sql_trans *tr, column_storage *cs, bool renew, bool temp)
 				cs->bid = temp_create(n); /* create empty copy */
 				bat_destroy(n);
 			} else {
+				if (cs->st == ST_FSST) { /* keep the symbol table */
+					bat nebid = temp_copy(cs->ebid, false, temp);
+
+					if (nebid == BID_NIL)
+						return BUN_NONE;
+					temp_destroy(cs->ebid);
+					cs->ebid = nebid;
+				}
 				bat nbid = temp_copy(cs->bid, true, false); /* create empty copy */
 
 				if (nbid == BID_NIL)
@@ -4349,6 +4591,15 @@ commit_update_delta( sql_trans *tr, sql_change *change, sql_table* t, sql_column
 	return LOG_OK;
 }
 
+static void
+data_committed(sql_table *t, ulng commit_ts)
+{
+	storage *s = ATOMIC_PTR_GET(&t->data);
+
+	if (s)
+		s->data_ts = commit_ts;
+}
+
 static int
 commit_update_col( sql_trans *tr, sql_change *change, ulng commit_ts, ulng oldest)
 {
@@ -4361,6 +4612,8 @@ commit_update_col( sql_trans *tr, sql_change *change, ulng commit_ts, ulng oldes
 	if (change->handled || isDeleted(c->t))
 		return LOG_OK;
 
+	if (commit_ts && !tr->parent)
+		data_committed(t, commit_ts);
 	return commit_update_delta(tr, change, t, c, NULL, data, type, commit_ts, oldest);
 }
 
@@ -4394,6 +4647,8 @@ commit_update_idx( sql_trans *tr, sql_change *change, ulng commit_ts, ulng oldes
 	if (change->handled || isDeleted(i->t))
 		return LOG_OK;
 
+	if (commit_ts && !tr->parent)
+		data_committed(t, commit_ts);
 	return commit_update_delta(tr, change, t, NULL, i, data, type, commit_ts, oldest);
 }
 
@@ -4474,6 +4729,7 @@ commit_update_del( sql_trans *tr, sql_change *change, ulng commit_ts, ulng oldes
 	} else if (ok == LOG_OK && !tr->parent) {
 		if (dbat->cs.ts == tr->tid) /* cleared table */
 			dbat->cs.ts = commit_ts;
+		dbat->data_ts = commit_ts;
 
 		ok = segments2cs(tr, dbat->segs, &dbat->cs);
 		if (ok == LOG_OK) {
@@ -5193,6 +5449,7 @@ bat_storage_init( store_functions *sf)
 	sf->delete_tab = &delete_tab;
 
 	sf->count_del = &count_del;
+	sf->commit_ts_tab = &commit_ts_tab;
 	sf->count_col = &count_col;
 	sf->count_idx = &count_idx;
 	sf->dcount_col = &dcount_col;
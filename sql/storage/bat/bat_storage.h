@@ -20,7 +20,7 @@ typedef struct column_storage {
 	int ebid;		/* extra bid */
 	int uibid;		/* bat with positions of updates */
 	int uvbid;		/* bat with values of updates */
-	storage_type st; /* ST_DEFAULT, ST_DICT, ST_FOR */
+	storage_type st; /* ST_DEFAULT, ST_DICT, ST_FOR, ST_FSST, ST_DELTA */
 	bool cleared;
 	bool merged;	/* only merge changes once */
 	size_t ucnt;	/* number of updates */
@@ -57,6 +57,7 @@ typedef struct segments {
 typedef struct storage {
 	column_storage cs;	/* storage on disk */
 	segments *segs;	/* local used segments */
+	ulng data_ts;	/* commit time of the last change of the data */
 	struct storage *next;
 } storage;
 
@@ -138,9 +138,11 @@ typedef int (*tab_validate_fptr) (sql_trans *tr, sql_table *t, int uncommitted);
 
 /*
 -- count number of rows in column (excluding the deletes)
+-- commit time of the last change of the table data
 -- check for sortedness
  */
 typedef size_t (*count_del_fptr) (sql_trans *tr, sql_table *t, int access);
+typedef ulng (*commit_ts_tab_fptr) (sql_trans *tr, sql_table *t);
 typedef size_t (*count_col_fptr) (sql_trans *tr, sql_column *c, int access);
 typedef size_t (*count_idx_fptr) (sql_trans *tr, sql_idx *i, int access);
 typedef size_t (*dcount_col_fptr) (sql_trans *tr, sql_column *c);
@@ -199,6 +201,8 @@ typedef enum storage_type {
 	ST_DEFAULT = 0,
 	ST_DICT,
 	ST_FOR,
+	ST_FSST,
+	ST_DELTA,
 } storage_type;
 
 typedef int (*col_compress_fptr) (sql_trans *tr, sql_column *c, storage_type st, BAT *offsets, BAT *vals);
@@ -230,6 +234,7 @@ typedef struct store_functions {
 	tab_validate_fptr tab_validate;
 
 	count_del_fptr count_del;
+	commit_ts_tab_fptr commit_ts_tab;
 	count_col_fptr count_col;
 	count_idx_fptr count_idx;
 	dcount_col_fptr dcount_col;
@@ -408,6 +413,11 @@ extern int sql_trans_is_duplicate_eliminated(sql_trans *tr, sql_column *col);
 extern int sql_trans_col_stats(sql_trans *tr, sql_column *col, bool *nonil, bool *unique, double *unique_est, ValPtr min, ValPtr max);
 extern size_t sql_trans_dist_count(sql_trans *tr, sql_column *col);
 extern int sql_trans_ranges(sql_trans *tr, sql_column *col, void **min, void **max);
+extern sql_histogram *sql_histogram_create(allocator *sa, int nr_buckets, int nr_mcvs);
+extern sql_histogram *sql_trans_col_histogram(sql_trans *tr, sql_column *col, allocator *sa);
+extern int sql_trans_set_col_histogram(sql_trans *tr, sql_column *col, sql_histogram *h);
+extern lng sql_trans_group_distinct(sql_trans *tr, sql_table *t, int nr, const sqlid *cols);
+extern int sql_trans_set_group_distinct(sql_trans *tr, sql_table *t, int nr, const sqlid *cols, lng distinct);
 
 extern void column_destroy(struct sqlstore *store, sql_column *c);
 extern void idx_destroy(struct sqlstore *store, sql_idx * i);
@@ -557,6 +567,15 @@ extern BAT *FORdecompress_(BAT *o, lng minval, int tt, role_t role);
 extern int FORprepare4append(BAT **noffsets, BAT *vals, lng minval, int tt);
 extern int FORprepare4append_vals(void **noffsets, void *vals, BUN cnt, lng minval, int vtype, int ft);
 
+extern BAT *FSSTdecompress_(BAT *o, BAT *u, role_t role);
+extern blob *FSSTencode_(BAT *u, const char *s);
+extern int FSSTprepare4append(BAT **noffsets, BAT *vals, BAT *u);
+extern int FSSTprepare4append_vals(void **noffsets, void *vals, BUN cnt, BAT *u);
+
+extern BAT *DELTAdecompress_(BAT *o, lng base, lng step, int tt, role_t role);
+extern int DELTAprepare4append(BAT **noffsets, BAT *vals, BUN offset, BAT *offsets, lng base, lng step, int rt);
+extern int DELTAprepare4append_vals(void **noffsets, void *vals, BUN cnt, BUN offset, BAT *offsets, lng base, lng step, int vtype, int rt);
+
 extern void store_printinfo(sqlstore *store);
 
 #endif /*SQL_STORAGE_H */
@@ -208,6 +208,92 @@ trigger_destroy(sqlstore *store, sql_trigger *t)
 	_DELETE(t);
 }
 
+/* The value distributions collected by analyze are kept in the tables
+ * sys.statistics_histograms, sys.statistics_mcvs and sys.statistics_groups,
+ * created by the SQL scripts (so they may be missing during an upgrade).
+ * Values are stored in their string representation.  The histogram of a
+ * column is cached with the column, as long as the statistics tables are
+ * not changed. */
+static sql_table *
+statistics_table(sql_trans *tr, const char *name)
+{
+	return find_sql_table(tr, find_sql_schema(tr, "sys"), name);
+}
+
+static int
+statistics_delete(sql_trans *tr, sql_table *t, const char *cname, sqlid id)
+{
+	sqlstore *store = tr->store;
+	sql_column *c;
+	rids *rs;
+	int res = LOG_OK;
+
+	if (!t || !(c = find_sql_column(t, cname)))
+		return LOG_OK;
+	if (!(rs = store->table_api.rids_select(tr, c, &id, &id, NULL)))
+		return LOG_ERR;
+	for (oid rid = store->table_api.rids_next(rs); !is_oid_nil(rid) && res == LOG_OK; rid = store->table_api.rids_next(rs))
+		res = store->table_api.table_delete(tr, t, rid);
+	store->table_api.rids_destroy(rs);
+	return res;
+}
+
+/* drop the column groups of table t with column id */
+static int
+statistics_delete_groups(sql_trans *tr, sql_table *t, sqlid id)
+{
+	sqlstore *store = tr->store;
+	sql_table *groups = statistics_table(tr, "statistics_groups");
+	sql_column *tid, *cols;
+	char key[16];
+	rids *rs;
+	oid rid;
+	int res = LOG_OK;
+
+	if (!groups || !(tid = find_sql_column(groups, "table_id")) || !(cols = find_sql_column(groups, "columns")))
+		return LOG_OK;
+	if (!(rs = store->table_api.rids_select(tr, tid, &t->base.id, &t->base.id, NULL)))
+		return LOG_ERR;
+	snprintf(key, sizeof(key), "%d", id);
+	while (res == LOG_OK && !is_oid_nil(rid = store->table_api.rids_next(rs))) {
+		ptr cbat;
+		const char *v = store->table_api.column_find_string_start(tr, cols, rid, &cbat);
+		size_t len = strlen(key);
+		bool found = false;
+
+		for (const char *p = v; p && !found; p = strchr(p, ',')) {
+			if (*p == ',')
+				p++;
+			found = strncmp(p, key, len) == 0 && (p[len] == ',' || p[len] == 0);
+		}
+		store->table_api.column_find_string_end(cbat);
+		if (found)
+			res = store->table_api.table_delete(tr, groups, rid);
+	}
+	store->table_api.rids_destroy(rs);
+	return res;
+}
+
+static void
+histogram_destroy(sql_histogram *h)
+{
+	if (!h)
+		return;
+	for (int i = 0; i < h->nr_buckets; i++) {
+		VALclear(&h->lower[i]);
+		VALclear(&h->upper[i]);
+	}
+	for (int i = 0; i < h->nr_mcvs; i++)
+		VALclear(&h->mcvs[i]);
+	GDKfree(h->lower);
+	GDKfree(h->upper);
+	GDKfree(h->rows);
+	GDKfree(h->distinct);
+	GDKfree(h->mcvs);
+	GDKfree(h->mcv_rows);
+	GDKfree(h);
+}
+
 void
 column_destroy(sqlstore *store, sql_column *c)
 {
@@ -218,6 +304,7 @@ column_destroy(sqlstore *store, sql_column *c)
 		store->storage_api.destroy_col(store, c);
 	_DELETE(c->min);
 	_DELETE(c->max);
+	histogram_destroy(c->hist);
 	_DELETE(c->def);
 	_DELETE(c->storage_type);
 	_DELETE(c->base.name);
@@ -4196,6 +4283,8 @@ sql_trans_create_(sqlstore *store, sql_trans *parent, const char *name)
 		store->cat->schemas = os_new(NULL, (destroy_fptr) &schema_destroy, false, true, true, true, store);
 		store->cat->objects = os_new(NULL, (destroy_fptr) &key_destroy, false, false, true, false, store);
 		ATOMIC_INIT(&store->cat->schema_version, 0);
+		ATOMIC_INIT(&store->cat->cache_version, 0);
+		ATOMIC_INIT(&store->cat->caches, 0);
 	}
 	tr->tmp = store->tmp;
 	TRC_DEBUG(SQL_STORE, "New transaction: %p\n", tr);
@@ -4915,6 +5004,11 @@ sys_drop_column(sql_trans *tr, sql_column *col, int drop_action)
 		return res;
 	if ((res = sql_trans_drop_any_comment(tr, col->base.id)))
 		return res;
+	if (!isTempTable(col->t) &&
+		((res = statistics_delete(tr, statistics_table(tr, "statistics_histograms"), "column_id", col->base.id)) ||
+		 (res = statistics_delete(tr, statistics_table(tr, "statistics_mcvs"), "column_id", col->base.id)) ||
+		 (res = statistics_delete_groups(tr, col->t, col->base.id))))
+		return res;
 	if ((res = sql_trans_drop_obj_priv(tr, col->base.id)))
 		return res;
 	if ((res = sys_drop_default_object(tr, col, drop_action)))
@@ -5126,6 +5220,8 @@ sys_drop_table(sql_trans *tr, sql_table *t, int drop_action)
 
 	if ((res = sql_trans_drop_any_comment(tr, t->base.id)))
 		return res;
+	if (!isTempTable(t) && (res = statistics_delete(tr, statistics_table(tr, "statistics_groups"), "table_id", t->base.id)))
+		return res;
 	if (!isNew(t) && (res = sql_trans_add_dependency_change(tr, t->base.id, ddl)))
 		return res;
 	if ((res = sql_trans_drop_dependencies(tr, t->base.id)))
@@ -6907,6 +7003,354 @@ sql_trans_ranges( sql_trans *tr, sql_column *col, void **min, void **max )
 	return *min != NULL && *max != NULL;
 }
 
+/* a histogram for nr_buckets buckets and nr_mcvs most common values, in sa
+ * or (when sa is NULL) in malloced memory */
+sql_histogram *
+sql_histogram_create(allocator *sa, int nr_buckets, int nr_mcvs)
+{
+	sql_histogram *h;
+	size_t nb = (size_t) MAX(nr_buckets, 1), nm = (size_t) MAX(nr_mcvs, 1);
+
+	if (sa) {
+		if (!(h = SA_ZNEW(sa, sql_histogram)) ||
+			!(h->lower = SA_ZNEW_ARRAY(sa, ValRecord, nb)) ||
+			!(h->upper = SA_ZNEW_ARRAY(sa, ValRecord, nb)) ||
+			!(h->rows = SA_ZNEW_ARRAY(sa, lng, nb)) ||
+			!(h->distinct = SA_ZNEW_ARRAY(sa, lng, nb)) ||
+			!(h->mcvs = SA_ZNEW_ARRAY(sa, ValRecord, nm)) ||
+			!(h->mcv_rows = SA_ZNEW_ARRAY(sa, lng, nm)))
+			return NULL;
+		return h;
+	}
+	if (!(h = ZNEW(sql_histogram)))
+		return NULL;
+	h->lower = GDKzalloc(nb * sizeof(ValRecord));
+	h->upper = GDKzalloc(nb * sizeof(ValRecord));
+	h->rows = GDKzalloc(nb * sizeof(lng));
+	h->distinct = GDKzalloc(nb * sizeof(lng));
+	h->mcvs = GDKzalloc(nm * sizeof(ValRecord));
+	h->mcv_rows = GDKzalloc(nm * sizeof(lng));
+	if (!h->lower || !h->upper || !h->rows || !h->distinct || !h->mcvs || !h->mcv_rows) {
+		histogram_destroy(h);
+		return NULL;
+	}
+	return h;
+}
+
+static sql_histogram *
+histogram_copy(allocator *sa, const sql_histogram *h)
+{
+	sql_histogram *n = sql_histogram_create(sa, h->nr_buckets, h->nr_mcvs);
+
+	if (!n)
+		return NULL;
+	for (int i = 0; i < h->nr_buckets; i++) {
+		if (!VALcopy(sa, &n->lower[i], &h->lower[i]) || !VALcopy(sa, &n->upper[i], &h->upper[i]))
+			return NULL;
+		n->rows[i] = h->rows[i];
+		n->distinct[i] = h->distinct[i];
+	}
+	n->nr_buckets = h->nr_buckets;
+	for (int i = 0; i < h->nr_mcvs; i++) {
+		if (!VALcopy(sa, &n->mcvs[i], &h->mcvs[i]))
+			return NULL;
+		n->mcv_rows[i] = h->mcv_rows[i];
+	}
+	n->nr_mcvs = h->nr_mcvs;
+	n->nils = h->nils;
+	n->total = h->total;
+	return n;
+}
+
+static bool
+statistics_value(allocator *ta, ValRecord *v, int tpe, const char *s)
+{
+	void *p = NULL;
+	size_t len = 0;
+
+	if (strNil(s) || ATOMfromstr(ta, tpe, &p, &len, s, false) < 0)
+		return false;
+	return VALinit(NULL, v, tpe, p) != NULL;
+}
+
+static char *
+statistics_str(allocator *ta, int tpe, const ValRecord *v)
+{
+	char *buf = NULL;
+	size_t len = 0;
+
+	if (BATatoms[tpe].atomToStr(ta, &buf, &len, VALptr(v), false) < 0)
+		return NULL;
+	return buf;
+}
+
+/* read the histogram of the column from the statistics tables, a column
+ * without statistics gets an empty one */
+static sql_histogram *
+histogram_load(sql_trans *tr, sql_column *col, sql_table *hists, sql_table *mcvs)
+{
+	sqlstore *store = tr->store;
+	sql_column *hid = find_sql_column(hists, "column_id"), *mid = find_sql_column(mcvs, "column_id");
+	int tpe = col->type.type->localtype, nb = 0, nm = 0;
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state;
+	sql_histogram *h = NULL;
+	rids *hs = NULL, *ms = NULL;
+	oid rid;
+
+	if (!hid || !mid)
+		return NULL;
+	if (!(hs = store->table_api.rids_select(tr, hid, &col->base.id, &col->base.id, NULL)) ||
+		!(ms = store->table_api.rids_select(tr, mid, &col->base.id, &col->base.id, NULL)))
+		goto bailout;
+	while (!is_oid_nil(store->table_api.rids_next(hs)))
+		nb++;
+	while (!is_oid_nil(store->table_api.rids_next(ms)))
+		nm++;
+	hs->cur = ms->cur = 0;
+	if (!(h = sql_histogram_create(NULL, nb, nm)))
+		goto bailout;
+
+	ta_state = ma_open(ta);
+	/* the buckets are stored by number, keep them in that order */
+	int *bucket = ma_alloc(ta, MAX(nb, 1) * sizeof(int));
+	while (bucket && !is_oid_nil(rid = store->table_api.rids_next(hs))) {
+		int b = store->table_api.column_find_int(tr, find_sql_column(hists, "bucket"), rid), i;
+		ptr cbat;
+		const char *v;
+		ValRecord lo, hi;
+		bool ok;
+
+		v = store->table_api.column_find_string_start(tr, find_sql_column(hists, "lower"), rid, &cbat);
+		ok = statistics_value(ta, &lo, tpe, v);
+		store->table_api.column_find_string_end(cbat);
+		if (!ok)
+			continue;
+		v = store->table_api.column_find_string_start(tr, find_sql_column(hists, "upper"), rid, &cbat);
+		ok = statistics_value(ta, &hi, tpe, v);
+		store->table_api.column_find_string_end(cbat);
+		if (!ok) {
+			VALclear(&lo);
+			continue;
+		}
+		for (i = h->nr_buckets; i > 0 && bucket[i - 1] > b; i--) {
+			bucket[i] = bucket[i - 1];
+			h->lower[i] = h->lower[i - 1];
+			h->upper[i] = h->upper[i - 1];
+			h->rows[i] = h->rows[i - 1];
+			h->distinct[i] = h->distinct[i - 1];
+		}
+		bucket[i] = b;
+		h->lower[i] = lo;
+		h->upper[i] = hi;
+		h->rows[i] = store->table_api.column_find_lng(tr, find_sql_column(hists, "rows"), rid);
+		h->distinct[i] = store->table_api.column_find_lng(tr, find_sql_column(hists, "distinct"), rid);
+		h->total += h->rows[i];
+		h->nr_buckets++;
+	}
+	while (!is_oid_nil(rid = store->table_api.rids_next(ms))) {
+		lng rows = store->table_api.column_find_lng(tr, find_sql_column(mcvs, "rows"), rid);
+		ptr cbat;
+		const char *v = store->table_api.column_find_string_start(tr, find_sql_column(mcvs, "value"), rid, &cbat);
+
+		if (strNil(v)) {
+			h->nils = rows;
+			h->total += rows;
+		} else if (statistics_value(ta, &h->mcvs[h->nr_mcvs], tpe, v)) {
+			h->mcv_rows[h->nr_mcvs++] = rows;
+			h->total += rows;
+		}
+		store->table_api.column_find_string_end(cbat);
+	}
+	ma_close(&ta_state);
+	if (!bucket) {
+		histogram_destroy(h);
+		h = NULL;
+	}
+  bailout:
+	if (hs)
+		store->table_api.rids_destroy(hs);
+	if (ms)
+		store->table_api.rids_destroy(ms);
+	return h;
+}
+
+/* the histogram of the column, copied into sa, or NULL when it has none */
+sql_histogram *
+sql_trans_col_histogram(sql_trans *tr, sql_column *col, allocator *sa)
+{
+	sqlstore *store = tr->store;
+	sql_table *hists, *mcvs;
+	sql_histogram *h = NULL, *n, *old;
+	ulng ts = 0;
+
+	if (!col || !isTable(col->t) || isTempTable(col->t) || !(hists = statistics_table(tr, "statistics_histograms")) || !(mcvs = statistics_table(tr, "statistics_mcvs")))
+		return NULL;
+	/* only cache with the catalog's own column, not with a copy, and not
+	 * for a transaction with changes of its own, it may see other statistics */
+	if (!tr->parent && list_empty(tr->changes) && sql_trans_find_table(tr, col->t->base.id) == col->t) {
+		ulng hts = store->storage_api.commit_ts_tab(tr, hists), mts = store->storage_api.commit_ts_tab(tr, mcvs);
+
+		if (hts && mts)
+			ts = MAX(hts, mts);
+	}
+	if (ts) {
+		MT_lock_set(&col->lock);
+		if (col->hist && col->hist_ts == ts) {
+			if (col->hist->total > 0)
+				h = histogram_copy(sa, col->hist);
+			MT_lock_unset(&col->lock);
+			return h;
+		}
+		MT_lock_unset(&col->lock);
+	}
+	if (!(n = histogram_load(tr, col, hists, mcvs)))
+		return NULL;
+	if (n->total > 0)
+		h = histogram_copy(sa, n);
+	if (ts) {
+		MT_lock_set(&col->lock);
+		old = col->hist;
+		col->hist = n;
+		col->hist_ts = ts;
+		MT_lock_unset(&col->lock);
+		n = old;
+	}
+	histogram_destroy(n);
+	return h;
+}
+
+/* replace the statistics of the column by the histogram h (if not NULL) */
+int
+sql_trans_set_col_histogram(sql_trans *tr, sql_column *col, sql_histogram *h)
+{
+	sqlstore *store = tr->store;
+	sql_table *hists = statistics_table(tr, "statistics_histograms"), *mcvs = statistics_table(tr, "statistics_mcvs");
+	int tpe = col->type.type->localtype, res;
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state;
+
+	if (!hists || !mcvs)
+		return LOG_OK;
+	if ((res = statistics_delete(tr, hists, "column_id", col->base.id)) ||
+		(res = statistics_delete(tr, mcvs, "column_id", col->base.id)) || !h)
+		return res;
+	ta_state = ma_open(ta);
+	for (int i = 0; i < h->nr_buckets && res == LOG_OK; i++) {
+		char *lower = statistics_str(ta, tpe, &h->lower[i]), *upper = statistics_str(ta, tpe, &h->upper[i]);
+
+		if (!lower || !upper)
+			res = LOG_ERR;
+		else
+			res = store->table_api.table_insert(tr, hists, &col->base.id, &i, &lower, &upper, &h->rows[i], &h->distinct[i]);
+	}
+	for (int i = 0; i < h->nr_mcvs && res == LOG_OK; i++) {
+		char *value = statistics_str(ta, tpe, &h->mcvs[i]);
+
+		if (!value)
+			res = LOG_ERR;
+		else
+			res = store->table_api.table_insert(tr, mcvs, &col->base.id, &value, &h->mcv_rows[i]);
+	}
+	if (h->nils > 0 && res == LOG_OK) {
+		const char *value = ATOMnilptr(TYPE_str);
+
+		res = store->table_api.table_insert(tr, mcvs, &col->base.id, &value, &h->nils);
+	}
+	ma_close(&ta_state);
+	return res;
+}
+
+/* the sorted, comma separated ids of a column group */
+static char *
+statistics_group(allocator *sa, int nr, const sqlid *cols)
+{
+	sqlid *ids = ma_alloc(sa, nr * sizeof(sqlid));
+	char *buf = ma_alloc(sa, nr * 12 + 1), *p = buf;
+
+	if (!ids || !buf)
+		return NULL;
+	for (int i = 0; i < nr; i++) {
+		int j;
+
+		for (j = i; j > 0 && ids[j - 1] > cols[i]; j--)
+			ids[j] = ids[j - 1];
+		ids[j] = cols[i];
+	}
+	*p = 0;
+	for (int i = 0; i < nr; i++)
+		p += sprintf(p, "%s%d", i ? "," : "", ids[i]);
+	return buf;
+}
+
+static oid
+statistics_group_row(sql_trans *tr, sql_table *groups, sqlid table_id, const char *key)
+{
+	sqlstore *store = tr->store;
+	sql_column *tid = find_sql_column(groups, "table_id"), *cols = find_sql_column(groups, "columns");
+	oid rid, res = oid_nil;
+	rids *rs;
+
+	if (!tid || !cols || !(rs = store->table_api.rids_select(tr, tid, &table_id, &table_id, NULL)))
+		return oid_nil;
+	while (is_oid_nil(res) && !is_oid_nil(rid = store->table_api.rids_next(rs))) {
+		ptr cbat;
+		const char *v = store->table_api.column_find_string_start(tr, cols, rid, &cbat);
+
+		if (strcmp(v, key) == 0)
+			res = rid;
+		store->table_api.column_find_string_end(cbat);
+	}
+	store->table_api.rids_destroy(rs);
+	return res;
+}
+
+/* the number of distinct combinations of values of the columns of t, as
+ * collected by analyze, or -1 when unknown */
+lng
+sql_trans_group_distinct(sql_trans *tr, sql_table *t, int nr, const sqlid *cols)
+{
+	sqlstore *store = tr->store;
+	sql_table *groups = statistics_table(tr, "statistics_groups");
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state;
+	lng res = -1;
+	char *key;
+	oid rid;
+
+	if (!groups || nr < 2 || !isTable(t))
+		return -1;
+	ta_state = ma_open(ta);
+	if ((key = statistics_group(ta, nr, cols)) && !is_oid_nil(rid = statistics_group_row(tr, groups, t->base.id, key)))
+		res = store->table_api.column_find_lng(tr, find_sql_column(groups, "distinct"), rid);
+	ma_close(&ta_state);
+	return res;
+}
+
+int
+sql_trans_set_group_distinct(sql_trans *tr, sql_table *t, int nr, const sqlid *cols, lng distinct)
+{
+	sqlstore *store = tr->store;
+	sql_table *groups = statistics_table(tr, "statistics_groups");
+	allocator *ta = MT_thread_getallocator();
+	allocator_state ta_state;
+	int res = LOG_OK;
+	char *key;
+	oid rid;
+
+	if (!groups)
+		return LOG_OK;
+	ta_state = ma_open(ta);
+	if (!(key = statistics_group(ta, nr, cols)))
+		res = LOG_ERR;
+	else if (!is_oid_nil(rid = statistics_group_row(tr, groups, t->base.id, key)))
+		res = store->table_api.table_delete(tr, groups, rid);
+	if (res == LOG_OK)
+		res = store->table_api.table_insert(tr, groups, &t->base.id, &key, &distinct);
+	ma_close(&ta_state);
+	return res;
+}
+
 int
 sql_trans_create_ukey(sql_key **kres, sql_trans *tr, sql_table *t, const char *name, key_type kt, const char* check)
 {
@@ -7699,6 +8143,7 @@ sql_trans_begin(sql_session *s)
 	int res = ATOMIC_GET(&s->schema_version) ?
 		ATOMIC_GET(&s->schema_version) != ATOMIC_GET(&tr->cat->schema_version) : 0;
 	ATOMIC_SET(&s->schema_version, tr->cat->schema_version);
+	ATOMIC_SET(&s->cache_version, ATOMIC_GET(&tr->cat->cache_version));
 
 	ATOMIC_INC(&store->nr_active);
 	list_append(store->active, tr);
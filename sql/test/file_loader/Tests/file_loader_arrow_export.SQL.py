@@ -0,0 +1,60 @@
+from MonetDBtesting import tpymonetdb as pymonetdb
+import os, sys, datetime, decimal, uuid
+import pyarrow as pa
+import pyarrow.compute as pc
+import pyarrow.ipc
+
+# COPY SELECT ... INTO file ARROW, read back with pyarrow
+
+TSTTRGDIR = os.environ['TSTTRGDIR']
+arrowexp = os.path.join(TSTTRGDIR, 'arrowexp.arrow')
+arrowexp2 = os.path.join(TSTTRGDIR, 'arrowexp2.arrow')
+
+dbh = pymonetdb.connect(port=int(os.getenv('MAPIPORT')),hostname=os.getenv('MAPIHOST'),database=os.getenv('TSTDB'), autocommit=True)
+cursor = dbh.cursor()
+
+cursor.execute('''
+create table arrowexp (b boolean, t tinyint, i int, l bigint, d decimal(10,2), f double, dt date, tm time(3), ts timestamp, v varchar(20), u uuid);
+insert into arrowexp values
+ (true, 1, 3, 4, 12.34, 2.5, '2020-01-02', '12:34:56.789', '2020-01-02 03:04:05.678901', 'hello', 'aee1a538-aca1-381b-d9f4-8c29ef3f5f7a'),
+ (null, null, null, null, null, null, null, null, null, null, null),
+ (false, -1, -3, -4, -0.01, -1.25, '1969-12-31', '00:00:00', '1900-01-01 00:00:00', '', '00000000-0000-0000-0000-000000000001');
+''')
+cursor.execute("copy select * from arrowexp into r'%s' arrow" % arrowexp)
+# more rows than fit in one record batch
+cursor.execute("copy select value as i, 'v' || (value %% 10) as s from generate_series(0, 1100000) into r'%s' arrow" % arrowexp2)
+cursor.execute("drop table arrowexp")
+cursor.close()
+dbh.close()
+
+with pa.ipc.open_stream(arrowexp) as reader:
+    tbl = reader.read_all()
+
+types = [(f.name, str(f.type)) for f in tbl.schema]
+if types != [('b', 'bool'), ('t', 'int8'), ('i', 'int32'), ('l', 'int64'),
+             ('d', 'decimal128(10, 2)'), ('f', 'double'), ('dt', 'date32[day]'),
+             ('tm', 'time64[us]'), ('ts', 'timestamp[us]'), ('v', 'string'),
+             ('u', 'extension<arrow.uuid>')]:
+    sys.stderr.write('unexpected schema %s\n' % types)
+
+rows = [tuple(r.values()) for r in tbl.to_pylist()]
+expected = [
+    (True, 1, 3, 4, decimal.Decimal('12.34'), 2.5, datetime.date(2020, 1, 2),
+     datetime.time(12, 34, 56, 789000), datetime.datetime(2020, 1, 2, 3, 4, 5, 678901),
+     'hello', uuid.UUID('aee1a538-aca1-381b-d9f4-8c29ef3f5f7a')),
+    (None,) * 11,
+    (False, -1, -3, -4, decimal.Decimal('-0.01'), -1.25, datetime.date(1969, 12, 31),
+     datetime.time(0, 0), datetime.datetime(1900, 1, 1, 0, 0),
+     '', uuid.UUID('00000000-0000-0000-0000-000000000001')),
+]
+if rows != expected:
+    sys.stderr.write('unexpected rows %s\n' % rows)
+
+with pa.ipc.open_stream(arrowexp2) as reader:
+    batches = list(reader)
+
+if [b.num_rows for b in batches] != [1048576, 51424]:
+    sys.stderr.write('unexpected record batches %s\n' % [b.num_rows for b in batches])
+tbl = pa.Table.from_batches(batches)
+if (pc.sum(tbl['i']).as_py(), pc.max(tbl['s']).as_py(), tbl['i'].null_count) != (604999450000, 'v9', 0):
+    sys.stderr.write('unexpected contents of the record batches\n')
@@ -0,0 +1,84 @@
+###
+# Check that a query whose memory budget does not fit in the global
+#   budget waits in sys.memory_claims until the running query releases
+#   its budget, and then runs
+# Uses its own server, started with a global budget of 100 MB
+###
+
+from MonetDBtesting import tpymonetdb as pymonetdb
+import os, sys, tempfile, threading, time
+
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+finished = {}
+
+def run_qry(port, name, msecs):
+    dbh = pymonetdb.connect(database='db1', port=port, autocommit=True)
+    cur = dbh.cursor()
+    # a budget of 80 MB, two of these do not fit in the global budget
+    cur.execute('call sys.setmemorylimit(80)')
+    cur.execute(f"select '{name}', mysleep({msecs})")
+    if cur.fetchall() != [(name, msecs)]:
+        sys.stderr.write(f'unexpected result of query {name}\n')
+    finished[name] = time.time()
+    cur.close()
+    dbh.close()
+
+with tempfile.TemporaryDirectory() as farm_dir:
+    os.mkdir(os.path.join(farm_dir, 'db1'))
+
+    with process.server(args=['--set', 'query_memory_budget=100'],
+                        dbname='db1',
+                        dbfarm=os.path.join(farm_dir, 'db1'),
+                        stdin=process.PIPE,
+                        stdout=process.PIPE,
+                        stderr=process.PIPE,
+                        mapiport='0') as s:
+        dbh = pymonetdb.connect(database='db1', port=s.dbport, autocommit=True)
+        cur = dbh.cursor()
+        cur.execute('create function mysleep(msecs int) returns int external name alarm.sleep')
+
+        t1 = threading.Thread(target=run_qry, args=(s.dbport, 'q1', 3000))
+        t1.start()
+        time.sleep(1)
+        t2 = threading.Thread(target=run_qry, args=(s.dbport, 'q2', 100))
+        t2.start()
+        time.sleep(1)
+
+        # the queries of this session have no budget and are not held up
+        cur.execute('select budget, status from sys.memory_claims order by queued')
+        res = cur.fetchall()
+        if res != [(80, 'running'), (80, 'waiting')]:
+            sys.stderr.write(f"[(80, 'running'), (80, 'waiting')] expected, {res} received\n")
+        cur.execute("select status from sys.queue where query like '%mysleep(100)%' and query not like '%sys.queue%'")
+        res = cur.fetchall()
+        if res != [('waiting',)]:
+            sys.stderr.write(f"[('waiting',)] expected, {res} received\n")
+        cur.execute('select reserved from sys.memory_budget()')
+        res = cur.fetchall()
+        if res != [(80,)]:
+            sys.stderr.write(f'[(80,)] expected, {res} received\n')
+
+        t1.join()
+        t2.join()
+        if 'q1' not in finished or 'q2' not in finished:
+            sys.stderr.write('queries did not finish\n')
+        elif finished['q2'] < finished['q1']:
+            sys.stderr.write('the waiting query finished before the running one\n')
+
+        cur.execute('select count(*) from sys.memory_claims')
+        res = cur.fetchall()
+        if res != [(0,)]:
+            sys.stderr.write(f'[(0,)] expected, {res} received\n')
+        cur.execute('select reserved from sys.memory_budget()')
+        res = cur.fetchall()
+        if res != [(0,)]:
+            sys.stderr.write(f'[(0,)] expected, {res} received\n')
+
+        cur.execute('drop function mysleep')
+        cur.close()
+        dbh.close()
+        s.communicate()
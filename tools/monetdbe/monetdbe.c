@@ -2886,6 +2886,467 @@ cleanup:
 	return mdbe->msg;
 }
 
+/*
+ * Arrow C data interface.  The result is exported as a struct array with
+ * one child per column.  The children point into the heaps of the result
+ * BATs, which are kept alive by the export until its release callback
+ * is called.  Only what has no Arrow equivalent in the BAT is converted
+ * or allocated: validity bitmaps (MonetDB uses nil values), booleans
+ * (bit packed in Arrow), dates, timestamps and small decimals.  Strings
+ * and blobs are exported as string/binary views that refer to the
+ * strings in the BAT's var heap.
+ */
+
+#define ARROW_VIEW_CHUNK	((size_t) 1 << 30)	/* max bytes addressed by one view buffer */
+
+typedef struct {
+	BAT *b;
+	BATiter bi;
+	void *owned[3];		/* buffers allocated for the export */
+	const void **buffers;
+	struct ArrowArray **children;
+} monetdbe_arrow_array;
+
+typedef struct {
+	char *format;
+	char *name;
+	char *metadata;
+	struct ArrowSchema **children;
+} monetdbe_arrow_schema;
+
+static void
+monetdbe_arrow_release_array(struct ArrowArray *array)
+{
+	monetdbe_arrow_array *p = array->private_data;
+
+	for (int64_t i = 0; i < array->n_children; i++) {
+		struct ArrowArray *c = array->children[i];
+		if (c->release)
+			c->release(c);
+	}
+	if (p) {
+		if (p->b) {
+			bat_iterator_end(&p->bi);
+			BBPunfix(p->b->batCacheid);
+		}
+		for (int i = 0; i < 3; i++)
+			GDKfree(p->owned[i]);
+		GDKfree(p->buffers);
+		if (p->children) {
+			GDKfree(p->children[0]);	/* all children are allocated at once */
+			GDKfree(p->children);
+		}
+		GDKfree(p);
+	}
+	array->release = NULL;
+}
+
+static void
+monetdbe_arrow_release_schema(struct ArrowSchema *schema)
+{
+	monetdbe_arrow_schema *p = schema->private_data;
+
+	for (int64_t i = 0; i < schema->n_children; i++) {
+		struct ArrowSchema *c = schema->children[i];
+		if (c->release)
+			c->release(c);
+	}
+	if (p) {
+		GDKfree(p->format);
+		GDKfree(p->name);
+		GDKfree(p->metadata);
+		if (p->children) {
+			GDKfree(p->children[0]);
+			GDKfree(p->children);
+		}
+		GDKfree(p);
+	}
+	schema->release = NULL;
+}
+
+/* the Arrow format string of a result column, NULL if there is none */
+static char *
+monetdbe_arrow_format(BAT *b, sql_subtype *t, int *uuid)
+{
+	char buf[64];
+	const char *f = NULL;
+	sql_class ec = t->type->eclass;
+
+	*uuid = 0;
+	if (ec == EC_DEC) {
+		int bits = ATOMstorage(b->ttype) == TYPE_lng ? 64 :
+#ifdef HAVE_HGE
+			ATOMstorage(b->ttype) == TYPE_hge ? 128 :
+#endif
+			32;
+		if (bits == 128)
+			snprintf(buf, sizeof(buf), "d:%u,%u", t->digits, t->scale);
+		else
+			snprintf(buf, sizeof(buf), "d:%u,%u,%d", t->digits, t->scale, bits);
+		return GDKstrdup(buf);
+	}
+	if (b->ttype == TYPE_date)
+		f = "tdD";
+	else if (b->ttype == TYPE_daytime)
+		f = "ttu";
+	else if (b->ttype == TYPE_timestamp)
+		f = EC_TEMP_TZ(ec) ? "tsu:UTC" : "tsu:";
+	else if (b->ttype == TYPE_uuid) {
+		f = "w:16";
+		*uuid = 1;
+	} else if (b->ttype == TYPE_blob)
+		f = "vz";
+	else {
+		switch (b->ttype) {
+		case TYPE_bit: f = "b"; break;
+		case TYPE_bte: f = "c"; break;
+		case TYPE_sht: f = "s"; break;
+		case TYPE_int: f = ec == EC_MONTH ? "tiM" : "i"; break;
+		case TYPE_lng: f = ec == EC_SEC ? "tDm" : "l"; break;
+#ifdef HAVE_HGE
+		case TYPE_hge: f = "d:38,0"; break;
+#endif
+		case TYPE_oid: f = "L"; break;
+		case TYPE_flt: f = "f"; break;
+		case TYPE_dbl: f = "g"; break;
+		case TYPE_str: f = "vu"; break;
+		default:
+			if (ATOMstorage(b->ttype) == TYPE_str)	/* json, url, ... */
+				f = "vu";
+			break;
+		}
+	}
+	return f ? GDKstrdup(f) : NULL;
+}
+
+#define ARROW_NULLS(T, ISNIL)						\
+	do {								\
+		const T *v = (const T *) p->bi.base;			\
+		for (BUN i = 0; i < n; i++) {				\
+			if (ISNIL(v[i])) {				\
+				nulls++;				\
+				if (valid)				\
+					valid[i >> 3] &= (uint8_t) ~(1 << (i & 7)); \
+			}						\
+		}							\
+	} while (0)
+
+/* count the nils, and if there are any, create the validity bitmap */
+static int64_t
+monetdbe_arrow_validity(monetdbe_arrow_array *p, uint8_t *valid)
+{
+	BUN n = p->bi.count;
+	int64_t nulls = 0;
+
+	if (p->bi.nonil)
+		return 0;
+	if (valid)
+		memset(valid, 0xFF, (n + 7) / 8);
+	switch (ATOMstorage(p->bi.type)) {
+	case TYPE_bte:
+		ARROW_NULLS(bte, is_bte_nil);
+		break;
+	case TYPE_sht:
+		ARROW_NULLS(sht, is_sht_nil);
+		break;
+	case TYPE_int:
+		ARROW_NULLS(int, is_int_nil);
+		break;
+	case TYPE_lng:
+		ARROW_NULLS(lng, is_lng_nil);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ARROW_NULLS(hge, is_hge_nil);
+		break;
+#endif
+	case TYPE_flt:
+		ARROW_NULLS(flt, is_flt_nil);
+		break;
+	case TYPE_dbl:
+		ARROW_NULLS(dbl, is_dbl_nil);
+		break;
+	case TYPE_uuid:
+		ARROW_NULLS(uuid, is_uuid_nil);
+		break;
+	case TYPE_str:
+		for (BUN i = 0; i < n; i++) {
+			if (strNil(BUNtvar(&p->bi, i))) {
+				nulls++;
+				if (valid)
+					valid[i >> 3] &= (uint8_t) ~(1 << (i & 7));
+			}
+		}
+		break;
+	default:		/* blob */
+		for (BUN i = 0; i < n; i++) {
+			if (is_blob_nil((const blob *) BUNtvar(&p->bi, i))) {
+				nulls++;
+				if (valid)
+					valid[i >> 3] &= (uint8_t) ~(1 << (i & 7));
+			}
+		}
+		break;
+	}
+	return nulls;
+}
+
+/* the views of a string or blob column refer into the var heap, which is
+ * split in ARROW_VIEW_CHUNK sized (overlapping) buffers, as view offsets
+ * are 32 bits */
+static char *
+monetdbe_arrow_views(monetdbe_arrow_array *p, struct ArrowArray *a)
+{
+	BUN n = p->bi.count;
+	const char *base = p->bi.vh->base;
+	size_t hfree = p->bi.vh->free;
+	int64_t nbufs = (int64_t) ((hfree + ARROW_VIEW_CHUNK - 1) / ARROW_VIEW_CHUNK);
+	int isstr = ATOMstorage(p->bi.type) == TYPE_str;
+	uint8_t *views;
+	int64_t *sizes;
+
+	if (nbufs == 0)
+		nbufs = 1;
+	if (!(views = p->owned[1] = GDKzalloc(n ? n * 16 : 16)) ||
+		!(sizes = p->owned[2] = GDKmalloc(nbufs * sizeof(int64_t))) ||
+		!(p->buffers = GDKmalloc((3 + nbufs) * sizeof(void *))))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	for (BUN i = 0; i < n; i++) {
+		const char *v = BUNtvar(&p->bi, i), *d;
+		size_t len;
+		uint8_t *view = views + 16 * i;
+
+		if (isstr) {
+			if (strNil(v))
+				continue;
+			d = v;
+			len = strlen(v);
+		} else {
+			if (is_blob_nil((const blob *) v))
+				continue;
+			d = (const char *) ((const blob *) v)->data;
+			len = ((const blob *) v)->nitems;
+		}
+		if (len > (size_t) INT32_MAX)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", "value too large for an Arrow view");
+		int32_t l = (int32_t) len;
+		memcpy(view, &l, 4);
+		if (len <= 12) {
+			memcpy(view + 4, d, len);
+		} else {
+			size_t off = (size_t) (d - base);
+			int32_t buf = (int32_t) (off / ARROW_VIEW_CHUNK);
+			int32_t o = (int32_t) (off % ARROW_VIEW_CHUNK);
+			memcpy(view + 4, d, 4);
+			memcpy(view + 8, &buf, 4);
+			memcpy(view + 12, &o, 4);
+		}
+	}
+	p->buffers[0] = p->owned[0];
+	p->buffers[1] = views;
+	for (int64_t i = 0; i < nbufs; i++) {
+		size_t start = (size_t) i * ARROW_VIEW_CHUNK;
+		p->buffers[2 + i] = base + start;
+		sizes[i] = (int64_t) (hfree > start ? hfree - start : 0);
+	}
+	p->buffers[2 + nbufs] = sizes;
+	a->buffers = p->buffers;
+	a->n_buffers = 3 + nbufs;
+	return MAL_SUCCEED;
+}
+
+static char *
+monetdbe_arrow_column(res_col *rc, struct ArrowArray *a, struct ArrowSchema *s)
+{
+	monetdbe_arrow_array *p;
+	monetdbe_arrow_schema *ps;
+	BAT *b;
+	BUN n;
+	int uuid;
+	sql_class ec = rc->type.type->eclass;
+
+	if (!(p = GDKzalloc(sizeof(monetdbe_arrow_array))))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	*a = (struct ArrowArray) {.release = monetdbe_arrow_release_array, .private_data = p};
+	if (!(ps = GDKzalloc(sizeof(monetdbe_arrow_schema))))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	*s = (struct ArrowSchema) {.release = monetdbe_arrow_release_schema, .private_data = ps, .flags = ARROW_FLAG_NULLABLE};
+
+	if (!(b = BATdescriptor(rc->b)))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (b->ttype == TYPE_void) {
+		BAT *m = COLcopy(b, TYPE_oid, true, TRANSIENT);
+		BBPunfix(b->batCacheid);
+		if (!(b = m))
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	}
+	p->b = b;
+	p->bi = bat_iterator(b);
+	n = p->bi.count;
+
+	if (!(ps->name = GDKstrdup(rc->name)))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	if (!(ps->format = monetdbe_arrow_format(b, &rc->type, &uuid)))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", "Type %s of column %s not supported", rc->type.type->base.name, rc->name);
+	if (uuid) {
+		/* the canonical extension type */
+		static const char key[] = "ARROW:extension:name", val[] = "arrow.uuid";
+		int32_t one = 1, kl = (int32_t) strlen(key), vl = (int32_t) strlen(val);
+		char *m = ps->metadata = GDKmalloc(12 + kl + vl);
+		if (!m)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+		memcpy(m, &one, 4);
+		memcpy(m + 4, &kl, 4);
+		memcpy(m + 8, key, kl);
+		memcpy(m + 8 + kl, &vl, 4);
+		memcpy(m + 12 + kl, val, vl);
+	}
+	s->format = ps->format;
+	s->name = ps->name;
+	s->metadata = ps->metadata;
+
+	a->length = (int64_t) n;
+	if (!p->bi.nonil && !(p->owned[0] = GDKmalloc(n ? (n + 7) / 8 : 1)))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	if ((a->null_count = monetdbe_arrow_validity(p, p->owned[0])) == 0) {
+		GDKfree(p->owned[0]);
+		p->owned[0] = NULL;
+	}
+
+	if (ps->format[0] == 'v')
+		return monetdbe_arrow_views(p, a);
+
+	const void *data = p->bi.base;
+	if (b->ttype == TYPE_bit) {
+		const bit *v = p->bi.base;
+		uint8_t *o = p->owned[1] = GDKzalloc(n ? (n + 7) / 8 : 1);
+		if (!o)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+		for (BUN i = 0; i < n; i++)
+			if (v[i] == 1)
+				o[i >> 3] |= (uint8_t) (1 << (i & 7));
+		data = o;
+	} else if (b->ttype == TYPE_date) {
+		const date *v = p->bi.base;
+		int32_t *o = p->owned[1] = GDKmalloc(n ? n * sizeof(int32_t) : 1);
+		date epoch = date_create(1970, 1, 1);
+		if (!o)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+		for (BUN i = 0; i < n; i++)
+			o[i] = is_date_nil(v[i]) ? 0 : (int32_t) date_diff(v[i], epoch);
+		data = o;
+	} else if (b->ttype == TYPE_timestamp) {
+		const timestamp *v = p->bi.base;
+		int64_t *o = p->owned[1] = GDKmalloc(n ? n * sizeof(int64_t) : 1);
+		if (!o)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+		for (BUN i = 0; i < n; i++)
+			o[i] = is_timestamp_nil(v[i]) ? 0 : (int64_t) timestamp_diff(v[i], unixepoch);
+		data = o;
+	} else if (ec == EC_DEC && (b->ttype == TYPE_bte || b->ttype == TYPE_sht)) {
+		/* Arrow has no 8 and 16 bit decimals */
+		int32_t *o = p->owned[1] = GDKmalloc(n ? n * sizeof(int32_t) : 1);
+		if (!o)
+			return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+		for (BUN i = 0; i < n; i++)
+			o[i] = b->ttype == TYPE_bte ? ((const bte *) p->bi.base)[i] : ((const sht *) p->bi.base)[i];
+		data = o;
+	}
+	if (!(p->buffers = GDKmalloc(2 * sizeof(void *))))
+		return createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL);
+	p->buffers[0] = p->owned[0];
+	p->buffers[1] = data;
+	a->buffers = p->buffers;
+	a->n_buffers = 2;
+	return MAL_SUCCEED;
+}
+
+char*
+monetdbe_result_fetch_arrow(monetdbe_result* mres, struct ArrowSchema *schema, struct ArrowArray *array)
+{
+	monetdbe_result_internal* result = (monetdbe_result_internal*) mres;
+	monetdbe_database_internal *mdbe = result->mdbe;
+	monetdbe_arrow_array *p = NULL;
+	monetdbe_arrow_schema *ps = NULL;
+	struct ArrowArray a = {0}, *ac = NULL;
+	struct ArrowSchema s = {0}, *sc = NULL;
+	size_t ncols = mres->ncols;
+	mvc *m;
+
+	if ((mdbe->msg = validate_database_handle(mdbe, "monetdbe.monetdbe_result_fetch_arrow")) != MAL_SUCCEED)
+		return mdbe->msg;
+	if ((mdbe->msg = getSQLContext(mdbe->c, NULL, &m, NULL)) != MAL_SUCCEED)
+		goto cleanup;
+	if (!schema || !array) {
+		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", "Parameter schema or array is NULL"));
+		goto cleanup;
+	}
+	if (!result->monetdbe_resultset) {
+		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", "Query did not produce a result set"));
+		goto cleanup;
+	}
+
+	/* the struct array, which owns the columns */
+	if (!(p = GDKzalloc(sizeof(monetdbe_arrow_array))) ||
+		!(ps = GDKzalloc(sizeof(monetdbe_arrow_schema))) ||
+		!(p->buffers = GDKzalloc(sizeof(void *))) ||
+		!(ps->format = GDKstrdup("+s")) ||
+		!(ps->name = GDKstrdup("")) ||
+		(ncols > 0 &&
+		 (!(p->children = GDKzalloc(ncols * sizeof(struct ArrowArray *))) ||
+		  !(ps->children = GDKzalloc(ncols * sizeof(struct ArrowSchema *))) ||
+		  !(ac = GDKzalloc(ncols * sizeof(struct ArrowArray))) ||
+		  !(sc = GDKzalloc(ncols * sizeof(struct ArrowSchema)))))) {
+		GDKfree(ac);
+		GDKfree(sc);
+		if (p) {
+			GDKfree(p->buffers);
+			GDKfree(p->children);
+			GDKfree(p);
+		}
+		if (ps) {
+			GDKfree(ps->format);
+			GDKfree(ps->name);
+			GDKfree(ps->children);
+			GDKfree(ps);
+		}
+		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_result_fetch_arrow", MAL_MALLOC_FAIL));
+		goto cleanup;
+	}
+	for (size_t i = 0; i < ncols; i++) {
+		p->children[i] = ac + i;
+		ps->children[i] = sc + i;
+	}
+	a = (struct ArrowArray) {
+		.length = mres->nrows,
+		.n_buffers = 1,
+		.buffers = p->buffers,
+		.children = p->children,
+		.release = monetdbe_arrow_release_array,
+		.private_data = p,
+	};
+	s = (struct ArrowSchema) {
+		.format = ps->format,
+		.name = ps->name,
+		.children = ps->children,
+		.release = monetdbe_arrow_release_schema,
+		.private_data = ps,
+	};
+	for (size_t i = 0; i < ncols; i++) {
+		a.n_children = s.n_children = (int64_t) i + 1;
+		if ((mdbe->msg = monetdbe_arrow_column(&result->monetdbe_resultset->cols[i], ac + i, sc + i)) != MAL_SUCCEED) {
+			a.release(&a);
+			s.release(&s);
+			goto cleanup;
+		}
+	}
+	*array = a;
+	*schema = s;
+cleanup:
+	mdbe->msg = commit_action(m, mdbe, NULL, NULL);
+	return mdbe->msg;
+}
+
 static void
 data_from_date(date d, monetdbe_data_date *ptr)
 {